@@ -0,0 +1,506 @@
+// predictor_bench.cc
+// Predictor microbenchmark: times predict+update per branch for every
+// conditional predictor (through the same cond_branch_predictor_interface
+// calls the simulator makes) and for the ITTAGE indirect predictor, on
+// deterministic synthetic branch streams. No trace or simulator is involved.
+//
+// Results are written as CSV. Given a baseline CSV, every (predictor, stream)
+// whose ns/branch grew by more than the threshold relative to the run's
+// median change is reported and the exit status is 1, so `make bench` fails
+// on a speed regression of some predictors but not on a slower machine.
+//
+// Each measurement runs on a freshly spawned thread: predictor state is
+// thread_local, so every run starts from the state a fresh ./cbp would.
+// Setup is not timed, and the fastest of -r repetitions is kept.
+//
+// -latency 1 instead times single predict and update calls of TAGE-SC-L and
+// of its pre-rewrite copy in reference/, and prints their distribution.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../cbp.h"
+#include "../cond_branch_predictor_interface.h"
+#include "../lib/predictor_type.h"
+#include "../lib/ittage.h"
+
+struct branch_t {
+   uint64_t pc;
+   bool taken;
+   uint64_t target;   // indirect target for ITTAGE; 0: derived from taken
+};
+
+struct stream_t {
+   const char *name;
+   std::vector<branch_t> branches;
+};
+
+// splitmix64: small, fast and identical on every platform.
+struct bench_rng_t {
+   uint64_t s;
+   explicit bench_rng_t(uint64_t seed) : s(seed) {}
+   uint64_t next() {
+      uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+   }
+   bool chance(uint32_t percent) { return (next() % 100) < percent; }
+};
+
+static const uint64_t BENCH_PC_BASE = 0x400000;
+
+// Mostly-biased branches: 256 PCs, each 97% in its own preferred direction.
+static stream_t gen_biased(size_t n)
+{
+   stream_t st{"biased", {}};
+   bench_rng_t rng(1);
+   std::vector<bool> bias(256);
+   for (size_t p = 0; p < bias.size(); p++)
+      bias[p] = rng.chance(50);
+   for (size_t i = 0; i < n; i++) {
+      const size_t p = rng.next() % bias.size();
+      st.branches.push_back({BENCH_PC_BASE + 4 * p, rng.chance(97) ? bias[p] : !bias[p]});
+   }
+   return st;
+}
+
+// Nested loops: inner trip count 7, middle 23, plus an always-taken guard.
+static stream_t gen_loop(size_t n)
+{
+   stream_t st{"loop", {}};
+   while (st.branches.size() < n) {
+      for (int j = 0; j < 23 && st.branches.size() < n; j++) {
+         st.branches.push_back({BENCH_PC_BASE + 0x100, true});
+         for (int k = 0; k < 7; k++)
+            st.branches.push_back({BENCH_PC_BASE + 0x104, k != 6});
+         st.branches.push_back({BENCH_PC_BASE + 0x108, j != 22});
+      }
+   }
+   st.branches.resize(n);
+   return st;
+}
+
+// Globally correlated: two random "data" branches followed by a branch whose
+// outcome is their XOR, so only a predictor with global history gets it.
+static stream_t gen_correlated(size_t n)
+{
+   stream_t st{"correlated", {}};
+   bench_rng_t rng(2);
+   while (st.branches.size() < n) {
+      const uint64_t site = BENCH_PC_BASE + 0x1000 * (rng.next() % 16);
+      const bool a = rng.chance(50);
+      const bool b = rng.chance(50);
+      st.branches.push_back({site, a});
+      st.branches.push_back({site + 0x10, b});
+      st.branches.push_back({site + 0x20, (a ^ b) != 0});
+   }
+   st.branches.resize(n);
+   return st;
+}
+
+// Unpredictable: 1024 PCs with 50/50 outcomes (worst case for update paths).
+static stream_t gen_random(size_t n)
+{
+   stream_t st{"random", {}};
+   bench_rng_t rng(3);
+   for (size_t i = 0; i < n; i++)
+      st.branches.push_back({BENCH_PC_BASE + 4 * (rng.next() % 1024), rng.chance(50)});
+   return st;
+}
+
+// Large footprint: 256K distinct PCs, biased, to stress table capacity and
+// host caches rather than prediction logic.
+static stream_t gen_large_footprint(size_t n)
+{
+   stream_t st{"large_footprint", {}};
+   bench_rng_t rng(4);
+   for (size_t i = 0; i < n; i++) {
+      const uint64_t p = rng.next() % (256 * 1024);
+      st.branches.push_back({BENCH_PC_BASE + 4 * p, ((p * 0x9E3779B1u) >> 7 & 7) != 0});
+   }
+   return st;
+}
+
+// Indirect heavy: 32 virtual call sites with 1 to 8 targets each. The
+// "object type" flowing through a sequence of 4 sites usually stays the
+// same, so a site's target is correlated with the targets of the sites
+// before it (what ITTAGE's path history captures). A chain picks a new type
+// 10% of the time, and 5% of the calls go to a random target. The
+// direction bit is the low bit of the target number.
+static stream_t gen_indirect(size_t n)
+{
+   stream_t st{"indirect", {}};
+   bench_rng_t rng(5);
+   uint64_t type = 0;
+   while (st.branches.size() < n) {
+      const uint64_t chain = rng.next() % 8;
+      if (rng.chance(10))
+         type = rng.next() % 64;
+      for (uint64_t s = 0; s < 4 && st.branches.size() < n; s++) {
+         const uint64_t site = 4 * chain + s;
+         const uint64_t num_targets = 1 + site % 8;
+         const uint64_t t = (rng.chance(5) ? rng.next() : type) % num_targets;
+         const uint64_t pc = BENCH_PC_BASE + 0x40 * site;
+         st.branches.push_back({pc, (t & 1) != 0, BENCH_PC_BASE + 0x100000 + 0x1000 * site + 0x80 * t});
+      }
+   }
+   st.branches.resize(n);
+   return st;
+}
+
+struct bench_predictor_t {
+   const char *name;
+   PredictorType type;
+   bool indirect;   // IPREDICTOR: driven directly rather than through the cond interface
+};
+
+static const bench_predictor_t bench_predictors[] = {
+   {"onebit",          PredictorType::PRED_ONEBIT,          false},
+   {"twobit",          PredictorType::PRED_TWOBIT,          false},
+   {"correlating",     PredictorType::PRED_CORRELATING,     false},
+   {"local",           PredictorType::PRED_LOCAL,           false},
+   {"gshare",          PredictorType::PRED_GSHARE,          false},
+   {"tournament",      PredictorType::PRED_TOURNAMENT,      false},
+   {"perceptron",      PredictorType::PRED_PERCEPTRON,      false},
+   {"tage",            PredictorType::PRED_TAGE,            false},
+   {"tage-sc-l",       PredictorType::PRED_TAGE_SC_L,       false},
+   {"tage-sc-l-192kb", PredictorType::PRED_TAGE_SC_L_192KB, false},
+   {"ittage",          PredictorType::PRED_TAGE_SC_L,       true},
+};
+
+struct bench_result_t {
+   double ns_per_branch;
+   uint64_t mispredicts;
+};
+
+// Conditional predictors see exactly what bp_t::predict() and the execute
+// stage hand them: predict, spec_update, then resolve.
+static bench_result_t run_cond(const bench_predictor_t &p, const stream_t &st)
+{
+   select_predictor(p.type);
+   beginCondDirPredictor();
+   ExecuteInfo exec_info;
+   exec_info.dec_info.insn_class = InstClass::condBranchInstClass;
+   uint64_t misp = 0;
+   const auto start = std::chrono::steady_clock::now();
+   uint64_t seq_no = 0;
+   for (const branch_t &b : st.branches) {
+      const uint64_t next_pc = b.taken ? (b.pc + 0x40) : (b.pc + 4);
+      const bool pred = get_cond_dir_prediction(seq_no, 0, b.pc, 0);
+      misp += (pred != b.taken);
+      spec_update(seq_no, 0, b.pc, InstClass::condBranchInstClass, b.taken, pred, next_pc);
+      exec_info.taken = b.taken;
+      exec_info.next_pc = next_pc;
+      notify_instr_execute_resolve(seq_no, 0, b.pc, pred, exec_info, 0);
+      seq_no++;
+   }
+   const auto stop = std::chrono::steady_clock::now();
+   endCondDirPredictor();
+   return {std::chrono::duration<double, std::nano>(stop - start).count() / (double)st.branches.size(), misp};
+}
+
+// ITTAGE: each branch is an indirect jump to its stream target or, for the
+// conditional streams, to one of two targets per PC picked by the outcome.
+static bench_result_t run_indirect(const stream_t &st)
+{
+   IPREDICTOR *ittage = new IPREDICTOR();
+   IPREDICTOR::pred_t pred;
+   uint64_t misp = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (const branch_t &b : st.branches) {
+      const uint64_t target = b.target ? b.target : b.pc + (b.taken ? 0x2000 : 0x1000);
+      misp += (ittage->GetPrediction(b.pc, pred) != target);
+      ittage->UpdatePredictor(b.pc, target, pred);
+   }
+   const auto stop = std::chrono::steady_clock::now();
+   delete ittage;
+   return {std::chrono::duration<double, std::nano>(stop - start).count() / (double)st.branches.size(), misp};
+}
+
+// Runs fn on a fresh thread with stdout/stderr pointed at /dev/null, since
+// some predictors print their storage budget on setup.
+template <class F>
+static void run_quiet(F fn)
+{
+   fflush(stdout);
+   fflush(stderr);
+   const int saved_out = dup(1);
+   const int saved_err = dup(2);
+   const int devnull = open("/dev/null", O_WRONLY);
+   dup2(devnull, 1);
+   dup2(devnull, 2);
+   std::thread t(fn);
+   t.join();
+   fflush(stdout);
+   fflush(stderr);
+   dup2(saved_out, 1);
+   dup2(saved_err, 2);
+   close(devnull);
+   close(saved_out);
+   close(saved_err);
+}
+
+// One measurement, from a fresh predictor.
+static bench_result_t run_isolated(const bench_predictor_t &p, const stream_t &st)
+{
+   bench_result_t res;
+   run_quiet([&]() { res = p.indirect ? run_indirect(st) : run_cond(p, st); });
+   return res;
+}
+
+// Latency mode (-latency 1): per-call timings of TAGE-SC-L against the
+// pre-rewrite copies in reference/, which keep {ctr, tag, u} entries and
+// halve every u counter of a table on a u reset.
+static const bench_predictor_t latency_predictors[] = {
+   {"tage-sc-l",           PredictorType::PRED_TAGE_SC_L,           false},
+   {"tage-sc-l-ref",       PredictorType::PRED_TAGE_SC_L_REF,       false},
+   {"tage-sc-l-192kb",     PredictorType::PRED_TAGE_SC_L_192KB,     false},
+   {"tage-sc-l-192kb-ref", PredictorType::PRED_TAGE_SC_L_192KB_REF, false},
+};
+
+struct latency_result_t {
+   std::vector<uint32_t> predict_ns;
+   std::vector<uint32_t> update_ns;   // spec_update + resolve
+};
+
+static uint32_t elapsed_ns(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b)
+{
+   return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count();
+}
+
+// Times every call of one pass over st. A rep after the first keeps the
+// faster time of each call: the stream and the predictor are deterministic,
+// so call i does the same work in every rep, and a preemption is unlikely to
+// hit the same call twice.
+static void run_latency(const bench_predictor_t &p, const stream_t &st, bool first, latency_result_t &res)
+{
+   if (first) {
+      res.predict_ns.assign(st.branches.size(), UINT32_MAX);
+      res.update_ns.assign(st.branches.size(), UINT32_MAX);
+   }
+   select_predictor(p.type);
+   beginCondDirPredictor();
+   ExecuteInfo exec_info;
+   exec_info.dec_info.insn_class = InstClass::condBranchInstClass;
+   for (size_t i = 0; i < st.branches.size(); i++) {
+      const branch_t &b = st.branches[i];
+      const uint64_t next_pc = b.taken ? (b.pc + 0x40) : (b.pc + 4);
+      const auto t0 = std::chrono::steady_clock::now();
+      const bool pred = get_cond_dir_prediction(i, 0, b.pc, 0);
+      const auto t1 = std::chrono::steady_clock::now();
+      spec_update(i, 0, b.pc, InstClass::condBranchInstClass, b.taken, pred, next_pc);
+      exec_info.taken = b.taken;
+      exec_info.next_pc = next_pc;
+      notify_instr_execute_resolve(i, 0, b.pc, pred, exec_info, 0);
+      const auto t2 = std::chrono::steady_clock::now();
+      res.predict_ns[i] = std::min(res.predict_ns[i], elapsed_ns(t0, t1));
+      res.update_ns[i] = std::min(res.update_ns[i], elapsed_ns(t1, t2));
+   }
+   endCondDirPredictor();
+}
+
+// q-quantile of v (sorts v).
+static uint32_t quantile(std::vector<uint32_t> &v, double q)
+{
+   std::sort(v.begin(), v.end());
+   return v[std::min(v.size() - 1, (size_t)(q * (double)v.size()))];
+}
+
+// Medians give the common-case cost (the tag search dominates predict); the
+// max is the worst single update, which for the reference is a u reset
+// sweeping a whole table.
+static int run_latency_report(const std::vector<stream_t> &streams, const std::string &pred_filter, int reps)
+{
+   printf("%-20s %-16s %12s %12s %12s %12s\n", "Predictor", "Stream", "predict p50", "update p50", "update p99.9", "update max");
+   for (const bench_predictor_t &p : latency_predictors) {
+      if (!pred_filter.empty() && pred_filter.find(std::string(",") + p.name + ",") == std::string::npos)
+         continue;
+      for (const stream_t &st : streams) {
+         latency_result_t res;
+         for (int r = 0; r < reps; r++)
+            run_quiet([&]() { run_latency(p, st, r == 0, res); });
+         const uint32_t predict_p50 = quantile(res.predict_ns, 0.5);
+         const uint32_t update_p50 = quantile(res.update_ns, 0.5);
+         const uint32_t update_p999 = quantile(res.update_ns, 0.999);
+         printf("%-20s %-16s %12u %12u %12u %12u\n", p.name, st.name, predict_p50, update_p50, update_p999, res.update_ns.back());
+      }
+   }
+   printf("(ns per call, fastest of %d reps per call)\n", reps);
+   return 0;
+}
+
+static std::string bench_key(const std::string &pred, const std::string &stream)
+{
+   return pred + "/" + stream;
+}
+
+// Baseline CSV: predictor,stream,branches,ns_per_branch,mispredicts
+static std::map<std::string, bench_result_t> read_baseline(const char *path)
+{
+   std::map<std::string, bench_result_t> base;
+   FILE *f = fopen(path, "r");
+   if (!f) {
+      printf("bench: no baseline at %s, nothing to compare against\n", path);
+      return base;
+   }
+   char line[512];
+   if (!fgets(line, sizeof(line), f)) {
+      fclose(f);
+      return base;
+   }
+   char pred[128], stream[128];
+   unsigned long long branches, misp;
+   double ns;
+   while (fgets(line, sizeof(line), f))
+      if (sscanf(line, "%127[^,],%127[^,],%llu,%lf,%llu", pred, stream, &branches, &ns, &misp) == 5)
+         base[bench_key(pred, stream)] = {ns, (uint64_t)misp};
+   fclose(f);
+   return base;
+}
+
+static void usage(const char *prog)
+{
+   printf("usage:\t%s\n"
+          "\t[optional: -n <branches per stream> (default 250000)]\n"
+          "\t[optional: -r <repetitions, the fastest is kept> (default 5)]\n"
+          "\t[optional: -pred <name,name,...> (default: all)]\n"
+          "\t[optional: -o <results.csv> (default bench/results.csv)]\n"
+          "\t[optional: -baseline <baseline.csv> to compare against]\n"
+          "\t[optional: -threshold <percent> slowdown reported as a regression (default 15)]\n"
+          "\t[optional: -latency 1: per-call predict/update latency of TAGE-SC-L vs. reference/, no CSV]\n", prog);
+   exit(1);
+}
+
+int main(int argc, char **argv)
+{
+   size_t num_branches = 250000;
+   int reps = 5;
+   double threshold = 15.0;
+   const char *out_path = "bench/results.csv";
+   const char *baseline_path = NULL;
+   std::string pred_filter;
+   bool latency = false;
+
+   for (int i = 1; i < argc; i += 2) {
+      if (i + 1 >= argc)
+         usage(argv[0]);
+      if (!strcmp(argv[i], "-n"))
+         num_branches = strtoull(argv[i + 1], NULL, 0);
+      else if (!strcmp(argv[i], "-r"))
+         reps = atoi(argv[i + 1]);
+      else if (!strcmp(argv[i], "-pred"))
+         pred_filter = std::string(",") + argv[i + 1] + ",";
+      else if (!strcmp(argv[i], "-o"))
+         out_path = argv[i + 1];
+      else if (!strcmp(argv[i], "-baseline"))
+         baseline_path = argv[i + 1];
+      else if (!strcmp(argv[i], "-threshold"))
+         threshold = atof(argv[i + 1]);
+      else if (!strcmp(argv[i], "-latency"))
+         latency = atoi(argv[i + 1]) != 0;
+      else
+         usage(argv[0]);
+   }
+   if (num_branches == 0 || reps <= 0)
+      usage(argv[0]);
+
+   const std::vector<stream_t> streams = {
+      gen_biased(num_branches),
+      gen_loop(num_branches),
+      gen_correlated(num_branches),
+      gen_random(num_branches),
+      gen_large_footprint(num_branches),
+      gen_indirect(num_branches),
+   };
+   if (latency)
+      return run_latency_report(streams, pred_filter, reps);
+
+   const std::map<std::string, bench_result_t> base = baseline_path ? read_baseline(baseline_path) : std::map<std::string, bench_result_t>();
+
+   FILE *out = fopen(out_path, "w");
+   if (!out) {
+      printf("bench: cannot open %s\n", out_path);
+      exit(1);
+   }
+   fprintf(out, "predictor,stream,branches,ns_per_branch,mispredicts\n");
+
+   // Repetitions go round-robin over all (predictor, stream) pairs, so load
+   // that comes and goes during the run hits every pair alike.
+   struct entry_t {
+      const bench_predictor_t *p;
+      const stream_t *st;
+      bench_result_t best;
+   };
+   std::vector<entry_t> entries;
+   for (const bench_predictor_t &p : bench_predictors) {
+      if (!pred_filter.empty() && pred_filter.find(std::string(",") + p.name + ",") == std::string::npos)
+         continue;
+      for (const stream_t &st : streams)
+         entries.push_back({&p, &st, {0.0, 0}});
+   }
+   for (int r = 0; r < reps; r++) {
+      for (entry_t &e : entries) {
+         const bench_result_t res = run_isolated(*e.p, *e.st);
+         if (r == 0 || res.ns_per_branch < e.best.ns_per_branch)
+            e.best = res;
+      }
+   }
+
+   // Each pair's ratio to its baseline, over the median ratio of the run: a
+   // machine that is uniformly faster or slower than when the baseline was
+   // recorded moves the median, not the gate.
+   std::vector<double> ratios;
+   for (const entry_t &e : entries) {
+      const auto it = base.find(bench_key(e.p->name, e.st->name));
+      if (it != base.end() && it->second.ns_per_branch > 0.0)
+         ratios.push_back(e.best.ns_per_branch / it->second.ns_per_branch);
+   }
+   double median = 1.0;
+   if (!ratios.empty()) {
+      std::sort(ratios.begin(), ratios.end());
+      const size_t n = ratios.size();
+      median = (n % 2) ? ratios[n / 2] : 0.5 * (ratios[n / 2 - 1] + ratios[n / 2]);
+   }
+
+   printf("%-16s %-16s %12s %12s %10s %10s %s\n", "Predictor", "Stream", "ns/branch", "Mispredicts", "vs.base", "vs.median", "");
+   int regressions = 0;
+   for (const entry_t &e : entries) {
+      const bench_result_t &best = e.best;
+      fprintf(out, "%s,%s,%zu,%.3f,%llu\n", e.p->name, e.st->name, e.st->branches.size(), best.ns_per_branch, (unsigned long long)best.mispredicts);
+
+      printf("%-16s %-16s %12.3f %12llu", e.p->name, e.st->name, best.ns_per_branch, (unsigned long long)best.mispredicts);
+      const auto it = base.find(bench_key(e.p->name, e.st->name));
+      if (it != base.end() && it->second.ns_per_branch > 0.0) {
+         const double ratio = best.ns_per_branch / it->second.ns_per_branch;
+         const double delta = 100.0 * (ratio / median - 1.0);
+         printf(" %+9.1f%% %+9.1f%%", 100.0 * (ratio - 1.0), delta);
+         if (delta > threshold) {
+            printf(" REGRESSION");
+            regressions++;
+         }
+         // Same stream, same predictor: a different count means the
+         // predictor's behaviour changed, not just its speed.
+         if (it->second.mispredicts != best.mispredicts)
+            printf(" (mispredicts changed from %llu)", (unsigned long long)it->second.mispredicts);
+      }
+      printf("\n");
+   }
+   fclose(out);
+
+   if (baseline_path) {
+      printf("median ratio to %s: %.3f\n", baseline_path, median);
+      printf("%d regression(s) beyond %.1f%% against the median\n", regressions, threshold);
+   }
+   return regressions ? 1 : 0;
+}
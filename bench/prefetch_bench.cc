@@ -0,0 +1,170 @@
+// prefetch_bench.cc
+// Stride-prefetcher microbenchmark: the per-load cost of the L1D stride
+// prefetcher (lookahead + train + issue, the calls uarchsim_t makes for every
+// load), with the prefetcher on and off, for a fully associative and a few
+// set-associative RPTs (-R). No trace or simulator is involved.
+//
+// "off" runs the same load stream without the prefetcher calls, as
+// uarchsim_t does with -noP; the prefetcher's cost is on - off. Streams
+// interleave N static loads, each walking its own stride, so N against the
+// 1024-entry RPT sets how often entries are replaced.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "spdlog/spdlog.h"
+#include "spdlog/fmt/ostr.h"
+#include "../lib/parameters.h"
+#include "../lib/resource_schedule.h"
+#include "../lib/stride_prefetcher.h"
+
+struct load_t {
+   uint64_t pc;
+   uint64_t addr;
+   bool miss;
+};
+
+// splitmix64, as in predictor_bench.
+struct bench_rng_t {
+   uint64_t s;
+   explicit bench_rng_t(uint64_t seed) : s(seed) {}
+   uint64_t next() {
+      uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+   }
+};
+
+// n loads from num_pcs static loads picked at random; each walks its own
+// region with a stride of 8 to 512 bytes and misses one time in four.
+static std::vector<load_t> gen_loads(const size_t n, const unsigned num_pcs)
+{
+   bench_rng_t rng(num_pcs);
+   std::vector<uint64_t> next(num_pcs), stride(num_pcs);
+   for (unsigned p = 0; p < num_pcs; p++)
+   {
+      next[p] = 0x10000000ull + (uint64_t)p * 0x100000;
+      stride[p] = 8ull << (rng.next() % 7);
+   }
+   std::vector<load_t> loads(n);
+   for (size_t i = 0; i < n; i++)
+   {
+      const unsigned p = rng.next() % num_pcs;
+      loads[i] = {(0x400000ull >> 2) + p, next[p], (rng.next() & 3) == 0};
+      next[p] += stride[p];
+   }
+   return loads;
+}
+
+// ns per load over the stream, best of reps.
+static double time_loads(const std::vector<load_t> &loads, const bool prefetch, const unsigned reps, uint64_t &issued)
+{
+   double best = 0.0;
+   for (unsigned r = 0; r < reps; r++)
+   {
+      StridePrefetcher *pf = new StridePrefetcher;
+      uint64_t sink = 0;
+      issued = 0;
+      const auto begin = std::chrono::steady_clock::now();
+      for (size_t i = 0; i < loads.size(); i++)
+      {
+         const load_t &l = loads[i];
+         const uint64_t cycle = i;
+         if (prefetch)
+         {
+            pf->lookahead(l.pc, cycle);
+            PrefetchTrainingInfo info{l.pc, l.addr, 0, l.miss};
+            pf->train(info);
+            Prefetch p;
+            while (pf->issue(p, cycle))
+               issued++;
+         }
+         sink += l.addr ^ l.pc;
+      }
+      const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / loads.size();
+      if (r == 0 || ns < best)
+         best = ns;
+      if (sink == 42)
+         printf(" ");
+      delete pf;
+   }
+   return best;
+}
+
+static void usage(const char *prog)
+{
+   printf("usage: %s [-n loads] [-r reps] [-pcs list] [-R list]\n"
+          "\t-n <n> loads per stream (default 2000000)\n"
+          "\t-r <n> repetitions, the fastest is kept (default 3)\n"
+          "\t-pcs <list> comma-separated static load counts (default 64,512,4096)\n"
+          "\t-R <list> comma-separated RPT associativities, 0 = fully associative (default 0,64,16,4)\n", prog);
+   exit(0);
+}
+
+static std::vector<uint64_t> parse_list(const char *s)
+{
+   std::vector<uint64_t> v;
+   for (const char *p = s; *p; )
+   {
+      char *end;
+      v.push_back(strtoull(p, &end, 10));
+      if (end == p)
+         return {};
+      p = (*end == ',') ? end + 1 : end;
+   }
+   return v;
+}
+
+int main(int argc, char **argv)
+{
+   size_t n = 2000000;
+   unsigned reps = 3;
+   std::vector<uint64_t> pcs = {64, 512, 4096};
+   std::vector<uint64_t> assocs = {0, 64, 16, 4};
+   for (int i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         n = strtoull(argv[++i], NULL, 10);
+      else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+         reps = atoi(argv[++i]);
+      else if (!strcmp(argv[i], "-pcs") && i + 1 < argc)
+         pcs = parse_list(argv[++i]);
+      else if (!strcmp(argv[i], "-R") && i + 1 < argc)
+         assocs = parse_list(argv[++i]);
+      else
+         usage(argv[0]);
+   }
+   if (n == 0 || reps == 0 || pcs.empty() || assocs.empty())
+      usage(argv[0]);
+   for (uint64_t a : assocs)
+   {
+      if (!rpt_assoc_valid(a))
+      {
+         printf("prefetch_bench: invalid RPT associativity %" PRIu64 "\n", a);
+         exit(1);
+      }
+   }
+
+   printf("%6s %6s %10s %10s %10s %10s\n", "PCs", "RPT", "off ns", "on ns", "cost ns", "PF/load");
+   for (uint64_t num_pcs : pcs)
+   {
+      const std::vector<load_t> loads = gen_loads(n, num_pcs);
+      uint64_t issued;
+      const double off = time_loads(loads, false, reps, issued);
+      for (uint64_t a : assocs)
+      {
+         RPT_ASSOC = a;
+         const double on = time_loads(loads, true, reps, issued);
+         const std::string rpt = a ? std::to_string(a) + "-way" : "full";
+         printf("%6" PRIu64 " %6s %10.1f %10.1f %10.1f %10.3f\n", num_pcs, rpt.c_str(), off, on, on - off, (double)issued / n);
+      }
+   }
+   return 0;
+}
@@ -17,6 +17,31 @@
 #pragma once
 #include "lib/sim_common_structs.h"
 
+//
+// Pipeline events consumed by the predictor
+//
+// The simulator only calls the notify_* hooks whose event is listed in CBP_EVENTS_CONSUMED; the
+// others are never called, and the simulator does not track the instructions through the stages
+// that only exist to call them. DecodeInfo/ExecuteInfo always carry the instruction class, taken
+// and next_pc. The register, memory and value fields are filled only if a consumed hook can see
+// them: decode, agen or commit, or execute/resolve together with CBP_INFO_OPERANDS.
+//
+// The shipped predictors only train at execute/resolve. If you implement another hook, add its
+// event here (or build with -DCBP_EVENTS_CONSUMED=CBP_EVENT_ALL); CBP_EVENT_ALL restores the
+// original behaviour of calling every hook with full information.
+//
+#define CBP_EVENT_FETCH            (1u << 0)   // notify_instr_fetch
+#define CBP_EVENT_DECODE           (1u << 1)   // notify_instr_decode
+#define CBP_EVENT_AGEN             (1u << 2)   // notify_agen_complete
+#define CBP_EVENT_EXECUTE_RESOLVE  (1u << 3)   // notify_instr_execute_resolve
+#define CBP_EVENT_COMMIT           (1u << 4)   // notify_instr_commit
+#define CBP_INFO_OPERANDS          (1u << 5)   // execute/resolve reads register, memory or value fields
+#define CBP_EVENT_ALL              (CBP_EVENT_FETCH | CBP_EVENT_DECODE | CBP_EVENT_AGEN | CBP_EVENT_EXECUTE_RESOLVE | CBP_EVENT_COMMIT | CBP_INFO_OPERANDS)
+
+#ifndef CBP_EVENTS_CONSUMED
+#define CBP_EVENTS_CONSUMED        (CBP_EVENT_EXECUTE_RESOLVE)
+#endif
+
 //
 // beginCondDirPredictor()
 // 
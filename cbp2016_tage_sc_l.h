@@ -14,7 +14,6 @@
 
 
 //parameters of the loop predictor
-#define LOGL 5
 #define WIDTHNBITERLOOP 10  // we predict only loops with less than 1K iterations
 #define LOOPTAG 10      //tag width in the loop predictor
 
@@ -22,8 +21,6 @@
 #define UINT64 uint64_t
 
 #define BORNTICK  1024
-//To get the predictor storage budget on stderr  uncomment the next line
-//#define PRINTSIZE
 
 #define SC          // 8.2 % if TAGE alone
 #define IMLI            // 0.2 %
@@ -37,86 +34,98 @@
 
 
 
-//The statistical corrector components
+template <class Config>
+class TageScL
+{
+    public:
+        // sizes set by the storage budget
+        static constexpr int LOGL = Config::LOGL;
+        static constexpr int LOGBIAS = Config::LOGBIAS;
+        static constexpr int LOGINB = Config::LOGINB;
+        static constexpr int LOGIMNB = Config::LOGIMNB;
+        static constexpr int LOGGNB = Config::LOGGNB;
+        static constexpr int LOGPNB = Config::LOGPNB;
+        static constexpr int LOGLNB = Config::LOGLNB;
+        static constexpr int LOGLOCAL = Config::LOGLOCAL;
+        static constexpr int LOGSNB = Config::LOGSNB;
+        static constexpr int LOGSECLOCAL = Config::LOGSECLOCAL;
+        static constexpr int LOGTNB = Config::LOGTNB;
+        static constexpr int LOGTLOCAL = Config::LOGTLOCAL;
+        static constexpr int LOGG = Config::LOGG;
+        static constexpr int TBITS = Config::TBITS;
+        static constexpr int LOGB = Config::LOGB;
+        static constexpr bool PRINTSIZE = Config::PRINTSIZE;    // print the predictor storage budget at setup
+
+        //The statistical corrector components
 
 #define PERCWIDTH 6     //Statistical corrector  counter width 5 -> 6 : 0.6 %
-//The three BIAS tables in the SC component
-//We play with the TAGE  confidence here, with the number of the hitting bank
-#define LOGBIAS 8
-int8_t Bias[(1 << LOGBIAS)];
-int8_t BiasSK[(1 << LOGBIAS)];
-int8_t BiasBank[(1 << LOGBIAS)];
+        //The three BIAS tables in the SC component
+        //We play with the TAGE  confidence here, with the number of the hitting bank
+        int8_t Bias[(1 << LOGBIAS)];
+        int8_t BiasSK[(1 << LOGBIAS)];
+        int8_t BiasBank[(1 << LOGBIAS)];
 
-//In all th GEHL components, the two tables with the shortest history lengths have only half of the entries.
+        //In all th GEHL components, the two tables with the shortest history lengths have only half of the entries.
 
-// IMLI-SIC -> Micro 2015  paper: a big disappointment on  CBP2016 traces
+        // IMLI-SIC -> Micro 2015  paper: a big disappointment on  CBP2016 traces
 #ifdef IMLI
-#define LOGINB 8        // 128-entry
 #define INB 1
-int Im[INB] = { 8 };
-int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
+        int Im[INB] = { 8 };
+        int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
 
-int8_t *IGEHL[INB];
+        int8_t *IGEHL[INB];
 
-#define LOGIMNB 9       // 2 * 256-entry
 #define IMNB 2
 
-int IMm[IMNB] = { 10, 4 };
-int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
+        int IMm[IMNB] = { 10, 4 };
+        int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
 
-int8_t *IMGEHL[IMNB];
+        int8_t *IMGEHL[IMNB];
 
 #endif
 
-//global branch GEHL
-#define LOGGNB 10       // 1 1K + 2 * 512-entry tables
+        //global branch GEHL
 #define GNB 3
-int Gm[GNB] = { 40, 24, 10 };
-int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
+        int Gm[GNB] = { 40, 24, 10 };
+        int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
 
-int8_t *GGEHL[GNB];
+        int8_t *GGEHL[GNB];
 
-//variation on global branch history
+        //variation on global branch history
 #define PNB 3
-#define LOGPNB 9        // 1 512 + 2 * 256-entry tables
-int Pm[PNB] = { 25, 16, 9 };
-int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
+        int Pm[PNB] = { 25, 16, 9 };
+        int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
 
-int8_t *PGEHL[PNB];
+        int8_t *PGEHL[PNB];
 
-//first local history
-#define LOGLNB  10      // 1 1K + 2 * 512-entry tables
+        //first local history
 #define LNB 3
-int Lm[LNB] = { 11, 6, 3 };
-int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
+        int Lm[LNB] = { 11, 6, 3 };
+        int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
 
-int8_t *LGEHL[LNB];
-#define  LOGLOCAL 8
+        int8_t *LGEHL[LNB];
 #define NLOCAL (1<<LOGLOCAL)
 
-// second local history
-#define LOGSNB 9        // 1 512 + 2 * 256-entry tables
+        // second local history
 #define SNB 3
-int Sm[SNB] = { 16, 11, 6 };
-int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
+        int Sm[SNB] = { 16, 11, 6 };
+        int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
 
-int8_t *SGEHL[SNB];
-#define LOGSECLOCAL 4
+        int8_t *SGEHL[SNB];
 #define NSECLOCAL (1<<LOGSECLOCAL)  //Number of second local histories
 
-//third local history
-#define LOGTNB 10       // 2 * 512-entry tables
+        //third local history
 #define TNB 2
-int Tm[TNB] = { 9, 4 };
-int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
+        int Tm[TNB] = { 9, 4 };
+        int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
 
-int8_t *TGEHL[TNB];
-#define NTLOCAL 16
+        int8_t *TGEHL[TNB];
+#define NTLOCAL (1<<LOGTLOCAL)  //Number of third local histories
 
 
-// playing with putting more weights (x2)  on some of the SC components
-// playing on using different update thresholds on SC
-//update threshold for the statistical corrector
+        // playing with putting more weights (x2)  on some of the SC components
+        // playing on using different update thresholds on SC
+        //update threshold for the statistical corrector
 #define VARTHRES
 #define WIDTHRES 12
 #define WIDTHRESP 8
@@ -126,100 +135,85 @@ int8_t *TGEHL[TNB];
 #define LOGSIZEUP 0
 #endif
 #define LOGSIZEUPS  (LOGSIZEUP/2)
-int updatethreshold;
-int Pupdatethreshold[(1 << LOGSIZEUP)]; //size is fixed by LOGSIZEUP
+        int updatethreshold;
+        int Pupdatethreshold[(1 << LOGSIZEUP)]; //size is fixed by LOGSIZEUP
 #define INDUPD (PC ^ (PC >>2)) & ((1 << LOGSIZEUP) - 1)
 #define INDUPDS ((PC ^ (PC >>2)) & ((1 << (LOGSIZEUPS)) - 1))
-int8_t WG[(1 << LOGSIZEUPS)];
-int8_t WL[(1 << LOGSIZEUPS)];
-int8_t WS[(1 << LOGSIZEUPS)];
-int8_t WT[(1 << LOGSIZEUPS)];
-int8_t WP[(1 << LOGSIZEUPS)];
-int8_t WI[(1 << LOGSIZEUPS)];
-int8_t WIM[(1 << LOGSIZEUPS)];
-int8_t WB[(1 << LOGSIZEUPS)];
+        int8_t WG[(1 << LOGSIZEUPS)];
+        int8_t WL[(1 << LOGSIZEUPS)];
+        int8_t WS[(1 << LOGSIZEUPS)];
+        int8_t WT[(1 << LOGSIZEUPS)];
+        int8_t WP[(1 << LOGSIZEUPS)];
+        int8_t WI[(1 << LOGSIZEUPS)];
+        int8_t WIM[(1 << LOGSIZEUPS)];
+        int8_t WB[(1 << LOGSIZEUPS)];
 #define EWIDTH 6
-int LSUM;
+        int LSUM;
 
-// The two counters used to choose between TAGE and SC on Low Conf SC
-int8_t FirstH, SecondH;
-bool MedConf;           // is the TAGE prediction medium confidence
+        // Upper bound on the number of counters read by the statistical corrector for one branch
+        // (3 bias tables, then one counter per GEHL table)
+#define SCNCOMP_MAX 8
+#define SCNCTR_MAX (3 + GNB + PNB + LNB + SNB + TNB + IMNB + INB)
+
+        // The two counters used to choose between TAGE and SC on Low Conf SC
+        int8_t FirstH, SecondH;
+        bool MedConf;           // is the TAGE prediction medium confidence
 
 
 #define CONFWIDTH 7     //for the counters in the choser
 #define HISTBUFFERLENGTH 4096   // we use a 4K entries history buffer to store the branch history (this allows us to explore using history length up to 4K)
 
-// utility class for index computation
-// this is the cyclic shift register for folding 
-// a long global history into a smaller number of bits; see P. Michaud's PPM-like predictor at CBP-1
-
-class bentry            // TAGE bimodal table entry  
-{
-    public:
-        int8_t hyst;
-        int8_t pred;
+        // utility class for index computation
+        // this is the cyclic shift register for folding 
+        // a long global history into a smaller number of bits; see P. Michaud's PPM-like predictor at CBP-1
 
-
-        bentry ()
+        class bentry            // TAGE bimodal table entry  
         {
-            pred = 0;
+            public:
+                int8_t hyst;
+                int8_t pred;
 
-            hyst = 1;
-        }
 
-};
-
-class gentry            // TAGE global table entry
-{
-    public:
-        int8_t ctr;
-        uint tag;
-        int8_t u;
-
-        gentry ()
-        {
-            ctr = 0;
-            u = 0;
-            tag = 0;
+                bentry ()
+                {
+                    pred = 0;
 
+                    hyst = 1;
+                }
 
-        }
-};
+        };
 
 #define  POWER
-//use geometric history length
+        //use geometric history length
 
 #define NHIST 36        // default: 36 histories
 
 #define NBANKLOW 10     // number of banks in the shared bank-interleaved for the low history lengths
 #define NBANKHIGH 20        // number of banks in the shared bank-interleaved for the  history lengths
 
-int SizeTable[NHIST + 1];
+        int SizeTable[NHIST + 1];
 
 
 #define BORN 13         // below BORN in the table for low history lengths, >= BORN in the table for high history lengths,
 
-// we use 2-way associativity for the medium history lengths
+        // we use 2-way associativity for the medium history lengths
 #define BORNINFASSOC 9      //2 -way assoc for those banks 0.4 %
 #define BORNSUPASSOC 23
 
-/*in practice 2 bits or 3 bits par branch: around 1200 cond. branchs*/
+        /*in practice 2 bits or 3 bits par branch: around 1200 cond. branchs*/
 
 #define MINHIST 6       // default: min history 6
 #define MAXHIST 3000    // default: max history 3000
 
 
-#define LOGG 10         /* logsize of the  banks in the  tagged TAGE tables */
-#define TBITS 8         //minimum width of the tags  (low history lengths), +4 for high history lengths
 
 
-bool NOSKIP[NHIST + 1];     // to manage the associativity for different history lengths
+        bool NOSKIP[NHIST + 1];     // to manage the associativity for different history lengths
 
 
 
 #define NNN 1           // number of extra entries allocated on a TAGE misprediction (1+NNN)
 #define HYSTSHIFT 2     // bimodal hysteresis shared by 4 entries
-#define LOGB 13         // log of number of entries in bimodal predictor
 
 
 #define PHISTWIDTH 27       // width of the path history used in TAGE
@@ -227,180 +221,186 @@ bool NOSKIP[NHIST + 1];     // to manage the associativity for different history
 #define CWIDTH 3        // predictor counter width on the TAGE tagged tables
 
 
-//the counter(s) to chose between longest match and alternate prediction on TAGE when weak counters
+        //the counter(s) to chose between longest match and alternate prediction on TAGE when weak counters
 #define LOGSIZEUSEALT 4
-bool AltConf;           // Confidence on the alternate prediction
+        bool AltConf;           // Confidence on the alternate prediction
 #define ALTWIDTH 5
 #define SIZEUSEALT  (1<<(LOGSIZEUSEALT))
 #define INDUSEALT (((((HitBank-1)/8)<<1)+AltConf) % (SIZEUSEALT-1))
-int8_t use_alt_on_na[SIZEUSEALT];
-//very marginal benefit
-int8_t BIM;
-
-int TICK;           // for the reset of the u counter
-//uint8_t ghist[HISTBUFFERLENGTH];
-//int ptghist;
-//uint64_t phist;      //path history
-//folded_history ch_i[NHIST + 1];   //utility for computing TAGE indices
-//folded_history ch_t[2][NHIST + 1];    //utility for computing TAGE tags
-
-class lentry            //loop predictor entry
-{
-    public:
-        uint16_t NbIter;        //10 bits
-        uint8_t confid;     // 4bits
-        uint16_t CurrentIter;       // 10 bits
-
-        uint16_t TAG;           // 10 bits
-        uint8_t age;            // 4 bits
-        bool dir;           // 1 bit
-
-        //39 bits per entry    
-        lentry ()
+        int8_t use_alt_on_na[SIZEUSEALT];
+        //very marginal benefit
+        int8_t BIM;
+
+        int TICK;           // for the reset of the u counter
+        //uint8_t ghist[HISTBUFFERLENGTH];
+        //int ptghist;
+        //uint64_t phist;      //path history
+        //folded_history ch_i[NHIST + 1];   //utility for computing TAGE indices
+        //folded_history ch_t[2][NHIST + 1];    //utility for computing TAGE tags
+
+        class lentry            //loop predictor entry
         {
-            confid = 0;
-            CurrentIter = 0;
-            NbIter = 0;
-            TAG = 0;
-            age = 0;
-            dir = false;
-        }
-};
+            public:
+                uint16_t NbIter;        //10 bits
+                uint8_t confid;     // 4bits
+                uint16_t CurrentIter;       // 10 bits
 
-//For the TAGE predictor
-bentry *btable;         //bimodal TAGE table
-gentry *gtable[NHIST + 1];  // tagged TAGE tables
-//lentry *ltable;
-int m[NHIST + 1];
-int TB[NHIST + 1];
-int logg[NHIST + 1];
+                uint16_t TAG;           // 10 bits
+                uint8_t age;            // 4 bits
+                bool dir;           // 1 bit
 
-uint64_t Seed;           // for the pseudo-random number generator
+                //39 bits per entry    
+                lentry ()
+                {
+                    confid = 0;
+                    CurrentIter = 0;
+                    NbIter = 0;
+                    TAG = 0;
+                    age = 0;
+                    dir = false;
+                }
+        };
 
+        //For the TAGE predictor
+        bentry *btable;         //bimodal TAGE table
+        // tagged TAGE tables, stored as structure of arrays: the hit search only reads the dense tag arrays
+        uint16_t *gtagtab[NHIST + 1];   // tags
+        int8_t *gctr[NHIST + 1];        // prediction counters
+        int8_t *gu[NHIST + 1];          // u counters, aged lazily (see uref)
+        uint32_t *gustamp[NHIST + 1];   // u aging epoch at the last access of each u counter
+        uint32_t UEPOCH;                // number of u resets since setup
+        //lentry *ltable;
+        int m[NHIST + 1];
+        int TB[NHIST + 1];
+        int logg[NHIST + 1];
 
-class folded_history
-{
-    public:
-        unsigned comp;
-        int CLENGTH;
-        int OLENGTH;
-        int OUTPOINT;
+        uint64_t Seed;           // for the pseudo-random number generator
 
-        folded_history ()
-        {
-        }
 
-        void init (int original_length, int compressed_length)
+        class folded_history
         {
-            comp = 0;
-            OLENGTH = original_length;
-            CLENGTH = compressed_length;
-            OUTPOINT = OLENGTH % CLENGTH;
+            public:
+                unsigned comp;
+                int CLENGTH;
+                int OLENGTH;
+                int OUTPOINT;
 
-        }
+                folded_history ()
+                {
+                }
 
-        void update (std::array<uint8_t, HISTBUFFERLENGTH>&h, int PT)
-        {
-            comp = (comp << 1) ^ h[PT & (HISTBUFFERLENGTH - 1)];
-            comp ^= h[(PT + OLENGTH) & (HISTBUFFERLENGTH - 1)] << OUTPOINT;
-            comp ^= (comp >> CLENGTH);
-            comp = (comp) & ((1 << CLENGTH) - 1);
-        }
-};
-using tage_index_t = std::array<folded_history, NHIST+1>;
-using tage_tag_t = std::array<folded_history, NHIST+1>;
+                void init (int original_length, int compressed_length)
+                {
+                    comp = 0;
+                    OLENGTH = original_length;
+                    CLENGTH = compressed_length;
+                    OUTPOINT = OLENGTH % CLENGTH;
 
+                }
 
-struct cbp_hist_t
-{
-      // Begin Conventional Histories
-      uint64_t GHIST;
-      std::array<uint8_t, HISTBUFFERLENGTH> ghist;
-      uint64_t phist;      //path history
-      int ptghist;
-      tage_index_t ch_i;
-      std::array<tage_tag_t, 2> ch_t;
-
-      std::array<uint64_t, NLOCAL> L_shist;
-      std::array<uint64_t, NSECLOCAL> S_slhist;
-      std::array<uint64_t, NTLOCAL> T_slhist;
-
-      std::array<uint64_t, 256> IMHIST;
-      uint64_t IMLIcount;      // use to monitor the iteration number
+                void update (std::array<uint8_t, HISTBUFFERLENGTH>&h, int PT)
+                {
+                    comp = (comp << 1) ^ h[PT & (HISTBUFFERLENGTH - 1)];
+                    comp ^= h[(PT + OLENGTH) & (HISTBUFFERLENGTH - 1)] << OUTPOINT;
+                    comp ^= (comp >> CLENGTH);
+                    comp = (comp) & ((1 << CLENGTH) - 1);
+                }
+        };
+        using tage_index_t = std::array<folded_history, NHIST+1>;
+        using tage_tag_t = std::array<folded_history, NHIST+1>;
+
+
+        struct cbp_hist_t
+        {
+              // Begin Conventional Histories
+              uint64_t GHIST;
+              std::array<uint8_t, HISTBUFFERLENGTH> ghist;
+              uint64_t phist;      //path history
+              int ptghist;
+              tage_index_t ch_i;
+              std::array<tage_tag_t, 2> ch_t;
+
+              std::array<uint64_t, NLOCAL> L_shist;
+              std::array<uint64_t, NSECLOCAL> S_slhist;
+              std::array<uint64_t, NTLOCAL> T_slhist;
+
+              std::array<uint64_t, 256> IMHIST;
+              uint64_t IMLIcount;      // use to monitor the iteration number
 #ifdef LOOPPREDICTOR
-      std::vector<lentry> ltable;
-      int8_t WITHLOOP;
+              std::vector<lentry> ltable;
+              int8_t WITHLOOP;
 #endif
-      cbp_hist_t()
-      {
+              cbp_hist_t()
+              {
 #ifdef LOOPPREDICTOR
-          ltable.resize(1 << (LOGL));
-          WITHLOOP = -1;
+                  ltable.resize(1 << (LOGL));
+                  WITHLOOP = -1;
 #endif
-      }
-};
+              }
+        };
 
 
 
-int predictorsize ()
-{
-    int STORAGESIZE = 0;
-    int inter = 0;
+
+        int predictorsize ()
+        {
+            int STORAGESIZE = 0;
+            int inter = 0;
 
 
 
-    STORAGESIZE +=
-        NBANKHIGH * (1 << (logg[BORN])) * (CWIDTH + UWIDTH + TB[BORN]);
-    STORAGESIZE += NBANKLOW * (1 << (logg[1])) * (CWIDTH + UWIDTH + TB[1]);
+            STORAGESIZE +=
+                NBANKHIGH * (1 << (logg[BORN])) * (CWIDTH + UWIDTH + TB[BORN]);
+            STORAGESIZE += NBANKLOW * (1 << (logg[1])) * (CWIDTH + UWIDTH + TB[1]);
 
-    STORAGESIZE += (SIZEUSEALT) * ALTWIDTH;
-    STORAGESIZE += (1 << LOGB) + (1 << (LOGB - HYSTSHIFT));
-    STORAGESIZE += m[NHIST];
-    STORAGESIZE += PHISTWIDTH;
-    STORAGESIZE += 10;      //the TICK counter
+            STORAGESIZE += (SIZEUSEALT) * ALTWIDTH;
+            STORAGESIZE += (1 << LOGB) + (1 << (LOGB - HYSTSHIFT));
+            STORAGESIZE += m[NHIST];
+            STORAGESIZE += PHISTWIDTH;
+            STORAGESIZE += 10;      //the TICK counter
 
-    fprintf (stderr, " (TAGE %d) ", STORAGESIZE);
+            fprintf (stderr, " (TAGE %d) ", STORAGESIZE);
 #ifdef SC
 #ifdef LOOPPREDICTOR
 
-    inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
-    fprintf (stderr, " (LOOP %d) ", inter);
-    STORAGESIZE += inter;
+            inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
+            fprintf (stderr, " (LOOP %d) ", inter);
+            STORAGESIZE += inter;
 #endif
 
-    inter += WIDTHRES;
-    inter += WIDTHRESP * ((1 << LOGSIZEUP)); //the update threshold counters
-    inter += 3 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
-    inter += (PERCWIDTH) * 3 * (1 << (LOGBIAS));
+            inter += WIDTHRES;
+            inter += WIDTHRESP * ((1 << LOGSIZEUP)); //the update threshold counters
+            inter += 3 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
+            inter += (PERCWIDTH) * 3 * (1 << (LOGBIAS));
 
-    inter +=
-        (GNB - 2) * (1 << (LOGGNB)) * (PERCWIDTH) +
-        (1 << (LOGGNB - 1)) * (2 * PERCWIDTH);
-    inter += Gm[0];     //global histories for SC
-    inter += (PNB - 2) * (1 << (LOGPNB)) * (PERCWIDTH) +
-        (1 << (LOGPNB - 1)) * (2 * PERCWIDTH);
-    //we use phist already counted for these tables
+            inter +=
+                (GNB - 2) * (1 << (LOGGNB)) * (PERCWIDTH) +
+                (1 << (LOGGNB - 1)) * (2 * PERCWIDTH);
+            inter += Gm[0];     //global histories for SC
+            inter += (PNB - 2) * (1 << (LOGPNB)) * (PERCWIDTH) +
+                (1 << (LOGPNB - 1)) * (2 * PERCWIDTH);
+            //we use phist already counted for these tables
 
 #ifdef LOCALH
-    inter +=
-        (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH) +
-        (1 << (LOGLNB - 1)) * (2 * PERCWIDTH);
-    inter += NLOCAL * Lm[0];
-    inter += EWIDTH * (1 << LOGSIZEUPS);
+            inter +=
+                (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH) +
+                (1 << (LOGLNB - 1)) * (2 * PERCWIDTH);
+            inter += NLOCAL * Lm[0];
+            inter += EWIDTH * (1 << LOGSIZEUPS);
 #ifdef LOCALS
-    inter +=
-        (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH) +
-        (1 << (LOGSNB - 1)) * (2 * PERCWIDTH);
-    inter += NSECLOCAL * (Sm[0]);
-    inter += EWIDTH * (1 << LOGSIZEUPS);
+            inter +=
+                (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH) +
+                (1 << (LOGSNB - 1)) * (2 * PERCWIDTH);
+            inter += NSECLOCAL * (Sm[0]);
+            inter += EWIDTH * (1 << LOGSIZEUPS);
 
 #endif
 #ifdef LOCALT
-    inter +=
-        (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH) +
-        (1 << (LOGTNB - 1)) * (2 * PERCWIDTH);
-    inter += NTLOCAL * Tm[0];
-    inter += EWIDTH * (1 << LOGSIZEUPS);
+            inter +=
+                (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH) +
+                (1 << (LOGTNB - 1)) * (2 * PERCWIDTH);
+            inter += NTLOCAL * Tm[0];
+            inter += EWIDTH * (1 << LOGSIZEUPS);
 #endif
 
 
@@ -417,46 +417,28 @@ int predictorsize ()
 
 #ifdef IMLI
 
-    inter += (1 << (LOGINB - 1)) * PERCWIDTH;
-    inter += Im[0];
+            inter += (1 << (LOGINB - 1)) * PERCWIDTH;
+            inter += Im[0];
 
-    inter += IMNB * (1 << (LOGIMNB - 1)) * PERCWIDTH;
-    inter += 2 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
-    inter += 256 * IMm[0];
+            inter += IMNB * (1 << (LOGIMNB - 1)) * PERCWIDTH;
+            inter += 2 * EWIDTH * (1 << LOGSIZEUPS);    // the extra weight of the partial sums
+            inter += 256 * IMm[0];
 #endif
-    inter += 2 * CONFWIDTH; //the 2 counters in the choser
-    STORAGESIZE += inter;
+            inter += 2 * CONFWIDTH; //the 2 counters in the choser
+            STORAGESIZE += inter;
 
 
-    fprintf (stderr, " (SC %d) ", inter);
-#endif
-#ifdef PRINTSIZE
-    fprintf (stderr, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
-            STORAGESIZE / 1024);
-    fprintf (stdout, " (TOTAL %d bits %d Kbits) ", STORAGESIZE,
-            STORAGESIZE / 1024);
+            fprintf (stderr, " (SC %d) ", inter);
 #endif
+            fprintf (stderr, " (TOTAL %d bits %.1f KBs) ", STORAGESIZE,
+                    (double)STORAGESIZE / 8192.0);
+            fprintf (stdout, " (TOTAL %d bits %.1f KBs) ", STORAGESIZE,
+                    (double)STORAGESIZE / 8192.0);
 
 
-    return (STORAGESIZE);
-}
-
-// The interface to the simulator is defined in cond_branch_predictor_interface.cc
-// This predictor is a modified version of CBP2016 Tage.
-// The CBP Tage predicted and updated the predictor right away.
-// The simulator here provides 3 major hooks for the predictor:
-// * get_cond_dir_prediction -> lookup the predictor and return the prediction.  This is invoked only for conditional branches.
-// * spec_update -> This is used for updating the history. It provides the actual direction of the branch. This is invoked for all branches.
-// * notify_instr_execute_resolve -> This hook is used to update the predictor. This is invoked for all the instructions and provides all information available at execute.
-//    * Note: The history at update is different than history at predict. To ensure that the predictor is getting trained correctly, 
-//    at predict, we checkpoint the history in an unordered_map(pred_time_histories) using unique identifying id of the instruction. 
-//    When updating the predicor, we recover the prediction time history.
-// There are a couple of other hooks that aren't used in the current implementation, but are available to exploit:
-// * notify_instr_decode 
-// * notify_instr_commit
-class CBP2016_TAGE_SC_L
-{
-    public:
+            return (STORAGESIZE);
+        }
+
         //state set by predict
         int GI[NHIST + 1];      // indexes to the different tables are computed only once  
         uint GTAG[NHIST + 1];   // tags for the different tables are computed only once  
@@ -465,6 +447,15 @@ class CBP2016_TAGE_SC_L
         //
         int THRES;
         //
+        // Statistical corrector state set in predict and used in update:
+        // the selected counters are gathered once, grouped by component
+        int8_t *SCCTR[SCNCTR_MAX];  // pointers to the selected counters, component after component
+        int SCEND[SCNCOMP_MAX];     // end of each component in SCCTR
+        int8_t *SCW[SCNCOMP_MAX];   // weight counter of each component
+        int SCPSUM[SCNCOMP_MAX];    // unweighted sum of each component
+        int NSCCTR;
+        int NSCCOMP;
+        //
         // State set in predict and used in update
         // Begin LOOPPREDICTOR State
         bool predloop;  // loop predictor prediction
@@ -492,16 +483,28 @@ class CBP2016_TAGE_SC_L
         // checkpointed history. Can be accesed using the inst-id(seq_no/piece)
         std::unordered_map<uint64_t/*key*/, cbp_hist_t/*val*/> pred_time_histories;
 
-        CBP2016_TAGE_SC_L (void)
+        TageScL (void)
         {
             init_histories (active_hist);
-#ifdef PRINTSIZE
-            predictorsize ();
-#endif
+        }
+
+        ~TageScL (void)
+        {
+            // banks 2..BORN-1 and BORN+1..NHIST alias these two
+            for (int i = 1; i <= BORN; i += BORN - 1)
+            {
+                delete[] gtagtab[i];
+                delete[] gctr[i];
+                delete[] gu[i];
+                delete[] gustamp[i];
+            }
+            delete[] btable;
         }
 
         void setup()
         {
+            if (PRINTSIZE)
+                predictorsize ();
         }
 
         void terminate()
@@ -559,16 +562,31 @@ class CBP2016_TAGE_SC_L
 //            ltable = new lentry[1 << (LOGL)];
 //#endif
 
-            gtable[1] = new gentry[NBANKLOW * (1 << LOGG)];
             SizeTable[1] = NBANKLOW * (1 << LOGG);
-
-            gtable[BORN] = new gentry[NBANKHIGH * (1 << LOGG)];
             SizeTable[BORN] = NBANKHIGH * (1 << LOGG);
+            for (int i = 1; i <= BORN; i += BORN - 1)
+            {
+                gtagtab[i] = new uint16_t[SizeTable[i]]();
+                gctr[i] = new int8_t[SizeTable[i]]();
+                gu[i] = new int8_t[SizeTable[i]]();
+                gustamp[i] = new uint32_t[SizeTable[i]]();
+            }
+            UEPOCH = 0;
 
             for (int i = BORN + 1; i <= NHIST; i++)
-                gtable[i] = gtable[BORN];
+            {
+                gtagtab[i] = gtagtab[BORN];
+                gctr[i] = gctr[BORN];
+                gu[i] = gu[BORN];
+                gustamp[i] = gustamp[BORN];
+            }
             for (int i = 2; i <= BORN - 1; i++)
-                gtable[i] = gtable[1];
+            {
+                gtagtab[i] = gtagtab[1];
+                gctr[i] = gctr[1];
+                gu[i] = gu[1];
+                gustamp[i] = gustamp[1];
+            }
             btable = new bentry[1 << LOGB];
 
             for (int i = 1; i <= NHIST; i++)
@@ -935,10 +953,10 @@ class CBP2016_TAGE_SC_L
             for (int i = NHIST; i > 0; i--)
             {
                 if (NOSKIP[i])
-                    if (gtable[i][GI[i]].tag == GTAG[i])
+                    if (gtagtab[i][GI[i]] == GTAG[i])
                     {
                         HitBank = i;
-                        LongestMatchPred = (gtable[HitBank][GI[HitBank]].ctr >= 0);
+                        LongestMatchPred = (gctr[HitBank][GI[HitBank]] >= 0);
                         break;
                     }
             }
@@ -947,7 +965,7 @@ class CBP2016_TAGE_SC_L
             for (int i = HitBank - 1; i > 0; i--)
             {
                 if (NOSKIP[i])
-                    if (gtable[i][GI[i]].tag == GTAG[i])
+                    if (gtagtab[i][GI[i]] == GTAG[i])
                     {
 
                         AltBank = i;
@@ -960,8 +978,8 @@ class CBP2016_TAGE_SC_L
             {
                 if (AltBank > 0)
                 {
-                    alttaken = (gtable[AltBank][GI[AltBank]].ctr >= 0);
-                    AltConf = (abs (2 * gtable[AltBank][GI[AltBank]].ctr + 1) > 1);
+                    alttaken = (gctr[AltBank][GI[AltBank]] >= 0);
+                    AltConf = (abs (2 * gctr[AltBank][GI[AltBank]] + 1) > 1);
 
                 }
                 else
@@ -972,16 +990,16 @@ class CBP2016_TAGE_SC_L
 
                 bool Huse_alt_on_na = (use_alt_on_na[INDUSEALT] >= 0);
                 if ((!Huse_alt_on_na)
-                        || (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) > 1))
+                        || (abs (2 * gctr[HitBank][GI[HitBank]] + 1) > 1))
                     tage_pred = LongestMatchPred;
                 else
                     tage_pred = alttaken;
 
                 HighConf =
-                    (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) >=
+                    (abs (2 * gctr[HitBank][GI[HitBank]] + 1) >=
                      (1 << CWIDTH) - 1);
-                LowConf = (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) == 1);
-                MedConf = (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) == 5);
+                LowConf = (abs (2 * gctr[HitBank][GI[HitBank]] + 1) == 1);
+                MedConf = (abs (2 * gctr[HitBank][GI[HitBank]] + 1) == 5);
 
             }
         }
@@ -1041,36 +1059,32 @@ class CBP2016_TAGE_SC_L
 
             //Compute the SC prediction
 
-            LSUM = 0;
+            NSCCTR = 0;
+            NSCCOMP = 0;
 
-            //integrate BIAS prediction   
-            int8_t ctr = Bias[get_bias_index(PC)];
-
-            LSUM += (2 * ctr + 1);
-            ctr = BiasSK[get_biassk_index(PC)];
-            LSUM += (2 * ctr + 1);
-            ctr = BiasBank[get_biasbank_index(PC)];
-            LSUM += (2 * ctr + 1);
-#ifdef VARTHRES
-            LSUM = (1 + (WB[INDUPDS] >= 0)) * LSUM;
-#endif
+            //integrate BIAS prediction
+            SCCTR[NSCCTR++] = &Bias[get_bias_index(PC)];
+            SCCTR[NSCCTR++] = &BiasSK[get_biassk_index(PC)];
+            SCCTR[NSCCTR++] = &BiasBank[get_biasbank_index(PC)];
+            SCclose (PC, WB);
             //integrate the GEHL predictions
-            LSUM += Gpredict ((PC << 1) + pred_inter, hist_to_use.GHIST, Gm, GGEHL, GNB, LOGGNB, WG);
-            LSUM += Gpredict (PC, hist_to_use.phist, Pm, PGEHL, PNB, LOGPNB, WP);
+            Ggather ((PC << 1) + pred_inter, hist_to_use.GHIST, Gm, GGEHL, GNB, LOGGNB, WG);
+            Ggather (PC, hist_to_use.phist, Pm, PGEHL, PNB, LOGPNB, WP);
 #ifdef LOCALH
-            LSUM += Gpredict (PC, hist_to_use.L_shist[get_local_index(PC)], Lm, LGEHL, LNB, LOGLNB, WL);
+            Ggather (PC, hist_to_use.L_shist[get_local_index(PC)], Lm, LGEHL, LNB, LOGLNB, WL);
 #ifdef LOCALS
-            LSUM += Gpredict (PC, hist_to_use.S_slhist[get_second_local_index(PC)], Sm, SGEHL, SNB, LOGSNB, WS);
+            Ggather (PC, hist_to_use.S_slhist[get_second_local_index(PC)], Sm, SGEHL, SNB, LOGSNB, WS);
 #endif
 #ifdef LOCALT
-            LSUM += Gpredict (PC, hist_to_use.T_slhist[get_third_local_index(PC)], Tm, TGEHL, TNB, LOGTNB, WT);
+            Ggather (PC, hist_to_use.T_slhist[get_third_local_index(PC)], Tm, TGEHL, TNB, LOGTNB, WT);
 #endif
 #endif
 
 #ifdef IMLI
-            LSUM += Gpredict (PC, hist_to_use.IMHIST[(hist_to_use.IMLIcount)], IMm, IMGEHL, IMNB, LOGIMNB, WIM);
-            LSUM += Gpredict (PC, hist_to_use.IMLIcount, Im, IGEHL, INB, LOGINB, WI);
+            Ggather (PC, hist_to_use.IMHIST[(hist_to_use.IMLIcount)], IMm, IMGEHL, IMNB, LOGIMNB, WIM);
+            Ggather (PC, hist_to_use.IMLIcount, Im, IGEHL, INB, LOGINB, WI);
 #endif
+            LSUM = SCsum ();
             bool SCPRED = (LSUM >= 0);
             //just  an heuristic if the respective contribution of component groups can be multiplied by 2 or not
             THRES = (updatethreshold>>3)+Pupdatethreshold[INDUPD]
@@ -1314,50 +1328,14 @@ class CBP2016_TAGE_SC_L
                     }
                 }
 #ifdef VARTHRES
+                for (int c = 0; c < NSCCOMP; c++)
                 {
-                    int XSUM =
-                        LSUM - ((WB[INDUPDS] >= 0) * ((2 * Bias[get_bias_index(PC)] + 1) +
-                                    (2 * BiasSK[get_biassk_index(PC)] + 1) +
-                                    (2 * BiasBank[get_biasbank_index(PC)] + 1)));
-                    if ((XSUM +
-                                ((2 * Bias[get_bias_index(PC)] + 1) + (2 * BiasSK[get_biassk_index(PC)] + 1) +
-                                 (2 * BiasBank[get_biasbank_index(PC)] + 1)) >= 0) != (XSUM >= 0))
-                        ctrupdate (WB[INDUPDS],
-                                (((2 * Bias[get_bias_index(PC)] + 1) +
-                                  (2 * BiasSK[get_biassk_index(PC)] + 1) +
-                                  (2 * BiasBank[get_biasbank_index(PC)] + 1) >= 0) == resolveDir),
-                                EWIDTH);
+                    int XSUM = LSUM - ((*SCW[c] >= 0)) * SCPSUM[c];
+                    if ((XSUM + SCPSUM[c] >= 0) != (XSUM >= 0))
+                        ctrupdate (*SCW[c], ((SCPSUM[c] >= 0) == resolveDir), EWIDTH);
                 }
 #endif
-                ctrupdate (Bias[get_bias_index(PC)], resolveDir, PERCWIDTH);
-                ctrupdate (BiasSK[get_biassk_index(PC)], resolveDir, PERCWIDTH);
-                ctrupdate (BiasBank[get_biasbank_index(PC)], resolveDir, PERCWIDTH);
-                Gupdate ((PC << 1) + pred_inter, resolveDir,
-                        hist_to_use.GHIST, Gm, GGEHL, GNB, LOGGNB, WG);
-                Gupdate (PC, resolveDir, hist_to_use.phist, Pm, PGEHL, PNB, LOGPNB, WP);
-#ifdef LOCALH
-                Gupdate (PC, resolveDir, hist_to_use.L_shist[get_local_index(PC)], Lm, LGEHL, LNB, LOGLNB,
-                        WL);
-#ifdef LOCALS
-                Gupdate (PC, resolveDir, hist_to_use.S_slhist[get_second_local_index(PC)], Sm,
-                        SGEHL, SNB, LOGSNB, WS);
-#endif
-#ifdef LOCALT
-
-                Gupdate (PC, resolveDir, hist_to_use.T_slhist[get_third_local_index(PC)], Tm, TGEHL, TNB, LOGTNB,
-                        WT);
-#endif
-#endif
-
-
-#ifdef IMLI
-                Gupdate (PC, resolveDir, hist_to_use.IMHIST[(hist_to_use.IMLIcount)], IMm, IMGEHL, IMNB,
-                        LOGIMNB, WIM);
-                Gupdate (PC, resolveDir, hist_to_use.IMLIcount, Im, IGEHL, INB, LOGINB, WI);
-#endif
-
-
-
+                SCupdate (resolveDir);
             }
 #endif
 
@@ -1373,7 +1351,7 @@ class CBP2016_TAGE_SC_L
                 // for "pseudo"-newly allocated longest matching entry
                 // this is extremely important for TAGE only, not that important when the overall predictor is implemented 
                 bool PseudoNewAlloc =
-                    (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) <= 1);
+                    (abs (2 * gctr[HitBank][GI[HitBank]] + 1) <= 1);
                 // an entry is considered as newly allocated if its prediction counter is weak
                 if (PseudoNewAlloc)
                 {
@@ -1419,17 +1397,17 @@ class CBP2016_TAGE_SC_L
                     bool Done = false;
                     if (NOSKIP[i])
                     {
-                        if (gtable[i][GI[i]].u == 0)
+                        if (uref (i, GI[i]) == 0)
 
                         {
 #define OPTREMP
                             // the replacement is optimized with a single u bit: 0.2 %
 #ifdef OPTREMP
-                            if (abs (2 * gtable[i][GI[i]].ctr + 1) <= 3)
+                            if (abs (2 * gctr[i][GI[i]] + 1) <= 3)
 #endif
                             {
-                                gtable[i][GI[i]].tag = GTAG[i];
-                                gtable[i][GI[i]].ctr = (resolveDir) ? 0 : -1;
+                                gtagtab[i][GI[i]] = GTAG[i];
+                                gctr[i][GI[i]] = (resolveDir) ? 0 : -1;
                                 NA++;
                                 if (T <= 0)
                                 {
@@ -1442,10 +1420,10 @@ class CBP2016_TAGE_SC_L
 #ifdef OPTREMP
                             else
                             {
-                                if (gtable[i][GI[i]].ctr > 0)
-                                    gtable[i][GI[i]].ctr--;
+                                if (gctr[i][GI[i]] > 0)
+                                    gctr[i][GI[i]]--;
                                 else
-                                    gtable[i][GI[i]].ctr++;
+                                    gctr[i][GI[i]]++;
                             }
 
 #endif
@@ -1466,15 +1444,15 @@ class CBP2016_TAGE_SC_L
                         if (NOSKIP[i])
                         {
 
-                            if (gtable[i][GI[i]].u == 0)
+                            if (uref (i, GI[i]) == 0)
                             {
 #ifdef OPTREMP
-                                if (abs (2 * gtable[i][GI[i]].ctr + 1) <= 3)
+                                if (abs (2 * gctr[i][GI[i]] + 1) <= 3)
 #endif
 
                                 {
-                                    gtable[i][GI[i]].tag = GTAG[i];
-                                    gtable[i][GI[i]].ctr = (resolveDir) ? 0 : -1;
+                                    gtagtab[i][GI[i]] = GTAG[i];
+                                    gctr[i][GI[i]] = (resolveDir) ? 0 : -1;
                                     NA++;
                                     if (T <= 0)
                                     {
@@ -1486,10 +1464,10 @@ class CBP2016_TAGE_SC_L
 #ifdef OPTREMP
                                 else
                                 {
-                                    if (gtable[i][GI[i]].ctr > 0)
-                                        gtable[i][GI[i]].ctr--;
+                                    if (gctr[i][GI[i]] > 0)
+                                        gctr[i][GI[i]]--;
                                     else
-                                        gtable[i][GI[i]].ctr++;
+                                        gctr[i][GI[i]]++;
                                 }
 
 #endif
@@ -1514,10 +1492,8 @@ class CBP2016_TAGE_SC_L
                     TICK = 0;
                 if (TICK >= BORNTICK)
                 {
-
-                    for (int i = 1; i <= BORN; i += BORN - 1)
-                        for (int j = 0; j < SizeTable[i]; j++)
-                            gtable[i][j].u >>= 1;
+                    // the u counters of all the entries are halved: the shift is applied on the next access (see uref)
+                    UEPOCH++;
                     TICK = 0;
 
 
@@ -1527,31 +1503,31 @@ class CBP2016_TAGE_SC_L
             //update predictions
             if (HitBank > 0)
             {
-                if (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) == 1)
+                if (abs (2 * gctr[HitBank][GI[HitBank]] + 1) == 1)
                     if (LongestMatchPred != resolveDir)
 
                     {           // acts as a protection 
                         if (AltBank > 0)
                         {
-                            ctrupdate (gtable[AltBank][GI[AltBank]].ctr,
+                            ctrupdate (gctr[AltBank][GI[AltBank]],
                                     resolveDir, CWIDTH);
                         }
                         if (AltBank == 0)
                             baseupdate (resolveDir);
 
                     }
-                ctrupdate (gtable[HitBank][GI[HitBank]].ctr, resolveDir, CWIDTH);
+                ctrupdate (gctr[HitBank][GI[HitBank]], resolveDir, CWIDTH);
                 //sign changes: no way it can have been useful
-                if (abs (2 * gtable[HitBank][GI[HitBank]].ctr + 1) == 1)
-                    gtable[HitBank][GI[HitBank]].u = 0;
+                if (abs (2 * gctr[HitBank][GI[HitBank]] + 1) == 1)
+                    uref (HitBank, GI[HitBank]) = 0;
                 if (alttaken == resolveDir)
                     if (AltBank > 0)
-                        if (abs (2 * gtable[AltBank][GI[AltBank]].ctr + 1) == 7)
-                            if (gtable[HitBank][GI[HitBank]].u == 1)
+                        if (abs (2 * gctr[AltBank][GI[AltBank]] + 1) == 7)
+                            if (uref (HitBank, GI[HitBank]) == 1)
                             {
                                 if (LongestMatchPred == resolveDir)
                                 {
-                                    gtable[HitBank][GI[HitBank]].u = 0;
+                                    uref (HitBank, GI[HitBank]) = 0;
                                 }
                             }
             }
@@ -1562,53 +1538,81 @@ class CBP2016_TAGE_SC_L
             if (LongestMatchPred != alttaken)
                 if (LongestMatchPred == resolveDir)
                 {
-                    if (gtable[HitBank][GI[HitBank]].u < (1 << UWIDTH) - 1)
-                        gtable[HitBank][GI[HitBank]].u++;
+                    if (uref (HitBank, GI[HitBank]) < (1 << UWIDTH) - 1)
+                        uref (HitBank, GI[HitBank])++;
                 }
             //END TAGE UPDATE
             //HistoryUpdate (PC, brtype, resolveDir, nextPC, phist, ptghist, ch_i, ch_t[0], ch_t[1]);
 
         }//END PREDICTOR UPDATE
 
+        // u counter of an entry of the tagged tables: the halvings pending since its last access are applied first
+        int8_t & uref (int bank, int index)
+        {
+            uint32_t age = UEPOCH - gustamp[bank][index];
+            if (age)
+            {
+                gu[bank][index] = (age < UWIDTH) ? (gu[bank][index] >> age) : 0;
+                gustamp[bank][index] = UEPOCH;
+            }
+            return gu[bank][index];
+        }
+
 #define GINDEX (((uint64_t) PC) ^ bhist ^ (bhist >> (8 - i)) ^ (bhist >> (16 - 2 * i)) ^ (bhist >> (24 - 3 * i)) ^ (bhist >> (32 - 3 * i)) ^ (bhist >> (40 - 4 * i))) & ((1 << (logs - (i >= (NBR - 2)))) - 1)
-        int Gpredict (UINT64 PC, uint64_t BHIST, int *length, int8_t ** tab, int NBR, int logs, int8_t * W)
+        // Appends the counters selected by one GEHL component to the gather buffer
+        void Ggather (UINT64 PC, uint64_t BHIST, int *length, int8_t ** tab, int NBR, int logs, int8_t * W)
         {
-            int PERCSUM = 0;
             for (int i = 0; i < NBR; i++)
             {
                 uint64_t bhist = BHIST & ((uint64_t) ((1ULL << length[i]) - 1));
                 uint64_t index = GINDEX;
 
-                int8_t ctr = tab[i][index];
-
-                PERCSUM += (2 * ctr + 1);
+                SCCTR[NSCCTR++] = &tab[i][index];
             }
-#ifdef VARTHRES
-            PERCSUM = (1 + (W[INDUPDS] >= 0)) * PERCSUM;
-#endif
-            return ((PERCSUM));
+            SCclose (PC, W);
         }
-        void Gupdate (UINT64 PC, bool taken, uint64_t BHIST, int *length,
-                int8_t ** tab, int NBR, int logs, int8_t * W)
+        // Closes the current component of the gather buffer
+        void SCclose (UINT64 PC, int8_t * W)
         {
+            SCEND[NSCCOMP] = NSCCTR;
+            SCW[NSCCOMP] = &W[INDUPDS];
+            NSCCOMP++;
+        }
+        // Sums the gathered counters: the counters are first copied into a dense lane buffer,
+        // each component is then reduced as 2*sum+n and weighted by its VARTHRES counter
+        int SCsum ()
+        {
+            int8_t lane[SCNCTR_MAX];
+            for (int k = 0; k < NSCCTR; k++)
+                lane[k] = *SCCTR[k];
 
-            int PERCSUM = 0;
-
-            for (int i = 0; i < NBR; i++)
+            int sum = 0;
+            int beg = 0;
+            for (int c = 0; c < NSCCOMP; c++)
             {
-                uint64_t bhist = BHIST & ((uint64_t) ((1ULL << length[i]) - 1));
-                uint64_t index = GINDEX;
-
-                PERCSUM += (2 * tab[i][index] + 1);
-                ctrupdate (tab[i][index], taken, PERCWIDTH);
-            }
+                int PERCSUM = 0;
+                for (int k = beg; k < SCEND[c]; k++)
+                    PERCSUM += lane[k];
+                PERCSUM = 2 * PERCSUM + (SCEND[c] - beg);
+                SCPSUM[c] = PERCSUM;
 #ifdef VARTHRES
+                PERCSUM = (1 + (*SCW[c] >= 0)) * PERCSUM;
+#endif
+                sum += PERCSUM;
+                beg = SCEND[c];
+            }
+            return sum;
+        }
+        // Saturating update of all the gathered counters towards the outcome
+        void SCupdate (bool taken)
+        {
+            const int8_t sat = taken ? ((1 << (PERCWIDTH - 1)) - 1) : -(1 << (PERCWIDTH - 1));
+            const int8_t inc = taken ? 1 : -1;
+            for (int k = 0; k < NSCCTR; k++)
             {
-                int XSUM = LSUM - ((W[INDUPDS] >= 0)) * PERCSUM;
-                if ((XSUM + PERCSUM >= 0) != (XSUM >= 0))
-                    ctrupdate (W[INDUPDS], ((PERCSUM >= 0) == taken), EWIDTH);
+                int8_t ctr = *SCCTR[k];
+                *SCCTR[k] = (ctr == sat) ? ctr : ctr + inc;
             }
-#endif
         }
 
 
@@ -1761,7 +1765,53 @@ class CBP2016_TAGE_SC_L
 // =================
 
 
+// The CBP2016 64KB budget, used by default
+struct TageScLConfig64KB
+{
+    static constexpr int LOGL = 5;
+    static constexpr int LOGBIAS = 8;
+    static constexpr int LOGINB = 8;       // 128-entry
+    static constexpr int LOGIMNB = 9;      // 2 * 256-entry
+    static constexpr int LOGGNB = 10;      // 1 1K + 2 * 512-entry tables
+    static constexpr int LOGPNB = 9;       // 1 512 + 2 * 256-entry tables
+    static constexpr int LOGLNB = 10;      // 1 1K + 2 * 512-entry tables
+    static constexpr int LOGLOCAL = 8;
+    static constexpr int LOGSNB = 9;       // 1 512 + 2 * 256-entry tables
+    static constexpr int LOGSECLOCAL = 4;
+    static constexpr int LOGTNB = 10;      // 2 * 512-entry tables
+    static constexpr int LOGTLOCAL = 4;
+    static constexpr int LOGG = 10;
+    static constexpr int TBITS = 8;
+    static constexpr int LOGB = 13;
+    static constexpr bool PRINTSIZE = false;
+};
+
+// The 192KB budget
+struct TageScLConfig192KB
+{
+    static constexpr int LOGL = 8;
+    static constexpr int LOGBIAS = 11;
+    static constexpr int LOGINB = 10;      // 512-entry
+    static constexpr int LOGIMNB = 11;     // 2 * 1K-entry
+    static constexpr int LOGGNB = 12;      // 1 4K + 2 * 2K-entry tables
+    static constexpr int LOGPNB = 11;      // 1 2K + 2 * 1K-entry tables
+    static constexpr int LOGLNB = 11;      // 1 2K + 2 * 1K-entry tables
+    static constexpr int LOGLOCAL = 9;
+    static constexpr int LOGSNB = 10;      // 1 1K + 2 * 512-entry tables
+    static constexpr int LOGSECLOCAL = 5;
+    static constexpr int LOGTNB = 11;      // 2 * 1K-entry tables
+    static constexpr int LOGTLOCAL = 5;
+    static constexpr int LOGG = 11;
+    static constexpr int TBITS = 10;
+    static constexpr int LOGB = 18;
+    static constexpr bool PRINTSIZE = true;
+};
+
+using CBP2016_TAGE_SC_L = TageScL<TageScLConfig64KB>;
+using CBP2016_TAGE_SC_L_192KB = TageScL<TageScLConfig192KB>;
+
 #undef UINT64
 
 #endif
-static CBP2016_TAGE_SC_L cbp2016_tage_sc_l;
+static thread_local CBP2016_TAGE_SC_L cbp2016_tage_sc_l;
+static thread_local CBP2016_TAGE_SC_L_192KB cbp2016_tage_sc_l_192kb;
@@ -34,6 +34,22 @@
 #include "perceptron_predictor.h"
 // Removed incremental TAGE - too messy with symbol conflicts
 #include "predictor_config.h"
+#include "pc_interner.h"
+#include "reference/reference_predictors.h"
+
+// The pre-rewrite TAGE-SC-L while PRED_TAGE_SC_L_REF or
+// PRED_TAGE_SC_L_192KB_REF is selected (cbp-check's tage-ref), else null.
+static thread_local ReferenceTageScL *reference_tage_sc_l = nullptr;
+
+// The pre-port copy of the selected simple predictor while
+// select_reference_simple() is on (cbp-check's simple-ref), else null. It
+// stands in for the predictor wherever it is predicted or trained: here and in
+// bp_t::predict().
+static thread_local ReferenceSimplePredictor *reference_simple = nullptr;
+
+ReferenceSimplePredictor *reference_simple_predictor() {
+    return reference_simple;
+}
 
 void select_predictor(PredictorType pt) {
     selected_predictor = pt;
@@ -57,12 +73,15 @@ void beginCondDirPredictor()
     }
     
     // setup predictors
+    g_pc_interner.clear();
     cbp2016_tage_sc_l.setup();
     cond_predictor_impl.setup();
     if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
-        onebit_predictor_init(g_predictor_config.onebit_table_bits);
+        onebit_predictor_init(g_predictor_config.onebit_table_bits,
+                              g_predictor_config.onebit_infinite != 0);
     } else if (get_selected_predictor() == PredictorType::PRED_TWOBIT) {
-        twobit_predictor_init(g_predictor_config.twobit_table_bits);
+        twobit_predictor_init(g_predictor_config.twobit_table_bits,
+                              g_predictor_config.twobit_infinite != 0);
     } else if (get_selected_predictor() == PredictorType::PRED_CORRELATING) {
         correlating_predictor_init(g_predictor_config.correlating_pc_bits, 
                                    g_predictor_config.correlating_history_bits, 
@@ -70,10 +89,12 @@ void beginCondDirPredictor()
     } else if (get_selected_predictor() == PredictorType::PRED_LOCAL) {
         local_predictor_init(g_predictor_config.local_lht_bits, 
                             g_predictor_config.local_history_bits, 
-                            g_predictor_config.local_pht_bits);
+                            g_predictor_config.local_pht_bits,
+                            g_predictor_config.local_infinite != 0);
     } else if (get_selected_predictor() == PredictorType::PRED_GSHARE) {
         gshare_predictor_init(g_predictor_config.gshare_table_bits, 
-                             g_predictor_config.gshare_history_bits);
+                             g_predictor_config.gshare_history_bits,
+                             g_predictor_config.gshare_infinite != 0);
     } else if (get_selected_predictor() == PredictorType::PRED_TOURNAMENT) {
         tournament_predictor_init(g_predictor_config.tournament_selector_bits, 
                                  g_predictor_config.tournament_bimodal_bits,
@@ -85,9 +106,18 @@ void beginCondDirPredictor()
         perceptron_predictor_init(g_predictor_config.perceptron_table_bits, 
                                   g_predictor_config.perceptron_history_length, 
                                   g_predictor_config.perceptron_weight_bits, 
-                                  g_predictor_config.perceptron_threshold);
+                                  g_predictor_config.perceptron_threshold,
+                                  g_predictor_config.perceptron_infinite != 0);
     // REMOVED: PRED_TAGE_INCREMENTAL - symbol conflicts
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+        cbp2016_tage_sc_l_192kb.setup();
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_REF) {
+        reference_tage_sc_l = new_reference_tage_sc_l_64kb();
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB_REF) {
+        reference_tage_sc_l = new_reference_tage_sc_l_192kb();
     }
+    delete reference_simple;
+    reference_simple = reference_simple_selected() ? new_reference_simple_predictor(get_selected_predictor()) : nullptr;
 }
 
 //
@@ -109,31 +139,49 @@ void notify_instr_fetch(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint6
 //
 bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle)
 {
-    if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
-        return onebit_predictor_predict((uint32_t)pc);
+    if (reference_simple) {
+        return reference_simple->predict(pc);
+    } else if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
+        return onebit_predictor_predict(pc);
     } else if (get_selected_predictor() == PredictorType::PRED_TWOBIT) {
-        return twobit_predictor_predict((uint32_t)pc);
+        return twobit_predictor_predict(pc);
     } else if (get_selected_predictor() == PredictorType::PRED_CORRELATING) {
         return correlating_predictor_predict((uint32_t)pc);
     } else if (get_selected_predictor() == PredictorType::PRED_LOCAL) {
-        return local_predictor_predict((uint32_t)pc);
+        return local_predictor_predict(pc);
     } else if (get_selected_predictor() == PredictorType::PRED_GSHARE) {
-        return gshare_predictor_predict((uint32_t)pc);
+        return gshare_predictor_predict(pc);
     } else if (get_selected_predictor() == PredictorType::PRED_TOURNAMENT) {
         return tournament_predictor_predict((uint32_t)pc);
     } else if (get_selected_predictor() == PredictorType::PRED_TAGE) {
         return tage_predictor_predict((uint32_t)pc);
     } else if (get_selected_predictor() == PredictorType::PRED_PERCEPTRON) {
-        return perceptron_predictor_predict((uint32_t)pc);
+        return perceptron_predictor_predict(pc);
     // REMOVED: PRED_TAGE_INCREMENTAL - symbol conflicts
     } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L) {
         return cbp2016_tage_sc_l.predict(seq_no, piece, pc);
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+        return cbp2016_tage_sc_l_192kb.predict(seq_no, piece, pc);
+    } else if (reference_tage_sc_l) {
+        return reference_tage_sc_l->predict(seq_no, piece, pc);
     }
     const bool tage_sc_l_pred =  cbp2016_tage_sc_l.predict(seq_no, piece, pc);
     const bool my_prediction = cond_predictor_impl.predict(seq_no, piece, pc, tage_sc_l_pred);
     return my_prediction;
 }
 
+cond_provider_t get_cond_dir_provider(const bool pred_taken)
+{
+    if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L) {
+        return tage_sc_l_provider(cbp2016_tage_sc_l, pred_taken);
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+        return tage_sc_l_provider(cbp2016_tage_sc_l_192kb, pred_taken);
+    } else if (reference_tage_sc_l) {
+        return reference_tage_sc_l->provider(pred_taken);
+    }
+    return PROVIDER_OTHER;
+}
+
 //
 // spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, const bool resolve_dir, const bool pred_dir, const uint64_t next_pc)
 // 
@@ -172,30 +220,44 @@ void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_cla
 
     if(inst_class == InstClass::condBranchInstClass)
     {
-        if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
-            onebit_predictor_train((uint32_t)pc, resolve_dir);
+        if (reference_simple) {
+            reference_simple->train(pc, resolve_dir);
+        } else if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
+            onebit_predictor_train(pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_TWOBIT) {
-            twobit_predictor_train((uint32_t)pc, resolve_dir);
+            twobit_predictor_train(pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_CORRELATING) {
             correlating_predictor_train((uint32_t)pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_LOCAL) {
-            local_predictor_train((uint32_t)pc, resolve_dir);
+            local_predictor_train(pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_GSHARE) {
-            gshare_predictor_train((uint32_t)pc, resolve_dir);
+            gshare_predictor_train(pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_TOURNAMENT) {
             tournament_predictor_train((uint32_t)pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_TAGE) {
             tage_predictor_train((uint32_t)pc, resolve_dir);
         } else if (get_selected_predictor() == PredictorType::PRED_PERCEPTRON) {
-            perceptron_predictor_train((uint32_t)pc, resolve_dir);
+            perceptron_predictor_train(pc, resolve_dir);
             perceptron_predictor_update_history(resolve_dir);
         // REMOVED: PRED_TAGE_INCREMENTAL - symbol conflicts
         } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L) {
             cbp2016_tage_sc_l.history_update(seq_no, piece, pc, br_type, pred_dir, resolve_dir, next_pc);
+        } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+            cbp2016_tage_sc_l_192kb.history_update(seq_no, piece, pc, br_type, pred_dir, resolve_dir, next_pc);
+        } else if (reference_tage_sc_l) {
+            reference_tage_sc_l->history_update(seq_no, piece, pc, br_type, pred_dir, resolve_dir, next_pc);
         } else {
             cond_predictor_impl.history_update(seq_no, piece, pc, resolve_dir, next_pc);
         }
     }
+    else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB)
+    {
+        cbp2016_tage_sc_l_192kb.TrackOtherInst(pc, br_type, pred_dir, resolve_dir, next_pc);
+    }
+    else if (reference_tage_sc_l)
+    {
+        reference_tage_sc_l->TrackOtherInst(pc, br_type, pred_dir, resolve_dir, next_pc);
+    }
     else
     {
         cbp2016_tage_sc_l.TrackOtherInst(pc, br_type, pred_dir, resolve_dir, next_pc);
@@ -241,26 +303,32 @@ void notify_instr_execute_resolve(uint64_t seq_no, uint8_t piece, uint64_t pc, c
         {
             const bool _resolve_dir = _exec_info.taken.value();
             const uint64_t _next_pc = _exec_info.next_pc;
-            if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
-                onebit_predictor_train((uint32_t)pc, _resolve_dir);
+            if (reference_simple) {
+                reference_simple->train(pc, _resolve_dir);
+            } else if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
+                onebit_predictor_train(pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_TWOBIT) {
-                twobit_predictor_train((uint32_t)pc, _resolve_dir);
+                twobit_predictor_train(pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_CORRELATING) {
                 correlating_predictor_train((uint32_t)pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_LOCAL) {
-                local_predictor_train((uint32_t)pc, _resolve_dir);
+                local_predictor_train(pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_GSHARE) {
-                gshare_predictor_train((uint32_t)pc, _resolve_dir);
+                gshare_predictor_train(pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_TOURNAMENT) {
                 tournament_predictor_train((uint32_t)pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_TAGE) {
                 tage_predictor_train((uint32_t)pc, _resolve_dir);
             } else if (get_selected_predictor() == PredictorType::PRED_PERCEPTRON) {
-                perceptron_predictor_train((uint32_t)pc, _resolve_dir);
+                perceptron_predictor_train(pc, _resolve_dir);
                 perceptron_predictor_update_history(_resolve_dir);
             // REMOVED: PRED_TAGE_INCREMENTAL - symbol conflicts
             } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L) {
                 cbp2016_tage_sc_l.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+                cbp2016_tage_sc_l_192kb.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
+            } else if (reference_tage_sc_l) {
+                reference_tage_sc_l->update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
             } else {
                 cond_predictor_impl.update(seq_no, piece, pc, _resolve_dir, pred_dir, _next_pc);
             }
@@ -291,6 +359,8 @@ void notify_instr_commit(uint64_t seq_no, uint8_t piece, uint64_t pc, const bool
 //
 void endCondDirPredictor ()
 {
+    delete reference_simple;
+    reference_simple = nullptr;
     if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
         onebit_predictor_cleanup();
     } else if (get_selected_predictor() == PredictorType::PRED_TWOBIT) {
@@ -310,6 +380,11 @@ void endCondDirPredictor ()
     // REMOVED: PRED_TAGE_INCREMENTAL - symbol conflicts
     } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L) {
         cbp2016_tage_sc_l.terminate();
+    } else if (get_selected_predictor() == PredictorType::PRED_TAGE_SC_L_192KB) {
+        cbp2016_tage_sc_l_192kb.terminate();
+    } else if (reference_tage_sc_l) {
+        delete reference_tage_sc_l;
+        reference_tage_sc_l = nullptr;
     } else {
         cond_predictor_impl.terminate();
     }
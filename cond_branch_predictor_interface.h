@@ -8,6 +8,9 @@
 void select_predictor(PredictorType pt);
 void beginCondDirPredictor();
 bool get_cond_dir_prediction(uint64_t seq_no, uint8_t piece, uint64_t pc, const uint64_t pred_cycle);
+// Component that provided the last get_cond_dir_prediction() (which returned pred_taken).
+// Only valid until the next spec_update() or notify_instr_execute_resolve().
+cond_provider_t get_cond_dir_provider(const bool pred_taken);
 void spec_update(uint64_t seq_no, uint8_t piece, uint64_t pc, InstClass inst_class, bool resolve_dir, bool pred_dir, uint64_t next_pc);
 void endCondDirPredictor();
 
@@ -3,26 +3,23 @@
 #include "correlating_predictor.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include "sat_counter_array.h"
 
-static uint8_t* table = NULL;
-static uint32_t mask = 0;
-static int bits = 0;
-static int n_bits = 2;
-static uint8_t max_val = 3;
-static uint8_t threshold = 2;
-static int history_bits = 0;
-static uint32_t history = 0;
+// Counters of n_bits (CORRELATING_COUNTER_BITS, at most 8) bits
+static thread_local SatCounterArray<0> table;
+static thread_local uint32_t mask = 0;
+static thread_local int bits = 0;
+static thread_local int n_bits = 2;
+static thread_local int history_bits = 0;
+static thread_local uint32_t history = 0;
 
 void correlating_predictor_init(int table_bits, int hist_bits, int nbits) {
     bits = table_bits;
     history_bits = hist_bits;
     n_bits = nbits;
     uint32_t size = 1 << (bits + history_bits);
-    table = (uint8_t*)malloc(size * sizeof(uint8_t));
-    for (uint32_t i = 0; i < size; i++) table[i] = 1; // Initialize to WEAK_NOT_TAKEN
+    table.init(size, 1, n_bits); // Initialize to WEAK_NOT_TAKEN
     mask = size - 1;
-    max_val = (1 << n_bits) - 1;
-    threshold = (1 << (n_bits - 1));
     history = 0;
 }
 
@@ -36,8 +33,8 @@ uint8_t correlating_predictor_predict(uint32_t pc) {
     // Use only the lower 'history_bits' bits of the global history
     uint32_t hist_part = history & hist_mask;
     uint32_t idx = pc_part | hist_part;
-    uint8_t counter = table[idx];
-    return (counter >= threshold) ? 1 : 0;
+    // Taken if the counter is in the upper half of its range
+    return table.taken(idx) ? 1 : 0;
 }
 
 void correlating_predictor_train(uint32_t pc, uint8_t outcome) {
@@ -50,22 +47,16 @@ void correlating_predictor_train(uint32_t pc, uint8_t outcome) {
     // Use only the lower 'history_bits' bits of the global history
     uint32_t hist_part = history & hist_mask;
     uint32_t idx = pc_part | hist_part;
-    uint8_t counter = table[idx];
-    if (outcome) {
-        if (counter < max_val) {
-            table[idx] = counter + 1;
-        }
-    } else {
-        if (counter > 0) {
-            table[idx] = counter - 1;
-        }
-    }
+    table.update(idx, outcome);
     // Update global history
     // Update global history: shift left, add new outcome, and mask to keep only 'history_bits' bits
     history = ((history << 1) | (outcome ? 1 : 0)) & ((1 << history_bits) - 1);
 }
 
+uint64_t correlating_predictor_storage_bits() {
+    return table.storage_bits() + history_bits;
+}
+
 void correlating_predictor_cleanup() {
-    if (table) free(table);
-    table = NULL;
+    table.clear();
 }
@@ -7,4 +7,6 @@ void correlating_predictor_init(int table_bits, int history_bits, int n_bits);
 uint8_t correlating_predictor_predict(uint32_t pc);
 void correlating_predictor_train(uint32_t pc, uint8_t outcome);
 void correlating_predictor_cleanup();
+// Bits of state as sized by init().
+uint64_t correlating_predictor_storage_bits();
 #endif
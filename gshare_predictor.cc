@@ -1,83 +1,89 @@
 // gshare_predictor_fixed.cc
 // Clean gshare implementation from scratch
 #include "gshare_predictor.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include "pc_interner.h"
+#include "sat_counter_array.h"
+#include "history.h"
 
 // Pattern History Table - 2-bit saturating counters
-static uint8_t* pht = NULL;
-static uint32_t pht_size = 0;
-static uint32_t pht_mask = 0;
+static thread_local SatCounterArray<2> pht;
+static thread_local uint32_t pht_size = 0;
+static thread_local uint32_t pht_mask = 0;
 
-// Global history register
-static uint32_t global_history = 0;
-static uint32_t history_mask = 0;
-static int history_bits = 0;
+// Global history (any length; the index uses its newest min(history_bits, 64)
+// bits)
+static thread_local GlobalHistory global_history;
+static thread_local uint64_t history_mask = 0;
+static thread_local int history_bits = 0;
 
-void gshare_predictor_init(int table_bits, int hist_bits) {
+// Infinite mode: a private 2^history_bits PHT per interned PC, indexed by the
+// global history alone, so no two branches share a counter.
+static thread_local bool infinite = false;
+static thread_local SatCounterArray<2> per_pc_pht;
+
+static inline SatCounterArray<2>& table_of(uint64_t pc, size_t* idx) {
+    if (infinite) {
+        *idx = per_pc_counters(per_pc_pht, pc_intern(pc), (size_t)history_mask + 1, 1) + global_history.recent(history_bits);
+        return per_pc_pht;
+    }
+    // Compute gshare index: PC XOR global_history
+    *idx = (pc ^ global_history.recent(history_bits)) & pht_mask;
+    return pht;
+}
+
+void gshare_predictor_init(int table_bits, int hist_bits, bool _infinite) {
     // Clean up any existing state
-    if (pht) free(pht);
+    pht.clear();
+    per_pc_pht.clear();
     
     // Set parameters
+    infinite = _infinite;
     history_bits = hist_bits;
     pht_size = 1 << table_bits;
     pht_mask = pht_size - 1;
-    history_mask = (1 << history_bits) - 1;
-    
-    // Allocate and initialize Pattern History Table
-    pht = (uint8_t*)malloc(pht_size * sizeof(uint8_t));
+    history_mask = (history_bits >= 64) ? ~0ull : (1ull << history_bits) - 1;
+    // Infinite mode gives each branch 2^history_bits counters.
+    if (infinite && history_bits >= 64) {
+        printf("gshare: infinite mode needs GSHARE_HISTORY_BITS < 64 (got %d).\n", history_bits);
+        exit(1);
+    }
     
     // Initialize all counters to weakly not taken (1)
-    for (uint32_t i = 0; i < pht_size; i++) {
-        pht[i] = 1;  // WEAK_NOT_TAKEN
-    }
+    if (!infinite)
+        pht.init(pht_size, 1);
     
     // Initialize global history to 0
-    global_history = 0;
+    global_history.init(history_bits);
 }
 
-uint8_t gshare_predictor_predict(uint32_t pc) {
-    // Compute gshare index: PC XOR global_history
-    uint32_t index = (pc ^ global_history) & pht_mask;
-    
-    // Get 2-bit counter value
-    uint8_t counter = pht[index];
-    
-    // Predict taken if counter >= 2
-    return (counter >= 2) ? 1 : 0;
+uint8_t gshare_predictor_predict(uint64_t pc) {
+    // Predict taken if the 2-bit counter >= 2
+    size_t idx;
+    return table_of(pc, &idx).taken(idx) ? 1 : 0;
 }
 
-void gshare_predictor_train(uint32_t pc, uint8_t outcome) {
-    // Compute same gshare index as in predict
-    uint32_t index = (pc ^ global_history) & pht_mask;
-    
-    // Update 2-bit saturating counter
-    uint8_t counter = pht[index];
-    
-    if (outcome) {
-        // Branch taken - increment (saturate at 3)
-        if (counter < 3) {
-            pht[index] = counter + 1;
-        }
-    } else {
-        // Branch not taken - decrement (saturate at 0)  
-        if (counter > 0) {
-            pht[index] = counter - 1;
-        }
-    }
+void gshare_predictor_train(uint64_t pc, uint8_t outcome) {
+    // Same counter as in predict; update the 2-bit saturating counter
+    size_t idx;
+    table_of(pc, &idx).update(idx, outcome);
     
-    // Update global history: shift left and add new outcome
-    global_history = ((global_history << 1) | outcome) & history_mask;
+    // Update global history with the new outcome
+    global_history.push(outcome);
+}
+
+uint64_t gshare_predictor_storage_bits() {
+    return infinite ? UINT64_MAX : pht.storage_bits() + global_history.storage_bits();
 }
 
 void gshare_predictor_cleanup() {
-    if (pht) {
-        free(pht);
-        pht = NULL;
-    }
+    pht.clear();
+    per_pc_pht.clear();
     pht_size = 0;
     pht_mask = 0;
-    global_history = 0;
+    global_history.init(0);
     history_mask = 0;
     history_bits = 0;
 }
@@ -3,8 +3,13 @@
 #ifndef GSHARE_PREDICTOR_H
 #define GSHARE_PREDICTOR_H
 #include <stdint.h>
-void gshare_predictor_init(int table_bits, int history_bits);
-uint8_t gshare_predictor_predict(uint32_t pc);
-void gshare_predictor_train(uint32_t pc, uint8_t outcome);
+// infinite: a private 2^history_bits PHT per static branch (interned full PC), so
+// branches never alias; table_bits is ignored
+void gshare_predictor_init(int table_bits, int history_bits, bool infinite = false);
+uint8_t gshare_predictor_predict(uint64_t pc);
+void gshare_predictor_train(uint64_t pc, uint8_t outcome);
 void gshare_predictor_cleanup();
+// Bits of state as sized by init(); UINT64_MAX in infinite mode, whose
+// tables grow with the trace.
+uint64_t gshare_predictor_storage_bits();
 #endif
@@ -0,0 +1,218 @@
+// history.h
+// Branch history primitives: long global history, folded histories, path
+// history and local history tables
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Global outcome history of any length, kept as a circular bit buffer.
+//
+// push() writes one bit. bit(age) (age 0 is the newest outcome) and
+// recent(n) read at most two words. recent(n) returns the n <= 64 newest
+// outcomes with the newest in bit 0, as a `(h << 1) | taken` register holds
+// them.
+//
+// The buffer keeps max_length + slack bits. A checkpoint is position().
+// restore() rewinds to a checkpoint if fewer than slack outcomes were pushed
+// since then, because the window's bits have not been overwritten yet.
+class GlobalHistory {
+public:
+    explicit GlobalHistory(size_t max_length = 64, size_t slack = 1024) { init(max_length, slack); }
+
+    void init(size_t max_length, size_t slack = 1024) {
+        size_t bits = 128;
+        while (bits < max_length + slack + 64)
+            bits <<= 1;
+        words.assign(bits / 64, 0);
+        bit_mask = bits - 1;
+        word_mask = bits / 64 - 1;
+        head = 0;
+        length = max_length;
+    }
+
+    // The newest bit sits at the lowest index, so a window read upward from
+    // head is already in register order.
+    inline void push(bool taken) {
+        head--;
+        const size_t i = head & bit_mask;
+        uint64_t& w = words[i >> 6];
+        w = (w & ~(1ull << (i & 63))) | ((uint64_t)taken << (i & 63));
+    }
+
+    inline bool bit(size_t age) const {
+        const size_t i = (head + age) & bit_mask;
+        return (words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    inline uint64_t recent(unsigned n) const {
+        const size_t i = head & bit_mask;
+        const unsigned s = i & 63;
+        uint64_t v = words[i >> 6] >> s;
+        if (s)
+            v |= words[((i >> 6) + 1) & word_mask] << (64 - s);
+        return (n >= 64) ? v : v & ((1ull << n) - 1);
+    }
+
+    size_t max_length() const { return length; }
+    // The max_length bits a predictor can read; the slack is simulator-side.
+    uint64_t storage_bits() const { return length; }
+    uint64_t position() const { return head; }
+    void restore(uint64_t pos) { head = pos; }
+
+private:
+    std::vector<uint64_t> words;
+    size_t bit_mask = 0;
+    size_t word_mask = 0;
+    uint64_t head = 0;
+    size_t length = 0;
+};
+
+// Folded histories: the `length` newest outcomes XORed down to `width` bits
+// (the bit of age a lands on bit a % width), as TAGE-style predictors use
+// them for indices and tags. After every GlobalHistory::push(), update() shifts
+// the new outcome in and the one that left each window out. That is O(1) per
+// register whatever its length, and every register is updated in one pass.
+//
+// The folded values are a plain vector, so a checkpoint is a copy of
+// values() and restore() puts it back (with the GlobalHistory position).
+class FoldedHistories {
+public:
+    // Returns the id of a new register over `length` outcomes, folded to
+    // `width` <= 31 bits; `length` must not exceed the history's max_length().
+    size_t add(unsigned length, unsigned width) {
+        comp.push_back(0);
+        olength.push_back(length);
+        clength.push_back(width);
+        outpoint.push_back(length % width);
+        return comp.size() - 1;
+    }
+
+    void reset() {
+        for (uint32_t& c : comp)
+            c = 0;
+    }
+
+    inline void update(const GlobalHistory& h) {
+        const uint32_t in = h.bit(0);
+        for (size_t i = 0; i < comp.size(); i++) {
+            uint32_t c = (comp[i] << 1) ^ in;
+            c ^= (uint32_t)h.bit(olength[i]) << outpoint[i];
+            c ^= c >> clength[i];
+            comp[i] = c & ((1u << clength[i]) - 1);
+        }
+    }
+
+    inline uint32_t operator[](size_t id) const { return comp[id]; }
+    size_t size() const { return comp.size(); }
+
+    const std::vector<uint32_t>& values() const { return comp; }
+    void restore(const std::vector<uint32_t>& saved) { comp = saved; }
+
+private:
+    std::vector<uint32_t> comp;
+    std::vector<uint32_t> olength;
+    std::vector<uint32_t> clength;
+    std::vector<uint32_t> outpoint;
+};
+
+// A GlobalHistory with its folded registers, pushed together.
+class FoldedGlobalHistory {
+public:
+    struct Checkpoint {
+        uint64_t position;
+        std::vector<uint32_t> folds;
+    };
+
+    explicit FoldedGlobalHistory(size_t max_length = 64, size_t slack = 1024) : hist(max_length, slack) {}
+
+    void init(size_t max_length, size_t slack = 1024) {
+        hist.init(max_length, slack);
+        folds = FoldedHistories();
+    }
+
+    size_t add_fold(unsigned length, unsigned width) { return folds.add(length, width); }
+
+    inline void push(bool taken) {
+        hist.push(taken);
+        folds.update(hist);
+    }
+
+    inline uint32_t fold(size_t id) const { return folds[id]; }
+    inline bool bit(size_t age) const { return hist.bit(age); }
+    inline uint64_t recent(unsigned n) const { return hist.recent(n); }
+
+    Checkpoint checkpoint() const { return {hist.position(), folds.values()}; }
+    void restore(const Checkpoint& c) {
+        hist.restore(c.position);
+        folds.restore(c.folds);
+    }
+
+private:
+    GlobalHistory hist;
+    FoldedHistories folds;
+};
+
+// Path history: `bits_per_branch` address bits of each branch (pc >> shift,
+// as instructions are 4-byte aligned), newest in the low bits, over the last
+// length / bits_per_branch branches (length <= 64). The checkpoint is value().
+class PathHistory {
+public:
+    PathHistory(unsigned length = 16, unsigned bits_per_branch = 1, unsigned shift = 2) { init(length, bits_per_branch, shift); }
+
+    void init(unsigned length, unsigned bits_per_branch = 1, unsigned shift = 2) {
+        mask = (length >= 64) ? ~0ull : (1ull << length) - 1;
+        bits = bits_per_branch;
+        pc_shift = shift;
+        path = 0;
+    }
+
+    inline void push(uint64_t pc) {
+        path = ((path << bits) | ((pc >> pc_shift) & ((1ull << bits) - 1))) & mask;
+    }
+
+    inline uint64_t value() const { return path; }
+    void restore(uint64_t saved) { path = saved; }
+
+private:
+    uint64_t path = 0;
+    uint64_t mask = 0;
+    unsigned bits = 1;
+    unsigned pc_shift = 2;
+};
+
+// Local histories of up to 32 bits, one per entry: a PC-indexed table of a
+// fixed size (init()), or one entry per interned branch id (grow()). An entry
+// is checkpointed by get() and restored by set().
+class LocalHistoryTable {
+public:
+    void init(size_t entries, unsigned history_bits) {
+        mask = (history_bits >= 32) ? ~0u : (1u << history_bits) - 1;
+        bits = history_bits;
+        hist.assign(entries, 0);
+    }
+
+    // Grows the table to at least n entries, the new ones empty.
+    void grow(size_t n) {
+        if (n > hist.size())
+            hist.resize(n, 0);
+    }
+
+    void clear() { std::vector<uint32_t>().swap(hist); }
+
+    inline uint32_t get(size_t i) const { return hist[i]; }
+    inline void set(size_t i, uint32_t h) { hist[i] = h & mask; }
+    inline void update(size_t i, bool taken) { hist[i] = ((hist[i] << 1) | (uint32_t)taken) & mask; }
+
+    size_t size() const { return hist.size(); }
+    uint64_t storage_bits() const { return (uint64_t)hist.size() * bits; }
+
+private:
+    std::vector<uint32_t> hist;
+    uint32_t mask = 0;
+    unsigned bits = 0;
+};
+
+#endif
@@ -32,6 +32,9 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "bp.h"
 #include "cbp.h"
 #include "parameters.h"
+#include "stats_writer.h"
+#include "profiler.h"
+#include "branch_profile.h"
 #include "../cond_branch_predictor_interface.h"
 #include "predictor_type.h"
 #include "../onebit_predictor.h"
@@ -40,14 +43,21 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "../local_predictor.h"
 #include "../gshare_predictor.h"
 #include "../tournament_predictor.h"
+#include "../reference/reference_predictors.h"
 
 bp_t::bp_t()
 {
    if(!PERFECT_INDIRECT_PRED)
    {
-       ITTAGE = new IPREDICTOR();
+       if (reference_ittage_selected())
+          REF_ITTAGE = new_reference_ittage();
+       else
+          ITTAGE = new IPREDICTOR();
    }
 
+   if (BPROF_TOP || BPROF_DUMP)
+      profile = new branch_profile_t;
+
    // Initialize measurements.
    //meas_conddir_n = 0;
    //meas_conddir_m = 0;
@@ -72,6 +82,15 @@ bp_t::bp_t()
 }
 
 bp_t::~bp_t() {
+   delete profile;
+}
+
+// Predictors bp_t::predict() runs itself, without the interface's
+// spec_update().
+static bool predicted_in_bp(const PredictorType pt)
+{
+   return pt == PredictorType::PRED_ONEBIT || pt == PredictorType::PRED_CORRELATING ||
+          pt == PredictorType::PRED_LOCAL || pt == PredictorType::PRED_GSHARE;
 }
 
 // Returns true if instruction is a mispredicted branch.
@@ -85,14 +104,25 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
 
    if (inst_class == InstClass::condBranchInstClass)
    {
+      PROF_SCOPE(COND_PREDICT);
+      cond_provider_t provider = PROVIDER_OTHER;
       // CONDITIONAL BRANCH
       // Determine the actual taken/not-taken outcome.
       taken = (next_pc != (pc + 4));
+      // cbp-check's simple-ref: the pre-port copy of a predictor updated here
+      // (the others get it through the interface)
+      ReferenceSimplePredictor *ref_simple = predicted_in_bp(get_selected_predictor()) ? reference_simple_predictor() : nullptr;
+      if (ref_simple) {
+         pred_taken = ref_simple->predict(pc);
+         misp = (pred_taken != taken);
+         ref_simple->train(pc, taken);
+         meas_conddir_n_per_epoch.back()++;
+         meas_conddir_m_per_epoch.back() += misp;
       // If one-bit predictor is selected, use only it for prediction and update
-      if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
-         pred_taken = onebit_predictor_predict((uint32_t)pc);
+      } else if (get_selected_predictor() == PredictorType::PRED_ONEBIT) {
+         pred_taken = onebit_predictor_predict(pc);
          misp = (pred_taken != taken);
-         onebit_predictor_train((uint32_t)pc, taken);
+         onebit_predictor_train(pc, taken);
          // Update measurements for one-bit predictor only
          meas_conddir_n_per_epoch.back()++;
          meas_conddir_m_per_epoch.back() += misp;
@@ -104,22 +134,24 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
          meas_conddir_n_per_epoch.back()++;
          meas_conddir_m_per_epoch.back() += misp;
       } else if (get_selected_predictor() == PredictorType::PRED_LOCAL) {
-         pred_taken = local_predictor_predict((uint32_t)pc);
+         pred_taken = local_predictor_predict(pc);
          misp = (pred_taken != taken);
-         local_predictor_train((uint32_t)pc, taken);
+         local_predictor_train(pc, taken);
          // Update measurements for local predictor only
          meas_conddir_n_per_epoch.back()++;
          meas_conddir_m_per_epoch.back() += misp;
       } else if (get_selected_predictor() == PredictorType::PRED_GSHARE) {
-         pred_taken = gshare_predictor_predict((uint32_t)pc);
+         pred_taken = gshare_predictor_predict(pc);
          misp = (pred_taken != taken);
-         gshare_predictor_train((uint32_t)pc, taken);
+         gshare_predictor_train(pc, taken);
          // Update measurements for gshare predictor only
          meas_conddir_n_per_epoch.back()++;
          meas_conddir_m_per_epoch.back() += misp;
       } else {
          // Default: TAGE logic
          pred_taken = get_cond_dir_prediction (seq_no, piece, pc, pred_cycle);
+         if (profile)
+            provider = get_cond_dir_provider(pred_taken);
          misp = (pred_taken != taken);
          if(MISP_REDUCTION_PERC != 0 && misp)
          {
@@ -131,11 +163,16 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
              }
          }
          // OOO Update Option
-         spec_update(seq_no, piece, pc, inst_class, taken, pred_taken, next_pc);
+         {
+            PROF_SCOPE(COND_UPDATE);
+            spec_update(seq_no, piece, pc, inst_class, taken, pred_taken, next_pc);
+         }
          // Update measurements.
          meas_conddir_n_per_epoch.back()++;
          meas_conddir_m_per_epoch.back() += misp;
       }
+      if (profile)
+         profile->record(pc, taken, misp, provider);
    }
    else if (inst_class == InstClass::uncondDirectBranchInstClass || inst_class == InstClass::callDirectInstClass) {
       // CALL OR JUMP DIRECT
@@ -148,10 +185,17 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
       /* A. Seznec: update branch  histories for TAGE-SC-L and ITTAGE */
       //TAGESCL->TrackOtherInst(pc , 0,  true,next_pc);
       //TrackOtherInst(pc , 0,  true,next_pc);
+      {
+         PROF_SCOPE(COND_UPDATE);
          spec_update(seq_no, piece, pc, inst_class, true/*taken*/, true/*pred_taken*/, next_pc);
+      }
       if(!PERFECT_INDIRECT_PRED)
       {
-          ITTAGE->TrackOtherInst(pc , next_pc);
+          PROF_SCOPE(INDIRECT);
+          if (REF_ITTAGE)
+             REF_ITTAGE->TrackOtherInst(pc, next_pc);
+          else
+             ITTAGE->TrackOtherInst(pc , next_pc);
       }
 
       // Update measurements.
@@ -170,21 +214,29 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
       }
       else
       {
+         PROF_SCOPE(INDIRECT);
          // Make prediction.
-         pred_target= ITTAGE->GetPrediction (pc);
+         IPREDICTOR::pred_t ipred;
+         pred_target = REF_ITTAGE ? REF_ITTAGE->GetPrediction(pc) : ITTAGE->GetPrediction (pc, ipred);
 
          // Determine if mispredicted or not.
          misp = (pred_target != next_pc);
       
          /* A. Seznec: update ITTAGE*/
-         ITTAGE-> UpdatePredictor (pc , next_pc);
+         if (REF_ITTAGE)
+            REF_ITTAGE->UpdatePredictor(pc, next_pc);
+         else
+            ITTAGE-> UpdatePredictor (pc , next_pc, ipred);
       
          // Update measurements.
          meas_jumpind_m_per_epoch.back() += !is_ret && misp;
          meas_jumpret_m_per_epoch.back() += is_ret && misp;
       }
 
+      {
+         PROF_SCOPE(COND_UPDATE);
          spec_update(seq_no, piece, pc, inst_class, true/*taken*/, true/*pred_taken*/, next_pc);
+      }
       /* A. Seznec: update history for TAGE-SC-L */
       //TAGESCL->TrackOtherInst(pc , 2,  true,next_pc);
       //TrackOtherInst(pc , 2,  true,next_pc);
@@ -202,6 +254,27 @@ bool bp_t::predict(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_
    return(misp);
 }
 
+bool bp_t::warm(uint64_t seq_no, uint8_t piece, InstClass inst_class, uint64_t pc, uint64_t next_pc, const uint64_t pred_cycle)
+{
+   std::vector<uint64_t> *const meas[] = {
+      &meas_conddir_n_per_epoch, &meas_conddir_m_per_epoch, &meas_jumpdir_n_per_epoch,
+      &meas_jumpind_n_per_epoch, &meas_jumpind_m_per_epoch, &meas_jumpret_n_per_epoch,
+      &meas_jumpret_m_per_epoch, &meas_notctrl_n_per_epoch, &meas_notctrl_m_per_epoch,
+   };
+   uint64_t saved[sizeof(meas) / sizeof(meas[0])];
+   for (size_t m = 0; m < sizeof(meas) / sizeof(meas[0]); m++)
+      saved[m] = meas[m]->back();
+   branch_profile_t *const saved_profile = profile;
+   profile = NULL;
+
+   const bool misp = predict(seq_no, piece, inst_class, pc, next_pc, pred_cycle);
+
+   profile = saved_profile;
+   for (size_t m = 0; m < sizeof(meas) / sizeof(meas[0]); m++)
+      meas[m]->back() = saved[m];
+   return misp;
+}
+
 void bp_t::notify_begin_new_epoch()
 {
     meas_conddir_n_per_epoch.emplace_back(0);   // # conditional branches
@@ -221,6 +294,55 @@ void bp_t::notify_begin_new_epoch()
     meas_cycles_on_wrong_path_per_epoch.emplace_back(0);    // cycles_on_wrong_path
 }
 
+template <class F>
+void bp_t::for_each_epoch_vector(const bp_t &other, F f)
+{
+    f(meas_conddir_n_per_epoch, other.meas_conddir_n_per_epoch);
+    f(meas_conddir_m_per_epoch, other.meas_conddir_m_per_epoch);
+    f(meas_jumpdir_n_per_epoch, other.meas_jumpdir_n_per_epoch);
+    f(meas_jumpind_n_per_epoch, other.meas_jumpind_n_per_epoch);
+    f(meas_jumpind_m_per_epoch, other.meas_jumpind_m_per_epoch);
+    f(meas_jumpret_n_per_epoch, other.meas_jumpret_n_per_epoch);
+    f(meas_jumpret_m_per_epoch, other.meas_jumpret_m_per_epoch);
+    f(meas_notctrl_n_per_epoch, other.meas_notctrl_n_per_epoch);
+    f(meas_notctrl_m_per_epoch, other.meas_notctrl_m_per_epoch);
+    f(meas_cycles_on_wrong_path_per_epoch, other.meas_cycles_on_wrong_path_per_epoch);
+}
+
+void bp_t::reset_epochs()
+{
+    for_each_epoch_vector(*this, [](std::vector<uint64_t> &v, const std::vector<uint64_t> &) {
+        v.erase(v.begin(), v.end() - 1);
+    });
+}
+
+void bp_t::clear_epochs()
+{
+    for_each_epoch_vector(*this, [](std::vector<uint64_t> &v, const std::vector<uint64_t> &) {
+        v.clear();
+    });
+}
+
+void bp_t::append_epochs(const bp_t &other, const size_t n)
+{
+    for_each_epoch_vector(other, [n](std::vector<uint64_t> &v, const std::vector<uint64_t> &o) {
+        assert(n <= o.size());
+        v.insert(v.end(), o.begin(), o.begin() + n);
+    });
+}
+
+bp_window_stats_t bp_t::epoch_range_stats(const size_t first, const size_t last) const
+{
+    bp_window_stats_t w;
+    for (size_t epoch = first; epoch < last; epoch++)
+    {
+        w.br                    += meas_conddir_n_per_epoch.at(epoch);
+        w.mispred               += meas_conddir_m_per_epoch.at(epoch);
+        w.cycles_on_wrong_path  += meas_cycles_on_wrong_path_per_epoch.at(epoch);
+    }
+    return w;
+}
+
 void bp_t::update_cycles_on_wrong_path(const uint64_t cycles_on_wrong_path)
 {
     meas_cycles_on_wrong_path_per_epoch.back() += cycles_on_wrong_path;
@@ -231,21 +353,21 @@ void bp_t::update_cycles_on_wrong_path(const uint64_t cycles_on_wrong_path)
 
 void bp_t::output(const uint64_t num_inst)
 {
-   const uint64_t meas_conddir_n = std::accumulate(meas_conddir_n_per_epoch.begin(), meas_conddir_n_per_epoch.end(), 0);    // # conditional branches
-   const uint64_t meas_conddir_m = std::accumulate(meas_conddir_m_per_epoch.begin(), meas_conddir_m_per_epoch.end(), 0);    // # mispredicted conditional branches
+   const uint64_t meas_conddir_n = std::accumulate(meas_conddir_n_per_epoch.begin(), meas_conddir_n_per_epoch.end(), uint64_t{0});    // # conditional branches
+   const uint64_t meas_conddir_m = std::accumulate(meas_conddir_m_per_epoch.begin(), meas_conddir_m_per_epoch.end(), uint64_t{0});    // # mispredicted conditional branches
                                    
-   const uint64_t meas_jumpdir_n = std::accumulate(meas_jumpdir_n_per_epoch.begin(), meas_jumpdir_n_per_epoch.end(), 0);    // # jumps, direct
+   const uint64_t meas_jumpdir_n = std::accumulate(meas_jumpdir_n_per_epoch.begin(), meas_jumpdir_n_per_epoch.end(), uint64_t{0});    // # jumps, direct
                                    
-   const uint64_t meas_jumpind_n = std::accumulate(meas_jumpind_n_per_epoch.begin(), meas_jumpind_n_per_epoch.end(), 0);    // # jumps, indirect
-   const uint64_t meas_jumpind_m = std::accumulate(meas_jumpind_m_per_epoch.begin(), meas_jumpind_m_per_epoch.end(), 0);    // # mispredicted jumps, indirect
+   const uint64_t meas_jumpind_n = std::accumulate(meas_jumpind_n_per_epoch.begin(), meas_jumpind_n_per_epoch.end(), uint64_t{0});    // # jumps, indirect
+   const uint64_t meas_jumpind_m = std::accumulate(meas_jumpind_m_per_epoch.begin(), meas_jumpind_m_per_epoch.end(), uint64_t{0});    // # mispredicted jumps, indirect
                                    
-   const uint64_t meas_jumpret_n = std::accumulate(meas_jumpret_n_per_epoch.begin(), meas_jumpret_n_per_epoch.end(), 0);    // # jumps, return
-   const uint64_t meas_jumpret_m = std::accumulate(meas_jumpret_m_per_epoch.begin(), meas_jumpret_m_per_epoch.end(), 0);    // # mispredicted jumps, return
+   const uint64_t meas_jumpret_n = std::accumulate(meas_jumpret_n_per_epoch.begin(), meas_jumpret_n_per_epoch.end(), uint64_t{0});    // # jumps, return
+   const uint64_t meas_jumpret_m = std::accumulate(meas_jumpret_m_per_epoch.begin(), meas_jumpret_m_per_epoch.end(), uint64_t{0});    // # mispredicted jumps, return
                                    
-   const uint64_t meas_notctrl_n = std::accumulate(meas_notctrl_n_per_epoch.begin(), meas_notctrl_n_per_epoch.end(), 0);    // # non-control transfer instructions
-   const uint64_t meas_notctrl_m = std::accumulate(meas_notctrl_m_per_epoch.begin(), meas_notctrl_m_per_epoch.end(), 0);    // # non-control transfer instructions for which: next_pc != pc + 4
+   const uint64_t meas_notctrl_n = std::accumulate(meas_notctrl_n_per_epoch.begin(), meas_notctrl_n_per_epoch.end(), uint64_t{0});    // # non-control transfer instructions
+   const uint64_t meas_notctrl_m = std::accumulate(meas_notctrl_m_per_epoch.begin(), meas_notctrl_m_per_epoch.end(), uint64_t{0});    // # non-control transfer instructions for which: next_pc != pc + 4
 
-   //const uint64_t meas_cycles_on_wrong_path = std::accumulate(meas_cycles_on_wrong_path_per_epoch.begin(), meas_cycles_on_wrong_path_per_epoch.end(), 0);
+   //const uint64_t meas_cycles_on_wrong_path = std::accumulate(meas_cycles_on_wrong_path_per_epoch.begin(), meas_cycles_on_wrong_path_per_epoch.end(), uint64_t{0});
 
    //uint64_t num_misp = (meas_conddir_m + meas_jumpind_m + meas_jumpret_m + meas_notctrl_m);
    printf("\n-----------------------------------------------BRANCH PREDICTION MEASUREMENTS (Full Simulation i.e. Counts Not Reset When Warmup Ends)----------------------------------------------\n");
@@ -257,6 +379,103 @@ void bp_t::output(const uint64_t num_inst)
    BP_OUTPUT("JumpReturn       ", meas_jumpret_n, meas_jumpret_m, num_inst);
    BP_OUTPUT("Not control      ", meas_notctrl_n, meas_notctrl_m, num_inst);
    printf("------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
+
+   if (profile) {
+      if (BPROF_TOP)
+         profile->output(BPROF_TOP, num_inst);
+      if (BPROF_DUMP && !profile->dump(BPROF_DUMP, num_inst))
+         fprintf(stderr, "Warning: -bprof-dump: could not write %s\n", BPROF_DUMP);
+   }
+}
+
+bp_window_stats_t bp_t::window_stats(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch, const uint64_t target_instr_count) const
+{
+   bp_window_stats_t w;
+   for(int epoch_index = num_insts_per_epoch.size() -1; epoch_index >= 0; epoch_index--)
+   {
+        w.instr                 += num_insts_per_epoch.at(epoch_index);
+        w.cycles                += num_cycles_per_epoch.at(epoch_index);
+        w.br                    += meas_conddir_n_per_epoch.at(epoch_index);
+        w.mispred               += meas_conddir_m_per_epoch.at(epoch_index);
+        w.cycles_on_wrong_path  += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
+        if(w.instr > target_instr_count)
+        {
+            break;
+        }
+   }
+   return w;
+}
+
+bp_window_stats_t bp_t::running_totals() const
+{
+   bp_window_stats_t w;
+   for (size_t epoch = 0; epoch < meas_conddir_n_per_epoch.size(); epoch++)
+   {
+        w.br                    += meas_conddir_n_per_epoch[epoch];
+        w.mispred               += meas_conddir_m_per_epoch[epoch];
+        w.cycles_on_wrong_path  += meas_cycles_on_wrong_path_per_epoch[epoch];
+   }
+   return w;
+}
+
+void bp_t::write_epoch_stats(stats_writer_t &w, const size_t epoch) const
+{
+   w.field("cond_br", meas_conddir_n_per_epoch.at(epoch));
+   w.field("cond_misp", meas_conddir_m_per_epoch.at(epoch));
+   w.field("jump_direct", meas_jumpdir_n_per_epoch.at(epoch));
+   w.field("jump_indirect", meas_jumpind_n_per_epoch.at(epoch));
+   w.field("jump_indirect_misp", meas_jumpind_m_per_epoch.at(epoch));
+   w.field("jump_return", meas_jumpret_n_per_epoch.at(epoch));
+   w.field("jump_return_misp", meas_jumpret_m_per_epoch.at(epoch));
+   w.field("not_control", meas_notctrl_n_per_epoch.at(epoch));
+   w.field("not_control_misp", meas_notctrl_m_per_epoch.at(epoch));
+   w.field("cyc_wp", meas_cycles_on_wrong_path_per_epoch.at(epoch));
+}
+
+void bp_t::write_summary(stats_writer_t &w, const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch) const
+{
+   auto sum = [](const std::vector<uint64_t> &v) { return std::accumulate(v.begin(), v.end(), uint64_t{0}); };
+
+   if (profile && BPROF_TOP)
+      profile->write_stats(w, BPROF_TOP);
+
+   w.begin("branch", 0);
+   w.field("cond_br", sum(meas_conddir_n_per_epoch));
+   w.field("cond_misp", sum(meas_conddir_m_per_epoch));
+   w.field("jump_direct", sum(meas_jumpdir_n_per_epoch));
+   w.field("jump_indirect", sum(meas_jumpind_n_per_epoch));
+   w.field("jump_indirect_misp", sum(meas_jumpind_m_per_epoch));
+   w.field("jump_return", sum(meas_jumpret_n_per_epoch));
+   w.field("jump_return_misp", sum(meas_jumpret_m_per_epoch));
+   w.field("not_control", sum(meas_notctrl_n_per_epoch));
+   w.field("not_control_misp", sum(meas_notctrl_m_per_epoch));
+   w.field("cyc_wp", sum(meas_cycles_on_wrong_path_per_epoch));
+   w.end();
+
+   // Same windows as output_periodic_info().
+   const uint64_t total_instr = sum(num_insts_per_epoch);
+   const struct { const char *name; uint64_t target; } windows[] = {
+      {"last_10M", 10000000},
+      {"last_25M", 25000000},
+      {"50perc", total_instr/2},
+      {"full", total_instr},
+   };
+   for (const auto &win : windows)
+   {
+      const bp_window_stats_t s = window_stats(num_insts_per_epoch, num_cycles_per_epoch, win.target);
+      w.begin(win.name, 0);
+      w.field("instr", s.instr);
+      w.field("cycles", s.cycles);
+      w.field("ipc", (double)s.instr/(double)s.cycles);
+      w.field("cond_br", s.br);
+      w.field("cond_misp", s.mispred);
+      w.field("mr_perc", 100.0*(double)s.mispred/(double)s.br);
+      w.field("mpki", 1000.0*(double)s.mispred/(double)s.instr);
+      w.field("cyc_wp", s.cycles_on_wrong_path);
+      w.field("cyc_wp_avg", (s.mispred == 0) ? 0.0 : (double)s.cycles_on_wrong_path/(double)s.mispred);
+      w.field("cyc_wp_pki", (double)s.cycles_on_wrong_path*1000/(double)s.instr);
+      w.end();
+   }
 }
 
 void bp_t::output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch)
@@ -267,23 +486,12 @@ void bp_t::output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch,
       const uint64_t target_instr_count = 10000000;
       printf("\n------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Last 10M instructions)-----------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for(int epoch_index = num_insts_per_epoch.size() -1; epoch_index >= 0; epoch_index--)
-      {
-           my_instr_count       += num_insts_per_epoch.at(epoch_index);
-           my_cycle_count       += num_cycles_per_epoch.at(epoch_index);
-           my_br_count          += meas_conddir_n_per_epoch.at(epoch_index);
-           my_br_mispred_count  += meas_conddir_m_per_epoch.at(epoch_index);
-           my_wpc_count         += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-           if(my_instr_count > target_instr_count)
-           {
-               break;
-           }
-      }
+      const bp_window_stats_t w = window_stats(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = w.instr;
+      const uint64_t my_cycle_count = w.cycles;
+      const uint64_t my_br_count = w.br;
+      const uint64_t my_br_mispred_count = w.mispred;
+      const uint64_t my_wpc_count = w.cycles_on_wrong_path;
       const double cyc_wp_avg =  (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count/(double)my_br_mispred_count;
       const double cyc_wp_pki =  (double)my_wpc_count*1000/(double)my_instr_count;
    printf("%12llu %12llu %8.4f %10llu %10llu %8.4lf %12.4lf %8.4lf%% %8.4lf %10llu %10.4lf %10.4lf\n", (unsigned long long)my_instr_count, (unsigned long long)my_cycle_count, (double)my_instr_count/(double)my_cycle_count, (unsigned long long)my_br_count, (unsigned long long)my_br_mispred_count, (double)(my_br_count)/(double)(my_cycle_count), (double)(my_br_mispred_count)/(double)(my_cycle_count), 100.0*((double)(my_br_mispred_count)/(double)(my_br_count)), 1000.0*((double)(my_br_mispred_count)/(double)(my_instr_count)), (unsigned long long)my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -294,51 +502,29 @@ void bp_t::output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch,
       const uint64_t target_instr_count = 25000000;
       printf("\n------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Last 25M instructions)-----------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for(int epoch_index = num_insts_per_epoch.size() -1; epoch_index >= 0; epoch_index--)
-      {
-           my_instr_count       += num_insts_per_epoch.at(epoch_index);
-           my_cycle_count       += num_cycles_per_epoch.at(epoch_index);
-           my_br_count          += meas_conddir_n_per_epoch.at(epoch_index);
-           my_br_mispred_count  += meas_conddir_m_per_epoch.at(epoch_index);
-           my_wpc_count         += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-           if(my_instr_count > target_instr_count)
-           {
-               break;
-           }
-      }
+      const bp_window_stats_t w = window_stats(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = w.instr;
+      const uint64_t my_cycle_count = w.cycles;
+      const uint64_t my_br_count = w.br;
+      const uint64_t my_br_mispred_count = w.mispred;
+      const uint64_t my_wpc_count = w.cycles_on_wrong_path;
       const double cyc_wp_avg =  (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count/(double)my_br_mispred_count;
       const double cyc_wp_pki =  (double)my_wpc_count*1000/(double)my_instr_count;
    printf("%12llu %12llu %8.4f %10llu %10llu %8.4lf %12.4lf %8.4lf%% %8.4lf %10llu %10.4lf %10.4lf\n", (unsigned long long)my_instr_count, (unsigned long long)my_cycle_count, (double)my_instr_count/(double)my_cycle_count, (unsigned long long)my_br_count, (unsigned long long)my_br_mispred_count, (double)(my_br_count)/(double)(my_cycle_count), (double)(my_br_mispred_count)/(double)(my_cycle_count), 100.0*((double)(my_br_mispred_count)/(double)(my_br_count)), 1000.0*((double)(my_br_mispred_count)/(double)(my_instr_count)), (unsigned long long)my_wpc_count, cyc_wp_avg, cyc_wp_pki);
       printf("-------------------------------------------------------------------------------------------------------------------------------------------------------------------------------------\n");
    }
 
-   const uint64_t total_instr = std::accumulate(num_insts_per_epoch.begin(), num_insts_per_epoch.end(), 0); // # mispredicted jumps, return
+   const uint64_t total_instr = std::accumulate(num_insts_per_epoch.begin(), num_insts_per_epoch.end(), uint64_t{0}); // # mispredicted jumps, return
    {
       const uint64_t target_instr_count = total_instr/2;
       printf("\n---------------------------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (50 Perc instructions)---------------------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for(int epoch_index = num_insts_per_epoch.size() -1; epoch_index >= 0; epoch_index--)
-      {
-           my_instr_count       += num_insts_per_epoch.at(epoch_index);
-           my_cycle_count       += num_cycles_per_epoch.at(epoch_index);
-           my_br_count          += meas_conddir_n_per_epoch.at(epoch_index);
-           my_br_mispred_count  += meas_conddir_m_per_epoch.at(epoch_index);
-           my_wpc_count         += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-           if(my_instr_count > target_instr_count)
-           {
-               break;
-           }
-      }
+      const bp_window_stats_t w = window_stats(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = w.instr;
+      const uint64_t my_cycle_count = w.cycles;
+      const uint64_t my_br_count = w.br;
+      const uint64_t my_br_mispred_count = w.mispred;
+      const uint64_t my_wpc_count = w.cycles_on_wrong_path;
       const double cyc_wp_avg =  (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count/(double)my_br_mispred_count;
       const double cyc_wp_pki =  (double)my_wpc_count*1000/(double)my_instr_count;
    printf("%12llu %12llu %8.4f %10llu %10llu %8.4lf %12.4lf %8.4lf%% %8.4lf %10llu %10.4lf %10.4lf\n", (unsigned long long)my_instr_count, (unsigned long long)my_cycle_count, (double)my_instr_count/(double)my_cycle_count, (unsigned long long)my_br_count, (unsigned long long)my_br_mispred_count, (double)(my_br_count)/(double)(my_cycle_count), (double)(my_br_mispred_count)/(double)(my_cycle_count), 100.0*((double)(my_br_mispred_count)/(double)(my_br_count)), 1000.0*((double)(my_br_mispred_count)/(double)(my_instr_count)), (unsigned long long)my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -346,27 +532,16 @@ void bp_t::output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch,
    }
 
    {
-      const uint64_t total_instr = std::accumulate(num_insts_per_epoch.begin(), num_insts_per_epoch.end(), 0);  // # mispredicted jumps, return
+      const uint64_t total_instr = std::accumulate(num_insts_per_epoch.begin(), num_insts_per_epoch.end(), uint64_t{0});  // # mispredicted jumps, return
       const uint64_t target_instr_count = total_instr;
       printf("\n-------------------------------------DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS (Full Simulation i.e. Counts Not Reset When Warmup Ends)-------------------------------------\n");
       printf("       Instr       Cycles      IPC      NumBr     MispBr BrPerCyc MispBrPerCyc        MR     MPKI      CycWP   CycWPAvg   CycWPPKI\n");
-      uint64_t my_instr_count = 0;
-      uint64_t my_cycle_count = 0;
-      uint64_t my_br_count = 0;
-      uint64_t my_br_mispred_count = 0;
-      uint64_t my_wpc_count = 0;
-      for(int epoch_index = num_insts_per_epoch.size() -1; epoch_index >= 0; epoch_index--)
-      {
-           my_instr_count       += num_insts_per_epoch.at(epoch_index);
-           my_cycle_count       += num_cycles_per_epoch.at(epoch_index);
-           my_br_count          += meas_conddir_n_per_epoch.at(epoch_index);
-           my_br_mispred_count  += meas_conddir_m_per_epoch.at(epoch_index);
-           my_wpc_count         += meas_cycles_on_wrong_path_per_epoch.at(epoch_index);
-           if(my_instr_count > target_instr_count)
-           {
-               break;
-           }
-      }
+      const bp_window_stats_t w = window_stats(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+      const uint64_t my_instr_count = w.instr;
+      const uint64_t my_cycle_count = w.cycles;
+      const uint64_t my_br_count = w.br;
+      const uint64_t my_br_mispred_count = w.mispred;
+      const uint64_t my_wpc_count = w.cycles_on_wrong_path;
       const double cyc_wp_avg =  (my_br_mispred_count == 0) ? 0.00 : (double)my_wpc_count/(double)my_br_mispred_count;
       const double cyc_wp_pki =  (double)my_wpc_count*1000/(double)my_instr_count;
    printf("%12llu %12llu %8.4f %10llu %10llu %8.4lf %12.4lf %8.4lf%% %8.4lf %10llu %10.4lf %10.4lf\n", (unsigned long long)my_instr_count, (unsigned long long)my_cycle_count, (double)my_instr_count/(double)my_cycle_count, (unsigned long long)my_br_count, (unsigned long long)my_br_mispred_count, (double)(my_br_count)/(double)(my_cycle_count), (double)(my_br_mispred_count)/(double)(my_cycle_count), 100.0*((double)(my_br_mispred_count)/(double)(my_br_count)), 1000.0*((double)(my_br_mispred_count)/(double)(my_instr_count)), (unsigned long long)my_wpc_count, cyc_wp_avg, cyc_wp_pki);
@@ -24,6 +24,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ittage.h"
 
+class stats_writer_t;
+class branch_profile_t;
+class ReferenceIttage;
+
 class ras_t {
 private:
     uint64_t *ras;
@@ -53,6 +57,15 @@ public:
     }
 };
 
+// Conditional branch counters summed over a window of trailing epochs.
+struct bp_window_stats_t {
+    uint64_t instr = 0;
+    uint64_t cycles = 0;
+    uint64_t br = 0;
+    uint64_t mispred = 0;
+    uint64_t cycles_on_wrong_path = 0;
+};
+
 class bp_t {
 private:
     //// Conditional branch predictor based on CBP-5 TAGE-SC-L
@@ -60,6 +73,8 @@ private:
 
     // Indirect target predictor based on ITTAGE
     IPREDICTOR *ITTAGE = nullptr;
+    // The pre-rewrite ITTAGE in its place (cbp-check's ittage-ref), else null
+    ReferenceIttage *REF_ITTAGE = nullptr;
 
     // Return address stack for predicting return targets.
     //ras_t ras;
@@ -98,6 +113,13 @@ private:
 
     std::vector<uint64_t> meas_cycles_on_wrong_path_per_epoch;
 
+    // Per-static-branch profile (-bprof / -bprof-dump), NULL if disabled.
+    branch_profile_t *profile = NULL;
+
+    // Calls f on every per-epoch measurement vector of *this and of other
+    // (parallel interval stitching).
+    template <class F> void for_each_epoch_vector(const bp_t &other, F f);
+
 public:
     bp_t();
     ~bp_t();
@@ -105,11 +127,30 @@ public:
     // Returns true if instruction is a mispredicted branch.
     // Also updates all branch predictor structures as applicable.
     bool predict(uint64_t seq_no, uint8_t piece, InstClass insn, uint64_t pc, uint64_t next_pc, const uint64_t pred_cycle);
+    // predict() for functional warming (-smarts): the predictors are trained
+    // the same way, but the measurements and the profile are left untouched.
+    bool warm(uint64_t seq_no, uint8_t piece, InstClass insn, uint64_t pc, uint64_t next_pc, const uint64_t pred_cycle);
 
     // Output all branch prediction measurements.
     void output(const uint64_t num_inst);
     void output_periodic_info(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch);
+    // Structured output (see stats_writer.h): the counters of one epoch as fields of the current record,
+    // and the full-run totals and windowed records.
+    void write_epoch_stats(stats_writer_t &w, const size_t epoch) const;
+    void write_summary(stats_writer_t &w, const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch) const;
+    // Sum epochs from the most recent backwards until more than target_instr_count instructions are covered.
+    bp_window_stats_t window_stats(const std::vector<uint64_t>&num_insts_per_epoch, const std::vector<uint64_t>&num_cycles_per_epoch, const uint64_t target_instr_count) const;
+    // Conditional branch counters since the start of simulation, including the current epoch (instr/cycles left 0).
+    bp_window_stats_t running_totals() const;
     void notify_begin_new_epoch();
+    // Parallel interval simulation (-par): keep only the current epoch (at an
+    // epoch boundary, i.e. drop the warmup's epochs), drop all epochs, append
+    // the first n epochs of another predictor's measurements.
+    void reset_epochs();
+    void clear_epochs();
+    void append_epochs(const bp_t &other, const size_t n);
+    // Conditional branch counters over epochs [first, last) (instr/cycles left 0).
+    bp_window_stats_t epoch_range_stats(const size_t first, const size_t last) const;
     void update_cycles_on_wrong_path(const uint64_t cycles_on_wrong_path);
 };
 
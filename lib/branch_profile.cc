@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include "stats_writer.h"
+#include "branch_profile.h"
+
+static const uint64_t BPROF_INITIAL_CAPACITY = 1 << 12;
+
+static bprof_entry_t bprof_empty_entry()
+{
+   bprof_entry_t e;
+   memset(&e, 0, sizeof(e));
+   e.pc = ~0ull;
+   return e;
+}
+
+branch_profile_t::branch_profile_t()
+   : table(BPROF_INITIAL_CAPACITY, bprof_empty_entry()), mask(BPROF_INITIAL_CAPACITY - 1), used(0)
+{
+}
+
+void branch_profile_t::grow()
+{
+   std::vector<bprof_entry_t> old(2 * table.size(), bprof_empty_entry());
+   old.swap(table);
+   mask = table.size() - 1;
+   for (const bprof_entry_t &e : old) {
+      if (e.pc == EMPTY)
+         continue;
+      uint64_t i = hash(e.pc) & mask;
+      while (table[i].pc != EMPTY)
+         i = (i + 1) & mask;
+      table[i] = e;
+   }
+}
+
+// Occupied entries, most mispredicted first (ties by execution count, then PC).
+std::vector<bprof_entry_t> branch_profile_t::sorted() const
+{
+   std::vector<bprof_entry_t> v;
+   v.reserve(used);
+   for (const bprof_entry_t &e : table)
+      if (e.pc != EMPTY)
+         v.push_back(e);
+   std::sort(v.begin(), v.end(), [](const bprof_entry_t &a, const bprof_entry_t &b) {
+      if (a.mispred != b.mispred) return a.mispred > b.mispred;
+      if (a.execs != b.execs) return a.execs > b.execs;
+      return a.pc < b.pc;
+   });
+   return v;
+}
+
+static cond_provider_t bprof_main_provider(const bprof_entry_t &e)
+{
+   int best = 0;
+   for (int p = 1; p < NUM_PROVIDERS; p++)
+      if (e.provider[p] > e.provider[best])
+         best = p;
+   return (cond_provider_t)best;
+}
+
+void branch_profile_t::output(const uint64_t top_n, const uint64_t num_inst) const
+{
+   const std::vector<bprof_entry_t> v = sorted();
+   uint64_t total_misp = 0;
+   for (const bprof_entry_t &e : v)
+      total_misp += e.mispred;
+
+   printf("--------------------------------------------HARDEST CONDITIONAL BRANCHES (top %llu of %llu static branches)--------------------------------------------\n",
+          (unsigned long long)top_n, (unsigned long long)v.size());
+   printf("%4s %18s %12s %10s %8s %8s %8s %8s %8s %8s  %-12s %s\n", "Rank", "PC", "Execs", "Mispred", "MispRate", "Taken", "Transit",
+          "MPKI", "%Misp", "Cum%", "Provider", "Mispred by provider (bim/long/alt/loop/sc/other)");
+   uint64_t cum = 0;
+   for (uint64_t r = 0; r < top_n && r < v.size(); r++) {
+      const bprof_entry_t &e = v[r];
+      cum += e.mispred;
+      printf("%4llu 0x%016llx %12llu %10llu %7.2f%% %7.2f%% %7.2f%% %8.4f %7.2f%% %7.2f%%  %-12s",
+             (unsigned long long)(r + 1), (unsigned long long)e.pc, (unsigned long long)e.execs, (unsigned long long)e.mispred,
+             100.0 * (double)e.mispred / (double)e.execs, 100.0 * (double)e.taken / (double)e.execs,
+             100.0 * (double)e.transitions / (double)e.execs,
+             num_inst ? 1000.0 * (double)e.mispred / (double)num_inst : 0.0,
+             total_misp ? 100.0 * (double)e.mispred / (double)total_misp : 0.0,
+             total_misp ? 100.0 * (double)cum / (double)total_misp : 0.0,
+             cond_provider_name(bprof_main_provider(e)));
+      for (int p = 0; p < NUM_PROVIDERS; p++)
+         printf("%s%llu", p ? "/" : " ", (unsigned long long)e.provider_mispred[p]);
+      printf("\n");
+   }
+   printf("---------------------------------------------------------------------------------------------------------------------------------------\n");
+}
+
+void branch_profile_t::write_stats(stats_writer_t &w, const uint64_t top_n) const
+{
+   const std::vector<bprof_entry_t> v = sorted();
+   for (uint64_t r = 0; r < top_n && r < v.size(); r++) {
+      const bprof_entry_t &e = v[r];
+      w.begin("bprof", r + 1);
+      w.field("pc", e.pc);
+      w.field("execs", e.execs);
+      w.field("mispred", e.mispred);
+      w.field("taken", e.taken);
+      w.field("transitions", e.transitions);
+      for (int p = 0; p < NUM_PROVIDERS; p++) {
+         const std::string name = std::string("mispred_") + cond_provider_name((cond_provider_t)p);
+         w.field(name.c_str(), e.provider_mispred[p]);
+      }
+      w.end();
+   }
+}
+
+bool branch_profile_t::dump(const char *path, const uint64_t num_inst) const
+{
+   FILE *f = fopen(path, "wb");
+   if (!f)
+      return false;
+   const std::vector<bprof_entry_t> v = sorted();
+   const uint32_t version = 1;
+   const uint32_t num_providers = NUM_PROVIDERS;
+   const uint64_t num_entries = v.size();
+   bool ok = (fwrite("CBPBPROF", 1, 8, f) == 8)
+          && (fwrite(&version, sizeof(version), 1, f) == 1)
+          && (fwrite(&num_providers, sizeof(num_providers), 1, f) == 1)
+          && (fwrite(&num_entries, sizeof(num_entries), 1, f) == 1)
+          && (fwrite(&num_inst, sizeof(num_inst), 1, f) == 1)
+          && (fwrite(v.data(), sizeof(bprof_entry_t), v.size(), f) == v.size());
+   ok = (fclose(f) == 0) && ok;
+   return ok;
+}
@@ -0,0 +1,89 @@
+#ifndef _BRANCH_PROFILE_H_
+#define _BRANCH_PROFILE_H_
+
+#include <inttypes.h>
+#include <vector>
+#include "predictor_type.h"
+
+class stats_writer_t;
+
+// Per-static-branch conditional branch profile (-bprof / -bprof-dump).
+//
+// bp_t::predict() records every conditional branch into an open-addressing
+// hash table keyed by PC (linear probing, power-of-two capacity, grown at
+// half load). At the end of the run the branches with the most
+// mispredictions are printed, and the whole table can be dumped to a
+// binary file for offline analysis:
+//
+//    header   char magic[8] = "CBPBPROF", uint32_t version = 1,
+//             uint32_t num_providers, uint64_t num_entries, uint64_t num_inst
+//    entries  num_entries x bprof_entry_t, sorted by mispredictions
+//
+// All fields are little-endian as written by the host.
+struct bprof_entry_t {
+   uint64_t pc;
+   uint64_t execs;
+   uint64_t mispred;
+   uint64_t taken;
+   uint64_t transitions;                 // outcome differs from the previous execution
+   uint64_t provider[NUM_PROVIDERS];     // predictions per providing component
+   uint64_t provider_mispred[NUM_PROVIDERS];
+   uint8_t last_taken;
+   uint8_t pad[7];
+};
+
+class branch_profile_t {
+public:
+   branch_profile_t();
+
+   inline void record(const uint64_t pc, const bool taken, const bool misp, const cond_provider_t provider)
+   {
+      bprof_entry_t &e = lookup(pc);
+      e.transitions += (e.execs != 0) && (e.last_taken != taken);
+      e.last_taken = taken;
+      e.execs++;
+      e.mispred += misp;
+      e.taken += taken;
+      e.provider[provider]++;
+      e.provider_mispred[provider] += misp;
+   }
+
+   void output(const uint64_t top_n, const uint64_t num_inst) const;
+   void write_stats(stats_writer_t &w, const uint64_t top_n) const;
+   bool dump(const char *path, const uint64_t num_inst) const;
+
+private:
+   static constexpr uint64_t EMPTY = ~0ull;
+
+   inline bprof_entry_t &lookup(const uint64_t pc)
+   {
+      uint64_t i = hash(pc) & mask;
+      while (table[i].pc != pc) {
+         if (table[i].pc == EMPTY) {
+            if (2 * (used + 1) > table.size()) {
+               grow();
+               return lookup(pc);
+            }
+            used++;
+            table[i].pc = pc;
+            break;
+         }
+         i = (i + 1) & mask;
+      }
+      return table[i];
+   }
+
+   static inline uint64_t hash(const uint64_t pc)
+   {
+      return (pc >> 2) * 0x9E3779B97F4A7C15ull >> 20;
+   }
+
+   void grow();
+   std::vector<bprof_entry_t> sorted() const;
+
+   std::vector<bprof_entry_t> table;
+   uint64_t mask;
+   uint64_t used;
+};
+
+#endif
@@ -28,6 +28,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <stdio.h>
 #include "parameters.h"
 #include "cache.h"
+#include "stats_writer.h"
+#include "profiler.h"
 
 
 cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t latency, cache_t *next_level) {
@@ -57,12 +59,15 @@ cache_t::cache_t(uint64_t size, uint64_t assoc, uint64_t blocksize, uint64_t lat
 
    accesses = 0;
    misses = 0;
+   pf_accesses = 0;
+   pf_misses = 0;
 }
 
 cache_t::~cache_t() {
 }
 
 bool cache_t::is_hit(uint64_t cycle, uint64_t addr) const {
+   PROF_SCOPE(CACHE);
    uint64_t tag = TAG(addr);
    uint64_t index = INDEX(addr);
 
@@ -77,6 +82,7 @@ bool cache_t::is_hit(uint64_t cycle, uint64_t addr) const {
 }
 
 uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf) {
+   PROF_SCOPE(CACHE);
    uint64_t avail;      // return value: cycle that requested block is available
    uint64_t tag = TAG(addr);
    uint64_t index = INDEX(addr);
@@ -130,6 +136,32 @@ uint64_t cache_t::access(uint64_t cycle, bool read, uint64_t addr, bool pf) {
    return(avail);
 }
 
+void cache_t::warm(uint64_t addr) {
+   PROF_SCOPE(CACHE);
+   uint64_t tag = TAG(addr);
+   uint64_t index = INDEX(addr);
+   uint64_t max_lru_ctr = 0;
+   uint64_t victim_way = 0;
+
+   for (uint64_t way = 0; way < assoc; way++) {
+      if (C[index][way].valid && (C[index][way].tag == tag)) {
+         update_lru(index, way);
+         return;
+      }
+      else if (C[index][way].lru >= max_lru_ctr) {
+         max_lru_ctr = C[index][way].lru;
+         victim_way = way;
+      }
+   }
+
+   if (next_level)
+      next_level->warm(addr);
+   C[index][victim_way].valid = true;
+   C[index][victim_way].tag = tag;
+   C[index][victim_way].timestamp = 0;
+   update_lru(index, victim_way);
+}
+
 void cache_t::update_lru(uint64_t index, uint64_t mru_way) {
    for (uint64_t way = 0; way < assoc; way++) {
       if (C[index][way].lru < C[index][mru_way].lru) {
@@ -140,6 +172,26 @@ void cache_t::update_lru(uint64_t index, uint64_t mru_way) {
    C[index][mru_way].lru = 0;
 }
 
+void cache_t::reset_stats() {
+   accesses = pf_accesses = misses = pf_misses = 0;
+}
+
+void cache_t::add_stats(const cache_t &other) {
+   accesses += other.accesses;
+   pf_accesses += other.pf_accesses;
+   misses += other.misses;
+   pf_misses += other.pf_misses;
+}
+
+void cache_t::write_stats(stats_writer_t &w, const char *name) const {
+   w.begin(name, 0);
+   w.field("accesses", accesses);
+   w.field("misses", misses);
+   w.field("pf_accesses", pf_accesses);
+   w.field("pf_misses", pf_misses);
+   w.end();
+}
+
 void cache_t::stats() {
    printf("\taccesses   = %llu\n", (unsigned long long)accesses);
    printf("\tmisses     = %llu\n", (unsigned long long)misses);
@@ -35,6 +35,8 @@ struct block_t {
 #define TAG(addr)   ((addr) >> (num_index_bits + num_offset_bits))
 #define INDEX(addr) (((addr) >> num_offset_bits) & index_mask)
 
+class stats_writer_t;
+
 class cache_t {
 private:
     block_t **C;
@@ -62,5 +64,17 @@ public:
     ~cache_t();
     uint64_t access(uint64_t cycle, bool read, uint64_t addr, bool pf = false);
     bool is_hit(uint64_t cycle, uint64_t addr) const;
+    // Functional warming (-smarts): brings addr's block into this level and
+    // the levels below, as access() would, but as if it had arrived long
+    // ago and without counting the access.
+    void warm(uint64_t addr);
+    // Parallel interval simulation (-par): zero the measurements after
+    // warmup, add another cache's measurements into these.
+    void reset_stats();
+    void add_stats(const cache_t &other);
     void stats();
+    void write_stats(stats_writer_t &w, const char *name) const;
+    // Demand and prefetch counters, for differential checking (cbp-check).
+    uint64_t get_accesses() const { return accesses + pf_accesses; }
+    uint64_t get_misses() const { return misses + pf_misses; }
 };
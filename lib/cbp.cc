@@ -27,6 +27,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <inttypes.h>
 #include <assert.h>
 #include <string.h>
+#include <memory>
 #include "cbp.h"
 #include "trace_reader.h"
 #include "fifo.h"
@@ -37,6 +38,12 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "parameters.h"
 #include "../cond_branch_predictor_interface.h"
 #include "predictor_type.h"
+#include "simpoint.h"
+#include "smarts.h"
+#include "par_sim.h"
+#include "trace_shm.h"
+#include "result_cache.h"
+#include "../predictor_config.h"
 
 uarchsim_t *sim;
 
@@ -64,6 +71,8 @@ int parseargs(int argc, char ** argv)
         if (i < argc) {
             if (!strcmp(argv[i], "tage-sc-l")) {
                 predictor_type = PredictorType::PRED_TAGE_SC_L;
+            } else if (!strcmp(argv[i], "tage-sc-l-192kb")) {
+                predictor_type = PredictorType::PRED_TAGE_SC_L_192KB;
             } else if (!strcmp(argv[i], "onebit")) {
                 predictor_type = PredictorType::PRED_ONEBIT;
             } else if (!strcmp(argv[i], "twobit")) {
@@ -87,12 +96,12 @@ int parseargs(int argc, char ** argv)
             } else if (!strcmp(argv[i], "perceptron")) {
                 predictor_type = PredictorType::PRED_PERCEPTRON;
             } else {
-                printf("Unknown predictor type: %s. Use 'tage-sc-l', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', or 'perceptron'.\n", argv[i]);
+                printf("Unknown predictor type: %s. Use 'tage-sc-l', 'tage-sc-l-192kb', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', or 'perceptron'.\n", argv[i]);
                 exit(1);
             }
             i++;
         } else {
-            printf("Usage: -pred <tage-sc-l|tage|onebit|twobit|correlating|local|gshare|tournament|perceptron>\n");
+            printf("Usage: -pred <tage-sc-l|tage-sc-l-192kb|tage|onebit|twobit|correlating|local|gshare|tournament|perceptron>\n");
             exit(1);
         }
      }
@@ -106,6 +115,239 @@ int parseargs(int argc, char ** argv)
         PREFETCHER_ENABLE = true;
         i++;
      }
+     else if (!strcmp(argv[i], "-noP"))
+     {
+        PREFETCHER_ENABLE = false;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-prof"))
+     {
+        PROFILE_ENABLE = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-perf"))
+     {
+        PERF_ENABLE = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-bprof"))
+     {
+        i++;
+        if (i < argc)
+        {
+           BPROF_TOP = atoi(argv[i]);
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: -bprof <n> (report the n most mispredicted conditional branches).\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-bprof-dump"))
+     {
+        i++;
+        if (i < argc)
+        {
+           BPROF_DUMP = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing file name: -bprof-dump <file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-simpoint-gen"))
+     {
+        i++;
+        if (i < argc)
+        {
+           SIMPOINT_GEN = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing file name: -simpoint-gen <file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-simpoint"))
+     {
+        i++;
+        if (i < argc)
+        {
+           SIMPOINT_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing file name: -simpoint <file>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-simpoint-interval") || !strcmp(argv[i], "-simpoint-warmup") || !strcmp(argv[i], "-simpoint-maxk"))
+     {
+        const char *flag = argv[i];
+        i++;
+        unsigned long long n;
+        if (i < argc && sscanf(argv[i], "%llu", &n) == 1)
+        {
+           if (!strcmp(flag, "-simpoint-interval"))
+              SIMPOINT_INTERVAL = n;
+           else if (!strcmp(flag, "-simpoint-warmup"))
+              SIMPOINT_WARMUP = n;
+           else
+              SIMPOINT_MAXK = n;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: %s <n>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-par") || !strcmp(argv[i], "-par-j") || !strcmp(argv[i], "-par-overlap"))
+     {
+        const char *flag = argv[i];
+        i++;
+        unsigned long long n;
+        if (i < argc && sscanf(argv[i], "%llu", &n) == 1)
+        {
+           if (!strcmp(flag, "-par"))
+              PAR_INTERVALS = n;
+           else if (!strcmp(flag, "-par-j"))
+              PAR_THREADS = n;
+           else
+              PAR_OVERLAP = n;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: %s <n>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-par-check"))
+     {
+        PAR_CHECK = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-trace-serve") || !strcmp(argv[i], "-trace-shm"))
+     {
+        const char *flag = argv[i];
+        i++;
+        if (i < argc)
+        {
+           if (!strcmp(flag, "-trace-serve"))
+              TRACE_SERVE = argv[i];
+           else
+              TRACE_SHM = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing name: %s <name>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-trace-serve-consumers") || !strcmp(argv[i], "-trace-serve-window"))
+     {
+        const char *flag = argv[i];
+        i++;
+        unsigned long long n;
+        if (i < argc && sscanf(argv[i], "%llu", &n) == 1)
+        {
+           if (!strcmp(flag, "-trace-serve-consumers"))
+              TRACE_SERVE_CONSUMERS = n;
+           else
+              TRACE_SERVE_WINDOW = n;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: %s <n>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-cache"))
+     {
+        i++;
+        if (i < argc)
+        {
+           CACHE_DIR = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing directory: -cache <dir>.\n");
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-cache-force"))
+     {
+        CACHE_FORCE = true;
+        i++;
+     }
+     else if (!strcmp(argv[i], "-cache-max-mb") || !strcmp(argv[i], "-cache-max-age"))
+     {
+        const char *flag = argv[i];
+        i++;
+        unsigned long long n;
+        if (i < argc && sscanf(argv[i], "%llu", &n) == 1)
+        {
+           if (!strcmp(flag, "-cache-max-mb"))
+              CACHE_MAX_MB = n;
+           else
+              CACHE_MAX_AGE = n;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: %s <n>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-smarts") || !strcmp(argv[i], "-smarts-window") || !strcmp(argv[i], "-smarts-detail-warmup") || !strcmp(argv[i], "-smarts-warmup"))
+     {
+        const char *flag = argv[i];
+        i++;
+        unsigned long long n;
+        if (i < argc && sscanf(argv[i], "%llu", &n) == 1)
+        {
+           if (!strcmp(flag, "-smarts"))
+              SMARTS_PERIOD = n;
+           else if (!strcmp(flag, "-smarts-window"))
+              SMARTS_WINDOW = n;
+           else if (!strcmp(flag, "-smarts-detail-warmup"))
+              SMARTS_DETAIL_WARMUP = n;
+           else
+              SMARTS_WARMUP = n;
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing count: %s <n>.\n", flag);
+           exit(0);
+        }
+     }
+     else if (!strcmp(argv[i], "-R"))
+     {
+        i++;
+        char *end = NULL;
+        if (i < argc)
+           RPT_ASSOC = strtoull(argv[i], &end, 10);
+        if ((i < argc) && (end != argv[i]) && (*end == '\0') && (argv[i][0] != '-') && rpt_assoc_valid(RPT_ASSOC))
+        {
+           i++;
+        }
+        else
+        {
+           printf("Usage: -R <rpt_assoc>: 0 (fully associative) or a divisor of the %" PRIu64 "-entry RPT that leaves a power-of-two number of sets (1, 2, 4, ..., %" PRIu64 ").\n",
+                  NUM_RPT_ENTRIES, NUM_RPT_ENTRIES);
+           exit(0);
+        }
+     }
      //else if (!strcmp(argv[i], "-f"))
      //{
      //   i++;
@@ -270,6 +512,20 @@ int parseargs(int argc, char ** argv)
            exit(0);
         }
      }
+     else if (!strcmp(argv[i], "-stats"))
+     {
+        i++;
+        if (i < argc)
+        {
+           STATS_FILE = argv[i];
+           i++;
+        }
+        else
+        {
+           printf("Usage: missing stats file: -stats <file.jsonl|file.csv>\n");
+           exit(0);
+        }
+     }
      else if (!strcmp(argv[i], "-w"))
      {
         i++;
@@ -291,31 +547,321 @@ int parseargs(int argc, char ** argv)
   }
 
    select_predictor(predictor_type);
+   // The selection is per thread and per translation unit; -par passes this
+   // TU's copy on to its simulation threads.
+   set_selected_predictor(predictor_type);
 
-  if (i < argc) {
+  // With -trace-shm the trace comes from the broker; a trace name is optional.
+  if (i < argc || TRACE_SHM) {
      return(i);
   }
   else {
      printf("usage:\t%s\n"
             "\t[optional: -d to enable perfect data cache]\n"
             "\t[optional: -b to enable perfect branch prediction (all branch types)]\n"
-            "\t[optional: -P to enable stride prefetcher in L1D]\n"
-            "\t[optional: -pred <tage-sc-l|onebit|twobit|correlating|local|gshare> to select branch predictor]\n"
+            "\t[optional: -P to enable stride prefetcher in L1D (the default)]\n"
+            "\t[optional: -noP to disable the stride prefetcher]\n"
+            "\t[optional: -R <n> for an n-way set-associative prefetcher RPT (default 0: fully associative)]\n"
+            "\t[optional: -stats <file> to stream per-epoch and summary stats as JSON Lines (CSV if <file> ends in .csv)]\n"
+            "\t[optional: -prof to report per-stage simulator time and MIPS (build with make PROFILE=1)]\n"
+            "\t[optional: -perf to report host hardware counters (cycles, instructions, LLC/branch/dTLB misses) per phase]\n"
+            "\t[optional: -bprof <n> to report the n most mispredicted conditional branches with the TAGE-SC-L component that provided them]\n"
+            "\t[optional: -bprof-dump <file> to write the per-branch profile to a binary file (layout in lib/branch_profile.h)]\n"
+            "\t[optional: -simpoint-gen <file> to pick SimPoint simulation points (no timing simulation) and write them to <file>]\n"
+            "\t[optional: -simpoint-interval <n> instructions per SimPoint interval (default 10000000)]\n"
+            "\t[optional: -simpoint-maxk <n> largest number of SimPoint clusters (default 10)]\n"
+            "\t[optional: -simpoint <file> to simulate only the simulation points in <file> and report weighted IPC/MPKI]\n"
+            "\t[optional: -simpoint-warmup <n> detailed warmup instructions before each simulation point (default one interval)]\n"
+            "\t[optional: -smarts <n> to sample one detailed window every n instructions, with functional warming in between, and report IPC/MPKI with confidence intervals]\n"
+            "\t[optional: -smarts-window <n> measured instructions per SMARTS window (default 1000)]\n"
+            "\t[optional: -smarts-detail-warmup <n> detailed instructions before each SMARTS window (default 2000)]\n"
+            "\t[optional: -smarts-warmup <n> functional warming instructions before the detailed warmup; the rest of the period is skipped (default: no skipping)]\n"
+            "\t[optional: -par <k> to simulate the trace as k intervals on parallel threads and stitch their epochs into one report]\n"
+            "\t[optional: -par-j <n> threads for -par (default: hardware concurrency)]\n"
+            "\t[optional: -par-overlap <n> warmup instructions simulated before each -par interval, rounded up to epochs (default 1000000)]\n"
+            "\t[optional: -par-check to also simulate the trace sequentially and report the per-interval warmup error]\n"
+            "\t[optional: -trace-serve <name> to inflate the trace once into shared memory <name> for -trace-shm consumers (no simulation)]\n"
+            "\t[optional: -trace-serve-consumers <n> consumers the broker waits for before streaming (default 1)]\n"
+            "\t[optional: -trace-serve-window <n> ring bytes: how far the fastest consumer may run ahead of the slowest (default 67108864)]\n"
+            "\t[optional: -trace-shm <name> to read the trace from the broker <name> instead of the .gz file]\n"
+            "\t[optional: -cache <dir> to reuse the report of an identical earlier run (same binary, trace, predictor, PredictorConfig and parameters) and store new ones]\n"
+            "\t[optional: -cache-force to simulate even if -cache has the result, and replace it]\n"
+            "\t[optional: -cache-max-mb <n> evict the least recently used -cache entries beyond n MB (default: no limit)]\n"
+            "\t[optional: -cache-max-age <n> evict -cache entries unused for n days (default: keep)]\n"
+            "\t[optional: -pred <tage-sc-l|tage-sc-l-192kb|onebit|twobit|correlating|local|gshare> to select branch predictor]\n"
             "\t[REQUIRED: .gz trace file]\n", argv[0]);
      exit(0);
   }
 }
 
-int main(int argc, char ** argv)
+// -simpoint-gen: one functional pass collecting basic block vectors, then
+// clustering. Neither the simulator nor the predictor is involved.
+static int simpoint_generate(TraceReader &reader)
 {
-  int i = parseargs(argc, argv);
-  TraceReader reader(argv[i]);
+  if (SIMPOINT_INTERVAL == 0) {
+     printf("-simpoint-interval must be positive.\n");
+     exit(1);
+  }
+  bbv_collector_t bbv(SIMPOINT_INTERVAL);
+  uint64_t num_inst = 0;
+  while (reader.skip_instr()) {
+     bbv.add(reader.mInstr.mPc, is_br(reader.mInstr.mType));
+     num_inst++;
+  }
+
+  const simpoint_set_t s = simpoint_choose(bbv.vectors(), SIMPOINT_INTERVAL, (int)SIMPOINT_MAXK, 1);
+  if (s.points.empty()) {
+     printf("-simpoint-gen: the trace (%llu instructions) is shorter than one interval (%llu).\n",
+            (unsigned long long)num_inst, (unsigned long long)SIMPOINT_INTERVAL);
+     exit(1);
+  }
+  if (!simpoint_write(SIMPOINT_GEN, s)) {
+     printf("-simpoint-gen: cannot write %s.\n", SIMPOINT_GEN);
+     exit(1);
+  }
+  printf("SimPoint: %llu instructions, %llu intervals of %llu, k = %d -> %s\n",
+         (unsigned long long)num_inst, (unsigned long long)s.num_intervals, (unsigned long long)s.interval_size, s.k, SIMPOINT_GEN);
+  printf("%8s %12s %8s\n", "Cluster", "Interval", "Weight");
+  for (const simpoint_t &p : s.points)
+     printf("%8d %12llu %8.4f\n", p.cluster, (unsigned long long)p.interval, p.weight);
+  return 0;
+}
+
+struct simpoint_result_t {
+  simpoint_t point;
+  bp_window_stats_t stats;
+};
+
+// -simpoint: fast-forward (trace decode only) to each simulation point's
+// warmup, then simulate warmup and interval in detail; the interval's counters
+// are the difference of the simulator's running counters around it. The run
+// stops after the last point.
+static std::vector<simpoint_result_t> simpoint_simulate(TraceReader &reader, const simpoint_set_t &s, const uint64_t warmup)
+{
+  std::vector<simpoint_result_t> results;
+  uint64_t icount = 0;   // trace instructions consumed, detailed or skipped
+  for (const simpoint_t &p : s.points) {
+     const uint64_t begin = p.interval * s.interval_size;
+     const uint64_t end = begin + s.interval_size;
+     const uint64_t detail_begin = (begin > warmup) ? (begin - warmup) : 0;
+     while (icount < detail_begin && reader.skip_instr())
+        icount++;
+
+     bool started = false;
+     bp_window_stats_t start;
+     while (icount < end) {
+        if (!started && icount >= begin) {
+           start = sim->get_running_stats();
+           started = true;
+        }
+        db_t *inst = reader.get_inst();
+        if (inst == nullptr)
+           break;
+        sim->step(inst);
+        icount += inst->is_last_piece;
+        delete inst;
+     }
+     if (!started)
+        break;   // trace ended before this point
+     const bp_window_stats_t now = sim->get_running_stats();
+     simpoint_result_t r;
+     r.point = p;
+     r.stats.instr = now.instr - start.instr;
+     r.stats.cycles = now.cycles - start.cycles;
+     r.stats.br = now.br - start.br;
+     r.stats.mispred = now.mispred - start.mispred;
+     r.stats.cycles_on_wrong_path = now.cycles_on_wrong_path - start.cycles_on_wrong_path;
+     if (r.stats.instr && r.stats.cycles)
+        results.push_back(r);
+  }
+  return results;
+}
+
+// Per-point counters and the weighted whole-trace estimate: MPKI is the
+// weighted mean of the points' MPKI, IPC the inverse of their weighted CPI.
+// Weights are renormalized over the points actually simulated.
+static void simpoint_output(const simpoint_set_t &s, const uint64_t warmup, const std::vector<simpoint_result_t> &results)
+{
+  printf("\n------------------------------------------SIMPOINT ESTIMATE (%zu of %d points, interval %llu, warmup %llu)------------------------------------------\n",
+         results.size(), s.k, (unsigned long long)s.interval_size, (unsigned long long)warmup);
+  printf("%8s %10s %8s %12s %12s %8s %10s %10s %8s\n", "Cluster", "Interval", "Weight", "Instr", "Cycles", "IPC", "NumBr", "MispBr", "MPKI");
+  double wsum = 0.0;
+  for (const simpoint_result_t &r : results)
+     wsum += r.point.weight;
+  double cpi = 0.0, mpki = 0.0, mr = 0.0;
+  for (const simpoint_result_t &r : results) {
+     const bp_window_stats_t &w = r.stats;
+     const double weight = r.point.weight / wsum;
+     cpi += weight * (double)w.cycles / (double)w.instr;
+     mpki += weight * 1000.0 * (double)w.mispred / (double)w.instr;
+     mr += weight * (w.br ? 100.0 * (double)w.mispred / (double)w.br : 0.0);
+     printf("%8d %10llu %8.4f %12llu %12llu %8.4f %10llu %10llu %8.4f\n", r.point.cluster, (unsigned long long)r.point.interval, r.point.weight,
+            (unsigned long long)w.instr, (unsigned long long)w.cycles, (double)w.instr / (double)w.cycles,
+            (unsigned long long)w.br, (unsigned long long)w.mispred, 1000.0 * (double)w.mispred / (double)w.instr);
+  }
+  if (results.empty())
+     printf("no simulation point was reached (trace shorter than the simpoints file expects?)\n");
+  else
+     printf("Weighted:  IPC %.4f  MR %.4f%%  MPKI %.4f\n", 1.0 / cpi, mr, mpki);
+  printf("-------------------------------------------------------------------------------------------------------------------------------------\n");
+}
+
+struct smarts_result_t {
+  sample_stat_t cpi;
+  sample_stat_t mpki;
+  bp_window_stats_t measured;   // sum over the windows
+  uint64_t detailed = 0;        // instructions through step(), warmups included
+  uint64_t warmed = 0;          // instructions through warm()
+  uint64_t skipped = 0;         // instructions only decoded
+};
+
+// Feeds all pieces of the next n trace instructions to fn; false if the trace
+// ended first.
+template <class F>
+static bool smarts_run(TraceReader &reader, const uint64_t n, F fn)
+{
+  uint64_t done = 0;
+  while (done < n) {
+     db_t *inst = reader.get_inst();
+     if (inst == nullptr)
+        return false;
+     fn(inst);
+     done += inst->is_last_piece;
+     delete inst;
+  }
+  return true;
+}
+
+// -smarts: per period, skip / functional warming / detailed warmup / measured
+// window (see smarts.h). A window cut short by the end of the trace is dropped.
+static smarts_result_t smarts_simulate(TraceReader &reader)
+{
+  const uint64_t detail = SMARTS_DETAIL_WARMUP + SMARTS_WINDOW;
+  if (SMARTS_WINDOW == 0 || SMARTS_PERIOD <= detail) {
+     printf("-smarts: the period (%llu) must be larger than -smarts-detail-warmup + -smarts-window (%llu), and the window positive.\n",
+            (unsigned long long)SMARTS_PERIOD, (unsigned long long)detail);
+     exit(1);
+  }
+  const uint64_t warm = std::min(SMARTS_WARMUP, SMARTS_PERIOD - detail);
+  const uint64_t skip = SMARTS_PERIOD - detail - warm;
+
+  smarts_result_t r;
+  for (;;) {
+     uint64_t n = 0;
+     while (n < skip && reader.skip_instr())
+        n++;
+     r.skipped += n;
+     if (n < skip)
+        break;
+     if (!smarts_run(reader, warm, [](db_t *inst) { sim->warm(inst); }))
+        break;
+     r.warmed += warm;
+     if (!smarts_run(reader, SMARTS_DETAIL_WARMUP, [](db_t *inst) { sim->step(inst); }))
+        break;
+     r.detailed += SMARTS_DETAIL_WARMUP;
+
+     const bp_window_stats_t start = sim->get_running_stats();
+     if (!smarts_run(reader, SMARTS_WINDOW, [](db_t *inst) { sim->step(inst); }))
+        break;
+     r.detailed += SMARTS_WINDOW;
+     const bp_window_stats_t now = sim->get_running_stats();
+     bp_window_stats_t w;
+     w.instr = now.instr - start.instr;
+     w.cycles = now.cycles - start.cycles;
+     w.br = now.br - start.br;
+     w.mispred = now.mispred - start.mispred;
+     w.cycles_on_wrong_path = now.cycles_on_wrong_path - start.cycles_on_wrong_path;
+     r.cpi.add((double)w.cycles / (double)w.instr);
+     r.mpki.add(1000.0 * (double)w.mispred / (double)w.instr);
+     r.measured.instr += w.instr;
+     r.measured.cycles += w.cycles;
+     r.measured.br += w.br;
+     r.measured.mispred += w.mispred;
+     r.measured.cycles_on_wrong_path += w.cycles_on_wrong_path;
+  }
+  return r;
+}
+
+// Sample means with 95% confidence intervals; IPC is the inverse of the mean
+// CPI, so its interval is the inverse of CPI's.
+static void smarts_output(const smarts_result_t &r)
+{
+  const uint64_t warm = std::min(SMARTS_WARMUP, SMARTS_PERIOD - SMARTS_DETAIL_WARMUP - SMARTS_WINDOW);
+  printf("\n------------------------------------------SMARTS ESTIMATE (%llu windows of %llu, period %llu, detailed warmup %llu, functional warming %llu)------------------------------------------\n",
+         (unsigned long long)r.cpi.count(), (unsigned long long)SMARTS_WINDOW, (unsigned long long)SMARTS_PERIOD,
+         (unsigned long long)SMARTS_DETAIL_WARMUP, (unsigned long long)warm);
+  const uint64_t total = r.detailed + r.warmed + r.skipped;
+  printf("Instructions: %llu detailed (%.2f%%), %llu functionally warmed, %llu skipped\n",
+         (unsigned long long)r.detailed, total ? 100.0 * (double)r.detailed / (double)total : 0.0,
+         (unsigned long long)r.warmed, (unsigned long long)r.skipped);
+  if (r.cpi.count() == 0) {
+     printf("no window was completed (trace shorter than one period?)\n");
+  }
+  else {
+     const double cpi = r.cpi.mean(), cpi_h = r.cpi.half_width();
+     const double mpki = r.mpki.mean(), mpki_h = r.mpki.half_width();
+     printf("%-6s %10s %24s %10s %8s %14s\n", "", "Estimate", "95% CI", "+-rel", "CV", "n for +-3%");
+     if (r.cpi.count() >= SMARTS_MIN_CI_WINDOWS) {
+        printf("%-6s %10.4f   [%9.4f, %9.4f] %9.2f%% %8.4f %14llu\n", "IPC", 1.0 / cpi, 1.0 / (cpi + cpi_h),
+               (cpi > cpi_h) ? 1.0 / (cpi - cpi_h) : INFINITY, 100.0 * cpi_h / cpi, r.cpi.cv(), (unsigned long long)r.cpi.samples_for(0.03));
+        printf("%-6s %10.4f   [%9.4f, %9.4f] %9.2f%% %8.4f %14llu\n", "MPKI", mpki, std::max(0.0, mpki - mpki_h), mpki + mpki_h,
+               (mpki != 0.0) ? 100.0 * mpki_h / mpki : 0.0, r.mpki.cv(), (unsigned long long)r.mpki.samples_for(0.03));
+        printf("The confidence intervals cover sampling error only: the start of the trace (predictor and cache cold start) is never measured.\n");
+     }
+     else {
+        printf("%-6s %10.4f %24s %10s %8.4f %14llu\n", "IPC", 1.0 / cpi, "-", "-", r.cpi.cv(), (unsigned long long)r.cpi.samples_for(0.03));
+        printf("%-6s %10.4f %24s %10s %8.4f %14llu\n", "MPKI", mpki, "-", "-", r.mpki.cv(), (unsigned long long)r.mpki.samples_for(0.03));
+        printf("Warning: only %llu windows (fewer than %d); no confidence interval. Use a shorter period or a longer trace.\n",
+               (unsigned long long)r.cpi.count(), SMARTS_MIN_CI_WINDOWS);
+     }
+     printf("Windows total: %llu instr, %llu cycles, %llu cond br, %llu mispred\n",
+            (unsigned long long)r.measured.instr, (unsigned long long)r.measured.cycles,
+            (unsigned long long)r.measured.br, (unsigned long long)r.measured.mispred);
+  }
+  printf("-------------------------------------------------------------------------------------------------------------------------------------\n");
+}
+
+// Everything the report of a run on trace_name depends on (result_cache_t).
+static bool cache_material(const char *trace_name, std::string &material)
+{
+  std::string trace_id;
+  if (!result_cache_t::trace_id(trace_name, trace_id))
+     return false;
+  load_config_from_env();
+  material = "kind cbp-report\n";
+  material += "build " + result_cache_t::build_id() + "\n";
+  material += "trace " + trace_id + "\n";
+  material += "pred " + std::to_string((int)get_selected_predictor()) + "\n";
+  material += result_cache_t::config_string(g_predictor_config);
+  material += std::string("PRINT_PREDICTOR_CONFIG=") + (std::getenv("PRINT_PREDICTOR_CONFIG") ? "set" : "-") + "\n";
+  std::string simpoints;
+  if (SIMPOINT_FILE && result_cache_t::file_hash(SIMPOINT_FILE, simpoints))
+     material += "simpoints " + simpoints + "\n";
+  material += parameters_string();
+  return true;
+}
+
+static int simulate_trace(const char *trace_name)
+{
+  std::unique_ptr<TraceReader> trace(TRACE_SHM ? new TraceReader(new trace_shm_streambuf(TRACE_SHM), false) : new TraceReader(trace_name));
+  TraceReader &reader = *trace;
+
+  if (SIMPOINT_GEN)
+     return simpoint_generate(reader);
+
+  simpoint_set_t simpoints;
+  if (SIMPOINT_FILE && SMARTS_PERIOD) {
+     printf("-simpoint and -smarts cannot be combined.\n");
+     exit(1);
+  }
+  if (SIMPOINT_FILE && !simpoint_read(SIMPOINT_FILE, simpoints)) {
+     printf("-simpoint: cannot read simulation points from %s.\n", SIMPOINT_FILE);
+     exit(1);
+  }
 
   // Need to create simulator after parsing arguments (for global parameters).
   sim = new uarchsim_t;
  
-  // Get to next (optional) argument after trace filename.
-  i++;
   //if (i < argc)
   //   beginPredictor((argc - i), &(argv[i]));
   //else
@@ -327,6 +873,25 @@ int main(int argc, char ** argv)
   //   beginCondDirPredictor(0, (char **)NULL);
   beginCondDirPredictor();
 
+  if (SIMPOINT_FILE) {
+     const uint64_t warmup = (SIMPOINT_WARMUP == UINT64_MAX) ? simpoints.interval_size : SIMPOINT_WARMUP;
+     const std::vector<simpoint_result_t> results = simpoint_simulate(reader, simpoints, warmup);
+     endPredictor();
+     endCondDirPredictor();
+     sim->output();
+     simpoint_output(simpoints, warmup, results);
+     return 0;
+  }
+
+  if (SMARTS_PERIOD) {
+     const smarts_result_t r = smarts_simulate(reader);
+     endPredictor();
+     endCondDirPredictor();
+     sim->output();
+     smarts_output(r);
+     return 0;
+  }
+
   db_t *inst = reader.get_inst(); 
 
   //bool dump_activity = true;
@@ -356,4 +921,48 @@ int main(int argc, char ** argv)
   endPredictor();
   endCondDirPredictor();
   sim->output();
+  return 0;
+}
+
+int main(int argc, char ** argv)
+{
+  int i = parseargs(argc, argv);
+  if (TRACE_SERVE && TRACE_SHM) {
+     printf("-trace-serve and -trace-shm cannot be combined.\n");
+     exit(1);
+  }
+  if (TRACE_SERVE)
+     return trace_shm_serve(TRACE_SERVE, argv[i], TRACE_SERVE_CONSUMERS, TRACE_SERVE_WINDOW);
+
+  // Reports with side outputs or host timings are not cached.
+  std::unique_ptr<result_cache_t> cache;
+  std::string material;
+  if (CACHE_DIR) {
+     if (SIMPOINT_GEN || STATS_FILE || BPROF_DUMP || PROFILE_ENABLE || PERF_ENABLE || PAR_INTERVALS || TRACE_SHM)
+        fprintf(stderr, "Warning: -cache: runs with -simpoint-gen, -stats, -bprof-dump, -prof, -perf, -par or -trace-shm are not cached.\n");
+     else if (cache_material(argv[i], material)) {
+        cache.reset(new result_cache_t(CACHE_DIR, CACHE_FORCE, CACHE_MAX_MB << 20, CACHE_MAX_AGE));
+        std::string report;
+        if (cache->lookup(material, report)) {
+           fwrite(report.data(), 1, report.size(), stdout);
+           fprintf(stderr, "cbp: cached result from %s (-cache-force to simulate again)\n", CACHE_DIR);
+           return 0;
+        }
+     }
+  }
+
+  if (PAR_INTERVALS)
+     return par_simulate(argv[i], get_selected_predictor());
+  stdout_capture_t capture;
+  if (cache)
+     capture.begin();
+  const int ret = simulate_trace(argv[i]);
+  if (cache) {
+     const std::string report = capture.end();
+     if (ret == 0 && !report.empty()) {
+        cache->store(material, report);
+        cache->evict();
+     }
+  }
+  return ret;
 }
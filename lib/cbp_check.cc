@@ -0,0 +1,615 @@
+// cbp_check.cc
+// Differential checker: runs a reference simulation and a candidate
+// implementation of the same simulation in lockstep, compares the simulator
+// state (uarch_digest_t: predictions, cycle numbers, counters) after every
+// step, and stops at the first divergence with the trace position that
+// reproduces it.
+//
+// A variant names the reference/candidate pair. The pairs are the optimized
+// paths the simulator has next to a reference one: the decompressed
+// in-memory trace image against the streamed .gz; the rewritten TAGE-SC-L,
+// ITTAGE, simple predictors and stride prefetcher against their pre-rewrite
+// copies in reference/; and the simulator that skips the pipeline stages no
+// predictor hook consumes against one that models them all. The selftest
+// variant gives the candidate another predictor, to show that a divergence is
+// caught and reported.
+//
+// Each side runs on its own thread for the whole check (thread_local predictor
+// state, as in cbp-sweep) and steps a batch of instructions per round; the
+// main thread compares the two batches before releasing the next round.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cbp.h"
+#include "trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "uarchsim_all_hooks.h"
+#include "parameters.h"
+#include "../cond_branch_predictor_interface.h"
+#include "../predictor_config.h"
+#include "predictor_type.h"
+#include "../reference/reference_predictors.h"
+
+struct predictor_name_t {
+   const char *name;
+   PredictorType type;
+};
+
+static const predictor_name_t predictor_names[] = {
+   {"tage-sc-l",       PredictorType::PRED_TAGE_SC_L},
+   {"tage-sc-l-192kb", PredictorType::PRED_TAGE_SC_L_192KB},
+   {"tage",            PredictorType::PRED_TAGE},
+   {"onebit",          PredictorType::PRED_ONEBIT},
+   {"twobit",          PredictorType::PRED_TWOBIT},
+   {"correlating",     PredictorType::PRED_CORRELATING},
+   {"local",           PredictorType::PRED_LOCAL},
+   {"gshare",          PredictorType::PRED_GSHARE},
+   {"tournament",      PredictorType::PRED_TOURNAMENT},
+   {"perceptron",      PredictorType::PRED_PERCEPTRON},
+};
+
+// How one side of a check simulates.
+struct check_path_t {
+   const char *label;
+   bool from_image;        // reads the in-memory image, not the .gz
+   bool other_predictor;   // selftest: onebit in place of the checked predictor (twobit for onebit)
+   bool reference_tage;    // the pre-rewrite TAGE-SC-L in place of TageScL
+   bool reference_ittage;  // the pre-rewrite ITTAGE in place of lib/ittage.h
+   bool reference_simple;  // the pre-port simple predictor in place of the current one
+   bool reference_prefetcher;  // the pre-rewrite stride prefetcher in place of lib/stride_prefetcher.h
+   bool all_hooks;         // the simulator built with every CBP event consumed (CBP_EVENT_ALL)
+};
+
+struct check_variant_t {
+   const char *name;
+   check_path_t ref;
+   check_path_t cand;
+   bool expect_divergence;
+   bool predict_indirect;  // both sides predict indirect targets (PERFECT_INDIRECT_PRED off), so ITTAGE runs
+};
+
+static const check_variant_t variants[] = {
+   {"image",          {"gz stream",              false, false, false, false, false, false, false}, {"in-memory image",   true, false, false, false, false, false, false}, false, false},
+   {"tage-ref",       {"pre-rewrite TAGE",       true,  false, true,  false, false, false, false}, {"TageScL",           true, false, false, false, false, false, false}, false, false},
+   {"ittage-ref",     {"pre-rewrite ITTAGE",     true,  false, false, true,  false, false, false}, {"ITTAGE",            true, false, false, false, false, false, false}, false, true},
+   {"simple-ref",     {"pre-port predictor",     true,  false, false, false, true,  false, false}, {"current predictor", true, false, false, false, false, false, false}, false, false},
+   {"prefetcher-ref", {"pre-rewrite prefetcher", true,  false, false, false, false, true,  false}, {"StridePrefetcher",  true, false, false, false, false, false, false}, false, false},
+   {"all-hooks",      {"every event",            true,  false, false, false, false, false, true},  {"consumed events",   true, false, false, false, false, false, false}, false, false},
+   {"selftest",       {"checked predictor",      true,  false, false, false, false, false, false}, {"other predictor",   true, true,  false, false, false, false, false}, true,  false},
+};
+
+// tage-ref only applies to these; other predictors are skipped.
+static bool has_reference_tage(const PredictorType pred)
+{
+   return pred == PredictorType::PRED_TAGE_SC_L || pred == PredictorType::PRED_TAGE_SC_L_192KB;
+}
+
+// simple-ref only applies to these.
+static bool has_reference_simple(const PredictorType pred)
+{
+   return pred == PredictorType::PRED_ONEBIT || pred == PredictorType::PRED_TWOBIT || pred == PredictorType::PRED_CORRELATING ||
+          pred == PredictorType::PRED_LOCAL || pred == PredictorType::PRED_GSHARE || pred == PredictorType::PRED_TOURNAMENT ||
+          pred == PredictorType::PRED_PERCEPTRON;
+}
+
+// Simulator parameters of a check, as cbp's -d and -F set them: each mode
+// takes different paths through uarchsim_t::step(). (-b is left out: the predictors'
+// update() expects the prediction that perfect prediction skips.)
+struct uarch_mode_t {
+   const char *name;
+   bool *param;
+};
+
+static const uarch_mode_t uarch_modes[] = {
+   {"default",          nullptr},
+   {"icache",           &FETCH_MODEL_ICACHE},
+   {"perfect-cache",    &PERFECT_CACHE},
+   {"stop-at-indirect", &FETCH_STOP_AT_INDIRECT},
+   {"stop-at-taken",    &FETCH_STOP_AT_TAKEN},
+};
+
+static const char *digest_fields[] = {UARCH_DIGEST_FIELDS};
+static_assert(sizeof(uarch_digest_t) == sizeof(digest_fields) / sizeof(digest_fields[0]) * sizeof(uint64_t),
+              "UARCH_DIGEST_FIELDS must name every uarch_digest_t field");
+
+static const char *stats_fields[] = {"instr", "cycles", "br", "mispred", "cycles_on_wrong_path"};
+static_assert(sizeof(bp_window_stats_t) == sizeof(stats_fields) / sizeof(stats_fields[0]) * sizeof(uint64_t),
+              "stats_fields must name every bp_window_stats_t field");
+
+#define NO_OFFSET UINT64_MAX
+
+// The state after one step, and where the stepped instruction is in the trace.
+struct check_record_t {
+   uarch_digest_t digest;
+   uint64_t instr;         // trace instruction number, from 0
+   uint64_t offset;        // byte offset of that instruction in the image (NO_OFFSET for the .gz)
+};
+
+struct check_trace_t {
+   std::string path;
+   std::string image;
+   uint64_t num_instr = 0;
+};
+
+// One side of a running check. The main thread sets go (or stop); the side
+// steps one batch, sets ready and waits again.
+struct check_side_t {
+   const check_path_t *path;
+   PredictorType pred;
+   const check_trace_t *trace;
+   uint64_t max_instr;
+   size_t batch_size;
+
+   std::mutex m;
+   std::condition_variable cv;
+   bool go = false;
+   bool ready = false;
+   bool stop = false;
+
+   std::vector<check_record_t> batch;
+   bool ended = false;     // end of the trace or -max-instr reached
+   uarch_digest_t final_digest = {};
+   bp_window_stats_t final_stats;
+};
+
+// Steps sim through the trace one batch per round, as the main thread
+// releases them. SIM is uarchsim_t or all_hooks_sim_t.
+template <class SIM>
+static void simulate(check_side_t *side, TraceReader *reader, SIM *sim)
+{
+   beginCondDirPredictor();
+
+   uint64_t instr = 0;
+   bool at_boundary = true;
+   uint64_t offset = side->path->from_image ? 0 : NO_OFFSET;
+   for (;;)
+   {
+      {
+         std::unique_lock<std::mutex> lock(side->m);
+         side->cv.wait(lock, [side]() { return side->go || side->stop; });
+         if (side->stop)
+            break;
+         side->go = false;
+      }
+
+      side->batch.clear();
+      while (side->batch.size() < side->batch_size)
+      {
+         if (instr >= side->max_instr)
+         {
+            side->ended = true;
+            break;
+         }
+         // image_offset() is only defined between trace instructions.
+         if (side->path->from_image && at_boundary)
+            offset = reader->image_offset();
+         db_t *inst = reader->get_inst();
+         if (!inst)
+         {
+            side->ended = true;
+            break;
+         }
+         sim->step(inst);
+         side->batch.push_back({sim->digest(), instr, offset});
+         at_boundary = inst->is_last_piece;
+         instr += inst->is_last_piece;
+         delete inst;
+      }
+      if (side->ended)
+      {
+         sim->end_simulation();
+         side->final_digest = sim->digest();
+         side->final_stats = sim->get_conddir_stats(sim->get_num_inst());
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(side->m);
+         side->ready = true;
+      }
+      side->cv.notify_all();
+      if (side->ended)
+         break;
+   }
+
+   endPredictor();
+   endCondDirPredictor();
+}
+
+static void side_main(check_side_t *side)
+{
+   PredictorType pred = side->pred;
+   if (side->path->other_predictor)
+      pred = (pred == PredictorType::PRED_ONEBIT) ? PredictorType::PRED_TWOBIT : PredictorType::PRED_ONEBIT;
+   if (side->path->reference_tage)
+      pred = (pred == PredictorType::PRED_TAGE_SC_L) ? PredictorType::PRED_TAGE_SC_L_REF : PredictorType::PRED_TAGE_SC_L_192KB_REF;
+   select_predictor(pred);
+   select_reference_ittage(side->path->reference_ittage);
+   select_reference_simple(side->path->reference_simple);
+   select_reference_prefetcher(side->path->reference_prefetcher);
+   g_predictor_config = PredictorConfig();
+
+   TraceReader *reader = side->path->from_image ? new TraceReader(side->trace->image, true/*quiet*/)
+                                                : new TraceReader(side->trace->path.c_str());
+   reader->quiet = true;
+   if (side->path->all_hooks)
+   {
+      all_hooks_sim_t *sim = new_all_hooks_sim();
+      simulate(side, reader, sim);
+      delete sim;
+   }
+   else
+   {
+      uarchsim_t *sim = new uarchsim_t;
+      simulate(side, reader, sim);
+      delete sim;
+   }
+   delete reader;
+}
+
+static void release(check_side_t &side)
+{
+   {
+      std::lock_guard<std::mutex> lock(side.m);
+      side.go = true;
+   }
+   side.cv.notify_all();
+}
+
+static void wait_ready(check_side_t &side)
+{
+   std::unique_lock<std::mutex> lock(side.m);
+   side.cv.wait(lock, [&side]() { return side.ready; });
+   side.ready = false;
+}
+
+static void halt(check_side_t &side)
+{
+   {
+      std::lock_guard<std::mutex> lock(side.m);
+      side.stop = true;
+   }
+   side.cv.notify_all();
+}
+
+// Prints the fields where a and b differ; returns how many do.
+static unsigned print_differences(const char *const *names, const uint64_t *a, const uint64_t *b, const size_t n, const check_variant_t &v)
+{
+   unsigned differ = 0;
+   for (size_t f = 0; f < n; f++)
+   {
+      if (a[f] == b[f])
+         continue;
+      if (differ++ == 0)
+         printf("    %-22s %20s %20s\n", "field", v.ref.label, v.cand.label);
+      printf("    %-22s %20" PRIu64 " %20" PRIu64 "\n", names[f], a[f], b[f]);
+   }
+   return differ;
+}
+
+static void print_repro(const check_variant_t &v, const char *pred, const char *mode, const uint64_t max_instr, const check_trace_t &trace)
+{
+   printf("  repro: ./cbp-check -variant %s -pred %s -uarch %s -max-instr %" PRIu64 " %s\n",
+          v.name, pred, mode, max_instr, trace.path.c_str());
+}
+
+static bool same_digest(const uarch_digest_t &a, const uarch_digest_t &b)
+{
+   return memcmp(&a, &b, sizeof(uarch_digest_t)) == 0;
+}
+
+// Runs one check; returns true if the sides diverged, and prints where.
+static bool run_check(const check_variant_t &v, const predictor_name_t &pred, const uarch_mode_t &mode,
+                      const check_trace_t &trace, const uint64_t max_instr, const size_t batch_size, const bool verbose,
+                      uint64_t &steps)
+{
+   check_side_t ref, cand;
+   for (check_side_t *s : {&ref, &cand})
+   {
+      s->pred = pred.type;
+      s->trace = &trace;
+      s->max_instr = max_instr;
+      s->batch_size = batch_size;
+   }
+   ref.path = &v.ref;
+   cand.path = &v.cand;
+   std::thread ref_thread(side_main, &ref);
+   std::thread cand_thread(side_main, &cand);
+
+   bool diverged = false;
+   steps = 0;
+   for (;;)
+   {
+      release(ref);
+      release(cand);
+      wait_ready(ref);
+      wait_ready(cand);
+
+      const size_t n = std::min(ref.batch.size(), cand.batch.size());
+      size_t i = 0;
+      while (i < n && same_digest(ref.batch[i].digest, cand.batch[i].digest))
+         i++;
+      steps += i;
+      if (i < n || ref.batch.size() != cand.batch.size())
+      {
+         diverged = true;
+         if (verbose || !v.expect_divergence)
+         {
+            const bool at_end = (i == n);
+            const check_record_t &r = at_end ? (ref.batch.size() > n ? ref.batch[n] : cand.batch[n]) : ref.batch[i];
+            const uint64_t offset = (r.offset != NO_OFFSET) ? r.offset : (at_end ? NO_OFFSET : cand.batch[i].offset);
+            printf("DIVERGED %s %s %s %s\n", v.name, pred.name, mode.name, trace.path.c_str());
+            printf("  at step %" PRIu64 ": trace instruction %" PRIu64 " piece %" PRIu64 ", seq_no %" PRIu64 ", pc 0x%" PRIx64,
+                   steps, r.instr, r.digest.piece, r.digest.seq_no, r.digest.pc);
+            if (offset != NO_OFFSET)
+               printf(", image offset %" PRIu64, offset);
+            printf("\n");
+            if (at_end)
+               printf("  %s ended the trace first\n", (ref.batch.size() > n) ? v.cand.label : v.ref.label);
+            else
+               print_differences(digest_fields, (const uint64_t *)&ref.batch[i].digest, (const uint64_t *)&cand.batch[i].digest,
+                                 sizeof(digest_fields) / sizeof(digest_fields[0]), v);
+            print_repro(v, pred.name, mode.name, r.instr + 1, trace);
+         }
+         break;
+      }
+      if (ref.ended || cand.ended)
+      {
+         // Both ended at the same step: the drained end state and the
+         // reported stats must agree too.
+         if (!same_digest(ref.final_digest, cand.final_digest) ||
+             memcmp(&ref.final_stats, &cand.final_stats, sizeof(bp_window_stats_t)) != 0)
+         {
+            diverged = true;
+            if (verbose || !v.expect_divergence)
+            {
+               printf("DIVERGED %s %s %s %s\n", v.name, pred.name, mode.name, trace.path.c_str());
+               printf("  at the end of the simulation (%" PRIu64 " steps)\n", steps);
+               print_differences(digest_fields, (const uint64_t *)&ref.final_digest, (const uint64_t *)&cand.final_digest,
+                                 sizeof(digest_fields) / sizeof(digest_fields[0]), v);
+               print_differences(stats_fields, (const uint64_t *)&ref.final_stats, (const uint64_t *)&cand.final_stats,
+                                 sizeof(stats_fields) / sizeof(stats_fields[0]), v);
+               print_repro(v, pred.name, mode.name, max_instr, trace);
+            }
+         }
+         break;
+      }
+   }
+
+   // A side that has not ended is still waiting for its next round.
+   if (!ref.ended)
+      halt(ref);
+   if (!cand.ended)
+      halt(cand);
+   ref_thread.join();
+   cand_thread.join();
+   return diverged;
+}
+
+static std::vector<std::string> split(const std::string &s, const char sep)
+{
+   std::vector<std::string> parts;
+   size_t begin = 0, end;
+   while ((end = s.find(sep, begin)) != std::string::npos)
+   {
+      parts.push_back(s.substr(begin, end - begin));
+      begin = end + 1;
+   }
+   parts.push_back(s.substr(begin));
+   return parts;
+}
+
+static std::vector<check_trace_t> traces;
+
+static void collect_traces(const char *arg)
+{
+   namespace fs = std::filesystem;
+   const fs::path root(arg);
+   std::vector<fs::path> found;
+   if (!fs::is_directory(root))
+   {
+      found.push_back(root);
+   }
+   else
+   {
+      for (const fs::directory_entry &e : fs::recursive_directory_iterator(root))
+      {
+         const std::string name = e.path().filename().string();
+         if (e.is_regular_file() && name.size() >= 9 && name.compare(name.size() - 9, 9, "_trace.gz") == 0)
+            found.push_back(e.path());
+      }
+      std::sort(found.begin(), found.end());
+   }
+   for (const fs::path &p : found)
+   {
+      traces.emplace_back();
+      traces.back().path = p.string();
+   }
+}
+
+static void usage(const char *prog)
+{
+   printf("usage: %s [options] <trace.gz or directory>...\n"
+          "\t[optional: -variant <list> comma-separated reference/candidate pairs: image (.gz stream vs in-memory image),\n"
+          "\t           tage-ref (pre-rewrite TAGE-SC-L vs TageScL; tage-sc-l and tage-sc-l-192kb only),\n"
+          "\t           ittage-ref (pre-rewrite ITTAGE vs lib/ittage.h),\n"
+          "\t           simple-ref (pre-port onebit, twobit, correlating, local, gshare, tournament, perceptron; those only),\n"
+          "\t           prefetcher-ref (pre-rewrite stride prefetcher vs lib/stride_prefetcher.h),\n"
+          "\t           all-hooks (simulator with every CBP event consumed vs cbp.h's CBP_EVENTS_CONSUMED),\n"
+          "\t           selftest (another predictor, must diverge)\n"
+          "\t           (default: image)]\n"
+          "\t[optional: -pred <list> comma-separated predictors, as cbp's -pred (default: tage-sc-l)]\n"
+          "\t[optional: -uarch <list> comma-separated simulator modes: default, icache, perfect-cache,\n"
+          "\t           stop-at-indirect, stop-at-taken (default: default)]\n"
+          "\t[optional: -max-instr <n> instructions per trace (default: the whole trace)]\n"
+          "\t[optional: -batch <n> steps per lockstep round (default: 4096)]\n"
+          "\t[optional: -v report the selftest divergences too]\n"
+          "\t[REQUIRED: one or more .gz traces or directories searched for *_trace.gz]\n"
+          "Predictor environment overrides (e.g. GSHARE_TABLE_BITS=12) apply to both sides.\n"
+          "Exits with status 1 if a check diverged (or a selftest did not).\n", prog);
+   exit(0);
+}
+
+int main(int argc, char **argv)
+{
+   std::vector<const check_variant_t *> checked_variants;
+   std::vector<const predictor_name_t *> preds;
+   std::vector<const uarch_mode_t *> modes;
+   uint64_t max_instr = 0;
+   size_t batch_size = 4096;
+   bool verbose = false;
+
+   int i = 1;
+   while (i < argc && argv[i][0] == '-')
+   {
+      if (!strcmp(argv[i], "-variant") && i + 1 < argc)
+      {
+         for (const std::string &name : split(argv[i + 1], ','))
+         {
+            const check_variant_t *found = nullptr;
+            for (const check_variant_t &v : variants)
+               if (name == v.name)
+                  found = &v;
+            if (!found)
+            {
+               printf("cbp-check: unknown variant %s; -variant takes image, tage-ref, ittage-ref, simple-ref, prefetcher-ref, all-hooks or selftest.\n", name.c_str());
+               exit(1);
+            }
+            checked_variants.push_back(found);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-pred") && i + 1 < argc)
+      {
+         for (const std::string &name : split(argv[i + 1], ','))
+         {
+            const predictor_name_t *found = nullptr;
+            for (const predictor_name_t &p : predictor_names)
+               if (name == p.name)
+                  found = &p;
+            if (!found)
+            {
+               printf("cbp-check: unknown predictor %s\n", name.c_str());
+               exit(1);
+            }
+            preds.push_back(found);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-uarch") && i + 1 < argc)
+      {
+         for (const std::string &name : split(argv[i + 1], ','))
+         {
+            const uarch_mode_t *found = nullptr;
+            for (const uarch_mode_t &m : uarch_modes)
+               if (name == m.name)
+                  found = &m;
+            if (!found)
+            {
+               printf("cbp-check: unknown simulator mode %s\n", name.c_str());
+               exit(1);
+            }
+            modes.push_back(found);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-max-instr") && i + 1 < argc)
+      {
+         max_instr = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-batch") && i + 1 < argc)
+      {
+         batch_size = strtoull(argv[i + 1], NULL, 10);
+         if (batch_size == 0)
+         {
+            printf("cbp-check: -batch must be at least 1\n");
+            exit(1);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-v"))
+      {
+         verbose = true;
+         i++;
+      }
+      else
+      {
+         usage(argv[0]);
+      }
+   }
+   if (checked_variants.empty())
+      checked_variants = {&variants[0]};
+   if (preds.empty())
+      preds.push_back(&predictor_names[0]);
+   if (modes.empty())
+      modes.push_back(&uarch_modes[0]);
+
+   for (; i < argc; i++)
+      collect_traces(argv[i]);
+   if (traces.empty())
+      usage(argv[0]);
+   for (check_trace_t &t : traces)
+   {
+      if (!load_trace_image(t.path.c_str(), t.image))
+      {
+         printf("cbp-check: cannot read trace %s\n", t.path.c_str());
+         exit(1);
+      }
+      t.num_instr = build_trace_index(t.image, UINT64_MAX).num_instr;
+   }
+
+   unsigned failed = 0, checks = 0;
+   const bool perfect_indirect = PERFECT_INDIRECT_PRED;
+   for (const uarch_mode_t *mode : modes)
+   {
+      for (const uarch_mode_t &m : uarch_modes)
+         if (m.param)
+            *m.param = false;
+      if (mode->param)
+         *mode->param = true;
+      for (const check_trace_t &trace : traces)
+      {
+         const uint64_t limit = (max_instr == 0 || max_instr > trace.num_instr) ? trace.num_instr : max_instr;
+         for (const predictor_name_t *pred : preds)
+         {
+            for (const check_variant_t *v : checked_variants)
+            {
+               if (v->ref.reference_tage && !has_reference_tage(pred->type))
+                  continue;
+               if (v->ref.reference_simple && !has_reference_simple(pred->type))
+                  continue;
+               PERFECT_INDIRECT_PRED = v->predict_indirect ? false : perfect_indirect;
+               uint64_t steps;
+               const bool diverged = run_check(*v, *pred, *mode, trace, limit, batch_size, verbose, steps);
+               const bool ok = (diverged == v->expect_divergence);
+               checks++;
+               failed += !ok;
+               if (ok)
+                  printf("%-8s %-14s %-15s %-16s %s: %" PRIu64 " instructions, %" PRIu64 " steps%s\n", "PASS", v->name, pred->name,
+                         mode->name, trace.path.c_str(), limit, steps, v->expect_divergence ? " before the expected divergence" : "");
+               else if (!diverged)
+                  printf("%-8s %-14s %-15s %-16s %s: no divergence in %" PRIu64 " steps; the checker missed a difference\n", "FAIL",
+                         v->name, pred->name, mode->name, trace.path.c_str(), steps);
+               fflush(stdout);
+            }
+         }
+      }
+   }
+
+   printf("cbp-check: %u of %u checks passed\n", checks - failed, checks);
+   return failed ? 1 : 0;
+}
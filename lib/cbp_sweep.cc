@@ -0,0 +1,626 @@
+// cbp_sweep.cc
+// In-process sweep driver: runs a grid of traces x predictors x PredictorConfig
+// values on a work-stealing thread pool and writes the CSV/JSON directly,
+// replacing scripts/trace_exec_training_list.py's one-subprocess-per-run flow.
+//
+// Each trace is decompressed once into memory and shared by every run on it;
+// the image is freed when its last run finishes. Predictor and simulator state
+// is thread_local, and every run executes on a freshly spawned thread so it
+// starts from the same state a fresh ./cbp process would.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <ctype.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cbp.h"
+#include "trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "../cond_branch_predictor_interface.h"
+#include "../predictor_config.h"
+#include "predictor_type.h"
+#include "result_cache.h"
+
+struct predictor_name_t {
+   const char *name;
+   PredictorType type;
+};
+
+static const predictor_name_t predictor_names[] = {
+   {"tage-sc-l",       PredictorType::PRED_TAGE_SC_L},
+   {"tage-sc-l-192kb", PredictorType::PRED_TAGE_SC_L_192KB},
+   {"tage",            PredictorType::PRED_TAGE},
+   {"onebit",          PredictorType::PRED_ONEBIT},
+   {"twobit",          PredictorType::PRED_TWOBIT},
+   {"correlating",     PredictorType::PRED_CORRELATING},
+   {"local",           PredictorType::PRED_LOCAL},
+   {"gshare",          PredictorType::PRED_GSHARE},
+   {"tournament",      PredictorType::PRED_TOURNAMENT},
+   {"perceptron",      PredictorType::PRED_PERCEPTRON},
+};
+
+// A trace shared by all runs on it; the image is loaded by the first run to
+// need it and released by the last.
+struct sweep_trace_t {
+   std::string path;
+   std::string workload;
+   std::string run;
+   double size_mb = 0.0;
+   std::string id;   // result_cache_t::trace_id(), with -cache
+
+   std::mutex lock;
+   std::string image;
+   bool loaded = false;
+   bool load_failed = false;
+   uint64_t pending_runs = 0;
+};
+
+struct sweep_job_t {
+   size_t trace;
+   const predictor_name_t *pred;
+   PredictorConfig config;
+   uint64_t pinned;          // the -set fields, kept over the environment
+   std::string config_desc;
+};
+
+struct sweep_result_t {
+   bool pass = false;
+   bool cached = false;
+   double exec_time = 0.0;
+   double mips = 0.0;
+   unsigned worker = 0;
+   uint64_t num_inst = 0;
+   uint64_t num_cycles = 0;
+   bp_window_stats_t full;
+   bp_window_stats_t half;
+};
+
+struct sweep_worker_t {
+   std::mutex lock;
+   std::deque<size_t> jobs;
+
+   uint64_t runs = 0;
+   uint64_t instr = 0;
+   double busy_seconds = 0.0;
+};
+
+static std::deque<sweep_trace_t> traces;
+static std::vector<sweep_job_t> jobs;
+static std::vector<sweep_result_t> results;
+static std::vector<sweep_worker_t> workers;
+static result_cache_t *cache = NULL;
+
+static const predictor_name_t *find_predictor(const char *name)
+{
+   for (const predictor_name_t &p : predictor_names)
+      if (!strcmp(p.name, name))
+         return &p;
+   return NULL;
+}
+
+static std::vector<std::string> split(const std::string &s, char sep)
+{
+   std::vector<std::string> out;
+   size_t begin = 0;
+   while (true)
+   {
+      const size_t end = s.find(sep, begin);
+      out.push_back(s.substr(begin, end - begin));
+      if (end == std::string::npos)
+         break;
+      begin = end + 1;
+   }
+   return out;
+}
+
+// A config axis only applies to the predictor whose name prefixes it, e.g.
+// GSHARE_TABLE_BITS is swept for gshare and ignored for the others.
+static bool axis_applies(const char *field_name, const char *pred_name)
+{
+   for (; *pred_name; field_name++, pred_name++)
+      if (*field_name != toupper(*pred_name))
+         return false;
+   return *field_name == '_';
+}
+
+static void add_trace(const std::filesystem::path &p)
+{
+   traces.emplace_back();
+   sweep_trace_t &t = traces.back();
+   t.path = p.string();
+   // Same naming as trace_exec_training_list.py: traces/int/int_0_trace.gz -> int, int_0_trace
+   t.workload = p.parent_path().filename().string();
+   t.run = p.stem().string();
+   std::error_code ec;
+   t.size_mb = (double)std::filesystem::file_size(p, ec) / (1024.0 * 1024.0);
+}
+
+static void collect_traces(const char *arg)
+{
+   namespace fs = std::filesystem;
+   const fs::path root(arg);
+   if (!fs::is_directory(root))
+   {
+      add_trace(root);
+      return;
+   }
+
+   std::vector<fs::path> found;
+   for (const fs::directory_entry &e : fs::recursive_directory_iterator(root))
+   {
+      const std::string name = e.path().filename().string();
+      if (e.is_regular_file() && name.size() >= 9 && name.compare(name.size() - 9, 9, "_trace.gz") == 0)
+         found.push_back(e.path());
+   }
+   std::sort(found.begin(), found.end());
+   for (const fs::path &p : found)
+      add_trace(p);
+}
+
+// Simulate one job; called on a dedicated thread so thread_local predictor
+// state is freshly constructed.
+static void simulate(const sweep_job_t &job, const std::string &image, sweep_result_t &r)
+{
+   select_predictor(job.pred->type);
+   g_predictor_config = job.config;
+   g_predictor_config_pinned = job.pinned;
+
+   TraceReader reader(image, true/*quiet*/);
+   uarchsim_t *sim = new uarchsim_t;
+   beginCondDirPredictor();
+
+   db_t *inst = reader.get_inst();
+   while (inst != nullptr)
+   {
+      sim->step(inst);
+      delete inst;
+      inst = reader.get_inst();
+   }
+
+   endPredictor();
+   endCondDirPredictor();
+   sim->end_simulation();
+
+   r.num_inst = sim->get_num_inst();
+   r.num_cycles = sim->get_cycle();
+   // Matches the "Full Simulation" and "50 Perc instructions" tables of bp_t::output_periodic_info().
+   r.full = sim->get_conddir_stats(r.num_inst);
+   r.half = sim->get_conddir_stats(r.num_inst / 2);
+   delete sim;
+}
+
+// Everything a job's result depends on (result_cache_t). The config is the
+// job's with the environment overrides beginCondDirPredictor() applies.
+static std::string cache_material(const sweep_job_t &job, const sweep_trace_t &trace)
+{
+   g_predictor_config = job.config;
+   g_predictor_config_pinned = job.pinned;
+   load_config_from_env();
+   std::string material = "kind cbp-sweep\n";
+   material += "build " + result_cache_t::build_id() + "\n";
+   material += "trace " + trace.id + "\n";
+   material += std::string("pred ") + job.pred->name + "\n";
+   material += result_cache_t::config_string(g_predictor_config);
+   material += parameters_string();
+   return material;
+}
+
+static std::string cache_payload(const sweep_result_t &r)
+{
+   char s[512];
+   snprintf(s, sizeof(s), "num_inst %llu\nnum_cycles %llu\nexec_time %.6f\nmips %.6f\n"
+            "full %llu %llu %llu %llu %llu\nhalf %llu %llu %llu %llu %llu\n",
+            (unsigned long long)r.num_inst, (unsigned long long)r.num_cycles, r.exec_time, r.mips,
+            (unsigned long long)r.full.instr, (unsigned long long)r.full.cycles, (unsigned long long)r.full.br,
+            (unsigned long long)r.full.mispred, (unsigned long long)r.full.cycles_on_wrong_path,
+            (unsigned long long)r.half.instr, (unsigned long long)r.half.cycles, (unsigned long long)r.half.br,
+            (unsigned long long)r.half.mispred, (unsigned long long)r.half.cycles_on_wrong_path);
+   return s;
+}
+
+static bool parse_payload(const std::string &payload, sweep_result_t &r)
+{
+   unsigned long long v[12];
+   const int n = sscanf(payload.c_str(), "num_inst %llu num_cycles %llu exec_time %lf mips %lf "
+                        "full %llu %llu %llu %llu %llu half %llu %llu %llu %llu %llu",
+                        &v[0], &v[1], &r.exec_time, &r.mips, &v[2], &v[3], &v[4], &v[5], &v[6], &v[7], &v[8], &v[9], &v[10], &v[11]);
+   if (n != 14)
+      return false;
+   r.num_inst = v[0];
+   r.num_cycles = v[1];
+   r.full = {v[2], v[3], v[4], v[5], v[6]};
+   r.half = {v[7], v[8], v[9], v[10], v[11]};
+   return true;
+}
+
+static void run_job(unsigned worker_id, size_t job_index)
+{
+   const sweep_job_t &job = jobs[job_index];
+   sweep_trace_t &trace = traces[job.trace];
+   sweep_result_t &r = results[job_index];
+   r.worker = worker_id;
+
+   // A hit needs neither the trace image nor a simulation.
+   std::string material, payload;
+   if (cache && !trace.id.empty())
+   {
+      material = cache_material(job, trace);
+      r.cached = cache->lookup(material, payload) && parse_payload(payload, r);
+      r.pass = r.cached;
+   }
+
+   if (!r.cached)
+   {
+      std::lock_guard<std::mutex> guard(trace.lock);
+      if (!trace.loaded && !trace.load_failed)
+      {
+         trace.loaded = load_trace_image(trace.path.c_str(), trace.image);
+         trace.load_failed = !trace.loaded;
+         if (trace.load_failed)
+            fprintf(stderr, "cbp-sweep: cannot read trace %s\n", trace.path.c_str());
+      }
+   }
+
+   if (!r.cached && trace.loaded)
+   {
+      const auto begin = std::chrono::steady_clock::now();
+      std::thread sim_thread(simulate, std::cref(job), std::cref(trace.image), std::ref(r));
+      sim_thread.join();
+      const auto end = std::chrono::steady_clock::now();
+
+      r.pass = true;
+      r.exec_time = std::chrono::duration<double>(end - begin).count();
+      r.mips = (r.exec_time > 0.0) ? (double)r.num_inst / r.exec_time / 1e6 : 0.0;
+
+      sweep_worker_t &w = workers[worker_id];
+      w.runs++;
+      w.instr += r.num_inst;
+      w.busy_seconds += r.exec_time;
+
+      if (!material.empty())
+         cache->store(material, cache_payload(r));
+   }
+
+   {
+      std::lock_guard<std::mutex> guard(trace.lock);
+      if (--trace.pending_runs == 0)
+      {
+         trace.image.clear();
+         trace.image.shrink_to_fit();
+      }
+   }
+
+   fprintf(stderr, "[worker %u] %s %s %s %s: %s%s\n", worker_id, trace.workload.c_str(), trace.run.c_str(),
+           job.pred->name, job.config_desc.c_str(), r.pass ? "Pass" : "Fail", r.cached ? " (cached)" : "");
+}
+
+// Pop from the front of our own queue; when it is empty steal from the back
+// of another worker's queue.
+static bool next_job(unsigned worker_id, size_t &job_index)
+{
+   const unsigned n = workers.size();
+   for (unsigned k = 0; k < n; k++)
+   {
+      sweep_worker_t &victim = workers[(worker_id + k) % n];
+      std::lock_guard<std::mutex> guard(victim.lock);
+      if (victim.jobs.empty())
+         continue;
+      if (k == 0)
+      {
+         job_index = victim.jobs.front();
+         victim.jobs.pop_front();
+      }
+      else
+      {
+         job_index = victim.jobs.back();
+         victim.jobs.pop_back();
+      }
+      return true;
+   }
+   return false;
+}
+
+static void worker_main(unsigned worker_id)
+{
+   size_t job_index;
+   while (next_job(worker_id, job_index))
+      run_job(worker_id, job_index);
+}
+
+#define WINDOW_FIELDS(w) \
+   (unsigned long long)(w).instr, (unsigned long long)(w).cycles, (double)(w).instr/(double)(w).cycles, \
+   (unsigned long long)(w).br, (unsigned long long)(w).mispred, (double)(w).br/(double)(w).cycles, \
+   (double)(w).mispred/(double)(w).cycles, 100.0*((double)(w).mispred/(double)(w).br), \
+   1000.0*((double)(w).mispred/(double)(w).instr), (unsigned long long)(w).cycles_on_wrong_path, \
+   ((w).mispred == 0) ? 0.0 : (double)(w).cycles_on_wrong_path/(double)(w).mispred, \
+   (double)(w).cycles_on_wrong_path*1000/(double)(w).instr
+
+static void write_csv(FILE *f)
+{
+   fprintf(f, "Workload,Run,Predictor,Config,TraceSize,Status,ExecTime,Worker,MIPS,"
+              "Instr,Cycles,IPC,NumBr,MispBr,BrPerCyc,MispBrPerCyc,MR,MPKI,CycWP,CycWPAvg,CycWPPKI,"
+              "50PercInstr,50PercCycles,50PercIPC,50PercNumBr,50PercMispBr,50PercBrPerCyc,50PercMispBrPerCyc,"
+              "50PercMR,50PercMPKI,50PercCycWP,50PercCycWPAvg,50PercCycWPPKI\n");
+   for (size_t i = 0; i < jobs.size(); i++)
+   {
+      const sweep_job_t &job = jobs[i];
+      const sweep_trace_t &t = traces[job.trace];
+      const sweep_result_t &r = results[i];
+      fprintf(f, "%s,%s,%s,%s,%f,%s,%f,%u,%.4f", t.workload.c_str(), t.run.c_str(), job.pred->name,
+              job.config_desc.c_str(), t.size_mb, r.pass ? "Pass" : "Fail", r.exec_time, r.worker, r.mips);
+      if (r.pass)
+      {
+         fprintf(f, ",%llu,%llu,%.4f,%llu,%llu,%.4f,%.4f,%.4f%%,%.4f,%llu,%.4f,%.4f", WINDOW_FIELDS(r.full));
+         fprintf(f, ",%llu,%llu,%.4f,%llu,%llu,%.4f,%.4f,%.4f%%,%.4f,%llu,%.4f,%.4f\n", WINDOW_FIELDS(r.half));
+      }
+      else
+      {
+         fprintf(f, ",0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0\n");
+      }
+   }
+}
+
+static void write_json(FILE *f)
+{
+   fprintf(f, "[\n");
+   for (size_t i = 0; i < jobs.size(); i++)
+   {
+      const sweep_job_t &job = jobs[i];
+      const sweep_trace_t &t = traces[job.trace];
+      const sweep_result_t &r = results[i];
+      fprintf(f, "  {\"Workload\": \"%s\", \"Run\": \"%s\", \"Predictor\": \"%s\", \"Config\": \"%s\", "
+                 "\"TraceSize\": %f, \"Status\": \"%s\", \"ExecTime\": %f, \"Worker\": %u, \"MIPS\": %.4f",
+              t.workload.c_str(), t.run.c_str(), job.pred->name, job.config_desc.c_str(),
+              t.size_mb, r.pass ? "Pass" : "Fail", r.exec_time, r.worker, r.mips);
+      if (r.pass)
+      {
+         fprintf(f, ", \"Instr\": %llu, \"Cycles\": %llu, \"IPC\": %.4f, \"NumBr\": %llu, \"MispBr\": %llu, "
+                    "\"BrPerCyc\": %.4f, \"MispBrPerCyc\": %.4f, \"MR\": %.4f, \"MPKI\": %.4f, \"CycWP\": %llu, "
+                    "\"CycWPAvg\": %.4f, \"CycWPPKI\": %.4f", WINDOW_FIELDS(r.full));
+         fprintf(f, ", \"50PercInstr\": %llu, \"50PercCycles\": %llu, \"50PercIPC\": %.4f, \"50PercNumBr\": %llu, "
+                    "\"50PercMispBr\": %llu, \"50PercBrPerCyc\": %.4f, \"50PercMispBrPerCyc\": %.4f, \"50PercMR\": %.4f, "
+                    "\"50PercMPKI\": %.4f, \"50PercCycWP\": %llu, \"50PercCycWPAvg\": %.4f, \"50PercCycWPPKI\": %.4f",
+                 WINDOW_FIELDS(r.half));
+      }
+      fprintf(f, "}%s\n", (i + 1 < jobs.size()) ? "," : "");
+   }
+   fprintf(f, "]\n");
+}
+
+static void usage(const char *prog)
+{
+   printf("usage:\t%s\n"
+          "\t[optional: -j <n> worker threads (default: hardware concurrency)]\n"
+          "\t[optional: -pred <p1,p2,...> predictors (default: tage-sc-l); names as for ./cbp -pred]\n"
+          "\t[optional: -set <NAME=v1,v2,...> sweep a PredictorConfig field, e.g. GSHARE_TABLE_BITS=14,16 (repeatable)]\n"
+          "\t[optional: -o <file> CSV output (default: sweep.csv)]\n"
+          "\t[optional: -json <file> also write JSON]\n"
+          "\t[optional: -cache <dir> reuse results of identical earlier runs (same binary, trace, predictor, PredictorConfig and parameters) and store new ones]\n"
+          "\t[optional: -cache-force simulate every run and replace its -cache entry]\n"
+          "\t[optional: -cache-max-mb <n> evict the least recently used -cache entries beyond n MB (default: no limit)]\n"
+          "\t[optional: -cache-max-age <n> evict -cache entries unused for n days (default: keep)]\n"
+          "\t[REQUIRED: one or more .gz traces or directories searched for *_trace.gz]\n", prog);
+   exit(0);
+}
+
+int main(int argc, char **argv)
+{
+   unsigned num_workers = std::thread::hardware_concurrency();
+   std::vector<const predictor_name_t *> preds;
+   std::vector<std::pair<const PredictorConfigField *, std::vector<int>>> axes;
+   const char *csv_path = "sweep.csv";
+   const char *json_path = NULL;
+   const char *cache_dir = NULL;
+   bool cache_force = false;
+   uint64_t cache_max_mb = 0;
+   uint64_t cache_max_age = 0;
+
+   int i = 1;
+   while (i < argc && argv[i][0] == '-')
+   {
+      if (!strcmp(argv[i], "-j") && i + 1 < argc)
+      {
+         num_workers = atoi(argv[i + 1]);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-pred") && i + 1 < argc)
+      {
+         for (const std::string &name : split(argv[i + 1], ','))
+         {
+            const predictor_name_t *p = find_predictor(name.c_str());
+            if (!p)
+            {
+               printf("Unknown predictor type: %s\n", name.c_str());
+               exit(1);
+            }
+            preds.push_back(p);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-set") && i + 1 < argc)
+      {
+         const std::string spec = argv[i + 1];
+         const size_t eq = spec.find('=');
+         const PredictorConfigField *field = (eq == std::string::npos) ? NULL : find_config_field(spec.substr(0, eq));
+         if (!field)
+         {
+            printf("Usage: -set <NAME=v1,v2,...> where NAME is a PredictorConfig field, e.g. GSHARE_TABLE_BITS. Got: %s\n", spec.c_str());
+            exit(1);
+         }
+         std::vector<int> values;
+         for (const std::string &v : split(spec.substr(eq + 1), ','))
+            values.push_back(atoi(v.c_str()));
+         axes.emplace_back(field, values);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      {
+         csv_path = argv[i + 1];
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-json") && i + 1 < argc)
+      {
+         json_path = argv[i + 1];
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-cache") && i + 1 < argc)
+      {
+         cache_dir = argv[i + 1];
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-cache-force"))
+      {
+         cache_force = true;
+         i++;
+      }
+      else if (!strcmp(argv[i], "-cache-max-mb") && i + 1 < argc)
+      {
+         cache_max_mb = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-cache-max-age") && i + 1 < argc)
+      {
+         cache_max_age = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else
+      {
+         usage(argv[0]);
+      }
+   }
+   if (i == argc)
+      usage(argv[0]);
+   if (num_workers == 0)
+      num_workers = 1;
+   if (preds.empty())
+      preds.push_back(find_predictor("tage-sc-l"));
+   // Swept fields are pinned (g_predictor_config_pinned), so the
+   // environment only sets the fields that are not swept.
+   for (const auto &axis : axes)
+      if (getenv(axis.first->name))
+         fprintf(stderr, "Warning: %s is set in the environment; the -set values are used instead.\n", axis.first->name);
+
+   for (; i < argc; i++)
+      collect_traces(argv[i]);
+   if (traces.empty())
+   {
+      printf("cbp-sweep: no traces found\n");
+      exit(1);
+   }
+   if (cache_dir)
+   {
+      cache = new result_cache_t(cache_dir, cache_force, cache_max_mb << 20, cache_max_age);
+      // A trace that cannot be identified is simulated (and fails) as usual.
+      for (sweep_trace_t &t : traces)
+         if (!result_cache_t::trace_id(t.path.c_str(), t.id))
+            t.id.clear();
+   }
+
+   // Expand the grid. Axes that do not apply to a predictor are left at
+   // their defaults for it rather than multiplying identical runs.
+   for (size_t t = 0; t < traces.size(); t++)
+   {
+      for (const predictor_name_t *p : preds)
+      {
+         std::vector<std::pair<PredictorConfig, std::string>> grid(1);
+         uint64_t pinned = 0;
+         for (const auto &axis : axes)
+         {
+            if (!axis_applies(axis.first->name, p->name))
+               continue;
+            pinned |= config_field_bit(axis.first);
+            std::vector<std::pair<PredictorConfig, std::string>> next;
+            for (const auto &point : grid)
+            {
+               for (int v : axis.second)
+               {
+                  PredictorConfig c = point.first;
+                  c.*axis.first->member = v;
+                  std::string desc = point.second.empty() ? "" : point.second + ";";
+                  desc += std::string(axis.first->name) + "=" + std::to_string(v);
+                  next.emplace_back(c, desc);
+               }
+            }
+            grid.swap(next);
+         }
+         for (const auto &point : grid)
+            jobs.push_back({t, p, point.first, pinned, point.second.empty() ? "default" : point.second});
+      }
+   }
+   for (const sweep_job_t &job : jobs)
+      traces[job.trace].pending_runs++;
+   results.resize(jobs.size());
+
+   // Deal jobs round-robin so workers start on the same trace and share its image.
+   workers = std::vector<sweep_worker_t>(num_workers);
+   for (size_t j = 0; j < jobs.size(); j++)
+      workers[j % num_workers].jobs.push_back(j);
+
+   fprintf(stderr, "cbp-sweep: %zu runs (%zu traces) on %u workers\n", jobs.size(), traces.size(), num_workers);
+   const auto begin = std::chrono::steady_clock::now();
+   std::vector<std::thread> threads;
+   for (unsigned w = 0; w < num_workers; w++)
+      threads.emplace_back(worker_main, w);
+   for (std::thread &t : threads)
+      t.join();
+   const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+   FILE *csv = fopen(csv_path, "w");
+   if (!csv)
+   {
+      printf("cbp-sweep: cannot open %s\n", csv_path);
+      exit(1);
+   }
+   write_csv(csv);
+   fclose(csv);
+
+   if (json_path)
+   {
+      FILE *json = fopen(json_path, "w");
+      if (!json)
+      {
+         printf("cbp-sweep: cannot open %s\n", json_path);
+         exit(1);
+      }
+      write_json(json);
+      fclose(json);
+   }
+
+   // Throughput, for sizing batch machines.
+   uint64_t total_instr = 0;
+   fprintf(stderr, "Worker   Runs        Instr    BusySec     MIPS\n");
+   for (unsigned w = 0; w < num_workers; w++)
+   {
+      const sweep_worker_t &sw = workers[w];
+      total_instr += sw.instr;
+      fprintf(stderr, "%6u %6llu %12llu %10.2f %8.3f\n", w, (unsigned long long)sw.runs, (unsigned long long)sw.instr,
+              sw.busy_seconds, (sw.busy_seconds > 0.0) ? (double)sw.instr / sw.busy_seconds / 1e6 : 0.0);
+   }
+   fprintf(stderr, "Total  %6zu %12llu %10.2f %8.3f (wall)\n", jobs.size(), (unsigned long long)total_instr,
+           wall, (wall > 0.0) ? (double)total_instr / wall / 1e6 : 0.0);
+   if (cache)
+   {
+      const uint64_t evicted = cache->evict();
+      fprintf(stderr, "Cache %s: %llu hits, %llu simulated, %llu entries evicted\n", cache_dir,
+              (unsigned long long)cache->hits.load(), (unsigned long long)cache->misses.load(), (unsigned long long)evicted);
+   }
+
+   for (const sweep_result_t &r : results)
+      if (!r.pass)
+         return 1;
+   return 0;
+}
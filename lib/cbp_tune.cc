@@ -0,0 +1,619 @@
+// cbp_tune.cc
+// In-process predictor-configuration tuner: searches PredictorConfig ranges
+// of one predictor under a storage budget by successive halving, and reports
+// the Pareto frontier of MPKI versus storage bits.
+//
+// Every candidate is first simulated on a short prefix of each trace; the best
+// 1/eta of them (by Pareto rank on MPKI and storage, then MPKI; at least
+// -keep) are promoted to a prefix eta times longer, until the survivors run
+// the full length. Traces
+// are decompressed once and shared by every evaluation, and each evaluation
+// runs on a freshly spawned thread (thread_local predictor state, as in
+// cbp-sweep), so no process is ever spawned per candidate.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <ctype.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cbp.h"
+#include "trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "../cond_branch_predictor_interface.h"
+#include "../predictor_config.h"
+#include "../onebit_predictor.h"
+#include "../twobit_predictor.h"
+#include "../correlating_predictor.h"
+#include "../local_predictor.h"
+#include "../gshare_predictor.h"
+#include "../tournament_predictor.h"
+#include "../perceptron_predictor.h"
+#include "predictor_type.h"
+
+// Only predictors sized by PredictorConfig can be tuned.
+struct tunable_t {
+   const char *name;
+   PredictorType type;
+};
+
+static const tunable_t tunables[] = {
+   {"onebit",      PredictorType::PRED_ONEBIT},
+   {"twobit",      PredictorType::PRED_TWOBIT},
+   {"correlating", PredictorType::PRED_CORRELATING},
+   {"local",       PredictorType::PRED_LOCAL},
+   {"gshare",      PredictorType::PRED_GSHARE},
+   {"tournament",  PredictorType::PRED_TOURNAMENT},
+   {"perceptron",  PredictorType::PRED_PERCEPTRON},
+};
+
+#define UNBOUNDED_STORAGE UINT64_MAX
+
+// Storage of a configuration in bits, as the predictor counts its own tables
+// (saturating counters, histories, perceptron weights) once set up with it.
+// The infinite (alias-free) modes grow with the trace. Predictor state is
+// thread_local, so this sets up and tears down this thread's copy only.
+static uint64_t storage_bits(const PredictorType type, const PredictorConfig &c)
+{
+   uint64_t bits = UNBOUNDED_STORAGE;
+   switch (type)
+   {
+      case PredictorType::PRED_ONEBIT:
+         onebit_predictor_init(c.onebit_table_bits, c.onebit_infinite != 0);
+         bits = onebit_predictor_storage_bits();
+         onebit_predictor_cleanup();
+         break;
+      case PredictorType::PRED_TWOBIT:
+         twobit_predictor_init(c.twobit_table_bits, c.twobit_infinite != 0);
+         bits = twobit_predictor_storage_bits();
+         twobit_predictor_cleanup();
+         break;
+      case PredictorType::PRED_GSHARE:
+         gshare_predictor_init(c.gshare_table_bits, c.gshare_history_bits, c.gshare_infinite != 0);
+         bits = gshare_predictor_storage_bits();
+         gshare_predictor_cleanup();
+         break;
+      case PredictorType::PRED_CORRELATING:
+         correlating_predictor_init(c.correlating_pc_bits, c.correlating_history_bits, c.correlating_counter_bits);
+         bits = correlating_predictor_storage_bits();
+         correlating_predictor_cleanup();
+         break;
+      case PredictorType::PRED_LOCAL:
+         local_predictor_init(c.local_lht_bits, c.local_history_bits, c.local_pht_bits, c.local_infinite != 0);
+         bits = local_predictor_storage_bits();
+         local_predictor_cleanup();
+         break;
+      case PredictorType::PRED_TOURNAMENT:
+         tournament_predictor_init(c.tournament_selector_bits, c.tournament_bimodal_bits,
+                                   c.tournament_gshare_table_bits, c.tournament_gshare_history_bits);
+         bits = tournament_predictor_storage_bits();
+         tournament_predictor_cleanup();
+         break;
+      case PredictorType::PRED_PERCEPTRON:
+         perceptron_predictor_init(c.perceptron_table_bits, c.perceptron_history_length, c.perceptron_weight_bits,
+                                   c.perceptron_threshold, c.perceptron_infinite != 0);
+         bits = perceptron_predictor_storage_bits();
+         perceptron_predictor_cleanup();
+         break;
+      default:
+         break;
+   }
+   return bits;
+}
+
+struct tune_trace_t {
+   std::string path;
+   std::string image;
+   uint64_t num_instr = 0;
+};
+
+struct tune_candidate_t {
+   PredictorConfig config;
+   std::string config_desc;
+   uint64_t storage = 0;
+};
+
+// One candidate's result on one rung.
+struct tune_score_t {
+   size_t candidate;
+   uint64_t instr = 0;
+   uint64_t mispred = 0;
+   double mpki = 0.0;   // mean of the per-trace MPKIs
+   unsigned rank = 0;   // Pareto rank on (MPKI, storage) within the rung; 0 is the frontier
+};
+
+struct tune_rung_t {
+   uint64_t limit;      // instructions simulated per trace
+   std::vector<tune_score_t> scores;
+   double seconds = 0.0;
+};
+
+static const tunable_t *tuned = NULL;
+static std::vector<tune_trace_t> traces;
+static std::vector<tune_candidate_t> candidates;
+
+static std::vector<std::string> split(const std::string &s, char sep)
+{
+   std::vector<std::string> out;
+   size_t begin = 0;
+   while (true)
+   {
+      const size_t end = s.find(sep, begin);
+      out.push_back(s.substr(begin, end - begin));
+      if (end == std::string::npos)
+         break;
+      begin = end + 1;
+   }
+   return out;
+}
+
+// Same rule as cbp-sweep: GSHARE_TABLE_BITS belongs to gshare.
+static bool axis_applies(const char *field_name, const char *pred_name)
+{
+   for (; *pred_name; field_name++, pred_name++)
+      if (*field_name != toupper(*pred_name))
+         return false;
+   return *field_name == '_';
+}
+
+// "v1,v2,..." or "lo:hi[:step]".
+static bool parse_values(const std::string &spec, std::vector<int> &values)
+{
+   if (spec.find(':') != std::string::npos)
+   {
+      const std::vector<std::string> parts = split(spec, ':');
+      if (parts.size() < 2 || parts.size() > 3)
+         return false;
+      const int lo = atoi(parts[0].c_str());
+      const int hi = atoi(parts[1].c_str());
+      const int step = (parts.size() == 3) ? atoi(parts[2].c_str()) : 1;
+      if (step <= 0 || hi < lo)
+         return false;
+      for (int v = lo; v <= hi; v += step)
+         values.push_back(v);
+      return true;
+   }
+   for (const std::string &v : split(spec, ','))
+      values.push_back(atoi(v.c_str()));
+   return !values.empty();
+}
+
+static void collect_traces(const char *arg)
+{
+   namespace fs = std::filesystem;
+   const fs::path root(arg);
+   std::vector<fs::path> found;
+   if (!fs::is_directory(root))
+   {
+      found.push_back(root);
+   }
+   else
+   {
+      for (const fs::directory_entry &e : fs::recursive_directory_iterator(root))
+      {
+         const std::string name = e.path().filename().string();
+         if (e.is_regular_file() && name.size() >= 9 && name.compare(name.size() - 9, 9, "_trace.gz") == 0)
+            found.push_back(e.path());
+      }
+      std::sort(found.begin(), found.end());
+   }
+   for (const fs::path &p : found)
+   {
+      traces.emplace_back();
+      traces.back().path = p.string();
+   }
+}
+
+// Simulate the first `limit` instructions of a trace; called on a dedicated
+// thread so thread_local predictor state is freshly constructed.
+static void simulate(const tune_candidate_t &cand, const tune_trace_t &trace, const uint64_t limit, bp_window_stats_t &w)
+{
+   select_predictor(tuned->type);
+   g_predictor_config = cand.config;
+
+   TraceReader reader(trace.image, true/*quiet*/);
+   uarchsim_t *sim = new uarchsim_t;
+   beginCondDirPredictor();
+
+   uint64_t icount = 0;
+   db_t *inst;
+   while (icount < limit && (inst = reader.get_inst()) != nullptr)
+   {
+      sim->step(inst);
+      icount += inst->is_last_piece;
+      delete inst;
+   }
+
+   endPredictor();
+   endCondDirPredictor();
+   sim->end_simulation();
+   w = sim->get_conddir_stats(sim->get_num_inst());
+   delete sim;
+}
+
+// Evaluate the rung's candidates on every trace with num_workers workers.
+static void run_rung(tune_rung_t &rung, const unsigned num_workers)
+{
+   const size_t num_jobs = rung.scores.size() * traces.size();
+   std::vector<bp_window_stats_t> stats(num_jobs);
+   std::atomic<size_t> next{0};
+   auto worker = [&]() {
+      size_t j;
+      while ((j = next++) < num_jobs)
+      {
+         const tune_candidate_t &cand = candidates[rung.scores[j / traces.size()].candidate];
+         const tune_trace_t &trace = traces[j % traces.size()];
+         std::thread sim_thread(simulate, std::cref(cand), std::cref(trace), rung.limit, std::ref(stats[j]));
+         sim_thread.join();
+      }
+   };
+
+   const auto begin = std::chrono::steady_clock::now();
+   std::vector<std::thread> threads;
+   for (unsigned t = 0; t < std::min<size_t>(num_workers, num_jobs); t++)
+      threads.emplace_back(worker);
+   for (std::thread &t : threads)
+      t.join();
+   rung.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+   for (size_t c = 0; c < rung.scores.size(); c++)
+   {
+      tune_score_t &s = rung.scores[c];
+      double mpki_sum = 0.0;
+      for (size_t t = 0; t < traces.size(); t++)
+      {
+         const bp_window_stats_t &w = stats[c * traces.size() + t];
+         s.instr += w.instr;
+         s.mispred += w.mispred;
+         mpki_sum += (w.instr > 0) ? 1000.0 * (double)w.mispred / (double)w.instr : 0.0;
+      }
+      s.mpki = mpki_sum / (double)traces.size();
+   }
+}
+
+// Non-dominated sorting on (MPKI, storage), both minimized; then orders the
+// scores by rank and, within a rank, by MPKI.
+static void rank_scores(std::vector<tune_score_t> &scores)
+{
+   auto dominates = [](const tune_score_t &a, const tune_score_t &b) {
+      const uint64_t sa = candidates[a.candidate].storage, sb = candidates[b.candidate].storage;
+      return a.mpki <= b.mpki && sa <= sb && (a.mpki < b.mpki || sa < sb);
+   };
+   std::vector<bool> ranked(scores.size(), false);
+   size_t left = scores.size();
+   for (unsigned rank = 0; left > 0; rank++)
+   {
+      std::vector<size_t> front;
+      for (size_t i = 0; i < scores.size(); i++)
+      {
+         if (ranked[i])
+            continue;
+         bool dominated = false;
+         for (size_t j = 0; j < scores.size() && !dominated; j++)
+            dominated = !ranked[j] && j != i && dominates(scores[j], scores[i]);
+         if (!dominated)
+            front.push_back(i);
+      }
+      for (size_t i : front)
+      {
+         scores[i].rank = rank;
+         ranked[i] = true;
+      }
+      left -= front.size();
+   }
+   std::stable_sort(scores.begin(), scores.end(), [](const tune_score_t &a, const tune_score_t &b) {
+      return (a.rank != b.rank) ? a.rank < b.rank : a.mpki < b.mpki;
+   });
+}
+
+static std::string storage_string(const uint64_t bits)
+{
+   if (bits == UNBOUNDED_STORAGE)
+      return "unbounded";
+   char s[32];
+   snprintf(s, sizeof(s), "%.2f KB", (double)bits / 8192.0);
+   return s;
+}
+
+static void write_csv(FILE *f, const std::vector<tune_rung_t> &rungs)
+{
+   fprintf(f, "Rung,InstrPerTrace,Predictor,Config,StorageBits,Instr,MispBr,MPKI,Rank,Promoted\n");
+   for (size_t k = 0; k < rungs.size(); k++)
+   {
+      const tune_rung_t &rung = rungs[k];
+      const size_t promoted = (k + 1 < rungs.size()) ? rungs[k + 1].scores.size() : 0;
+      for (size_t i = 0; i < rung.scores.size(); i++)
+      {
+         const tune_score_t &s = rung.scores[i];
+         const tune_candidate_t &c = candidates[s.candidate];
+         fprintf(f, "%zu,%llu,%s,%s,", k, (unsigned long long)rung.limit, tuned->name, c.config_desc.c_str());
+         if (c.storage == UNBOUNDED_STORAGE)
+            fprintf(f, "inf");
+         else
+            fprintf(f, "%llu", (unsigned long long)c.storage);
+         fprintf(f, ",%llu,%llu,%.4f,%u,%d\n", (unsigned long long)s.instr, (unsigned long long)s.mispred, s.mpki, s.rank,
+                 i < promoted ? 1 : 0);
+      }
+   }
+}
+
+static void usage(const char *prog)
+{
+   printf("usage:\t%s\n"
+          "\t[REQUIRED: -pred <p> predictor to tune: onebit, twobit, correlating, local, gshare, tournament or perceptron]\n"
+          "\t[REQUIRED: -set <NAME=lo:hi[:step]> or <NAME=v1,v2,...> range of a PredictorConfig field of that predictor, e.g. GSHARE_TABLE_BITS=10:18 (repeatable)]\n"
+          "\t[optional: -budget-kb <n> drop candidates whose storage exceeds n KB (default: no budget)]\n"
+          "\t[optional: -n <n> evaluate at most n candidates, a random sample of the grid (default: the whole grid)]\n"
+          "\t[optional: -seed <n> seed of the -n sample (default: 1)]\n"
+          "\t[optional: -eta <n> keep 1/n of the candidates per rung, with n times longer prefixes (default: 3)]\n"
+          "\t[optional: -min-instr <n> instructions per trace on the first rung (default: 100000)]\n"
+          "\t[optional: -max-instr <n> instructions per trace on the last rung (default: the whole trace)]\n"
+          "\t[optional: -keep <n> promote at least n candidates per rung, so the last rung has a frontier to report (default: 8)]\n"
+          "\t[optional: -j <n> worker threads (default: hardware concurrency)]\n"
+          "\t[optional: -o <file> CSV of every evaluation (default: tune.csv)]\n"
+          "\t[REQUIRED: one or more .gz traces or directories searched for *_trace.gz]\n", prog);
+   exit(0);
+}
+
+int main(int argc, char **argv)
+{
+   unsigned num_workers = std::thread::hardware_concurrency();
+   std::vector<std::pair<const PredictorConfigField *, std::vector<int>>> axes;
+   double budget_kb = 0.0;
+   uint64_t max_candidates = 0;
+   uint64_t seed = 1;
+   uint64_t eta = 3;
+   uint64_t min_instr = 100000;
+   uint64_t max_instr = 0;
+   uint64_t min_keep = 8;
+   const char *csv_path = "tune.csv";
+
+   int i = 1;
+   while (i < argc && argv[i][0] == '-')
+   {
+      if (!strcmp(argv[i], "-pred") && i + 1 < argc)
+      {
+         for (const tunable_t &t : tunables)
+            if (!strcmp(t.name, argv[i + 1]))
+               tuned = &t;
+         if (!tuned)
+         {
+            printf("cbp-tune: cannot tune %s; -pred must be onebit, twobit, correlating, local, gshare, tournament or perceptron.\n", argv[i + 1]);
+            exit(1);
+         }
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-set") && i + 1 < argc)
+      {
+         const std::string spec = argv[i + 1];
+         const size_t eq = spec.find('=');
+         const PredictorConfigField *field = (eq == std::string::npos) ? NULL : find_config_field(spec.substr(0, eq));
+         std::vector<int> values;
+         if (!field || !parse_values(spec.substr(eq + 1), values))
+         {
+            printf("Usage: -set <NAME=lo:hi[:step]> or <NAME=v1,v2,...> where NAME is a PredictorConfig field, e.g. GSHARE_TABLE_BITS. Got: %s\n", spec.c_str());
+            exit(1);
+         }
+         axes.emplace_back(field, values);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-budget-kb") && i + 1 < argc)
+      {
+         budget_kb = atof(argv[i + 1]);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-n") && i + 1 < argc)
+      {
+         max_candidates = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-seed") && i + 1 < argc)
+      {
+         seed = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-eta") && i + 1 < argc)
+      {
+         eta = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-min-instr") && i + 1 < argc)
+      {
+         min_instr = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-max-instr") && i + 1 < argc)
+      {
+         max_instr = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-keep") && i + 1 < argc)
+      {
+         min_keep = strtoull(argv[i + 1], NULL, 10);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+      {
+         num_workers = atoi(argv[i + 1]);
+         i += 2;
+      }
+      else if (!strcmp(argv[i], "-o") && i + 1 < argc)
+      {
+         csv_path = argv[i + 1];
+         i += 2;
+      }
+      else
+      {
+         usage(argv[0]);
+      }
+   }
+   if (i == argc || !tuned || axes.empty())
+      usage(argv[0]);
+   if (eta < 2 || min_instr == 0 || min_keep == 0)
+   {
+      printf("cbp-tune: -eta must be at least 2, and -min-instr and -keep positive.\n");
+      exit(1);
+   }
+   if (num_workers == 0)
+      num_workers = 1;
+   for (const auto &axis : axes)
+   {
+      if (!axis_applies(axis.first->name, tuned->name))
+      {
+         printf("cbp-tune: %s is not a %s field.\n", axis.first->name, tuned->name);
+         exit(1);
+      }
+      // beginCondDirPredictor() applies the environment over the candidate.
+      if (getenv(axis.first->name))
+         fprintf(stderr, "Warning: %s is set in the environment and overrides the tuned values.\n", axis.first->name);
+   }
+
+   // The grid, minus the candidates over the budget, sampled down to -n.
+   std::vector<std::pair<PredictorConfig, std::string>> grid(1);
+   for (const auto &axis : axes)
+   {
+      std::vector<std::pair<PredictorConfig, std::string>> next;
+      for (const auto &point : grid)
+      {
+         for (int v : axis.second)
+         {
+            PredictorConfig c = point.first;
+            c.*axis.first->member = v;
+            std::string desc = point.second.empty() ? "" : point.second + ";";
+            desc += std::string(axis.first->name) + "=" + std::to_string(v);
+            next.emplace_back(c, desc);
+         }
+      }
+      grid.swap(next);
+   }
+   const uint64_t budget_bits = (uint64_t)(budget_kb * 8192.0);
+   size_t over_budget = 0;
+   for (const auto &point : grid)
+   {
+      const uint64_t bits = storage_bits(tuned->type, point.first);
+      if (budget_bits && bits > budget_bits)
+      {
+         over_budget++;
+         continue;
+      }
+      candidates.push_back({point.first, point.second, bits});
+   }
+   if (max_candidates && candidates.size() > max_candidates)
+   {
+      std::mt19937_64 rng(seed);
+      std::shuffle(candidates.begin(), candidates.end(), rng);
+      candidates.resize(max_candidates);
+   }
+   if (candidates.empty())
+   {
+      printf("cbp-tune: all %zu grid points exceed the %.2f KB budget.\n", grid.size(), budget_kb);
+      exit(1);
+   }
+
+   // Traces are decompressed once and kept for every rung.
+   for (; i < argc; i++)
+      collect_traces(argv[i]);
+   if (traces.empty())
+   {
+      printf("cbp-tune: no traces found\n");
+      exit(1);
+   }
+   uint64_t longest = 0;
+   for (tune_trace_t &t : traces)
+   {
+      if (!load_trace_image(t.path.c_str(), t.image))
+      {
+         printf("cbp-tune: cannot read trace %s\n", t.path.c_str());
+         exit(1);
+      }
+      t.num_instr = build_trace_index(t.image, UINT64_MAX).num_instr;
+      longest = std::max(longest, t.num_instr);
+   }
+   if (max_instr == 0 || max_instr > longest)
+      max_instr = longest;
+
+   // Prefix lengths min_instr * eta^k, then the full length (at least eta
+   // times the last prefix).
+   std::vector<tune_rung_t> rungs;
+   for (uint64_t limit = min_instr; limit * eta <= max_instr; limit *= eta)
+      rungs.push_back({limit, {}});
+   rungs.push_back({max_instr, {}});
+
+   printf("cbp-tune: %s, %zu candidates (%zu grid points, %zu over budget), %zu traces, eta %llu, %u workers\n", tuned->name,
+          candidates.size(), grid.size(), over_budget, traces.size(), (unsigned long long)eta, num_workers);
+   printf("%4s %10s %12s %10s %10s %12s  %s\n", "Rung", "Candidates", "Instr/trace", "Seconds", "BestMPKI", "Storage", "Config");
+
+   uint64_t simulated = 0;
+   for (size_t c = 0; c < candidates.size(); c++)
+      rungs[0].scores.push_back({c});
+   for (size_t k = 0; k < rungs.size(); k++)
+   {
+      tune_rung_t &rung = rungs[k];
+      run_rung(rung, num_workers);
+      rank_scores(rung.scores);
+      for (const tune_score_t &s : rung.scores)
+         simulated += s.instr;
+
+      const tune_score_t *best = &rung.scores[0];
+      for (const tune_score_t &s : rung.scores)
+         if (s.mpki < best->mpki)
+            best = &s;
+      printf("%4zu %10zu %12llu %10.2f %10.4f %12s  %s\n", k, rung.scores.size(), (unsigned long long)rung.limit, rung.seconds,
+             best->mpki, storage_string(candidates[best->candidate].storage).c_str(), candidates[best->candidate].config_desc.c_str());
+
+      if (k + 1 < rungs.size())
+      {
+         const size_t keep = std::min(rung.scores.size(), std::max<size_t>(min_keep, (rung.scores.size() + eta - 1) / eta));
+         rungs[k + 1].scores.assign(rung.scores.begin(), rung.scores.begin() + keep);
+         for (tune_score_t &s : rungs[k + 1].scores)
+            s = {s.candidate};
+      }
+   }
+
+   const tune_rung_t &last = rungs.back();
+   printf("\nPareto frontier of MPKI versus storage at %llu instructions per trace:\n", (unsigned long long)last.limit);
+   printf("%14s %12s %10s  %s\n", "StorageBits", "Storage", "MPKI", "Config");
+   std::vector<tune_score_t> frontier;
+   for (const tune_score_t &s : last.scores)
+      if (s.rank == 0)
+         frontier.push_back(s);
+   std::sort(frontier.begin(), frontier.end(), [](const tune_score_t &a, const tune_score_t &b) {
+      return candidates[a.candidate].storage < candidates[b.candidate].storage;
+   });
+   for (const tune_score_t &s : frontier)
+   {
+      const tune_candidate_t &c = candidates[s.candidate];
+      printf("%14s %12s %10.4f  %s\n", (c.storage == UNBOUNDED_STORAGE) ? "inf" : std::to_string(c.storage).c_str(),
+             storage_string(c.storage).c_str(), s.mpki, c.config_desc.c_str());
+   }
+
+   // Against simulating every candidate to the last rung's length.
+   uint64_t exhaustive = 0;
+   for (const tune_trace_t &t : traces)
+      exhaustive += std::min(t.num_instr, max_instr) * candidates.size();
+   printf("\nSimulated %llu instructions, %.1f%% of evaluating every candidate in full.\n", (unsigned long long)simulated,
+          exhaustive ? 100.0 * (double)simulated / (double)exhaustive : 0.0);
+
+   FILE *csv = fopen(csv_path, "w");
+   if (!csv)
+   {
+      printf("cbp-tune: cannot open %s\n", csv_path);
+      exit(1);
+   }
+   write_csv(csv, rungs);
+   fclose(csv);
+   return 0;
+}
@@ -47,51 +47,21 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.*/
 // Fast  implementation of the ITTAGE predictor: probably not optimal, but not
 // that far
 //
-// utility class for index computation
-// this is the cyclic shift register for folding
-// a long global history into a smaller number of bits; see P. Michaud's
-// PPM-like predictor at CBP-1
-class folded_history {
-public:
-  unsigned comp;
-  int CLENGTH;
-  int OLENGTH;
-  int OUTPOINT;
-
-  folded_history() {}
-
-  void init(int original_length, int compressed_length) {
-    comp = 0;
-    OLENGTH = original_length;
-    CLENGTH = compressed_length;
-    OUTPOINT = OLENGTH % CLENGTH;
-  }
-
-  void update(uint8_t *h, int PT) {
-    comp = (comp << 1) ^ h[PT & (HISTBUFFERLENGTH - 1)];
-    comp ^= h[(PT + OLENGTH) & (HISTBUFFERLENGTH - 1)] << OUTPOINT;
-    comp ^= (comp >> CLENGTH);
-    comp = (comp) & ((1 << CLENGTH) - 1);
-  }
-};
-
-class ientry // ITTAGE global table entry
-{
-public:
-  uint64_t target;
-  int8_t ctr;
-  uint tag;
-  int8_t u;
-
-  ientry() {
-    target = 0xdeadbeef;
-
-    ctr = 0;
-    u = 0;
-    tag = 0;
-  }
-};
-
+// Layout (predictions are identical to the original entry-per-struct code):
+//
+// - the tagged tables are stored as structure of arrays (tag, ctr, u and
+//   target each in their own [bank][index] array), so the tag probe of all
+//   banks only touches the 2-byte tags;
+// - GetPrediction() fills a pred_t with the indices, tags and matching banks,
+//   and UpdatePredictor() takes it back, instead of relying on member state
+//   left over from the last prediction;
+// - the history-dependent part of every index and tag is computed once per
+//   history update, so a prediction only mixes in the PC;
+// - the three history bits inserted per branch are folded into each
+//   compressed history in one step (see fold3());
+// - the periodic halving of the u counters is lazy: a reset only bumps
+//   u_epoch, and an entry applies the halvings it missed when it is next
+//   accessed (see u_at()).
 class IPREDICTOR {
 public:
 #define NHIST 8
@@ -106,35 +76,48 @@ public:
 #define UWIDTH 2      // u counter width on ITTAGE
 #define CWIDTH 3      // predictor counter width on the ITTAGE tagged tables
 
+  // Everything UpdatePredictor() needs from the matching GetPrediction()
+  struct pred_t {
+    int GI[NHIST + 1];      // index in each bank
+    uint16_t GTAG[NHIST + 1]; // tag in each bank
+    int HitBank;            // longest matching bank, -1 if none
+    int AltBank;            // alternate matching bank, -1 if none
+    uint64_t LongestMatchPred;
+    uint64_t alt_target;    // alternate  TAGEprediction
+    uint64_t tage_target;   // TAGE prediction
+  };
+
   // the counter to chose between longest match and alternate prediction on
   // ITTAGE when weak confidence counters
 
   int8_t use_alt_on_na;
-  long long GHIST;
 
   int TICK; // for the reset of the u counter
   uint8_t ghist[HISTBUFFERLENGTH];
   int ptghist;
-  long long phist;                   // path history
-  folded_history ch_i[NHIST + 1];    // utility for computing ITTAGE indices
-  folded_history ch_t[2][NHIST + 1]; // utility for computing ITTAGE tags
-
-  ientry *itable[NHIST + 1];
-  int m[NHIST + 1];
-  int TB[NHIST + 1];
-  int logg[NHIST + 1];
-
-  int GI[NHIST + 1]; // indexes to the different tables are computed only once
-  uint GTAG[NHIST + 1]; // tags for the different tables are computed only once
-  uint64_t pred_target; // prediction
-  uint64_t alt_target;  // alternate  TAGEprediction
-  uint64_t tage_target; // TAGE prediction
-
-  uint64_t LongestMatchPred;
-  int HitBank; // longest matching bank
-  int AltBank; // alternate matching bank
-  int Seed;    // for the pseudo-random number generator
-  uint64_t target_inter;
+  long long phist; // path history
+
+  // Compressed histories (cyclic shift registers folding the global history,
+  // see P. Michaud's PPM-like predictor at CBP-1): [0] for the index, [1] and
+  // [2] for the two halves of the tag. Bank 0 has no history.
+  unsigned comp[3][NHIST + 1];
+  int clength[3][NHIST + 1];
+  int outpoint[3][NHIST + 1];
+
+  int m[NHIST + 1]; // history length of each bank
+  int pc_shift[NHIST + 1];
+  int hist_index[NHIST + 1]; // history part of the index of each bank
+  unsigned hist_tag[NHIST + 1]; // history part of the tag of each bank
+
+  // Tagged tables
+  uint16_t tag[NHIST + 1][1 << LOGG];
+  int8_t ctr[NHIST + 1][1 << LOGG];
+  int8_t u[NHIST + 1][1 << LOGG];
+  uint8_t u_stamp[NHIST + 1][1 << LOGG]; // u_epoch when u was last brought up to date
+  uint64_t target[NHIST + 1][1 << LOGG];
+  uint8_t u_epoch; // number of u resets (mod 256, see age_u())
+
+  int Seed; // for the pseudo-random number generator
 
   IPREDICTOR(void) { reinit(); }
 
@@ -149,32 +132,32 @@ public:
     }
 
     for (int i = 0; i <= NHIST; i++) {
-      TB[i] = TBITS;
-      logg[i] = LOGG;
-    }
-
-    for (int i = 0; i <= NHIST; i++)
-      itable[i] = new ientry[(1 << LOGG)];
-
-    for (int i = 0; i <= NHIST; i++) {
-      ch_i[i].init(m[i], (logg[i]));
-      ch_t[0][i].init(ch_i[i].OLENGTH, TB[i]);
-      ch_t[1][i].init(ch_i[i].OLENGTH, TB[i] - 1);
+      const int width[3] = {LOGG, TBITS, TBITS - 1};
+      for (int k = 0; k < 3; k++) {
+        comp[k][i] = 0;
+        clength[k][i] = width[k];
+        outpoint[k][i] = m[i] % width[k];
+      }
+      pc_shift[i] = abs(LOGG - i) + 1;
+      for (int j = 0; j < (1 << LOGG); j++) {
+        tag[i][j] = 0;
+        ctr[i][j] = 0;
+        u[i][j] = 0;
+        u_stamp[i][j] = 0;
+        target[i][j] = 0xdeadbeef;
+      }
     }
+    u_epoch = 0;
 
     Seed = 0;
-
     TICK = 0;
     phist = 0;
-    Seed = 0;
 
     for (int i = 0; i < HISTBUFFERLENGTH; i++)
-      ghist[0] = 0;
+      ghist[i] = 0;
     ptghist = 0;
     use_alt_on_na = 0;
-    GHIST = 0;
-    ptghist = 0;
-    phist = 0;
+    update_hist_hash();
   }
 
   // F serves to mix path history: not very important impact
@@ -182,33 +165,58 @@ public:
   int F(long long A, int size, int bank) {
     int A1, A2;
     A = A & ((1 << size) - 1);
-    A1 = (A & ((1 << logg[bank]) - 1));
-    A2 = (A >> logg[bank]);
+    A1 = (A & ((1 << LOGG) - 1));
+    A2 = (A >> LOGG);
 
-    if (bank < logg[bank])
-      A2 = ((A2 << bank) & ((1 << logg[bank]) - 1)) +
-           (A2 >> (logg[bank] - bank));
+    if (bank < LOGG)
+      A2 = ((A2 << bank) & ((1 << LOGG) - 1)) + (A2 >> (LOGG - bank));
     A = A1 ^ A2;
-    if (bank < logg[bank])
-      A = ((A << bank) & ((1 << logg[bank]) - 1)) + (A >> (logg[bank] - bank));
+    if (bank < LOGG)
+      A = ((A << bank) & ((1 << LOGG) - 1)) + (A >> (LOGG - bank));
     return (A);
   }
 
-  // gindex computes a full hash of PC, ghist and phist
-  int gindex(unsigned int PC, int bank, long long hist, folded_history *ch_i) {
-    int index;
-    int M = (m[bank] > PHISTWIDTH) ? PHISTWIDTH : m[bank];
-    index = PC ^ (PC >> (abs(logg[bank] - bank) + 1)) ^ ch_i[bank].comp ^
-            F(hist, M, bank);
+  // The index of bank i is a hash of PC, the folded global history and the
+  // path history, and the tag one of PC and two folded histories; the
+  // history parts only change in HistoryUpdate().
+  void update_hist_hash() {
+    for (int i = 0; i <= NHIST; i++) {
+      int M = (m[i] > PHISTWIDTH) ? PHISTWIDTH : m[i];
+      hist_index[i] = comp[0][i] ^ F(phist, M, i);
+      hist_tag[i] = comp[1][i] ^ (comp[2][i] << 1);
+    }
+  }
 
-    return (index & ((1 << (logg[bank])) - 1));
+  int gindex(unsigned int PC, int bank) {
+    return (PC ^ (PC >> pc_shift[bank]) ^ hist_index[bank]) &
+           ((1 << LOGG) - 1);
   }
 
-  //  tag computation
-  uint16_t gtag(unsigned int PC, int bank, folded_history *ch0,
-                folded_history *ch1) {
-    int tag = (PC) ^ ch0[bank].comp ^ (ch1[bank].comp << 1);
-    return (tag & ((1 << (TB[bank])) - 1));
+  uint16_t gtag(unsigned int PC, int bank) {
+    return (PC ^ hist_tag[bank]) & ((1 << TBITS) - 1);
+  }
+
+  // u of an entry, first applying the halvings it missed since last accessed
+  int8_t &u_at(int bank, int index) {
+    const uint8_t missed = u_epoch - u_stamp[bank][index];
+    if (missed) {
+      u[bank][index] = (missed >= UWIDTH) ? 0 : (u[bank][index] >> missed);
+      u_stamp[bank][index] = u_epoch;
+    }
+    return u[bank][index];
+  }
+
+  // Halve every u counter (lazily). Before u_epoch wraps around, the pending
+  // halvings are applied to the whole table so the stamps can restart at 0.
+  void age_u() {
+    if (u_epoch == UINT8_MAX) {
+      for (int i = 0; i <= NHIST; i++)
+        for (int j = 0; j < (1 << LOGG); j++)
+          u_at(i, j);
+      memset(u_stamp, 0, sizeof(u_stamp));
+      u_epoch = 0;
+    }
+    u_epoch++;
   }
 
   // up-down saturating counter
@@ -235,96 +243,114 @@ public:
 
   //  ITTAGE PREDICTION: same code at fetch or retire time but the index and
   //  tags must recomputed
-  uint64_t GetPrediction(uint64_t PC) {
-    HitBank = -1;
-    AltBank = -1;
+  uint64_t GetPrediction(uint64_t PC, pred_t &p) {
+    // Probe every bank, then pick the two longest matches from the hit mask
+    unsigned hits = 0;
     for (int i = 0; i <= NHIST; i++) {
-      GI[i] = gindex(PC, i, phist, ch_i);
-      GTAG[i] = gtag(PC, i, ch_t[0], ch_t[1]);
+      p.GI[i] = gindex(PC, i);
+      p.GTAG[i] = gtag(PC, i);
+      hits |= (unsigned)(tag[i][p.GI[i]] == p.GTAG[i]) << i;
     }
 
-    alt_target = 0;
-    tage_target = 0;
-
-    LongestMatchPred = 0;
+    p.HitBank = -1;
+    p.AltBank = -1;
+    p.alt_target = 0;
+    p.tage_target = 0;
+    p.LongestMatchPred = 0;
 
     int AltConf = -4;
     int HitConf = -4;
-    // Look for the bank with longest matching history
-    for (int i = NHIST; i >= 0; i--) {
-      if (itable[i][GI[i]].tag == GTAG[i]) {
-        HitBank = i;
-        HitConf = itable[HitBank][GI[HitBank]].ctr;
-        LongestMatchPred = itable[HitBank][GI[HitBank]].target;
-        break;
+    if (hits) {
+      p.HitBank = 31 - __builtin_clz(hits);
+      HitConf = ctr[p.HitBank][p.GI[p.HitBank]];
+      p.LongestMatchPred = target[p.HitBank][p.GI[p.HitBank]];
+      hits &= ~(1u << p.HitBank);
+      if (hits) {
+        p.AltBank = 31 - __builtin_clz(hits);
+        AltConf = ctr[p.AltBank][p.GI[p.AltBank]];
+        p.alt_target = target[p.AltBank][p.GI[p.AltBank]];
       }
     }
 
-    // Look for the alternate bank
-    for (int i = HitBank - 1; i >= 0; i--) {
-      if (itable[i][GI[i]].tag == GTAG[i]) {
-        alt_target = itable[i][GI[i]].target;
-        AltBank = i;
-        AltConf = itable[AltBank][GI[AltBank]].ctr;
-        break;
-      }
-    }
     // computes the prediction and the alternate prediction
 
-    if (HitBank > 0) {
+    if (p.HitBank > 0) {
 
       bool Huse_alt_on_na = (use_alt_on_na >= 0);
       if ((!Huse_alt_on_na) || (HitConf > 0) || (HitConf >= AltConf))
-        tage_target = LongestMatchPred;
+        p.tage_target = p.LongestMatchPred;
       else
-        tage_target = alt_target;
+        p.tage_target = p.alt_target;
     }
-    if (AltBank < 0)
-      tage_target = LongestMatchPred;
+    if (p.AltBank < 0)
+      p.tage_target = p.LongestMatchPred;
 
-    return (tage_target);
+    return (p.tage_target);
   }
 
-  void HistoryUpdate(uint64_t PC, uint64_t target, long long &X, int &Y,
-                     folded_history *H, folded_history *G, folded_history *J) {
+  // Rotate a len-bit value left by n (n < len)
+  static unsigned rotl(unsigned x, int n, int len) {
+    return ((x << n) | (x >> (len - n))) & ((1u << len) - 1);
+  }
+
+  // Shifting three bits into a folded history one at a time is
+  // comp = rotl(comp, 1) ^ in ^ (out << OUTPOINT) three times; as every step
+  // is linear, the three steps collapse into one rotation by 3 plus the
+  // incoming bits (oldest first in bits 2..0) and the outgoing bits rotated
+  // to OUTPOINT.
+  static unsigned fold3(unsigned c, unsigned in3, unsigned out3, int len,
+                        int outpt) {
+    return rotl(c, 3, len) ^ in3 ^ rotl(out3, outpt, len);
+  }
+
+  void HistoryUpdate(uint64_t PC, uint64_t branchTarget) {
 
-    int maxt = 3;
     int T = (PC >> 2) ^ (PC >> 6);
-    int PATH = (target >> 2) ^ (target >> 6);
-
-    for (int t = 0; t < maxt; t++) {
-      bool DIR = (T & 1);
-      T >>= 1;
-      int PATHBIT = (PATH & 127);
-      PATH >>= 1;
-      // update  history
-      Y--;
-      ghist[Y & (HISTBUFFERLENGTH - 1)] = DIR;
-      X = (X << 1) ^ PATHBIT;
-
-      for (int i = 1; i <= NHIST; i++) {
-
-        H[i].update(ghist, Y);
-        G[i].update(ghist, Y);
-        J[i].update(ghist, Y);
-      }
+    int PATH = (branchTarget >> 2) ^ (branchTarget >> 6);
+
+    // update  history: three bits per branch
+    unsigned in3 = 0;
+    for (int t = 0; t < 3; t++) {
+      bool DIR = (T >> t) & 1;
+      int PATHBIT = (PATH >> t) & 127;
+      ptghist--;
+      ghist[ptghist & (HISTBUFFERLENGTH - 1)] = DIR;
+      phist = (phist << 1) ^ PATHBIT;
+      in3 = (in3 << 1) | DIR;
     }
-
-    X = (X & ((1 << PHISTWIDTH) - 1));
+    phist = (phist & ((1 << PHISTWIDTH) - 1));
+
+    // The bit leaving bank i's window at step t is ghist[Y_t + m[i]]; none of
+    // the bits written above are overwritten before being read, so the
+    // outgoing bits can be gathered after the writes.
+    for (int i = 1; i <= NHIST; i++) {
+      unsigned out3 = 0;
+      for (int t = 2; t >= 0; t--)
+        out3 = (out3 << 1) |
+               ghist[(ptghist + t + m[i]) & (HISTBUFFERLENGTH - 1)];
+      for (int k = 0; k < 3; k++)
+        comp[k][i] =
+            fold3(comp[k][i], in3, out3, clength[k][i], outpoint[k][i]);
+    }
+    update_hist_hash();
 
     // END UPDATE  HISTORIES
   }
 
   void TrackOtherInst(uint64_t PC, uint64_t branchTarget) {
 
-    HistoryUpdate(PC, branchTarget, phist, ptghist, ch_i, ch_t[0], ch_t[1]);
+    HistoryUpdate(PC, branchTarget);
   }
   // PREDICTOR UPDATE
 
-  void UpdatePredictor(uint64_t PC, uint64_t branchTarget) {
+  void UpdatePredictor(uint64_t PC, uint64_t branchTarget, const pred_t &p) {
+    const int HitBank = p.HitBank;
+    const int AltBank = p.AltBank;
+    const uint64_t LongestMatchPred = p.LongestMatchPred;
+    const uint64_t alt_target = p.alt_target;
 
     // TAGE UPDATE
-    bool ALLOC = ((tage_target != branchTarget) & (HitBank < NHIST));
+    bool ALLOC = ((p.tage_target != branchTarget) & (HitBank < NHIST));
 
     // do not allocate too often if the overall prediction is correct
 
@@ -334,7 +360,7 @@ public:
         // for "pseudo"-newly allocated longest matching entry
         // this is extremely important for TAGE only, not that important when
         // the overall predictor is implemented
-        bool PseudoNewAlloc = (itable[HitBank][GI[HitBank]].ctr <= 0);
+        bool PseudoNewAlloc = (ctr[HitBank][p.GI[HitBank]] <= 0);
         // an entry is considered as newly allocated if its prediction counter
         // is weak
         if (PseudoNewAlloc) {
@@ -361,10 +387,10 @@ public:
       int NA = 0;
       int DEP = HitBank + A;
       for (int i = DEP; i <= NHIST; i++) {
-        if (itable[i][GI[i]].u == 0) {
-          itable[i][GI[i]].tag = GTAG[i];
-          itable[i][GI[i]].target = branchTarget;
-          itable[i][GI[i]].ctr = 0;
+        if (u_at(i, p.GI[i]) == 0) {
+          tag[i][p.GI[i]] = p.GTAG[i];
+          target[i][p.GI[i]] = branchTarget;
+          ctr[i][p.GI[i]] = 0;
           NA++;
           if (T <= 0) {
             break;
@@ -385,41 +411,39 @@ public:
       if (TICK < 0)
         TICK = 0;
       if (TICK >= BORNTICK) {
-
-        for (int i = 0; i <= NHIST; i++)
-          for (int j = 0; j < (1 << LOGG); j++)
-            itable[i][j].u >>= 1;
+        age_u();
         TICK = 0;
       }
     }
 
     // update predictions
     if (HitBank >= 0) {
-      if (itable[HitBank][GI[HitBank]].ctr <= 0)
+      int8_t &hit_ctr = ctr[HitBank][p.GI[HitBank]];
+      if (hit_ctr <= 0)
         if (LongestMatchPred != branchTarget)
 
         {
           if (alt_target == branchTarget)
             if (AltBank >= 0) {
-              ctrupdate(itable[AltBank][GI[AltBank]].ctr,
+              ctrupdate(ctr[AltBank][p.GI[AltBank]],
                         (alt_target == branchTarget), CWIDTH);
             }
         }
 
-      ctrupdate(itable[HitBank][GI[HitBank]].ctr,
-                (LongestMatchPred == branchTarget), CWIDTH);
+      ctrupdate(hit_ctr, (LongestMatchPred == branchTarget), CWIDTH);
       if (LongestMatchPred != branchTarget)
-        if (itable[HitBank][GI[HitBank]].ctr < 0)
-          itable[HitBank][GI[HitBank]].target = branchTarget;
+        if (hit_ctr < 0)
+          target[HitBank][p.GI[HitBank]] = branchTarget;
     }
     if (LongestMatchPred != alt_target)
       if (LongestMatchPred == branchTarget) {
-        if (itable[HitBank][GI[HitBank]].u < (1 << UWIDTH) - 1)
-          itable[HitBank][GI[HitBank]].u++;
+        int8_t &hit_u = u_at(HitBank, p.GI[HitBank]);
+        if (hit_u < (1 << UWIDTH) - 1)
+          hit_u++;
       }
     // END TAGE UPDATE
 
-    HistoryUpdate(PC, branchTarget, phist, ptghist, ch_i, ch_t[0], ch_t[1]);
+    HistoryUpdate(PC, branchTarget);
 
     // END PREDICTOR UPDATE
   }
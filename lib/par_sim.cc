@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cbp.h"
+#include "trace_reader.h"
+#include "fifo.h"
+#include "cache.h"
+#include "bp.h"
+#include "resource_schedule.h"
+#include "uarchsim.h"
+#include "parameters.h"
+#include "../cond_branch_predictor_interface.h"
+#include "par_sim.h"
+
+struct par_part_t {
+   uint64_t first_epoch;   // the interval is epochs [first_epoch, end_epoch) of the trace
+   uint64_t end_epoch;
+   uint64_t warm_begin;    // first simulated trace instruction (overlap start)
+   uint64_t begin;         // first measured trace instruction
+   uint64_t end;
+   uarchsim_t *sim = nullptr;
+   double seconds = 0.0;
+};
+
+static double seconds_since(const std::chrono::steady_clock::time_point &t)
+{
+   return std::chrono::duration<double>(std::chrono::steady_clock::now() - t).count();
+}
+
+// Simulate trace instructions [from, to), measuring from `measure`. Runs on a
+// dedicated thread so thread_local predictor state is freshly constructed.
+static uarchsim_t *simulate_range(const PredictorType pred, const std::string &image, const trace_index_t &index,
+                                  const uint64_t from, const uint64_t measure, const uint64_t to)
+{
+   select_predictor(pred);
+   TraceReader *reader = index.reader_at(image, from);
+   uarchsim_t *sim = new uarchsim_t;
+   beginCondDirPredictor();
+
+   uint64_t icount = from;
+   bool measuring = (measure == from);
+   while (icount < to) {
+      if (!measuring && icount == measure) {
+         sim->reset_stats();
+         measuring = true;
+      }
+      db_t *inst = reader->get_inst();
+      if (inst == nullptr)
+         break;
+      sim->step(inst);
+      icount += inst->is_last_piece;
+      delete inst;
+   }
+   delete reader;
+
+   endPredictor();
+   endCondDirPredictor();
+   sim->end_simulation();
+   return sim;
+}
+
+#define PAR_FIELDS(w) (double)(w).instr / (double)(w).cycles, 1000.0 * (double)(w).mispred / (double)(w).instr
+
+static double rel_err(const double est, const double ref)
+{
+   return (ref != 0.0) ? 100.0 * (est - ref) / ref : 0.0;
+}
+
+int par_simulate(const char *trace_name, const PredictorType pred)
+{
+   if (SIMPOINT_GEN || SIMPOINT_FILE || SMARTS_PERIOD || STATS_FILE || PERF_ENABLE || BPROF_TOP || BPROF_DUMP || TRACE_SHM) {
+      printf("-par cannot be combined with -simpoint-gen, -simpoint, -smarts, -stats, -perf, -bprof or -trace-shm.\n");
+      exit(1);
+   }
+   if (EPOCH_SIZE_INSTS == 0) {
+      printf("-par needs a positive epoch size (-E).\n");
+      exit(1);
+   }
+
+   const auto t_load = std::chrono::steady_clock::now();
+   std::string image;
+   if (!load_trace_image(trace_name, image)) {
+      printf("-par: cannot read trace %s\n", trace_name);
+      exit(1);
+   }
+   const trace_index_t index = build_trace_index(image, EPOCH_SIZE_INSTS);
+   const double load_seconds = seconds_since(t_load);
+   if (index.num_instr == 0) {
+      printf("-par: empty trace %s\n", trace_name);
+      exit(1);
+   }
+
+   // Intervals on epoch boundaries, as even as the epochs allow.
+   const uint64_t num_epochs = (index.num_instr + EPOCH_SIZE_INSTS - 1) / EPOCH_SIZE_INSTS;
+   const uint64_t k = std::min(PAR_INTERVALS, num_epochs);
+   const uint64_t overlap_epochs = (PAR_OVERLAP + EPOCH_SIZE_INSTS - 1) / EPOCH_SIZE_INSTS;
+   std::vector<par_part_t> parts(k);
+   for (uint64_t p = 0; p < k; p++) {
+      par_part_t &part = parts[p];
+      part.first_epoch = p * num_epochs / k;
+      part.end_epoch = (p + 1) * num_epochs / k;
+      part.begin = part.first_epoch * EPOCH_SIZE_INSTS;
+      part.end = std::min(part.end_epoch * EPOCH_SIZE_INSTS, index.num_instr);
+      part.warm_begin = (part.first_epoch > overlap_epochs) ? (part.first_epoch - overlap_epochs) * EPOCH_SIZE_INSTS : 0;
+   }
+
+   unsigned num_threads = PAR_THREADS ? (unsigned)PAR_THREADS : std::thread::hardware_concurrency();
+   num_threads = std::max(1u, std::min(num_threads, (unsigned)k));
+
+   // Workers take the next interval and simulate it on a fresh thread.
+   const auto t_par = std::chrono::steady_clock::now();
+   std::atomic<size_t> next{0};
+   auto worker = [&]() {
+      size_t p;
+      while ((p = next++) < parts.size()) {
+         par_part_t &part = parts[p];
+         const auto t = std::chrono::steady_clock::now();
+         std::thread sim_thread([&]() {
+            part.sim = simulate_range(pred, image, index, part.warm_begin, part.begin, part.end);
+         });
+         sim_thread.join();
+         part.seconds = seconds_since(t);
+      }
+   };
+   std::vector<std::thread> workers;
+   for (unsigned t = 0; t < num_threads; t++)
+      workers.emplace_back(worker);
+   for (std::thread &t : workers)
+      t.join();
+   const double par_seconds = seconds_since(t_par);
+
+   uarchsim_t *seq = nullptr;
+   double seq_seconds = 0.0;
+   if (PAR_CHECK) {
+      const auto t_seq = std::chrono::steady_clock::now();
+      std::thread sim_thread([&]() {
+         seq = simulate_range(pred, image, index, 0, 0, index.num_instr);
+      });
+      sim_thread.join();
+      seq_seconds = seconds_since(t_seq);
+   }
+
+   std::vector<const uarchsim_t *> sims;
+   for (const par_part_t &part : parts)
+      sims.push_back(part.sim);
+   uarchsim_t *stitched = new uarchsim_t;
+   stitched->stitch(sims);
+   stitched->output();
+
+   printf("\n------------------------------------------PARALLEL INTERVALS (%llu intervals, overlap %llu instructions, %u threads)------------------------------------------\n",
+          (unsigned long long)k, (unsigned long long)(overlap_epochs * EPOCH_SIZE_INSTS), num_threads);
+   printf("%8s %14s %12s %12s %8s %8s %8s", "Interval", "Epochs", "Instr", "Overlap", "IPC", "MPKI", "Seconds");
+   if (seq)
+      printf(" %8s %8s %8s %8s", "seqIPC", "err", "seqMPKI", "err");
+   printf("\n");
+   for (uint64_t p = 0; p < k; p++) {
+      const par_part_t &part = parts[p];
+      const size_t last = (p + 1 < k) ? part.end_epoch : stitched->num_epochs();
+      const bp_window_stats_t w = stitched->epoch_range_stats(part.first_epoch, last);
+      printf("%8llu %6llu-%-7llu %12llu %12llu %8.4f %8.4f %8.2f", (unsigned long long)p, (unsigned long long)part.first_epoch,
+             (unsigned long long)part.end_epoch, (unsigned long long)w.instr, (unsigned long long)(part.begin - part.warm_begin),
+             PAR_FIELDS(w), part.seconds);
+      if (seq) {
+         const bp_window_stats_t s = seq->epoch_range_stats(part.first_epoch, (p + 1 < k) ? part.end_epoch : seq->num_epochs());
+         printf(" %8.4f %7.2f%% %8.4f %7.2f%%", (double)s.instr / (double)s.cycles, rel_err((double)w.instr / (double)w.cycles, (double)s.instr / (double)s.cycles),
+                1000.0 * (double)s.mispred / (double)s.instr, rel_err((double)w.mispred / (double)w.instr, (double)s.mispred / (double)s.instr));
+      }
+      printf("\n");
+   }
+   const bp_window_stats_t all = stitched->epoch_range_stats(0, stitched->num_epochs());
+   printf("%8s %14s %12llu %12s %8.4f %8.4f %8.2f", "Total", "", (unsigned long long)all.instr, "", PAR_FIELDS(all), par_seconds);
+   if (seq) {
+      const bp_window_stats_t s = seq->epoch_range_stats(0, seq->num_epochs());
+      printf(" %8.4f %7.2f%% %8.4f %7.2f%%", (double)s.instr / (double)s.cycles, rel_err((double)all.instr / (double)all.cycles, (double)s.instr / (double)s.cycles),
+             1000.0 * (double)s.mispred / (double)s.instr, rel_err((double)all.mispred / (double)all.instr, (double)s.mispred / (double)s.instr));
+   }
+   printf("\n");
+   printf("Load and index: %.2f s; parallel simulation: %.2f s", load_seconds, par_seconds);
+   if (seq)
+      printf("; sequential simulation: %.2f s (%.2fx)", seq_seconds, seq_seconds / par_seconds);
+   printf("\n");
+   printf("-------------------------------------------------------------------------------------------------------------------------------------\n");
+
+   for (par_part_t &part : parts)
+      delete part.sim;
+   delete seq;
+   delete stitched;
+   return 0;
+}
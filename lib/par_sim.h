@@ -0,0 +1,26 @@
+#ifndef _PAR_SIM_H_
+#define _PAR_SIM_H_
+
+#include "predictor_type.h"
+
+// Parallel interval simulation of one trace (-par).
+//
+// The trace is decompressed into memory and indexed (trace_index_t), then cut
+// into PAR_INTERVALS contiguous intervals on epoch boundaries (EPOCH_SIZE_INSTS,
+// -E). Each interval is simulated on a fresh thread (predictor state is
+// thread_local) by its own uarchsim_t, starting PAR_OVERLAP instructions
+// (rounded up to whole epochs) before the interval: the overlap is simulated
+// in detail to warm the predictor, caches and pipeline, then
+// uarchsim_t::reset_stats() drops its epochs. The intervals' per-epoch
+// counters are stitched in trace order into one simulator whose output() is
+// the usual report, so the per-epoch and "last N%" tables line up with a
+// sequential run's.
+//
+// With PAR_CHECK the trace is also simulated sequentially, and the intervals'
+// IPC/MPKI are compared over the same epochs; the difference is the error of
+// starting each interval from a state warmed over the overlap only.
+
+// Returns the process exit code.
+int par_simulate(const char *trace_name, const PredictorType pred);
+
+#endif
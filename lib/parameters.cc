@@ -22,7 +22,10 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 // Author: Eric Rotenberg (ericro@ncsu.edu)
 
 
+#include <stdio.h>
 #include <inttypes.h>
+#include <string>
+#include "parameters.h"
 
 bool VP_ENABLE = false;
 bool VP_PERFECT = false;
@@ -41,6 +44,7 @@ uint64_t NUM_LDST_LANES = 8;
 uint64_t NUM_ALU_LANES = 16;
 
 bool PREFETCHER_ENABLE = true;
+uint64_t RPT_ASSOC = 0;  // stride prefetcher RPT associativity, 0 = fully associative
 bool PERFECT_CACHE = false;
 bool WRITE_ALLOCATE = true;
 
@@ -79,3 +83,110 @@ uint64_t MISP_REDUCTION_PERC = 0;
 
 uint64_t EPOCH_SIZE_INSTS = 1000000;
 bool PRINT_PER_EPOCH_STATS = false;
+const char *STATS_FILE = nullptr;  // -stats: stream per-epoch and summary stats (JSON Lines, or CSV if it ends in .csv)
+bool PROFILE_ENABLE = false;       // -prof: report per-stage simulator time (needs a make PROFILE=1 build)
+bool PERF_ENABLE = false;          // -perf: report host hardware counters per phase (Linux perf_event)
+uint64_t BPROF_TOP = 0;           // -bprof: report the n most mispredicted conditional branches (0: off)
+const char *BPROF_DUMP = nullptr;  // -bprof-dump: write the per-branch profile to this binary file
+const char *SIMPOINT_GEN = nullptr;   // -simpoint-gen: collect BBVs, cluster them and write this simpoints file (no timing simulation)
+const char *SIMPOINT_FILE = nullptr;  // -simpoint: simulate only the intervals listed in this simpoints file
+uint64_t SIMPOINT_INTERVAL = 10000000; // -simpoint-interval: instructions per interval for -simpoint-gen
+uint64_t SIMPOINT_WARMUP = UINT64_MAX; // -simpoint-warmup: detailed warmup before each simulation point (default: one interval)
+uint64_t SIMPOINT_MAXK = 10;           // -simpoint-maxk: largest number of clusters tried
+uint64_t SMARTS_PERIOD = 0;            // -smarts: sampling period in instructions (0: off)
+uint64_t SMARTS_WINDOW = 1000;         // -smarts-window: measured detailed instructions per period
+uint64_t SMARTS_DETAIL_WARMUP = 2000;  // -smarts-detail-warmup: detailed (unmeasured) instructions before each window
+uint64_t SMARTS_WARMUP = UINT64_MAX;   // -smarts-warmup: functional warming before the detailed warmup (default: the rest of the period)
+uint64_t PAR_INTERVALS = 0;            // -par: simulate the trace as this many concurrent intervals (0: off)
+uint64_t PAR_THREADS = 0;              // -par-j: worker threads for -par (0: hardware concurrency)
+uint64_t PAR_OVERLAP = 1000000;        // -par-overlap: warmup instructions simulated before each interval (rounded up to epochs)
+bool PAR_CHECK = false;                // -par-check: also run sequentially and report the per-interval warmup error
+const char *TRACE_SERVE = nullptr;     // -trace-serve: serve the trace through this shared memory segment (no simulation)
+uint64_t TRACE_SERVE_CONSUMERS = 1;    // -trace-serve-consumers: consumers the broker waits for before streaming
+uint64_t TRACE_SERVE_WINDOW = 64 << 20; // -trace-serve-window: ring bytes, i.e. how far ahead of the slowest consumer the fastest may run
+const char *TRACE_SHM = nullptr;       // -trace-shm: read the trace from this broker's segment instead of the .gz file
+const char *CACHE_DIR = nullptr;       // -cache: look up and store results in this directory
+bool CACHE_FORCE = false;              // -cache-force: simulate even on a hit, and overwrite the entry
+uint64_t CACHE_MAX_MB = 0;             // -cache-max-mb: evict least recently used entries beyond this size (0: no limit)
+uint64_t CACHE_MAX_AGE = 0;            // -cache-max-age: evict entries unused for this many days (0: keep)
+
+// The result cache hashes this: every parameter that can change a result,
+// i.e. all of the above but the -cache* ones. Add new parameters here too.
+std::string parameters_string()
+{
+   std::string s;
+   char line[256];
+#define P_U64(p) snprintf(line, sizeof(line), "%s=%llu\n", #p, (unsigned long long)(p)), s += line
+#define P_BOOL(p) snprintf(line, sizeof(line), "%s=%d\n", #p, (int)(p)), s += line
+#define P_STR(p) s += std::string(#p) + "=" + ((p) ? (p) : "-") + "\n"
+   P_BOOL(VP_ENABLE);
+   P_BOOL(VP_PERFECT);
+   P_U64(VP_TRACK);
+   P_U64(WINDOW_SIZE);
+   P_U64(FETCH_WIDTH);
+   P_U64(FETCH_NUM_BRANCH);
+   P_BOOL(FETCH_STOP_AT_INDIRECT);
+   P_BOOL(FETCH_STOP_AT_TAKEN);
+   P_BOOL(FETCH_MODEL_ICACHE);
+   P_BOOL(PERFECT_BRANCH_PRED);
+   P_BOOL(PERFECT_INDIRECT_PRED);
+   P_U64(PIPELINE_FILL_LATENCY);
+   P_U64(NUM_LDST_LANES);
+   P_U64(NUM_ALU_LANES);
+   P_BOOL(PREFETCHER_ENABLE);
+   P_U64(RPT_ASSOC);
+   P_BOOL(PERFECT_CACHE);
+   P_BOOL(WRITE_ALLOCATE);
+   P_U64(IC_SIZE);
+   P_U64(IC_ASSOC);
+   P_U64(IC_BLOCKSIZE);
+   P_U64(L1_SIZE);
+   P_U64(L1_ASSOC);
+   P_U64(L1_BLOCKSIZE);
+   P_U64(L1_LATENCY);
+   P_U64(L2_SIZE);
+   P_U64(L2_ASSOC);
+   P_U64(L2_BLOCKSIZE);
+   P_U64(L2_LATENCY);
+   P_U64(L3_SIZE);
+   P_U64(L3_ASSOC);
+   P_U64(L3_BLOCKSIZE);
+   P_U64(L3_LATENCY);
+   P_U64(MAIN_MEMORY_LATENCY);
+   P_U64(DEFAULT_EXEC_LATENCY);
+   P_U64(FP_EXEC_LATENCY);
+   P_U64(SLOW_ALU_EXEC_LATENCY);
+   P_U64(LOG_LEVEL);
+   P_U64(LOG_START_CYCLE);
+   P_U64(LOG_END_CYCLE);
+   P_U64(DQ_LATENCY);
+   P_U64(MISP_REDUCTION_PERC);
+   P_U64(EPOCH_SIZE_INSTS);
+   P_BOOL(PRINT_PER_EPOCH_STATS);
+   P_STR(STATS_FILE);
+   P_BOOL(PROFILE_ENABLE);
+   P_BOOL(PERF_ENABLE);
+   P_U64(BPROF_TOP);
+   P_STR(BPROF_DUMP);
+   P_STR(SIMPOINT_GEN);
+   P_STR(SIMPOINT_FILE);
+   P_U64(SIMPOINT_INTERVAL);
+   P_U64(SIMPOINT_WARMUP);
+   P_U64(SIMPOINT_MAXK);
+   P_U64(SMARTS_PERIOD);
+   P_U64(SMARTS_WINDOW);
+   P_U64(SMARTS_DETAIL_WARMUP);
+   P_U64(SMARTS_WARMUP);
+   P_U64(PAR_INTERVALS);
+   P_U64(PAR_THREADS);
+   P_U64(PAR_OVERLAP);
+   P_BOOL(PAR_CHECK);
+   P_STR(TRACE_SERVE);
+   P_U64(TRACE_SERVE_CONSUMERS);
+   P_U64(TRACE_SERVE_WINDOW);
+   P_STR(TRACE_SHM);
+#undef P_U64
+#undef P_BOOL
+#undef P_STR
+   return s;
+}
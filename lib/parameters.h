@@ -24,6 +24,8 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #ifndef _PARAMETERS_H_
 #define _PARAMETERS_H_
 
+#include <string>
+
 enum class VPTracks
 {
     ALL  = 0,
@@ -49,6 +51,7 @@ extern uint64_t NUM_LDST_LANES;
 extern uint64_t NUM_ALU_LANES;
 
 extern bool PREFETCHER_ENABLE;
+extern uint64_t RPT_ASSOC;
 extern bool PERFECT_CACHE;
 extern bool WRITE_ALLOCATE;
 
@@ -86,4 +89,33 @@ extern uint64_t MISP_REDUCTION_PERC;
 
 extern uint64_t EPOCH_SIZE_INSTS;
 extern bool PRINT_PER_EPOCH_STATS;
+extern const char *STATS_FILE;
+extern bool PROFILE_ENABLE;
+extern bool PERF_ENABLE;
+extern uint64_t BPROF_TOP;
+extern const char *BPROF_DUMP;
+extern const char *SIMPOINT_GEN;
+extern const char *SIMPOINT_FILE;
+extern uint64_t SIMPOINT_INTERVAL;
+extern uint64_t SIMPOINT_WARMUP;
+extern uint64_t SIMPOINT_MAXK;
+extern uint64_t SMARTS_PERIOD;
+extern uint64_t SMARTS_WINDOW;
+extern uint64_t SMARTS_DETAIL_WARMUP;
+extern uint64_t SMARTS_WARMUP;
+extern uint64_t PAR_INTERVALS;
+extern uint64_t PAR_THREADS;
+extern uint64_t PAR_OVERLAP;
+extern bool PAR_CHECK;
+extern const char *TRACE_SERVE;
+extern uint64_t TRACE_SERVE_CONSUMERS;
+extern uint64_t TRACE_SERVE_WINDOW;
+extern const char *TRACE_SHM;
+extern const char *CACHE_DIR;
+extern bool CACHE_FORCE;
+extern uint64_t CACHE_MAX_MB;
+extern uint64_t CACHE_MAX_AGE;
+
+// "NAME=value" lines of every parameter above but the -cache* ones.
+std::string parameters_string();
 #endif
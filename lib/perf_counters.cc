@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "stats_writer.h"
+#include "perf_counters.h"
+
+static const char *perf_event_names[PERF_NUM_EVENTS] = {
+   "cycles",
+   "instructions",
+   "llc_misses",
+   "branch_misses",
+   "dtlb_misses",
+};
+
+#ifdef __linux__
+static int perf_open(uint32_t type, uint64_t config, int group_fd)
+{
+   struct perf_event_attr attr;
+   memset(&attr, 0, sizeof(attr));
+   attr.size = sizeof(attr);
+   attr.type = type;
+   attr.config = config;
+   attr.disabled = (group_fd == -1);
+   attr.exclude_kernel = 1;
+   attr.exclude_hv = 1;
+   attr.read_format = PERF_FORMAT_GROUP;
+   // pid 0, cpu -1: this thread on any CPU, so cbp-sweep workers count separately.
+   return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+#endif
+
+perf_counters_t::perf_counters_t()
+   : leader(-1), num_open(0)
+{
+   for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      fd[e] = -1;
+      slot[e] = -1;
+      last[e] = 0;
+   }
+#ifdef __linux__
+   const struct { uint32_t type; uint64_t config; } events[PERF_NUM_EVENTS] = {
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+      {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+      {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+   };
+   for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      fd[e] = perf_open(events[e].type, events[e].config, leader);
+      if (fd[e] < 0) {
+         if (e == PERF_CYCLES) {
+            fprintf(stderr, "Warning: -perf: hardware counters unavailable (%s); check /proc/sys/kernel/perf_event_paranoid. Continuing without them.\n", strerror(errno));
+            return;
+         }
+         continue;
+      }
+      if (e == PERF_CYCLES)
+         leader = fd[e];
+      slot[e] = num_open++;
+   }
+   ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+   ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+   fprintf(stderr, "Warning: -perf: hardware counters are only supported on Linux. Continuing without them.\n");
+#endif
+}
+
+perf_counters_t::~perf_counters_t()
+{
+#ifdef __linux__
+   for (int e = 0; e < PERF_NUM_EVENTS; e++)
+      if (fd[e] >= 0)
+         close(fd[e]);
+#endif
+}
+
+// Reads the running totals of the whole group in one syscall.
+bool perf_counters_t::read_group(uint64_t *values) const
+{
+#ifdef __linux__
+   uint64_t buf[1 + PERF_NUM_EVENTS];
+   const ssize_t want = (ssize_t)((1 + num_open) * sizeof(uint64_t));
+   if (read(leader, buf, sizeof(buf)) < want || buf[0] != (uint64_t)num_open)
+      return false;
+   for (int e = 0; e < PERF_NUM_EVENTS; e++)
+      values[e] = (slot[e] >= 0) ? buf[1 + slot[e]] : 0;
+   return true;
+#else
+   return false;
+#endif
+}
+
+void perf_counters_t::end_epoch()
+{
+   if (!available())
+      return;
+   // A failed read leaves the epoch at zero so epochs stay aligned.
+   uint64_t now[PERF_NUM_EVENTS];
+   if (!read_group(now))
+      memcpy(now, last, sizeof(now));
+   std::vector<uint64_t> delta(PERF_NUM_EVENTS);
+   for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+      delta[e] = now[e] - last[e];
+      last[e] = now[e];
+   }
+   per_epoch.push_back(delta);
+}
+
+// Folds the per-epoch counts into warmup / first_half / second_half / full.
+// The second half is accumulated backwards from the last epoch exactly like
+// bp_t::window_stats() builds the "50perc" window.
+std::vector<perf_counters_t::phase_t> perf_counters_t::phases(const std::vector<uint64_t> &num_insts_per_epoch) const
+{
+   std::vector<phase_t> p = {{"warmup", 0, {}}, {"first_half", 0, {}}, {"second_half", 0, {}}, {"full", 0, {}}};
+   const size_t n = std::min(per_epoch.size(), num_insts_per_epoch.size());
+   uint64_t total = 0;
+   for (size_t i = 0; i < n; i++)
+      total += num_insts_per_epoch[i];
+
+   size_t second_start = n;
+   uint64_t tail = 0;
+   while (second_start > 0) {
+      second_start--;
+      tail += num_insts_per_epoch[second_start];
+      if (tail > total / 2)
+         break;
+   }
+
+   for (size_t i = 0; i < n; i++) {
+      phase_t &ph = p[(i >= second_start) ? 2 : (i == 0) ? 0 : 1];
+      ph.instr += num_insts_per_epoch[i];
+      p[3].instr += num_insts_per_epoch[i];
+      for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+         ph.count[e] += per_epoch[i][e];
+         p[3].count[e] += per_epoch[i][e];
+      }
+   }
+   return p;
+}
+
+void perf_counters_t::output(const char *predictor, const std::vector<uint64_t> &num_insts_per_epoch) const
+{
+   if (!available())
+      return;
+   printf("-------------------------------------------HOST HARDWARE COUNTERS (perf_event, predictor: %s)------------------------------------------\n", predictor);
+   printf("%-12s %12s %16s %16s %8s %14s %14s %14s %12s\n", "Phase", "SimInstr", "Cycles", "Instructions", "HostIPC",
+          "LLCMisses", "BranchMisses", "DTLBMisses", "Cyc/SimInstr");
+   for (const phase_t &ph : phases(num_insts_per_epoch)) {
+      printf("%-12s %12llu", ph.name, (unsigned long long)ph.instr);
+      for (int e = 0; e < PERF_NUM_EVENTS; e++) {
+         if (e == PERF_LLC_MISSES)
+            printf(" %8.3f", ph.count[PERF_CYCLES] ? (double)ph.count[PERF_INSTRUCTIONS] / (double)ph.count[PERF_CYCLES] : 0.0);
+         if (slot[e] >= 0)
+            printf(" %*llu", (e <= PERF_INSTRUCTIONS) ? 16 : 14, (unsigned long long)ph.count[e]);
+         else
+            printf(" %*s", (e <= PERF_INSTRUCTIONS) ? 16 : 14, "n/a");
+      }
+      printf(" %12.1f\n", ph.instr ? (double)ph.count[PERF_CYCLES] / (double)ph.instr : 0.0);
+   }
+   printf("---------------------------------------------------------------------------------------------------------------------------------------\n");
+}
+
+void perf_counters_t::write_stats(stats_writer_t &w, const std::vector<uint64_t> &num_insts_per_epoch) const
+{
+   if (!available())
+      return;
+   for (const phase_t &ph : phases(num_insts_per_epoch)) {
+      const std::string record = std::string("perf_") + ph.name;
+      w.begin(record.c_str(), 0);
+      w.field("sim_instr", ph.instr);
+      for (int e = 0; e < PERF_NUM_EVENTS; e++)
+         if (slot[e] >= 0)
+            w.field(perf_event_names[e], ph.count[e]);
+      w.end();
+   }
+}
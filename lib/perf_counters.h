@@ -0,0 +1,62 @@
+#ifndef _PERF_COUNTERS_H_
+#define _PERF_COUNTERS_H_
+
+#include <inttypes.h>
+#include <vector>
+
+class stats_writer_t;
+
+// Host hardware counters for the simulator's own execution (-perf).
+//
+// Opens one Linux perf_event_open group on the calling thread (user mode
+// only) counting cycles, instructions, LLC misses, branch misses and dTLB
+// load misses. The group is read at every epoch boundary, so counts can be
+// attributed to the same instruction windows as the branch statistics:
+//    warmup       the first epoch
+//    first_half   the rest of the first half of the run
+//    second_half  the "50perc" window of the text tables
+//
+// If perf_event_open is unavailable (non-Linux, no PMU in a VM, or
+// perf_event_paranoid too strict) a single warning is printed and every
+// call is a no-op; events the PMU lacks are reported as n/a.
+enum perf_event_id_t {
+   PERF_CYCLES,
+   PERF_INSTRUCTIONS,
+   PERF_LLC_MISSES,
+   PERF_BRANCH_MISSES,
+   PERF_DTLB_MISSES,
+   PERF_NUM_EVENTS
+};
+
+class perf_counters_t {
+public:
+   perf_counters_t();
+   ~perf_counters_t();
+
+   bool available() const { return leader >= 0; }
+
+   // Closes the current epoch: appends the counts since the previous call.
+   void end_epoch();
+
+   void output(const char *predictor, const std::vector<uint64_t> &num_insts_per_epoch) const;
+   void write_stats(stats_writer_t &w, const std::vector<uint64_t> &num_insts_per_epoch) const;
+
+private:
+   struct phase_t {
+      const char *name;
+      uint64_t instr;
+      uint64_t count[PERF_NUM_EVENTS];
+   };
+
+   bool read_group(uint64_t *values) const;
+   std::vector<phase_t> phases(const std::vector<uint64_t> &num_insts_per_epoch) const;
+
+   int leader;
+   int fd[PERF_NUM_EVENTS];
+   int slot[PERF_NUM_EVENTS];   // position in the group read, -1 if the event could not be opened
+   int num_open;
+   uint64_t last[PERF_NUM_EVENTS];
+   std::vector<std::vector<uint64_t>> per_epoch;
+};
+
+#endif
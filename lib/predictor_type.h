@@ -3,6 +3,7 @@
 
 enum class PredictorType {
     PRED_TAGE_SC_L,
+    PRED_TAGE_SC_L_192KB,
     PRED_SAMPLE,
     PRED_GSHARE,
     PRED_TOURNAMENT,
@@ -12,10 +13,13 @@ enum class PredictorType {
     PRED_CORRELATING,
     PRED_LOCAL,
     PRED_PERCEPTRON,
+    PRED_TAGE_SC_L_REF,         // pre-rewrite TAGE-SC-L, cbp-check's tage-ref reference side
+    PRED_TAGE_SC_L_192KB_REF,
 };
 
-// Static variable to hold the selected predictor
-static PredictorType selected_predictor = PredictorType::PRED_TAGE_SC_L;
+// Static variable to hold the selected predictor (per thread, so cbp-sweep
+// workers can each simulate a different predictor)
+static thread_local PredictorType selected_predictor = PredictorType::PRED_TAGE_SC_L;
 
 // Inline function to get the selected predictor
 inline PredictorType get_selected_predictor() {
@@ -27,4 +31,62 @@ inline void set_selected_predictor(PredictorType pt) {
     selected_predictor = pt;
 }
 
+// Name of a predictor as spelled on the -pred command line
+inline const char *predictor_type_name(PredictorType pt) {
+    switch (pt) {
+        case PredictorType::PRED_TAGE_SC_L:       return "tage-sc-l";
+        case PredictorType::PRED_TAGE_SC_L_192KB: return "tage-sc-l-192kb";
+        case PredictorType::PRED_SAMPLE:          return "sample";
+        case PredictorType::PRED_GSHARE:          return "gshare";
+        case PredictorType::PRED_TOURNAMENT:      return "tournament";
+        case PredictorType::PRED_TAGE:            return "tage";
+        case PredictorType::PRED_ONEBIT:          return "onebit";
+        case PredictorType::PRED_TWOBIT:          return "twobit";
+        case PredictorType::PRED_CORRELATING:     return "correlating";
+        case PredictorType::PRED_LOCAL:           return "local";
+        case PredictorType::PRED_PERCEPTRON:      return "perceptron";
+        case PredictorType::PRED_TAGE_SC_L_REF:   return "tage-sc-l-ref";
+        case PredictorType::PRED_TAGE_SC_L_192KB_REF: return "tage-sc-l-192kb-ref";
+    }
+    return "unknown";
+}
+
+// Component of the selected predictor that provided a conditional branch
+// prediction (see get_cond_dir_provider()). Only TAGE-SC-L reports the
+// components; every other predictor is PROVIDER_OTHER.
+enum cond_provider_t {
+    PROVIDER_BIMODAL,       // TAGE base table, no tagged hit
+    PROVIDER_TAGE_LONGEST,  // longest matching tagged bank (HitBank)
+    PROVIDER_TAGE_ALT,      // alternate prediction on a newly allocated HitBank entry
+    PROVIDER_LOOP,          // loop predictor
+    PROVIDER_SC,            // statistical corrector overrode TAGE/loop
+    PROVIDER_OTHER,
+    NUM_PROVIDERS
+};
+
+inline const char *cond_provider_name(cond_provider_t p) {
+    switch (p) {
+        case PROVIDER_BIMODAL:      return "bimodal";
+        case PROVIDER_TAGE_LONGEST: return "tage_longest";
+        case PROVIDER_TAGE_ALT:     return "tage_alt";
+        case PROVIDER_LOOP:         return "loop";
+        case PROVIDER_SC:           return "sc";
+        default:                    return "other";
+    }
+}
+
+// Reads the state a TAGE-SC-L's predict() leaves behind; mirrors the final
+// selection in predict_using_given_hist(). TAGE is TageScL<Config> or a
+// reference CBP2016_TAGE_SC_L.
+template <class TAGE>
+inline cond_provider_t tage_sc_l_provider(const TAGE& p, const bool pred_taken) {
+    if (pred_taken != p.pred_inter)
+        return PROVIDER_SC;
+    if (p.LVALID && (p.active_hist.WITHLOOP >= 0))
+        return PROVIDER_LOOP;
+    if (p.HitBank == 0)
+        return PROVIDER_BIMODAL;
+    return (p.tage_pred == p.LongestMatchPred) ? PROVIDER_TAGE_LONGEST : PROVIDER_TAGE_ALT;
+}
+
 #endif // PREDICTOR_TYPE_H
@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <inttypes.h>
+#include <chrono>
+#include <string>
+#include "parameters.h"
+#include "stats_writer.h"
+#include "profiler.h"
+
+#ifdef CBP_PROFILE
+
+thread_local bool prof_enabled = false;
+thread_local prof_counters_t prof_counters = {};
+thread_local prof_scope_t *prof_current = nullptr;
+
+static const char *prof_stage_names[(int)prof_stage_t::NUM_STAGES] = {
+   "trace_decode",
+   "uarch_step",
+   "cond_predict",
+   "cond_update",
+   "indirect",
+   "cache",
+   "prefetch",
+};
+
+// Wall clock and tick counter at prof_begin(), used to convert ticks to seconds.
+static thread_local std::chrono::steady_clock::time_point prof_wall_start;
+static thread_local uint64_t prof_tick_start;
+
+void prof_begin() {
+   prof_counters = {};
+   prof_current = nullptr;
+   prof_enabled = PROFILE_ENABLE;
+   prof_wall_start = std::chrono::steady_clock::now();
+   prof_tick_start = prof_now();
+}
+
+struct prof_summary_t {
+   double wall_sec;
+   double ns_per_tick;
+   uint64_t total_ticks;
+};
+
+static prof_summary_t prof_summarize() {
+   prof_summary_t s;
+   const uint64_t ticks = prof_now() - prof_tick_start;
+   s.wall_sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - prof_wall_start).count();
+   s.ns_per_tick = ticks ? (s.wall_sec * 1e9 / (double)ticks) : 0.0;
+   s.total_ticks = 0;
+   for (int i = 0; i < (int)prof_stage_t::NUM_STAGES; i++)
+      s.total_ticks += prof_counters.ticks[i];
+   return s;
+}
+
+void prof_output(uint64_t num_inst) {
+   if (!prof_enabled)
+      return;
+   const prof_summary_t s = prof_summarize();
+   printf("-----------------------------------------------SELF-PROFILE (simulator wall time per stage)--------------------------------------------\n");
+   printf("%-14s %14s %16s %10s %8s %10s\n", "Stage", "Calls", "Ticks", "Seconds", "%", "ns/call");
+   for (int i = 0; i < (int)prof_stage_t::NUM_STAGES; i++) {
+      const uint64_t calls = prof_counters.calls[i];
+      const uint64_t ticks = prof_counters.ticks[i];
+      const double sec = (double)ticks * s.ns_per_tick / 1e9;
+      printf("%-14s %14llu %16llu %10.3f %7.2f%% %10.1f\n", prof_stage_names[i],
+         (unsigned long long)calls, (unsigned long long)ticks, sec,
+         s.total_ticks ? 100.0 * (double)ticks / (double)s.total_ticks : 0.0,
+         calls ? (double)ticks * s.ns_per_tick / (double)calls : 0.0);
+   }
+   printf("Profiled time  = %.3f s (wall %.3f s)\n", (double)s.total_ticks * s.ns_per_tick / 1e9, s.wall_sec);
+   printf("Simulated MIPS = %.3f\n", s.wall_sec > 0.0 ? (double)num_inst / s.wall_sec / 1e6 : 0.0);
+   printf("---------------------------------------------------------------------------------------------------------------------------------------\n");
+}
+
+void prof_write_stats(stats_writer_t &w, uint64_t num_inst) {
+   if (!prof_enabled)
+      return;
+   const prof_summary_t s = prof_summarize();
+   for (int i = 0; i < (int)prof_stage_t::NUM_STAGES; i++) {
+      const std::string record = std::string("prof_") + prof_stage_names[i];
+      w.begin(record.c_str(), 0);
+      w.field("calls", prof_counters.calls[i]);
+      w.field("ticks", prof_counters.ticks[i]);
+      w.field("seconds", (double)prof_counters.ticks[i] * s.ns_per_tick / 1e9);
+      w.end();
+   }
+   w.begin("prof_total", 0);
+   w.field("wall_seconds", s.wall_sec);
+   w.field("profiled_seconds", (double)s.total_ticks * s.ns_per_tick / 1e9);
+   w.field("mips", s.wall_sec > 0.0 ? (double)num_inst / s.wall_sec / 1e6 : 0.0);
+   w.end();
+}
+
+#else
+
+void prof_begin() {
+   if (PROFILE_ENABLE)
+      fprintf(stderr, "Warning: -prof ignored, rebuild with 'make PROFILE=1' to enable the self-profiler.\n");
+}
+
+void prof_output(uint64_t num_inst) {
+}
+
+void prof_write_stats(stats_writer_t &w, uint64_t num_inst) {
+}
+
+#endif
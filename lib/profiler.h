@@ -0,0 +1,100 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <inttypes.h>
+
+class stats_writer_t;
+
+// Built-in self-profiler: where does the simulator's own time go?
+//
+// Hot paths are bracketed with PROF_SCOPE(stage). Each scope charges its
+// exclusive time (minus any nested scopes) and one call to its stage, so the
+// per-stage numbers add up to the profiled total. Time is read with rdtsc on
+// x86 and steady_clock elsewhere.
+//
+// Instrumentation only exists when built with -DCBP_PROFILE (make PROFILE=1);
+// otherwise PROF_SCOPE expands to nothing and the default build is unchanged.
+// Even in a profiling build, counting is off until -prof sets PROFILE_ENABLE.
+enum class prof_stage_t {
+   TRACE_DECODE,     // TraceReader::get_inst(): gzip inflate + record decode
+   UARCH_STEP,       // uarchsim_t::step() excluding the stages below
+   COND_PREDICT,     // conditional direction prediction (and training for the simple predictors)
+   COND_UPDATE,      // spec_update / execute-resolve / commit predictor hooks
+   INDIRECT,         // ITTAGE prediction, update and history tracking
+   CACHE,            // cache lookups and fills, all levels
+   PREFETCH,         // stride prefetcher lookahead / train / issue
+   NUM_STAGES
+};
+
+// Called once the simulator is built: arms counting if PROFILE_ENABLE is set.
+void prof_begin();
+// Prints the per-stage table and simulated MIPS (no-op unless armed).
+void prof_output(uint64_t num_inst);
+// Emits one "prof_<stage>" record per stage plus a "prof_total" record.
+void prof_write_stats(stats_writer_t &w, uint64_t num_inst);
+
+#ifdef CBP_PROFILE
+
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+static inline uint64_t prof_now() {
+#if defined(__x86_64__) || defined(__i386__)
+   return __rdtsc();
+#else
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+struct prof_counters_t {
+   uint64_t ticks[(int)prof_stage_t::NUM_STAGES];
+   uint64_t calls[(int)prof_stage_t::NUM_STAGES];
+};
+
+class prof_scope_t;
+
+extern thread_local bool prof_enabled;
+extern thread_local prof_counters_t prof_counters;
+extern thread_local prof_scope_t *prof_current;
+
+class prof_scope_t {
+public:
+   prof_scope_t(prof_stage_t s) : stage(s), parent(nullptr), child_ticks(0), start(0) {
+      if (!prof_enabled)
+         return;
+      parent = prof_current;
+      prof_current = this;
+      start = prof_now();
+   }
+
+   ~prof_scope_t() {
+      if (!start)
+         return;
+      const uint64_t elapsed = prof_now() - start;
+      prof_counters.ticks[(int)stage] += elapsed - child_ticks;
+      prof_counters.calls[(int)stage]++;
+      if (parent)
+         parent->child_ticks += elapsed;
+      prof_current = parent;
+   }
+
+private:
+   prof_stage_t stage;
+   prof_scope_t *parent;
+   uint64_t child_ticks;
+   uint64_t start;
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(s) prof_scope_t PROF_CONCAT(prof_scope_, __LINE__)(prof_stage_t::s)
+
+#else
+
+#define PROF_SCOPE(s) do {} while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "../predictor_config.h"
+#include "result_cache.h"
+
+#define RESULT_CACHE_MAGIC "cbp-result-cache v1"
+// Bytes at the start of a trace that go into its identity.
+#define RESULT_CACHE_TRACE_HEAD (64 << 10)
+
+// Two FNV-1a lanes with different offset bases, printed as 32 hex digits.
+// Entries store their material, so the hash only has to spread names.
+struct hash128_t {
+   uint64_t h[2] = {0xcbf29ce484222325ull, 0x6c62272e07bb0142ull};
+
+   void add(const char *p, const size_t n)
+   {
+      for (size_t i = 0; i < n; i++) {
+         h[0] = (h[0] ^ (uint8_t)p[i]) * 0x100000001b3ull;
+         h[1] = (h[1] ^ (uint8_t)p[i]) * 0x100000001b3ull;
+         h[1] ^= h[1] >> 29;
+      }
+   }
+
+   std::string hex() const
+   {
+      char s[33];
+      snprintf(s, sizeof(s), "%016llx%016llx", (unsigned long long)h[0], (unsigned long long)h[1]);
+      return s;
+   }
+};
+
+// Hashes at most limit bytes of a file (0: all of it).
+static bool hash_file(const char *path, const uint64_t limit, std::string &hex)
+{
+   FILE *f = fopen(path, "rb");
+   if (!f)
+      return false;
+   hash128_t h;
+   char buf[1 << 16];
+   uint64_t total = 0;
+   size_t n;
+   while ((limit == 0 || total < limit) && (n = fread(buf, 1, limit ? std::min<uint64_t>(sizeof(buf), limit - total) : sizeof(buf), f)) > 0) {
+      h.add(buf, n);
+      total += n;
+   }
+   fclose(f);
+   hex = h.hex();
+   return true;
+}
+
+result_cache_t::result_cache_t(const char *dir, const bool force, const uint64_t max_bytes, const uint64_t max_age_days)
+   : dir(dir), force(force), max_bytes(max_bytes), max_age_days(max_age_days)
+{
+}
+
+const std::string &result_cache_t::build_id()
+{
+   // Any rebuild changes the binary, hence every key.
+   static const std::string id = []() {
+      std::string hex;
+      if (!hash_file("/proc/self/exe", 0, hex))
+         hex = std::string("built ") + __DATE__ + " " + __TIME__;
+      return hex;
+   }();
+   return id;
+}
+
+bool result_cache_t::trace_id(const char *path, std::string &id)
+{
+   struct stat st;
+   std::string head;
+   if (stat(path, &st) != 0 || !hash_file(path, RESULT_CACHE_TRACE_HEAD, head))
+      return false;
+   char s[128];
+   snprintf(s, sizeof(s), "size %llu mtime %lld.%09ld head ", (unsigned long long)st.st_size, (long long)st.st_mtim.tv_sec, (long)st.st_mtim.tv_nsec);
+   id = s + head;
+   return true;
+}
+
+bool result_cache_t::file_hash(const char *path, std::string &hash)
+{
+   return hash_file(path, 0, hash);
+}
+
+std::string result_cache_t::config_string(const PredictorConfig &c)
+{
+   std::string s;
+   for (const PredictorConfigField &f : predictor_config_fields)
+      s += std::string(f.name) + "=" + std::to_string(c.*f.member) + "\n";
+   return s;
+}
+
+std::string result_cache_t::entry_path(const std::string &material) const
+{
+   hash128_t h;
+   h.add(material.data(), material.size());
+   return dir + "/" + h.hex() + ".entry";
+}
+
+bool result_cache_t::lookup(const std::string &material, std::string &payload)
+{
+   if (force) {
+      misses++;
+      return false;
+   }
+   const std::string path = entry_path(material);
+   FILE *f = fopen(path.c_str(), "rb");
+   if (!f) {
+      misses++;
+      return false;
+   }
+   std::string s;
+   char buf[1 << 16];
+   size_t n;
+   while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+      s.append(buf, n);
+   fclose(f);
+
+   const std::string magic = RESULT_CACHE_MAGIC "\n";
+   const size_t nl = s.find('\n', magic.size());
+   if (s.compare(0, magic.size(), magic) != 0 || nl == std::string::npos) {
+      misses++;
+      return false;
+   }
+   const size_t len = strtoull(s.c_str() + magic.size(), nullptr, 10);
+   if (s.size() < nl + 1 + len || s.compare(nl + 1, len, material) != 0) {
+      misses++;
+      return false;
+   }
+   payload = s.substr(nl + 1 + len);
+   // Last use, for eviction.
+   utimensat(AT_FDCWD, path.c_str(), nullptr, 0);
+   hits++;
+   return true;
+}
+
+void result_cache_t::store(const std::string &material, const std::string &payload)
+{
+   std::error_code ec;
+   std::filesystem::create_directories(dir, ec);
+   const std::string path = entry_path(material);
+   const std::string tmp = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+   FILE *f = fopen(tmp.c_str(), "wb");
+   bool ok = (f != nullptr);
+   if (ok) {
+      ok = fprintf(f, "%s\n%zu\n", RESULT_CACHE_MAGIC, material.size()) > 0;
+      ok = ok && fwrite(material.data(), 1, material.size(), f) == material.size();
+      ok = ok && fwrite(payload.data(), 1, payload.size(), f) == payload.size();
+      ok = (fclose(f) == 0) && ok;
+   }
+   if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+      fprintf(stderr, "Warning: -cache: cannot write %s\n", path.c_str());
+      unlink(tmp.c_str());
+   }
+}
+
+uint64_t result_cache_t::evict()
+{
+   namespace fs = std::filesystem;
+   if (max_bytes == 0 && max_age_days == 0)
+      return 0;
+
+   struct entry_t {
+      fs::path path;
+      fs::file_time_type used;
+      uint64_t size;
+   };
+   std::vector<entry_t> entries;
+   std::error_code ec;
+   for (const fs::directory_entry &e : fs::directory_iterator(dir, ec)) {
+      if (e.is_regular_file(ec) && e.path().extension() == ".entry")
+         entries.push_back({e.path(), e.last_write_time(ec), e.file_size(ec)});
+   }
+   std::sort(entries.begin(), entries.end(), [](const entry_t &a, const entry_t &b) { return a.used < b.used; });
+
+   const fs::file_time_type oldest = fs::file_time_type::clock::now() - std::chrono::hours(24 * max_age_days);
+   uint64_t total = 0;
+   for (const entry_t &e : entries)
+      total += e.size;
+   uint64_t dropped = 0;
+   for (const entry_t &e : entries) {
+      const bool too_old = max_age_days && e.used < oldest;
+      const bool too_big = max_bytes && total > max_bytes;
+      if (!too_old && !too_big)
+         break;
+      if (fs::remove(e.path, ec)) {
+         total -= e.size;
+         dropped++;
+      }
+   }
+   return dropped;
+}
+
+// A capture still running at exit() (an error path) is ended first, so that
+// what was printed reaches the real stdout.
+static stdout_capture_t *active_capture = nullptr;
+
+static void end_active_capture()
+{
+   if (active_capture)
+      active_capture->end();
+}
+
+void stdout_capture_t::begin()
+{
+   fflush(stdout);
+   int fds[2];
+   if (pipe(fds) != 0)
+      return;
+   saved_fd = dup(STDOUT_FILENO);
+   dup2(fds[1], STDOUT_FILENO);
+   close(fds[1]);
+   read_fd = fds[0];
+   pump = std::thread([this]() {
+      char buf[1 << 16];
+      ssize_t n;
+      while ((n = read(read_fd, buf, sizeof(buf))) > 0) {
+         text.append(buf, n);
+         for (ssize_t done = 0, w; done < n; done += w)
+            if ((w = write(saved_fd, buf + done, n - done)) <= 0)
+               break;
+      }
+   });
+   static bool registered = false;
+   if (!registered) {
+      atexit(end_active_capture);
+      registered = true;
+   }
+   active_capture = this;
+}
+
+std::string stdout_capture_t::end()
+{
+   if (saved_fd < 0)
+      return text;
+   active_capture = nullptr;
+   std::cout.flush();
+   fflush(stdout);
+   // Replacing fd 1 closes the pipe's last write end: the pump sees EOF
+   // once it has passed everything on to saved_fd.
+   dup2(saved_fd, STDOUT_FILENO);
+   pump.join();
+   close(saved_fd);
+   saved_fd = -1;
+   close(read_fd);
+   read_fd = -1;
+   return text;
+}
@@ -0,0 +1,75 @@
+#ifndef _RESULT_CACHE_H_
+#define _RESULT_CACHE_H_
+
+#include <inttypes.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+struct PredictorConfig;
+
+// Content-addressed cache of simulation results (cbp -cache, cbp-sweep -cache).
+//
+// A run is identified by its key material, a text listing everything that
+// determines its result: what kind of result it is, the build (a hash of the
+// running binary), the trace (size, mtime and a hash of its first 64 KiB, so
+// the same trace under another name still hits), the predictor, the full
+// PredictorConfig and every parameters.h global. The entry file is named
+// after a 128-bit hash of the material and stores the material itself, so a
+// hash collision is a miss, never a wrong result.
+//
+// Entry file (text header, then the payload verbatim to the end of file):
+//
+//    cbp-result-cache v1
+//    <length of the material in bytes>
+//    <material>
+//    <payload>
+//
+// Entries are written to a temporary file and renamed, so concurrent runs
+// sharing a directory never read a partial entry. A hit touches the entry's
+// mtime, which is its last use for eviction: entries unused for max_age_days
+// are dropped, then the least recently used ones until the directory holds at
+// most max_bytes (0: no limit).
+class result_cache_t {
+public:
+   result_cache_t(const char *dir, const bool force, const uint64_t max_bytes, const uint64_t max_age_days);
+
+   // The payload stored for this material; false on a miss or with force.
+   bool lookup(const std::string &material, std::string &payload);
+   void store(const std::string &material, const std::string &payload);
+   // Applies the eviction policies; returns the number of entries dropped.
+   uint64_t evict();
+
+   // Key material pieces.
+   static const std::string &build_id();
+   static bool trace_id(const char *path, std::string &id);
+   static bool file_hash(const char *path, std::string &hash);
+   static std::string config_string(const PredictorConfig &c);
+
+   std::atomic<uint64_t> hits{0};
+   std::atomic<uint64_t> misses{0};
+
+private:
+   std::string entry_path(const std::string &material) const;
+
+   std::string dir;
+   bool force;
+   uint64_t max_bytes;
+   uint64_t max_age_days;
+};
+
+// Copies everything written to stdout (printf and std::cout) into a string
+// while still passing it through, so a report can be cached as printed.
+class stdout_capture_t {
+public:
+   void begin();
+   std::string end();
+
+private:
+   int saved_fd = -1;
+   int read_fd = -1;
+   std::thread pump;
+   std::string text;
+};
+
+#endif
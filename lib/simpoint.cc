@@ -0,0 +1,245 @@
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <vector>
+#include "simpoint.h"
+
+// k-means restarts per k; the run with the lowest distortion is kept.
+static const int SIMPOINT_SEEDS = 5;
+static const int SIMPOINT_MAX_ITERS = 100;
+
+static uint64_t splitmix64(uint64_t x)
+{
+   x += 0x9E3779B97F4A7C15ull;
+   x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+   x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+   return x ^ (x >> 31);
+}
+
+// Entry (bb, d) of the random projection matrix, uniform in [-1, 1). It is a
+// hash of the block address, so the matrix never has to be stored and is the
+// same for every run.
+static double projection(const uint64_t bb, const int d)
+{
+   return (double)(splitmix64(bb * SIMPOINT_DIMS + d) >> 11) * 0x1.0p-52 - 1.0;
+}
+
+bbv_collector_t::bbv_collector_t(const uint64_t interval_size)
+   : interval_size(interval_size)
+{
+}
+
+void bbv_collector_t::end_block()
+{
+   if (bb_len) {
+      counts[bb_start] += bb_len;
+      bb_len = 0;
+   }
+}
+
+void bbv_collector_t::end_interval()
+{
+   std::vector<double> v(SIMPOINT_DIMS, 0.0);
+   for (const auto &c : counts) {
+      const double frac = (double)c.second / (double)interval_size;
+      for (int d = 0; d < SIMPOINT_DIMS; d++)
+         v[d] += frac * projection(c.first, d);
+   }
+   bbv.push_back(v);
+   counts.clear();
+   interval_pos = 0;
+}
+
+static double dist2(const std::vector<double> &a, const std::vector<double> &b)
+{
+   double s = 0.0;
+   for (size_t d = 0; d < a.size(); d++)
+      s += (a[d] - b[d]) * (a[d] - b[d]);
+   return s;
+}
+
+struct kmeans_t {
+   std::vector<std::vector<double>> centers;
+   std::vector<int> assign;
+   double distortion;
+};
+
+// Lloyd's algorithm from k distinct random points.
+static kmeans_t kmeans(const std::vector<std::vector<double>> &x, const int k, uint64_t &rng)
+{
+   const size_t n = x.size();
+   kmeans_t km;
+   std::vector<size_t> order(n);
+   for (size_t i = 0; i < n; i++)
+      order[i] = i;
+   for (int c = 0; c < k; c++) {
+      rng = splitmix64(rng);
+      std::swap(order[c], order[c + rng % (n - c)]);
+      km.centers.push_back(x[order[c]]);
+   }
+   km.assign.assign(n, -1);
+   for (int iter = 0; iter < SIMPOINT_MAX_ITERS; iter++) {
+      bool changed = false;
+      for (size_t i = 0; i < n; i++) {
+         int best = 0;
+         double best_d = dist2(x[i], km.centers[0]);
+         for (int c = 1; c < k; c++) {
+            const double d = dist2(x[i], km.centers[c]);
+            if (d < best_d) {
+               best_d = d;
+               best = c;
+            }
+         }
+         changed |= (km.assign[i] != best);
+         km.assign[i] = best;
+      }
+      if (!changed)
+         break;
+      std::vector<std::vector<double>> sum(k, std::vector<double>(SIMPOINT_DIMS, 0.0));
+      std::vector<size_t> size(k, 0);
+      for (size_t i = 0; i < n; i++) {
+         size[km.assign[i]]++;
+         for (int d = 0; d < SIMPOINT_DIMS; d++)
+            sum[km.assign[i]][d] += x[i][d];
+      }
+      for (int c = 0; c < k; c++)
+         if (size[c])
+            for (int d = 0; d < SIMPOINT_DIMS; d++)
+               km.centers[c][d] = sum[c][d] / (double)size[c];
+   }
+   km.distortion = 0.0;
+   for (size_t i = 0; i < n; i++)
+      km.distortion += dist2(x[i], km.centers[km.assign[i]]);
+   return km;
+}
+
+// BIC of a clustering under the identical spherical Gaussian model of
+// X-means (Pelleg and Moore), as used by SimPoint.
+static double bic(const kmeans_t &km, const size_t n)
+{
+   const int k = (int)km.centers.size();
+   const double R = (double)n;
+   const double M = SIMPOINT_DIMS;
+   double variance = (n > (size_t)k) ? km.distortion / (M * (R - k)) : 0.0;
+   variance = std::max(variance, 1e-12);
+   std::vector<size_t> size(k, 0);
+   for (const int a : km.assign)
+      size[a]++;
+   double loglik = -M * (R - k) / 2.0;
+   for (int c = 0; c < k; c++)
+      if (size[c])
+         loglik += (double)size[c] * (log((double)size[c] / R) - M / 2.0 * log(2.0 * M_PI * variance));
+   const double params = (k - 1) + M * k + 1;
+   return loglik - params / 2.0 * log(R);
+}
+
+simpoint_set_t simpoint_choose(const std::vector<std::vector<double>> &vectors, const uint64_t interval_size, const int maxk, const uint64_t seed)
+{
+   simpoint_set_t s;
+   s.interval_size = interval_size;
+   s.num_intervals = vectors.size();
+   if (vectors.empty())
+      return s;
+
+   // Best clustering for each k, then the smallest k whose BIC reaches 90%
+   // of the observed BIC range. k is capped at half the intervals: as k
+   // approaches n the distortion goes to 0, and the variance floor in bic()
+   // makes the clustering that gives every interval its own cluster score
+   // best. A zero-distortion clustering ends the search; no larger k can
+   // fit better.
+   uint64_t rng = seed;
+   std::vector<kmeans_t> best;
+   std::vector<double> score;
+   const uint64_t n = vectors.size();
+   const int kmax = (int)std::min<uint64_t>(std::max(maxk, 1), std::max<uint64_t>(n / 2, 1));
+   for (int k = 1; k <= kmax; k++) {
+      kmeans_t b;
+      for (int r = 0; r < SIMPOINT_SEEDS; r++) {
+         kmeans_t km = kmeans(vectors, k, rng);
+         if (r == 0 || km.distortion < b.distortion)
+            b = km;
+      }
+      score.push_back(bic(b, n));
+      best.push_back(b);
+      if (b.distortion == 0.0)
+         break;
+   }
+   const double lo = *std::min_element(score.begin(), score.end());
+   const double hi = *std::max_element(score.begin(), score.end());
+   size_t pick = 0;
+   while (score[pick] < lo + 0.9 * (hi - lo))
+      pick++;
+   const kmeans_t &km = best[pick];
+
+   // The interval closest to each (non-empty) cluster's centroid represents
+   // it. Interval 0 cannot be warmed up, so it is only picked when it is
+   // alone in its cluster.
+   for (int c = 0; c < (int)km.centers.size(); c++) {
+      size_t members = 0;
+      size_t rep = 0;
+      double rep_d = 0.0;
+      for (size_t i = 0; i < vectors.size(); i++) {
+         if (km.assign[i] != c)
+            continue;
+         const double d = dist2(vectors[i], km.centers[c]);
+         if (members == 0 || rep == 0 || d < rep_d) {
+            rep = i;
+            rep_d = d;
+         }
+         members++;
+      }
+      if (members)
+         s.points.push_back({rep, (double)members / (double)vectors.size(), c});
+   }
+   std::sort(s.points.begin(), s.points.end(), [](const simpoint_t &a, const simpoint_t &b) { return a.interval < b.interval; });
+   for (size_t p = 0; p < s.points.size(); p++)
+      s.points[p].cluster = (int)p;
+   s.k = (int)s.points.size();
+   return s;
+}
+
+bool simpoint_write(const char *path, const simpoint_set_t &s)
+{
+   FILE *f = fopen(path, "w");
+   if (!f)
+      return false;
+   fprintf(f, "# cbp simpoints v1\n");
+   fprintf(f, "interval %llu\n", (unsigned long long)s.interval_size);
+   fprintf(f, "intervals %llu\n", (unsigned long long)s.num_intervals);
+   fprintf(f, "k %d\n", s.k);
+   for (const simpoint_t &p : s.points)
+      fprintf(f, "%llu %.6f %d\n", (unsigned long long)p.interval, p.weight, p.cluster);
+   return fclose(f) == 0;
+}
+
+bool simpoint_read(const char *path, simpoint_set_t &s)
+{
+   FILE *f = fopen(path, "r");
+   if (!f)
+      return false;
+   s = simpoint_set_t();
+   char line[256];
+   bool ok = true;
+   while (ok && fgets(line, sizeof(line), f)) {
+      unsigned long long a;
+      double w;
+      int c;
+      if (line[0] == '#' || line[0] == '\n')
+         continue;
+      if (sscanf(line, "interval %llu", &a) == 1)
+         s.interval_size = a;
+      else if (sscanf(line, "intervals %llu", &a) == 1)
+         s.num_intervals = a;
+      else if (sscanf(line, "k %d", &c) == 1)
+         s.k = c;
+      else if (sscanf(line, "%llu %lf %d", &a, &w, &c) == 3)
+         s.points.push_back({a, w, c});
+      else
+         ok = false;
+   }
+   fclose(f);
+   std::sort(s.points.begin(), s.points.end(), [](const simpoint_t &a, const simpoint_t &b) { return a.interval < b.interval; });
+   return ok && s.interval_size && !s.points.empty();
+}
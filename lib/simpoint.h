@@ -0,0 +1,87 @@
+#ifndef _SIMPOINT_H_
+#define _SIMPOINT_H_
+
+#include <inttypes.h>
+#include <vector>
+#include <unordered_map>
+
+// SimPoint-style phase sampling (-simpoint-gen / -simpoint).
+//
+// Generation is one pass over the trace without the timing model: the
+// instructions of each fixed-size interval are counted per basic block
+// (a block ends at a branch and is named by its first PC), the resulting
+// basic block vector is normalized to sum 1 and randomly projected to
+// SIMPOINT_DIMS dimensions. The projected vectors are clustered with
+// k-means for k = 1..min(maxk, n / 2), k is chosen by the Bayesian Information
+// Criterion as in SimPoint 3.0, and the interval closest to each centroid
+// is the simulation point of its cluster, weighted by the cluster's share
+// of the intervals.
+//
+// Simpoints file (text):
+//
+//    # cbp simpoints v1
+//    interval <instructions per interval>
+//    intervals <number of full intervals in the trace>
+//    k <number of clusters>
+//    <interval index> <weight> <cluster>     one line per simulation point
+//
+// Lines starting with '#' are comments.
+
+#define SIMPOINT_DIMS 15
+
+// Basic block vectors of consecutive intervals, projected as they complete.
+class bbv_collector_t {
+public:
+   bbv_collector_t(const uint64_t interval_size);
+
+   // One call per trace instruction (not per piece).
+   inline void add(const uint64_t pc, const bool is_branch)
+   {
+      if (bb_len == 0)
+         bb_start = pc;
+      bb_len++;
+      if (is_branch)
+         end_block();
+      if (++interval_pos == interval_size) {
+         end_block();
+         end_interval();
+      }
+   }
+
+   // Projected, normalized vectors of the full intervals seen so far (the
+   // trailing partial interval is dropped).
+   const std::vector<std::vector<double>> &vectors() const { return bbv; }
+   uint64_t get_interval_size() const { return interval_size; }
+
+private:
+   void end_block();
+   void end_interval();
+
+   uint64_t interval_size;
+   uint64_t interval_pos = 0;
+   uint64_t bb_start = 0;
+   uint64_t bb_len = 0;
+   std::unordered_map<uint64_t, uint64_t> counts;   // this interval: block -> instructions
+   std::vector<std::vector<double>> bbv;
+};
+
+struct simpoint_t {
+   uint64_t interval;   // index of the interval in the trace
+   double weight;       // share of the intervals in its cluster
+   int cluster;
+};
+
+struct simpoint_set_t {
+   uint64_t interval_size = 0;
+   uint64_t num_intervals = 0;
+   int k = 0;
+   std::vector<simpoint_t> points;   // sorted by interval
+};
+
+// Clusters the vectors and picks one simulation point per cluster.
+simpoint_set_t simpoint_choose(const std::vector<std::vector<double>> &vectors, const uint64_t interval_size, const int maxk, const uint64_t seed);
+
+bool simpoint_write(const char *path, const simpoint_set_t &s);
+bool simpoint_read(const char *path, simpoint_set_t &s);
+
+#endif
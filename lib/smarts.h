@@ -0,0 +1,66 @@
+#ifndef _SMARTS_H_
+#define _SMARTS_H_
+
+#include <inttypes.h>
+#include <math.h>
+
+// SMARTS-style systematic sampling (-smarts).
+//
+// The trace is cut into periods of SMARTS_PERIOD instructions. Each period
+// ends with a short detailed warmup (SMARTS_DETAIL_WARMUP instructions
+// through uarchsim_t::step(), not measured) and a measured window
+// (SMARTS_WINDOW instructions). Before that, the branch predictor and the
+// caches are kept warm by functional warming (uarchsim_t::warm(): no window,
+// execution lanes or store queue), either for the whole rest of the period
+// (the default, as in SMARTS) or, with -smarts-warmup, only for that many
+// instructions, the start of the period being skipped (trace decode only).
+//
+// Every window is one sample of CPI and MPKI. The estimates are the sample
+// means, with a normal-approximation confidence interval that is updated as
+// windows complete. With fewer than SMARTS_MIN_CI_WINDOWS windows the
+// approximation does not hold and no interval is reported.
+//
+// The interval covers sampling error only. The windows sit at the end of
+// each period, so the start of the trace, where the predictor and caches are
+// cold, is only ever functionally warmed; a full run counts that cold start
+// and the estimate does not.
+
+// z for a two-sided 95% confidence interval.
+#define SMARTS_Z 1.96
+
+// Fewest windows for which a confidence interval is reported.
+#define SMARTS_MIN_CI_WINDOWS 30
+
+// Running mean and variance of a sample (Welford).
+class sample_stat_t {
+public:
+   inline void add(const double x)
+   {
+      n++;
+      const double d = x - m;
+      m += d / (double)n;
+      m2 += d * (x - m);
+   }
+
+   uint64_t count() const { return n; }
+   double mean() const { return m; }
+   double variance() const { return (n > 1) ? m2 / (double)(n - 1) : 0.0; }
+   double stddev() const { return sqrt(variance()); }
+   // Coefficient of variation of the samples.
+   double cv() const { return (m != 0.0) ? stddev() / fabs(m) : 0.0; }
+   // Half-width of the confidence interval of the mean.
+   double half_width(const double z = SMARTS_Z) const { return (n > 1) ? z * stddev() / sqrt((double)n) : 0.0; }
+   // Samples needed for a half-width of rel_error * mean (SMARTS: n >= (z V / e)^2).
+   uint64_t samples_for(const double rel_error, const double z = SMARTS_Z) const
+   {
+      const double s = z * cv() / rel_error;
+      return (uint64_t)ceil(s * s);
+   }
+
+private:
+   uint64_t n = 0;
+   double m = 0.0;
+   double m2 = 0.0;
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "stats_writer.h"
+
+stats_writer_t::stats_writer_t(const char *path)
+{
+   f = fopen(path, "w");
+   if (!f) {
+      printf("Cannot open stats file %s\n", path);
+      exit(1);
+   }
+   const size_t len = strlen(path);
+   csv = (len >= 4) && !strcmp(path + len - 4, ".csv");
+   index = 0;
+   if (csv)
+      fprintf(f, "record,index,key,value\n");
+}
+
+stats_writer_t::~stats_writer_t()
+{
+   fclose(f);
+}
+
+void stats_writer_t::begin(const char *record, uint64_t index)
+{
+   this->record = record;
+   this->index = index;
+   if (!csv)
+      fprintf(f, "{\"record\":\"%s\",\"index\":%llu", record, (unsigned long long)index);
+}
+
+void stats_writer_t::field(const char *key, uint64_t value)
+{
+   if (csv)
+      fprintf(f, "%s,%llu,%s,%llu\n", record.c_str(), (unsigned long long)index, key, (unsigned long long)value);
+   else
+      fprintf(f, ",\"%s\":%llu", key, (unsigned long long)value);
+}
+
+void stats_writer_t::field(const char *key, double value)
+{
+   // Ratios over empty windows (e.g. MR with no branches) are written as missing values.
+   if (!isfinite(value)) {
+      if (csv)
+         fprintf(f, "%s,%llu,%s,\n", record.c_str(), (unsigned long long)index, key);
+      else
+         fprintf(f, ",\"%s\":null", key);
+      return;
+   }
+   if (csv)
+      fprintf(f, "%s,%llu,%s,%.6f\n", record.c_str(), (unsigned long long)index, key, value);
+   else
+      fprintf(f, ",\"%s\":%.6f", key, value);
+}
+
+void stats_writer_t::end()
+{
+   if (!csv)
+      fprintf(f, "}\n");
+   fflush(f);
+}
@@ -0,0 +1,34 @@
+#ifndef _STATS_WRITER_H_
+#define _STATS_WRITER_H_
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string>
+
+// Streams simulation statistics as they are produced, so long runs can be
+// monitored live (tail -f) and aggregated without scraping the text tables.
+//
+// Every record has a type (e.g. "epoch", "full", "L1") and an index (the
+// epoch number, 0 for one-off summary records) followed by named values.
+// Format is picked from the file name:
+//    *.csv  long format, one "record,index,key,value" row per value
+//    other  JSON Lines, one {"record":..,"index":..,key:value,...} object per record
+// Each record is flushed as soon as it is complete.
+class stats_writer_t {
+public:
+    stats_writer_t(const char *path);
+    ~stats_writer_t();
+
+    void begin(const char *record, uint64_t index);
+    void field(const char *key, uint64_t value);
+    void field(const char *key, double value);
+    void end();
+
+private:
+    FILE *f;
+    bool csv;
+    std::string record;
+    uint64_t index;
+};
+
+#endif
@@ -4,8 +4,10 @@
 #include <vector>
 #include <deque>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 //#include <optional>
+#include "parameters.h"
 
 #define DEF_ENUM(ENUM, NAME) _DEF_ENUM(ENUM, NAME)
 #define _DEF_ENUM(ENUM, NAME)                          \
@@ -54,9 +56,20 @@ static std::ostream& operator<<(std::ostream& stream, const PrefetcherState& s)
 }
 
 constexpr uint64_t NUM_RPT_ENTRIES = 1024;
+constexpr uint32_t RPT_NIL = ~0u;
 constexpr uint64_t PREFETCH_MULTIPLIER = 2; // 2 because when we lookahead, we are 1 behind, so need next(next(access))
-constexpr int PF_QUEUE_SIZE = 32;
+constexpr size_t PF_QUEUE_SIZE = 32;
 constexpr uint64_t CACHE_LINE_MASK = ~63lu;
+
+// RPT_ASSOC values the RPT can be split into: 0 (or NUM_RPT_ENTRIES and up) for fully
+// associative, otherwise a divisor of NUM_RPT_ENTRIES leaving a power-of-two number of sets.
+inline bool rpt_assoc_valid(const uint64_t assoc)
+{
+    if ((assoc == 0) || (assoc >= NUM_RPT_ENTRIES))
+        return true;
+    const uint64_t sets = NUM_RPT_ENTRIES / assoc;
+    return (sets * assoc == NUM_RPT_ENTRIES) && !(sets & (sets - 1));
+}
 constexpr uint64_t PF_MUST_ISSUE_BEFORE_CYCLES = 8;
 
 
@@ -67,23 +80,16 @@ struct RPTEntry
     uint64_t prev_address = 0xdeadbeef;
     uint64_t current_address = 0xdeadbeef;
     int64_t stride = -1;
-    uint64_t lru= 0;
+    // Intrusive LRU list of the entry's set: lru_prev is towards the LRU end, lru_next towards the MRU end.
+    uint32_t lru_prev = RPT_NIL;
+    uint32_t lru_next = RPT_NIL;
     uint64_t index = -1;
 
     RPTEntry() =default;
-    RPTEntry(PrefetcherState st_, uint64_t t_ , uint64_t p_ , uint64_t c_ , int64_t s_, uint64_t l_, uint64_t i_)
-    :state(st_)
-    ,tag(t_)
-    ,prev_address(p_)
-    ,current_address(c_)
-    ,stride(s_)
-    ,lru(l_)
-    ,index(i_)
-    {}
 
     friend std::ostream& operator<<(std::ostream& stream, const RPTEntry& e)
     {
-        stream << "Index:" <<std::hex << e.index << " State " << e.state << " Tag: " << std::hex << e.tag << " Prev: " << std::hex << e.prev_address << " Cur: " << std::hex << e.current_address << " Stride: " << std::hex << e.stride << " LRU: " << e.lru;
+        stream << "Index:" <<std::hex << e.index << " State " << e.state << " Tag: " << std::hex << e.tag << " Prev: " << std::hex << e.prev_address << " Cur: " << std::hex << e.current_address << " Stride: " << std::hex << e.stride << " LRU prev/next: " << std::dec << e.lru_prev << "/" << e.lru_next;
         return stream;
 
     }
@@ -117,19 +123,34 @@ struct Prefetch
     //CacheLevel level;
 };
 
+// Reference prediction table (RPT) of NUM_RPT_ENTRIES entries, fully associative by default or
+// RPT_ASSOC-way set-associative. Entries are found through a tag->slot hash map and replaced from
+// an intrusive per-set LRU list, so lookup, training and replacement are O(1) per load.
+// The fully associative configuration makes exactly the same replacement decisions as the
+// original linear-scan implementation (LRU order initially follows the entry index).
 class StridePrefetcher
 {
    public:
     void init(const uint64_t n)
     {
+        assert(n == NUM_RPT_ENTRIES);
+        assoc = ((RPT_ASSOC == 0) || (RPT_ASSOC >= n)) ? n : RPT_ASSOC;
+        num_sets = n / assoc;
+        assert(rpt_assoc_valid(RPT_ASSOC) && "RPT_ASSOC must divide the RPT into a power-of-two number of sets");
+
+        lru_head.assign(num_sets, RPT_NIL);
+        lru_tail.assign(num_sets, RPT_NIL);
         for(uint64_t i = 0; i < n; i++)
         {
-            //Initialize LRU
+            //Initialize LRU: within a set, lower ways start closer to the LRU end
             rpt[i].index = i;
-            rpt[i].lru = i;
+            lru_append(i);
         }
+        slot_of_tag.clear();
+        slot_of_tag.reserve(2 * n);
         //Clear queue of generated prefetches
         queue.clear();
+        queued_lines.clear();
     }
 
     StridePrefetcher()
@@ -137,29 +158,77 @@ class StridePrefetcher
         init(NUM_RPT_ENTRIES);
     }
 
-    uint64_t victim_way()
+    // Set s holds slots [s * assoc, (s + 1) * assoc).
+    uint64_t set_of_slot(uint64_t index) const
+    {
+        return index / assoc;
+    }
+
+    uint64_t set_of_tag(uint64_t tag) const
     {
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [](RPTEntry& e){ return !e.lru; });
-        assert((entry != rpt.end()) && "Must find a valid victim way ");
-        spdlog::debug("Prefetch: Found victim entry : {}", *entry);
+        return (tag ^ (tag >> 10)) & (num_sets - 1);
+    }
+
+    RPTEntry* find(uint64_t tag)
+    {
+        auto it = slot_of_tag.find(tag);
+        return (it == slot_of_tag.end()) ? nullptr : &rpt[it->second];
+    }
 
-        return entry->index;
+    uint64_t victim_way(uint64_t set)
+    {
+        const uint32_t victim = lru_head[set];
+        assert((victim != RPT_NIL) && "Must find a valid victim way ");
+        spdlog::debug("Prefetch: Found victim entry : {}", rpt[victim]);
+
+        return victim;
+    }
+
+    void lru_append(uint64_t index)
+    {
+        RPTEntry& e = rpt[index];
+        const uint64_t set = set_of_slot(index);
+        e.lru_prev = lru_tail[set];
+        e.lru_next = RPT_NIL;
+        if(lru_tail[set] != RPT_NIL)
+        {
+            rpt[lru_tail[set]].lru_next = index;
+        }
+        else
+        {
+            lru_head[set] = index;
+        }
+        lru_tail[set] = index;
     }
 
     void update_lru(uint64_t index)
     {
         spdlog::debug("Updating LRU Index: {}", index);
-        auto& lru_way = rpt[index];
-        std::for_each(rpt.begin(), rpt.end(), [&lru_way](RPTEntry &e) { if(e.lru > lru_way.lru){ --e.lru;} });
-        lru_way.lru = (NUM_RPT_ENTRIES - 1);
+        const uint64_t set = set_of_slot(index);
+        if(lru_tail[set] == index)
+        {
+            return;
+        }
+        // Unlink, then make it the MRU entry of its set
+        RPTEntry& e = rpt[index];
+        if(e.lru_prev != RPT_NIL)
+        {
+            rpt[e.lru_prev].lru_next = e.lru_next;
+        }
+        else
+        {
+            lru_head[set] = e.lru_next;
+        }
+        rpt[e.lru_next].lru_prev = e.lru_prev;
+        lru_append(index);
     }
 
     // Prefetches will be generated when the load is fetched as in "Effective Hardware-Based Data Prefetching for High-Performance Processors"
     // However because we train immediately, there is no need for a count variable.
     void lookahead(uint64_t la_pc, uint64_t cycle)
     {
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [la_pc](RPTEntry& e){ return e.tag == la_pc; });
-        if(entry == rpt.end())
+        RPTEntry* entry = find(la_pc);
+        if(entry == nullptr)
         {
             return;
         }
@@ -172,12 +241,17 @@ class StridePrefetcher
     void train(const PrefetchTrainingInfo & info)
     {
         spdlog::debug("Prefetcher: Training on LD {}", info);
-        auto entry = std::find_if(rpt.begin(), rpt.end(), [&info](RPTEntry& e){ return e.tag == info.pc; });
-        if(entry == rpt.end())
+        RPTEntry* entry = find(info.pc);
+        if(entry == nullptr)
         {
             //Establish a new entry
-            auto victim_index = victim_way();
+            auto victim_index = victim_way(set_of_tag(info.pc));
             auto& victim_entry = rpt[victim_index];
+            if(victim_entry.state != PrefetcherState::Invalid)
+            {
+                slot_of_tag.erase(victim_entry.tag);
+            }
+            slot_of_tag[info.pc] = victim_index;
             victim_entry.state = PrefetcherState::Initial;
             victim_entry.tag = info.pc;
             victim_entry.prev_address = 0xdeadbeef;
@@ -294,37 +368,51 @@ class StridePrefetcher
         Prefetch pf{entry.current_address + entry.stride * PREFETCH_MULTIPLIER, cycle};
         spdlog::debug("Prefetcher: Queuing a new prefetch: {} Entry {}", pf, entry);
 
-        auto it = std::find_if(queue.begin(), queue.end(), [&](const Prefetch & qpf)
+        if(queued_lines.count(pf.address & CACHE_LINE_MASK))
         {
-            return (qpf.address & CACHE_LINE_MASK) == (pf.address & CACHE_LINE_MASK);
-        });
+            spdlog::debug("Prefetcher: Dropping pf: {} because already in pf queue", pf);
+            ++stat_duplicate_pf_filtered;
+            return;
+        }
 
-        if(it == queue.end())
+        if(queue.size() >= PF_QUEUE_SIZE)
         {
-            queue.push_back(pf);
-            
-            // Make extra sure PF are sorted by generation order from oldest to youngest
-            std::sort(queue.begin(), queue.end(), [](const Prefetch & lhs, const Prefetch & rhs)
-            {
-                if(lhs.cycle_generated != rhs.cycle_generated)
-                {
-                    return lhs.cycle_generated < rhs.cycle_generated;
-                }
-                if(lhs.address != rhs.address)
-                {
-                    return lhs.address < rhs.address;
-                }
-                return false;
-            });
+            spdlog::debug("Prefetcher: Dropping pf: {} because pf queue is full", pf);
+            ++stat_queue_full;
+            return;
+        }
 
-            ++stat_generated;
+        // Keep PF sorted by generation order from oldest to youngest (ties broken by address).
+        // Generation cycles are nearly monotonic, so the insertion point is found by walking back from the youngest end.
+        auto pos = queue.end();
+        while(pos != queue.begin() && pf_younger(*std::prev(pos), pf))
+        {
+            --pos;
         }
-        else
+        queue.insert(pos, pf);
+        ++queued_lines[pf.address & CACHE_LINE_MASK];
+
+        ++stat_generated;
+    }
+
+    static bool pf_younger(const Prefetch & lhs, const Prefetch & rhs)
+    {
+        if(lhs.cycle_generated != rhs.cycle_generated)
         {
-            spdlog::debug("Prefetcher: Dropping pf: {} because already in pf queue", pf);
-            ++stat_duplicate_pf_filtered;
+            return lhs.cycle_generated > rhs.cycle_generated;
         }
-        
+        return lhs.address > rhs.address;
+    }
+
+    void pop_front()
+    {
+        auto line = queued_lines.find(queue.front().address & CACHE_LINE_MASK);
+        assert(line != queued_lines.end());
+        if(--line->second == 0)
+        {
+            queued_lines.erase(line);
+        }
+        queue.pop_front();
     }
 
     bool issue(Prefetch& p, uint64_t cycle)
@@ -333,7 +421,7 @@ class StridePrefetcher
         {
             spdlog::debug("Dropping pf because too old (created at cycle {}, current fetch cycle {})", queue.front().cycle_generated, cycle);
             ++stat_dropped_untimely_pf;
-            queue.pop_front();
+            pop_front();
         }
 
         if(!queue.empty())
@@ -341,7 +429,7 @@ class StridePrefetcher
             p = queue.front();
             if(p.cycle_generated <= cycle)
             {
-                queue.pop_front();
+                pop_front();
                 ++stat_issued;
                 return true;
             }
@@ -351,10 +439,12 @@ class StridePrefetcher
         return false;
     }
 
+    // p was the oldest prefetch when issued, so it goes back at the front.
     void put_back(const Prefetch & p)
     {
         ++stat_put_back;
         queue.push_front(p);
+        ++queued_lines[p.address & CACHE_LINE_MASK];
     }
 
     uint64_t get_oldest_pf_cycle() const
@@ -375,21 +465,49 @@ class StridePrefetcher
         std::cout << "Num Prefetches generated :" << stat_generated << std::endl;
         std::cout << "Num Prefetches issued :" << stat_issued << std::endl;
         std::cout << "Num Prefetches filtered by PF queue :" << stat_duplicate_pf_filtered << std::endl;
+        std::cout << "Num Prefetches dropped because PF queue full :" << stat_queue_full << std::endl;
         std::cout << "Num untimely prefetches dropped from PF queue :" << stat_dropped_untimely_pf << std::endl;
         std::cout << "Num prefetches not issued LDST contention :" << stat_put_back << std::endl;
         std::cout << "Num prefetches not issued stride 0 :" << stat_stride_zero << std::endl;
     }
+
+    // Parallel interval simulation (-par): zero the stats after warmup, add
+    // another prefetcher's stats into these.
+    void reset_stats()
+    {
+        stat_trainings = stat_generated = stat_issued = stat_duplicate_pf_filtered = 0;
+        stat_queue_full = stat_dropped_untimely_pf = stat_put_back = stat_stride_zero = 0;
+    }
+    void add_stats(const StridePrefetcher & other)
+    {
+        stat_trainings += other.stat_trainings;
+        stat_generated += other.stat_generated;
+        stat_issued += other.stat_issued;
+        stat_duplicate_pf_filtered += other.stat_duplicate_pf_filtered;
+        stat_queue_full += other.stat_queue_full;
+        stat_dropped_untimely_pf += other.stat_dropped_untimely_pf;
+        stat_put_back += other.stat_put_back;
+        stat_stride_zero += other.stat_stride_zero;
+    }
     private:
     std::array<RPTEntry, NUM_RPT_ENTRIES> rpt;
-    uint64_t lru_info;
-
-    //Queue to store generated prefetches
+    uint64_t assoc;
+    uint64_t num_sets;
+    // LRU and MRU ends of each set's LRU list
+    std::vector<uint32_t> lru_head;
+    std::vector<uint32_t> lru_tail;
+    std::unordered_map<uint64_t, uint32_t> slot_of_tag;
+
+    //Queue to store generated prefetches, oldest first, at most PF_QUEUE_SIZE entries
     std::deque<Prefetch> queue;
+    //Cache lines in the queue (with multiplicity) for duplicate filtering
+    std::unordered_map<uint64_t, uint32_t> queued_lines;
     //Stats
     uint64_t stat_trainings = 0;
     uint64_t stat_generated = 0;
     uint64_t stat_issued = 0;
     uint64_t stat_duplicate_pf_filtered = 0;
+    uint64_t stat_queue_full = 0;
     uint64_t stat_dropped_untimely_pf = 0;
     uint64_t stat_put_back = 0;
     uint64_t stat_stride_zero = 0;
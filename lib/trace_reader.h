@@ -73,6 +73,7 @@
 #include <cassert>
 #include "sim_common_structs.h"
 #include "./gzstream.h"
+#include "profiler.h"
 
 // This structure is used by CBP's simulator.
 // Adapt for your own needs.
@@ -359,7 +360,24 @@ struct TraceReader
         }
     };
 
-    gz::igzstream * dpressed_input;
+    // Read-only view of a decompressed trace image.
+    struct image_streambuf : std::streambuf
+    {
+        image_streambuf(const std::string & image, size_t offset)
+        {
+            char * base = const_cast<char *>(image.data());
+            setg(base, base + std::min(offset, image.size()), base + image.size());
+        }
+        size_t pos() const { return gptr() - eback(); }
+    };
+
+    std::istream * dpressed_input;
+    // Non-null when reading from a caller-owned, already decompressed image.
+    image_streambuf * image_buf = nullptr;
+    // Non-null when reading from a stream buffer the reader owns (-trace-shm).
+    std::streambuf * stream_buf = nullptr;
+    // Suppress progress prints (cbp-sweep runs many readers at once).
+    bool quiet = false;
 
     // Buffer to hold trace instruction information
     Instr mInstr;
@@ -396,9 +414,35 @@ struct TraceReader
     // Note that there is no check for trace existence, so modify to suit your needs.
     TraceReader(const char * trace_name)
     {
-        dpressed_input = new gz::igzstream();
-        dpressed_input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+        gz::igzstream * gz_input = new gz::igzstream();
+        gz_input->open(trace_name, std::ios_base::in | std::ios_base::binary);
+        dpressed_input = gz_input;
+        reset_bookkeeping();
+    }
+
+    // Reads from a decompressed trace image (see load_trace_image()). The
+    // image is not copied and must outlive the reader, so several readers can
+    // share one image. offset is the byte offset of the first instruction to
+    // read; it must be an instruction boundary (see trace_index_t).
+    TraceReader(const std::string & image, bool quiet_reader, size_t offset = 0)
+    {
+        image_buf = new image_streambuf(image, offset);
+        dpressed_input = new std::istream(image_buf);
+        quiet = quiet_reader;
+        reset_bookkeeping();
+    }
+
+    // Reads decompressed trace bytes from buf, which the reader deletes.
+    TraceReader(std::streambuf * buf, bool quiet_reader)
+    {
+        stream_buf = buf;
+        dpressed_input = new std::istream(stream_buf);
+        quiet = quiet_reader;
+        reset_bookkeeping();
+    }
 
+    void reset_bookkeeping()
+    {
         mTotalPieces = 0;
         mMemPieces = 0;
         mCrackRegIdx = 0;
@@ -413,8 +457,11 @@ struct TraceReader
     {
         if(dpressed_input)
             delete dpressed_input;
+        delete image_buf;
+        delete stream_buf;
 
-        std::cout  << " Read " << nInstr << " instrs " << std::endl;
+        if(!quiet)
+            std::cout  << " Read " << nInstr << " instrs " << std::endl;
     }
 
     // This is the main API function
@@ -423,6 +470,7 @@ struct TraceReader
     //              ... process instr
     db_t  *get_inst()
     {
+        PROF_SCOPE(TRACE_DECODE);
         // If we are creating several pieces from a single trace instructions and some are left to create,
         // mProcessedPieces != mTotalPieces
         if(mProcessedPieces != mTotalPieces)
@@ -445,6 +493,27 @@ struct TraceReader
 
     }
 
+    // Reads the next trace instruction into mInstr without creating its pieces
+    // (fast-forward, or a functional pass that only needs mInstr). Must be
+    // called between instructions, i.e. after get_inst() returned the last
+    // piece of the previous one. Returns false at the end of the trace.
+    bool skip_instr()
+    {
+        assert(mProcessedPieces == mTotalPieces);
+        if(!readInstr())
+            return false;
+        mProcessedPieces = mTotalPieces;
+        return true;
+    }
+
+    // Byte offset of the next trace instruction in the image; only meaningful
+    // for image readers, between instructions.
+    size_t image_offset() const
+    {
+        assert(image_buf && mProcessedPieces == mTotalPieces);
+        return image_buf->pos();
+    }
+
     // Creates a new object and populate it with trace information.
     // Subsequent calls to populateNewInstr() will take care of creating multiple pieces for a trace instruction
     // that has several outputs or 128-bit output.
@@ -699,7 +768,8 @@ struct TraceReader
 
         if(dpressed_input->eof())
         {
-            std::cout<<"EOF"<<std::endl;
+            if(!quiet)
+                std::cout<<"EOF"<<std::endl;
             return false;
         }
 
@@ -870,9 +940,63 @@ struct TraceReader
 
         nInstr++;
 
-        if(nInstr % 5000000 == 0)
+        if(!quiet && nInstr % 5000000 == 0)
             std::cout << nInstr << " instrs " << std::endl;
 
         return true;
     }
 };
+
+// Decompress a whole .gz trace into memory so that several simulations can
+// read it without each paying for inflate. Returns false if the file cannot
+// be opened.
+inline bool load_trace_image(const char * trace_name, std::string & image)
+{
+    gz::igzstream input;
+    input.open(trace_name, std::ios_base::in | std::ios_base::binary);
+    if(!input.good())
+        return false;
+
+    image.clear();
+    char chunk[1 << 16];
+    while(input.read(chunk, sizeof(chunk)) || input.gcount() > 0)
+        image.append(chunk, input.gcount());
+    return true;
+}
+
+// Seek index of a trace image: the byte offset of every stride-th instruction,
+// built by one decode pass (trace instructions have no inter-instruction
+// state, so a reader can start at any instruction boundary).
+struct trace_index_t
+{
+    uint64_t stride = 0;
+    uint64_t num_instr = 0;
+    std::vector<size_t> offsets;    // offsets[i]: instruction i * stride
+
+    // A reader positioned at trace instruction n (n <= num_instr).
+    TraceReader * reader_at(const std::string & image, const uint64_t n) const
+    {
+        assert(n <= num_instr);
+        TraceReader * reader = new TraceReader(image, true/*quiet*/, offsets[n / stride]);
+        for(uint64_t i = 0; i < n % stride; i++)
+            reader->skip_instr();
+        return reader;
+    }
+};
+
+inline trace_index_t build_trace_index(const std::string & image, const uint64_t stride)
+{
+    assert(stride > 0);
+    trace_index_t index;
+    index.stride = stride;
+    TraceReader reader(image, true/*quiet*/);
+    while(true)
+    {
+        if(index.num_instr % stride == 0)
+            index.offsets.push_back(reader.image_offset());
+        if(!reader.skip_instr())
+            break;
+        index.num_instr++;
+    }
+    return index;
+}
@@ -0,0 +1,357 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <signal.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include "gzstream.h"
+#include "trace_shm.h"
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#define TRACE_SHM_MAGIC 0x676e697274706263ull   // "cbptring"
+#define TRACE_SHM_VERSION 1
+#define TRACE_SHM_MAX_CONSUMERS 256
+// Futex waits time out after this long so that dead peers are noticed.
+#define TRACE_SHM_POLL_MS 100
+// How long a consumer waits for the broker to create the segment.
+#define TRACE_SHM_ATTACH_TIMEOUT_S 60
+// The broker inflates at most this much before publishing it.
+#define TRACE_SHM_CHUNK (1 << 20)
+
+// Consumer slots only move FREE -> ATTACHED -> DETACHED, so a slot's tail is
+// never reused.
+enum { SLOT_FREE = 0, SLOT_ATTACHED = 1, SLOT_DETACHED = 2 };
+
+struct trace_shm_consumer_t {
+   std::atomic<uint32_t> state;
+   std::atomic<int32_t> pid;
+   std::atomic<uint64_t> tail;   // ring bytes consumed
+};
+
+// The segment: this header, then the ring at TRACE_SHM_RING_OFFSET. Positions
+// (head, tail) count bytes since the start of the trace; byte p of the trace
+// is at ring offset p % capacity.
+struct trace_shm_t {
+   std::atomic<uint64_t> magic;   // stored last by the broker
+   uint32_t version;
+   int32_t broker_pid;
+   uint64_t capacity;
+   std::atomic<uint32_t> started;   // streaming; consumers that attach now are refused
+   std::atomic<uint32_t> eof;       // head is final
+   std::atomic<uint64_t> head;      // bytes published
+   std::atomic<uint32_t> data_seq;  // futex word: head or eof changed
+   std::atomic<uint32_t> space_seq; // futex word: a consumer attached, consumed or detached
+   std::atomic<uint32_t> data_waiters;
+   std::atomic<uint32_t> space_waiters;
+   trace_shm_consumer_t consumers[TRACE_SHM_MAX_CONSUMERS];
+};
+
+static const size_t TRACE_SHM_RING_OFFSET = (sizeof(trace_shm_t) + 4095) & ~(size_t)4095;
+
+static char *ring(trace_shm_t *s)
+{
+   return (char *)s + TRACE_SHM_RING_OFFSET;
+}
+
+// POSIX shared memory names start with a slash.
+static std::string shm_path(const char *name)
+{
+   return (name[0] == '/') ? std::string(name) : std::string("/") + name;
+}
+
+static bool process_exited(const int32_t pid)
+{
+   return pid > 0 && kill(pid, 0) < 0 && errno == ESRCH;
+}
+
+// Bumps the sequence word and wakes its sleepers, if any.
+static void notify(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiters)
+{
+   seq.fetch_add(1);
+   if (waiters.load())
+      syscall(SYS_futex, (uint32_t *)&seq, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// Sleeps until seq changes, unless ready() already holds, or until the poll
+// timeout. Registering as a waiter before reading seq and testing ready()
+// pairs with notify(): either the notifier sees the waiter, or the waiter
+// sees the new state.
+template <typename F>
+static void wait_for(std::atomic<uint32_t> &seq, std::atomic<uint32_t> &waiters, F ready)
+{
+   waiters.fetch_add(1);
+   const uint32_t s = seq.load();
+   if (!ready()) {
+      struct timespec timeout = {0, TRACE_SHM_POLL_MS * 1000000L};
+      syscall(SYS_futex, (uint32_t *)&seq, FUTEX_WAIT, s, &timeout, nullptr, 0);
+   }
+   waiters.fetch_sub(1);
+}
+
+// Detaches consumers whose process is gone.
+static void reap_consumers(trace_shm_t *s)
+{
+   for (int c = 0; c < TRACE_SHM_MAX_CONSUMERS; c++) {
+      trace_shm_consumer_t &tc = s->consumers[c];
+      if (tc.state.load() == SLOT_ATTACHED && process_exited(tc.pid.load())) {
+         tc.state.store(SLOT_DETACHED);
+         fprintf(stderr, "Warning: -trace-serve: consumer %d exited without detaching.\n", tc.pid.load());
+      }
+   }
+}
+
+static uint64_t attached_consumers(trace_shm_t *s)
+{
+   uint64_t n = 0;
+   for (int c = 0; c < TRACE_SHM_MAX_CONSUMERS; c++)
+      n += (s->consumers[c].state.load() == SLOT_ATTACHED);
+   return n;
+}
+
+// Position of the slowest attached consumer (head if there is none).
+static uint64_t min_tail(trace_shm_t *s, const uint64_t head)
+{
+   uint64_t m = head;
+   for (int c = 0; c < TRACE_SHM_MAX_CONSUMERS; c++)
+      if (s->consumers[c].state.load() == SLOT_ATTACHED)
+         m = std::min(m, s->consumers[c].tail.load());
+   return m;
+}
+
+// The segment name is removed if the broker is interrupted.
+static std::string serving_path;
+
+static void serve_signal(int sig)
+{
+   shm_unlink(serving_path.c_str());
+   _exit(128 + sig);
+}
+
+int trace_shm_serve(const char *name, const char *trace_name, const uint64_t consumers, const uint64_t window)
+{
+   if (consumers == 0 || consumers > TRACE_SHM_MAX_CONSUMERS) {
+      printf("-trace-serve-consumers must be between 1 and %d.\n", TRACE_SHM_MAX_CONSUMERS);
+      exit(1);
+   }
+   if (window < TRACE_SHM_CHUNK) {
+      printf("-trace-serve-window must be at least %d bytes.\n", TRACE_SHM_CHUNK);
+      exit(1);
+   }
+   gz::igzstream input;
+   input.open(trace_name, std::ios_base::in | std::ios_base::binary);
+   if (!input.good()) {
+      printf("-trace-serve: cannot read trace %s\n", trace_name);
+      exit(1);
+   }
+
+   serving_path = shm_path(name);
+   const int fd = shm_open(serving_path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+   if (fd < 0) {
+      printf("-trace-serve: cannot create shared memory %s: %s\n", serving_path.c_str(), strerror(errno));
+      exit(1);
+   }
+   signal(SIGINT, serve_signal);
+   signal(SIGTERM, serve_signal);
+   const size_t map_size = TRACE_SHM_RING_OFFSET + window;
+   void *mem = MAP_FAILED;
+   if (ftruncate(fd, map_size) == 0)
+      mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mem == MAP_FAILED) {
+      printf("-trace-serve: cannot map %zu bytes of shared memory: %s\n", map_size, strerror(errno));
+      shm_unlink(serving_path.c_str());
+      exit(1);
+   }
+   trace_shm_t *s = new (mem) trace_shm_t();
+   s->version = TRACE_SHM_VERSION;
+   s->broker_pid = getpid();
+   s->capacity = window;
+   s->magic.store(TRACE_SHM_MAGIC);
+
+   printf("Trace broker %s: waiting for %llu consumers (cbp -trace-shm %s ...)\n", serving_path.c_str(), (unsigned long long)consumers, name);
+   fflush(stdout);
+   while (attached_consumers(s) < consumers) {
+      wait_for(s->space_seq, s->space_waiters, [&]() { return attached_consumers(s) >= consumers; });
+      reap_consumers(s);
+   }
+   s->started.store(1);
+
+   const auto t_start = std::chrono::steady_clock::now();
+   double stall_seconds = 0.0;
+   uint64_t head = 0;
+   while (input.good() && attached_consumers(s) > 0) {
+      const uint64_t space = window - (head - min_tail(s, head));
+      if (space == 0) {
+         // Backpressure: the slowest consumer is a whole window behind.
+         const auto t_stall = std::chrono::steady_clock::now();
+         while (head - min_tail(s, head) == window) {
+            wait_for(s->space_seq, s->space_waiters, [&]() { return head - min_tail(s, head) < window; });
+            reap_consumers(s);
+         }
+         stall_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - t_stall).count();
+         continue;
+      }
+      const uint64_t off = head % window;
+      const uint64_t n = std::min({space, window - off, (uint64_t)TRACE_SHM_CHUNK});
+      input.read(ring(s) + off, n);
+      head += input.gcount();
+      s->head.store(head);
+      notify(s->data_seq, s->data_waiters);
+   }
+   s->eof.store(1);
+   notify(s->data_seq, s->data_waiters);
+   const double serve_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+
+   while (attached_consumers(s) > 0) {
+      wait_for(s->space_seq, s->space_waiters, [&]() { return attached_consumers(s) == 0; });
+      reap_consumers(s);
+   }
+   shm_unlink(serving_path.c_str());
+   munmap(mem, map_size);
+   printf("Trace broker %s: served %llu bytes of %s to %llu consumers in %.2f s (%.2f s waiting for the slowest consumer)\n",
+          serving_path.c_str(), (unsigned long long)head, trace_name, (unsigned long long)consumers, serve_seconds, stall_seconds);
+   return 0;
+}
+
+trace_shm_streambuf::trace_shm_streambuf(const char *name)
+{
+   const std::string path = shm_path(name);
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(TRACE_SHM_ATTACH_TIMEOUT_S);
+   // The broker may not have created (or sized, or initialized) the segment yet.
+   int fd = -1;
+   struct stat st;
+   while (true) {
+      if (fd < 0)
+         fd = shm_open(path.c_str(), O_RDWR, 0);
+      if (fd < 0 && errno != ENOENT) {
+         printf("-trace-shm: cannot open shared memory %s: %s\n", path.c_str(), strerror(errno));
+         exit(1);
+      }
+      if (fd >= 0 && fstat(fd, &st) == 0 && (size_t)st.st_size > TRACE_SHM_RING_OFFSET)
+         break;
+      if (std::chrono::steady_clock::now() > deadline) {
+         printf("-trace-shm: no trace broker at %s (start one with cbp -trace-serve %s <trace>).\n", path.c_str(), name);
+         exit(1);
+      }
+      usleep(10000);
+   }
+   map_size = st.st_size;
+   void *mem = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if (mem == MAP_FAILED) {
+      printf("-trace-shm: cannot map shared memory %s: %s\n", path.c_str(), strerror(errno));
+      exit(1);
+   }
+   shm = (trace_shm_t *)mem;
+   while (shm->magic.load() != TRACE_SHM_MAGIC) {
+      if (std::chrono::steady_clock::now() > deadline) {
+         printf("-trace-shm: %s is not a trace broker segment.\n", path.c_str());
+         exit(1);
+      }
+      usleep(10000);
+   }
+   if (shm->version != TRACE_SHM_VERSION) {
+      printf("-trace-shm: %s has version %u, expected %d.\n", path.c_str(), shm->version, TRACE_SHM_VERSION);
+      exit(1);
+   }
+
+   // Claim a slot, then check that the broker has not started: it sets
+   // started before reading the slots, so one of the two sees the other.
+   slot = -1;
+   for (int c = 0; c < TRACE_SHM_MAX_CONSUMERS && slot < 0; c++) {
+      uint32_t expected = SLOT_FREE;
+      if (shm->consumers[c].state.compare_exchange_strong(expected, SLOT_ATTACHED))
+         slot = c;
+   }
+   if (slot < 0) {
+      printf("-trace-shm: %s has no free consumer slot.\n", path.c_str());
+      exit(1);
+   }
+   shm->consumers[slot].pid.store(getpid());
+   if (shm->started.load()) {
+      shm->consumers[slot].state.store(SLOT_DETACHED);
+      notify(shm->space_seq, shm->space_waiters);
+      printf("-trace-shm: the broker at %s has already started streaming; raise its -trace-serve-consumers or start a new one.\n", path.c_str());
+      exit(1);
+   }
+   notify(shm->space_seq, shm->space_waiters);
+   setg(nullptr, nullptr, nullptr);
+}
+
+trace_shm_streambuf::~trace_shm_streambuf()
+{
+   shm->consumers[slot].state.store(SLOT_DETACHED);
+   notify(shm->space_seq, shm->space_waiters);
+   munmap(shm, map_size);
+}
+
+trace_shm_streambuf::int_type trace_shm_streambuf::underflow()
+{
+   // The whole get area has been read: hand it back to the broker.
+   pos += egptr() - eback();
+   trace_shm_consumer_t &me = shm->consumers[slot];
+   me.tail.store(pos);
+   notify(shm->space_seq, shm->space_waiters);
+
+   uint64_t head;
+   while (true) {
+      // eof is stored after the last head, so load it first.
+      const bool eof = shm->eof.load();
+      head = shm->head.load();
+      if (head > pos)
+         break;
+      if (eof)
+         return traits_type::eof();
+      wait_for(shm->data_seq, shm->data_waiters, [&]() { return shm->head.load() > pos || shm->eof.load(); });
+      if (process_exited(shm->broker_pid)) {
+         printf("-trace-shm: the trace broker exited before the end of the trace.\n");
+         exit(1);
+      }
+   }
+   // Take at most a quarter of the ring so the broker can refill behind us.
+   const uint64_t capacity = shm->capacity;
+   const uint64_t off = pos % capacity;
+   const uint64_t n = std::min({head - pos, capacity - off, capacity / 4});
+   char *base = ring(shm) + off;
+   setg(base, base, base + n);
+   return traits_type::to_int_type(*gptr());
+}
+
+#else
+
+int trace_shm_serve(const char *name, const char *trace_name, const uint64_t consumers, const uint64_t window)
+{
+   printf("-trace-serve is only supported on Linux.\n");
+   exit(1);
+}
+
+trace_shm_streambuf::trace_shm_streambuf(const char *name)
+{
+   printf("-trace-shm is only supported on Linux.\n");
+   exit(1);
+}
+
+trace_shm_streambuf::~trace_shm_streambuf()
+{
+}
+
+trace_shm_streambuf::int_type trace_shm_streambuf::underflow()
+{
+   return traits_type::eof();
+}
+
+#endif
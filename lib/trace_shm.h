@@ -0,0 +1,47 @@
+#ifndef _TRACE_SHM_H_
+#define _TRACE_SHM_H_
+
+#include <inttypes.h>
+#include <stddef.h>
+#include <streambuf>
+
+// Shared-memory trace broker (-trace-serve / -trace-shm).
+//
+// One broker process inflates a .gz trace into a ring buffer in POSIX shared
+// memory, and any number of cbp processes on the same host read the trace
+// from the ring instead of each inflating it (inflate is about two thirds of
+// the cost of reading a trace). Consumers still decode the trace records
+// themselves, so every TraceReader use (skip_instr(), mInstr) works unchanged.
+//
+// The broker creates the segment, waits for TRACE_SERVE_CONSUMERS consumers
+// to attach, then streams the trace and refuses consumers that attach late.
+// The ring size is the lag window: the fastest consumer can be at most that
+// many bytes ahead of the slowest one, and the broker blocks (backpressure)
+// until the slowest one frees space. Both sides sleep on futexes in the
+// segment, with a timeout so that a consumer that dies without detaching
+// does not stall the others, and a consumer notices a dead broker.
+
+// Broker: serves trace_name through the segment `name` to `consumers`
+// consumers with a ring of `window` bytes. Returns the process exit code.
+int trace_shm_serve(const char *name, const char *trace_name, const uint64_t consumers, const uint64_t window);
+
+struct trace_shm_t;
+
+// Consumer: the trace bytes of the segment `name`, for TraceReader. Waits for
+// the broker to create the segment; exits if it cannot attach.
+class trace_shm_streambuf : public std::streambuf {
+public:
+   trace_shm_streambuf(const char *name);
+   ~trace_shm_streambuf();
+
+protected:
+   int_type underflow() override;
+
+private:
+   trace_shm_t *shm;
+   size_t map_size;
+   int slot;
+   uint64_t pos = 0;   // ring bytes consumed up to eback()
+};
+
+#endif
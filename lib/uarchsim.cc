@@ -37,6 +37,19 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "resource_schedule.h"
 #include "uarchsim.h"
 #include "parameters.h"
+#include "stats_writer.h"
+#include "profiler.h"
+#include "perf_counters.h"
+#include "predictor_type.h"
+#include "../reference/reference_predictors.h"
+
+// Pipeline events the predictor listens to (CBP_EVENTS_CONSUMED in cbp.h).
+// Stages and DecodeInfo/ExecuteInfo fields nobody consumes are not modeled.
+static constexpr bool cbp_consumes(const unsigned events)
+{
+   return (CBP_EVENTS_CONSUMED & events) != 0;
+}
+static constexpr bool cbp_needs_operands = cbp_consumes(CBP_EVENT_DECODE | CBP_EVENT_AGEN | CBP_EVENT_COMMIT | CBP_INFO_OPERANDS);
 
 //uarchsim_t::uarchsim_t():window(WINDOW_SIZE),
 uarchsim_t::uarchsim_t()
@@ -71,6 +84,16 @@ uarchsim_t::uarchsim_t()
    num_uop = 0;
    cycle = 0;
 
+   if (STATS_FILE)
+      stats_out = new stats_writer_t(STATS_FILE);
+
+   if (reference_prefetcher_selected())
+      REF_PF = new_reference_stride_prefetcher();
+
+   prof_begin();
+   if (PERF_ENABLE)
+      perf = new perf_counters_t;
+
    num_insts_per_epoch.clear();
    num_cycles_per_epoch.clear();
    last_epoch_end_cycle = 0;
@@ -84,9 +107,13 @@ uarchsim_t::uarchsim_t()
    // stats
    num_load = 0;
    num_load_sqmiss = 0;
+   cycles_on_wrong_path = 0;
 }
 
 uarchsim_t::~uarchsim_t() {
+   delete stats_out;
+   delete perf;
+   delete REF_PF;
 }
 
 void uarchsim_t::end_current_begin_new_epoch(const bool first_epoch, const bool last_epoch, const uint64_t epoch_end_cycle)
@@ -96,6 +123,18 @@ void uarchsim_t::end_current_begin_new_epoch(const bool first_epoch, const bool
         assert(epoch_end_cycle > last_epoch_end_cycle);
         // update cycles for the previous epoch
         num_cycles_per_epoch.back() = epoch_end_cycle - last_epoch_end_cycle;
+        if(perf)
+            perf->end_epoch();
+
+        if(stats_out)
+        {
+            const size_t epoch = num_insts_per_epoch.size() - 1;
+            stats_out->begin("epoch", epoch);
+            stats_out->field("instr", num_insts_per_epoch.back());
+            stats_out->field("cycles", num_cycles_per_epoch.back());
+            BP.write_epoch_stats(*stats_out, epoch);
+            stats_out->end();
+        }
     }
 
     last_epoch_end_cycle = epoch_end_cycle;
@@ -214,6 +253,9 @@ void uarchsim_t::populate_exec_info(db_t *inst)
     }
     _current_execute_info.next_pc = inst->next_pc;
 
+    if (!cbp_needs_operands)
+        return;
+
     if(inst->is_load || inst->is_store)
     {
         _current_execute_info.mem_va.emplace(inst->addr);
@@ -232,6 +274,9 @@ void uarchsim_t::populate_decode_info(db_t *inst)
     _current_decode_info.reset();
     _current_decode_info.insn_class = inst->insn_class;
 
+    if (!cbp_needs_operands)
+        return;
+
     if (inst->A.valid) {
         assert(inst->A.log_reg < RFSIZE);
         _current_decode_info.src_reg_info.push_back(inst->A.log_reg);
@@ -279,7 +324,7 @@ void uarchsim_t::step(db_t *inst)
 ////////////////////////
 // Manage DQ
 ////////////////////////
-void uarchsim_t::eval_decode(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_cycle) 
+void uarchsim_t::eval_decode(bool& activity_observed, const uint64_t current_cycle)
 {
    if(!DQ.empty())
    {
@@ -309,7 +354,7 @@ void uarchsim_t::eval_decode(std::ostream& activity_trace, bool& activity_observ
 ////////////////////////
 // Manage AGEN
 ////////////////////////
-void uarchsim_t::eval_aq(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_cycle) 
+void uarchsim_t::eval_aq(bool& activity_observed, const uint64_t current_cycle)
 {
    auto aq_it = AQ.begin();
    while(aq_it != AQ.end())
@@ -323,7 +368,8 @@ void uarchsim_t::eval_aq(std::ostream& activity_trace, bool& activity_observed,
            assert(current_cycle > window_entry.decode_cycle);
            assert(current_cycle <= window_entry.exec_cycle);
            notify_agen_complete(window_entry.seq_no, window_entry.piece, window_entry.PC, window_entry.exec_info.dec_info, window_entry.exec_info.mem_va.value(), window_entry.exec_info.mem_sz.value(), current_cycle);
-           activity_trace<<current_cycle<<"::AGEN:"<<window_entry<<"\n";
+           if (LOG_LEVEL != 0)
+               activity_trace<<current_cycle<<"::AGEN:"<<window_entry<<"\n";
            activity_observed = true;
            aq_it = AQ.erase(aq_it);
        }
@@ -338,7 +384,7 @@ void uarchsim_t::eval_aq(std::ostream& activity_trace, bool& activity_observed,
 ////////////////////////
 // Manage Execute
 ////////////////////////
-void uarchsim_t::eval_exec(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_cycle) 
+void uarchsim_t::eval_exec(bool& activity_observed, const uint64_t current_cycle)
 {
    auto eq_it = EQ.begin();
    while(eq_it != EQ.end())
@@ -349,8 +395,12 @@ void uarchsim_t::eval_exec(std::ostream& activity_trace, bool& activity_observed
        {
            const auto& window_entry = locate_entry_in_window(seq_no, piece);
            assert(window_entry.exec_cycle == exec_cycle);
-           notify_instr_execute_resolve(window_entry.seq_no, window_entry.piece, window_entry.PC, window_entry.pred_taken, window_entry.exec_info, current_cycle);
-           activity_trace<<current_cycle<<"::Executed:"<<window_entry<<"\n";
+           {
+               PROF_SCOPE(COND_UPDATE);
+               notify_instr_execute_resolve(window_entry.seq_no, window_entry.piece, window_entry.PC, window_entry.pred_taken, window_entry.exec_info, current_cycle);
+           }
+           if (LOG_LEVEL != 0)
+               activity_trace<<current_cycle<<"::Executed:"<<window_entry<<"\n";
            activity_observed = true;
            eq_it = EQ.erase(eq_it);
        }
@@ -364,30 +414,51 @@ void uarchsim_t::eval_exec(std::ostream& activity_trace, bool& activity_observed
 /////////////////////////////
 // Manage window: retire.
 /////////////////////////////
-void uarchsim_t::eval_retire(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_cycle) 
+void uarchsim_t::eval_retire(bool& activity_observed, const uint64_t current_cycle)
 {
    while (!window.empty() && (current_cycle >= window.front().retire_cycle)) {
       //window_t w = window.pop();
       window_t w = window.front();
-      activity_trace<<current_cycle<<"::Retired:"<<w<<"\n";
+      if (LOG_LEVEL != 0)
+         activity_trace<<current_cycle<<"::Retired:"<<w<<"\n";
       activity_observed = true;
 
       //window.pop();
       window.pop_front();
-      notify_instr_commit(w.seq_no, w.piece, w.PC, w.pred_taken, w.exec_info, current_cycle);
+      if (cbp_consumes(CBP_EVENT_COMMIT))
+      {
+         PROF_SCOPE(COND_UPDATE);
+         notify_instr_commit(w.seq_no, w.piece, w.PC, w.pred_taken, w.exec_info, current_cycle);
+      }
       if (VP_ENABLE && !VP_PERFECT)
          updatePredictor(w.seq_no, w.addr, w.value, w.latency);
    }
 }
 
-void uarchsim_t::step(db_t *inst) 
+void uarchsim_t::eval_cycle(bool& activity_observed, const uint64_t current_cycle)
+{
+   if (cbp_consumes(CBP_EVENT_DECODE))
+      eval_decode(activity_observed, current_cycle);
+   if (cbp_consumes(CBP_EVENT_AGEN))
+      eval_aq(activity_observed, current_cycle);
+   if (cbp_consumes(CBP_EVENT_EXECUTE_RESOLVE))
+      eval_exec(activity_observed, current_cycle);
+   eval_retire(activity_observed, current_cycle);
+}
+
+void uarchsim_t::step(db_t *inst)
 {
+   PROF_SCOPE(UARCH_STEP);
    spdlog::debug("Stepping, FC: {}",fetch_cycle);
    bool activity_observed = false;
-   std::ostringstream activity_trace;
+   const bool log_activity = (LOG_LEVEL != 0);
+   if (log_activity)
+   {
+      activity_trace.str("");
+      activity_trace.clear();
+   }
 
    // Preliminary step: determine which piece of the instruction this is.
-   static uint8_t piece = UINT8_MAX;
    //static uint64_t prev_pc = 0xdeadbeef;
    piece = (piece == UINT8_MAX) ? 0 : (piece + 1);
    //prev_pc = inst->pc;
@@ -399,10 +470,7 @@ void uarchsim_t::step(db_t *inst)
        uint64_t temp_fetch_cycle = previous_fetch_cycle;
        while(temp_fetch_cycle <= fetch_cycle)
        {
-           eval_decode(activity_trace, activity_observed, temp_fetch_cycle);
-           eval_aq(activity_trace, activity_observed, temp_fetch_cycle);
-           eval_exec(activity_trace, activity_observed, temp_fetch_cycle);
-           eval_retire(activity_trace, activity_observed, temp_fetch_cycle);
+           eval_cycle(activity_observed, temp_fetch_cycle);
            temp_fetch_cycle++;
        }
    }
@@ -429,10 +497,7 @@ void uarchsim_t::step(db_t *inst)
           uint64_t temp_fetch_cycle = fetch_cycle;
           while(temp_fetch_cycle <= next_fetch_cycle)
           {
-              eval_decode(activity_trace, activity_observed, temp_fetch_cycle);
-              eval_aq(activity_trace, activity_observed, temp_fetch_cycle);
-              eval_exec(activity_trace, activity_observed, temp_fetch_cycle);
-              eval_retire(activity_trace, activity_observed, temp_fetch_cycle);
+              eval_cycle(activity_observed, temp_fetch_cycle);
               temp_fetch_cycle++;
           }
           fetch_cycle = next_fetch_cycle;
@@ -514,14 +579,21 @@ void uarchsim_t::step(db_t *inst)
       // Train the prefetcher when the load finds out its outcome in the L1D
       if (PREFETCHER_ENABLE)
       {
+         PROF_SCOPE(PREFETCH);
          // Generate prefetches ahead of time as in "Effective Hardware-Based Data Prefetching for High-Performance Processors"
          // Instruction PC will be 4B aligned.
-         prefetcher.lookahead((inst->pc >> 2), fetch_cycle);
+         if (REF_PF)
+            REF_PF->lookahead((inst->pc >> 2), fetch_cycle);
+         else
+            prefetcher.lookahead((inst->pc >> 2), fetch_cycle);
 
          // Train the prefetcher 
          const bool hit = L1.is_hit(exec_cycle, inst->addr);
          PrefetchTrainingInfo info{inst->pc >> 2, inst->addr, 0, hit};
-         prefetcher.train(info);
+         if (REF_PF)
+            REF_PF->train(info.pc, info.address, info.size, info.miss);
+         else
+            prefetcher.train(info);
       }
 
       // Search D$ using AGEN's cycle.
@@ -576,12 +648,13 @@ void uarchsim_t::step(db_t *inst)
    // The idea is that a prefetch can go only if there is a free LDST slot "this" cycle
    // Here, "this" means all the cycles between the previous fetch cycle and the current one since all fetched ld/st will have been
    // scheduled and prefetch can correctly "steal" ld/st slots.
-   if(PREFETCHER_ENABLE)
+   if (PREFETCHER_ENABLE)
    {
+      PROF_SCOPE(PREFETCH);
       uint64_t tmp_previous_fetch_cycle;
       Prefetch p;
       bool issued;
-      while(prefetcher.issue(p, fetch_cycle))
+      while(REF_PF ? REF_PF->issue(p.address, p.cycle_generated, fetch_cycle) : prefetcher.issue(p, fetch_cycle))
       {
          tmp_previous_fetch_cycle = MAX(previous_fetch_cycle, p.cycle_generated);
          issued = false;
@@ -608,7 +681,10 @@ void uarchsim_t::step(db_t *inst)
          
          if(!issued)
          {
-            prefetcher.put_back(p);
+            if (REF_PF)
+               REF_PF->put_back(p.address, p.cycle_generated);
+            else
+               prefetcher.put_back(p);
             break;
          }
       }
@@ -676,19 +752,23 @@ void uarchsim_t::step(db_t *inst)
                ((inst->is_load || inst->is_store) ? inst->addr : 0xDEADBEEF), // addr
                ((inst->D.valid && (inst->D.log_reg != RFFLAGS)) ? inst->D.value : 0xDEADBEEF), //value
            latency}); //latency
-   activity_trace<<fetch_cycle<<"::Fetched:"<<window.back()<<" Inst:"<<*inst<<"\n";
+   if (log_activity)
+      activity_trace<<fetch_cycle<<"::Fetched:"<<window.back()<<" Inst:"<<*inst<<"\n";
    activity_observed = true;
    assert(window.size() <= window_capacity);
 
-   notify_instr_fetch(seq_no, piece, inst->pc, fetch_cycle);
+   if (cbp_consumes(CBP_EVENT_FETCH))
+      notify_instr_fetch(seq_no, piece, inst->pc, fetch_cycle);
 
-   DQ.push_back(std::make_tuple(seq_no, piece, decode_cycle));
-   if(is_mem(inst->insn_class))
+   if (cbp_consumes(CBP_EVENT_DECODE))
+      DQ.push_back(std::make_tuple(seq_no, piece, decode_cycle));
+   if(cbp_consumes(CBP_EVENT_AGEN) && is_mem(inst->insn_class))
    {
        AQ.push_back(std::make_tuple(seq_no, piece, agen_cycle));
        assert(AQ.size() <= window_capacity);
    }
-   EQ.push_back(std::make_tuple(seq_no, piece, exec_cycle));
+   if (cbp_consumes(CBP_EVENT_EXECUTE_RESOLVE))
+      EQ.push_back(std::make_tuple(seq_no, piece, exec_cycle));
 
    /////////////////////////////
    // Manage fetch cycle.
@@ -743,7 +823,7 @@ void uarchsim_t::step(db_t *inst)
        }
 
        // Taken branch constraint.
-       if(FETCH_STOP_AT_TAKEN && inst->is_taken)
+       if (FETCH_STOP_AT_TAKEN && inst->is_taken)
        {
            const bool taken_branch = (is_cond_br(inst->insn_class) && (inst->next_pc != (inst->pc + 4))) || is_uncond_br(inst->insn_class);
            if(!taken_branch)
@@ -798,13 +878,14 @@ void uarchsim_t::step(db_t *inst)
        window.back().update_pred_taken(predicted_taken);
    }
 
-   spdlog::debug("Updating base_cycle to {}", MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
+   const uint64_t oldest_pf_cycle = REF_PF ? REF_PF->get_oldest_pf_cycle() : prefetcher.get_oldest_pf_cycle();
+   spdlog::debug("Updating base_cycle to {}", MIN(fetch_cycle, oldest_pf_cycle));
 
    // Attempt to advance the base cycles of resource schedules.
    // Note : We may have some prefetches to issue still that are older than the fetch cycle.
-   if (ldst_lanes) ldst_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
-   if (alu_lanes) alu_lanes->advance_base_cycle(MIN(fetch_cycle, prefetcher.get_oldest_pf_cycle()));
-   const bool dump_activity = LOG_LEVEL != 0 && (fetch_cycle>= LOG_START_CYCLE) && (fetch_cycle<=LOG_END_CYCLE);
+   if (ldst_lanes) ldst_lanes->advance_base_cycle(MIN(fetch_cycle, oldest_pf_cycle));
+   if (alu_lanes) alu_lanes->advance_base_cycle(MIN(fetch_cycle, oldest_pf_cycle));
+   const bool dump_activity = log_activity && (fetch_cycle>= LOG_START_CYCLE) && (fetch_cycle<=LOG_END_CYCLE);
    if(dump_activity && activity_observed)
    {
        std::cout<<activity_trace.str();
@@ -825,6 +906,59 @@ void uarchsim_t::step(db_t *inst)
 }
 #endif
 
+void uarchsim_t::drain()
+{
+   bool activity_observed = false;
+   const uint64_t last_retire_cycle = window.back().retire_cycle;
+   for (uint64_t c = previous_fetch_cycle; c <= last_retire_cycle; c++)
+      eval_cycle(activity_observed, c);
+   assert(window.empty());
+   fetch_cycle = MAX(fetch_cycle, last_retire_cycle);
+   previous_fetch_cycle = fetch_cycle;
+   num_fetched = 0;
+   num_fetched_branch = 0;
+}
+
+void uarchsim_t::warm(db_t *inst)
+{
+   PROF_SCOPE(UARCH_STEP);
+   if (!window.empty())
+      drain();
+
+   piece = (piece == UINT8_MAX) ? 0 : (piece + 1);
+   const uint64_t seq_no = num_uop++;
+
+   if (FETCH_MODEL_ICACHE)
+      IC.warm(inst->pc);
+   if (!PERFECT_CACHE && (inst->is_load || (inst->is_store && WRITE_ALLOCATE)))
+      L1.warm(inst->addr);
+
+   populate_exec_info(inst);
+   if (cbp_consumes(CBP_EVENT_FETCH))
+      notify_instr_fetch(seq_no, piece, inst->pc, fetch_cycle);
+   const bool br_mispred = !PERFECT_BRANCH_PRED && BP.warm(seq_no, piece, inst->insn_class, inst->pc, inst->next_pc, fetch_cycle);
+   if (cbp_consumes(CBP_EVENT_DECODE))
+      notify_instr_decode(seq_no, piece, inst->pc, _current_execute_info.dec_info, fetch_cycle);
+   if (cbp_consumes(CBP_EVENT_AGEN) && is_mem(inst->insn_class))
+      notify_agen_complete(seq_no, piece, inst->pc, _current_execute_info.dec_info, _current_execute_info.mem_va.value(), _current_execute_info.mem_sz.value(), fetch_cycle);
+
+   bool pred_taken = false;
+   if (is_cond_br(inst->insn_class))
+      pred_taken = br_mispred ? !_current_execute_info.taken.value() : _current_execute_info.taken.value();
+   else if (is_br(inst->insn_class))
+      pred_taken = true;
+   {
+      PROF_SCOPE(COND_UPDATE);
+      if (cbp_consumes(CBP_EVENT_EXECUTE_RESOLVE))
+         notify_instr_execute_resolve(seq_no, piece, inst->pc, pred_taken, _current_execute_info, fetch_cycle);
+      if (cbp_consumes(CBP_EVENT_COMMIT))
+         notify_instr_commit(seq_no, piece, inst->pc, pred_taken, _current_execute_info, fetch_cycle);
+   }
+
+   if (inst->is_last_piece)
+      piece = UINT8_MAX;
+}
+
 
 
 #define KILOBYTE    (1<<10)
@@ -837,9 +971,147 @@ uint64_t uarchsim_t::get_current_fetch_cycle() const {
     return fetch_cycle;
 }
 
-void uarchsim_t::output() 
+bp_window_stats_t uarchsim_t::get_conddir_stats(const uint64_t target_instr_count) const {
+    return BP.window_stats(num_insts_per_epoch, num_cycles_per_epoch, target_instr_count);
+}
+
+bp_window_stats_t uarchsim_t::get_running_stats() const {
+    bp_window_stats_t w = BP.running_totals();
+    w.instr = num_inst;
+    w.cycles = cycle;
+    return w;
+}
+
+uarch_digest_t uarchsim_t::digest() const {
+    uarch_digest_t d = {};
+    if (!window.empty()) {
+        const window_t &w = window.back();
+        d.seq_no = w.seq_no;
+        d.pc = w.PC;
+        d.piece = w.piece;
+        d.fetch_cycle = w.fetch_cycle;
+        d.exec_cycle = w.exec_cycle;
+        d.retire_cycle = w.retire_cycle;
+        d.pred_taken = w.pred_taken;
+    }
+    d.next_fetch_cycle = fetch_cycle;
+    d.cycle = cycle;
+    d.num_inst = num_inst;
+    d.window_size = window.size();
+    const bp_window_stats_t bp = BP.running_totals();
+    d.cond_br = bp.br;
+    d.cond_mispred = bp.mispred;
+    d.cycles_on_wrong_path = bp.cycles_on_wrong_path;
+    d.num_load_sqmiss = num_load_sqmiss;
+    d.vp_correct = num_correct;
+    d.vp_incorrect = num_incorrect;
+    d.ic_accesses = IC.get_accesses();
+    d.ic_misses = IC.get_misses();
+    d.l1_accesses = L1.get_accesses();
+    d.l1_misses = L1.get_misses();
+    d.l2_accesses = L2.get_accesses();
+    d.l2_misses = L2.get_misses();
+    d.l3_accesses = L3.get_accesses();
+    d.l3_misses = L3.get_misses();
+    return d;
+}
+
+void uarchsim_t::reset_stats()
+{
+   assert(num_insts_per_epoch.back() == 0);
+   num_insts_per_epoch.erase(num_insts_per_epoch.begin(), num_insts_per_epoch.end() - 1);
+   num_cycles_per_epoch.erase(num_cycles_per_epoch.begin(), num_cycles_per_epoch.end() - 1);
+   BP.reset_epochs();
+   num_inst = 0;
+   num_eligible = num_correct = num_incorrect = 0;
+   num_load = num_load_sqmiss = 0;
+   cycles_on_wrong_path = 0;
+   stat_pfs_issued_to_mem = 0;
+   IC.reset_stats();
+   L1.reset_stats();
+   L2.reset_stats();
+   L3.reset_stats();
+   prefetcher.reset_stats();
+}
+
+void uarchsim_t::stitch(const std::vector<const uarchsim_t *> &parts)
 {
+   num_insts_per_epoch.clear();
+   num_cycles_per_epoch.clear();
+   BP.clear_epochs();
+   cycle = 0;
+   for (size_t p = 0; p < parts.size(); p++) {
+      const uarchsim_t &part = *parts[p];
+      assert(part.simulation_ended);
+      size_t n = part.num_insts_per_epoch.size();
+      if ((p + 1 < parts.size()) && n && (part.num_insts_per_epoch.back() == 0))
+         n--;
+      num_insts_per_epoch.insert(num_insts_per_epoch.end(), part.num_insts_per_epoch.begin(), part.num_insts_per_epoch.begin() + n);
+      num_cycles_per_epoch.insert(num_cycles_per_epoch.end(), part.num_cycles_per_epoch.begin(), part.num_cycles_per_epoch.begin() + n);
+      BP.append_epochs(part.BP, n);
+      for (size_t e = 0; e < n; e++)
+         cycle += part.num_cycles_per_epoch[e];
+
+      num_inst += part.num_inst;
+      num_eligible += part.num_eligible;
+      num_correct += part.num_correct;
+      num_incorrect += part.num_incorrect;
+      num_load += part.num_load;
+      num_load_sqmiss += part.num_load_sqmiss;
+      cycles_on_wrong_path += part.cycles_on_wrong_path;
+      stat_pfs_issued_to_mem += part.stat_pfs_issued_to_mem;
+      IC.add_stats(part.IC);
+      L1.add_stats(part.L1);
+      L2.add_stats(part.L2);
+      L3.add_stats(part.L3);
+      prefetcher.add_stats(part.prefetcher);
+   }
+   last_epoch_end_cycle = cycle;
+   simulation_ended = true;
+}
+
+bp_window_stats_t uarchsim_t::epoch_range_stats(const size_t first, const size_t last) const
+{
+   bp_window_stats_t w = BP.epoch_range_stats(first, last);
+   for (size_t e = first; e < last; e++) {
+      w.instr += num_insts_per_epoch.at(e);
+      w.cycles += num_cycles_per_epoch.at(e);
+   }
+   return w;
+}
+
+void uarchsim_t::end_simulation()
+{
+   if (simulation_ended)
+      return;
+   simulation_ended = true;
    end_current_begin_new_epoch(false/*first_epoch*/, true/*last_epoch*/, cycle);
+
+   if (stats_out) {
+      stats_out->begin("core", 0);
+      stats_out->field("instr", num_inst);
+      stats_out->field("cycles", cycle);
+      stats_out->field("ipc", (double)num_inst/(double)cycle);
+      stats_out->field("cyc_wp", cycles_on_wrong_path);
+      stats_out->field("loads", num_load);
+      stats_out->field("loads_sq_miss", num_load_sqmiss);
+      stats_out->field("pfs_issued", stat_pfs_issued_to_mem);
+      stats_out->end();
+      if (FETCH_MODEL_ICACHE)
+         IC.write_stats(*stats_out, "IC");
+      L1.write_stats(*stats_out, "L1");
+      L2.write_stats(*stats_out, "L2");
+      L3.write_stats(*stats_out, "L3");
+      BP.write_summary(*stats_out, num_insts_per_epoch, num_cycles_per_epoch);
+      prof_write_stats(*stats_out, num_inst);
+      if (perf)
+         perf->write_stats(*stats_out, num_insts_per_epoch);
+   }
+}
+
+void uarchsim_t::output() 
+{
+   end_simulation();
    //auto get_track_name = [] (uint64_t track){
    //   static std::string track_names [] = {
    //      "ALL",
@@ -901,7 +1173,10 @@ void uarchsim_t::output()
    printf("L3$:\n"); L3.stats();
    printf("---------------------------------------------------------------------------------------------------------------------------------------\n");
    printf("----------------------------------------------Prefetcher (Full Simulation i.e. No Warmup)----------------------------------------------\n");
-   prefetcher.print_stats();
+   if (REF_PF)
+      REF_PF->print_stats();
+   else
+      prefetcher.print_stats();
    printf("---------------------------------------------------------------------------------------------------------------------------------------\n");
    printf("\n-------------------------------ILP LIMIT STUDY (Full Simulation i.e. Counts Not Reset When Warmup Ends)--------------------------------\n");
    printf("instructions = %llu\n", (unsigned long long)num_inst);
@@ -912,4 +1187,7 @@ void uarchsim_t::output()
    // Branch Prediction Measurements
    BP.output(num_inst);
    BP.output_periodic_info(num_insts_per_epoch, num_cycles_per_epoch);
+   prof_output(num_inst);
+   if (perf)
+      perf->output(predictor_type_name(get_selected_predictor()), num_insts_per_epoch);
 }
@@ -24,6 +24,7 @@ THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <unordered_map>
 #include <list>
+#include <sstream>
 #include "spdlog/spdlog.h"
 #include "spdlog/fmt/ostr.h"
 //#include "cbp.h"
@@ -34,6 +35,10 @@ using namespace std;
 #ifndef _RISCV_UARCHSIM_H
 #define _RISCV_UARCHSIM_H
 
+class stats_writer_t;
+class perf_counters_t;
+class ReferenceStridePrefetcher;
+
 #define RFSIZE 66   // integer: r0-r31.  fp/simd: r32-r63. flags: r64.
 #define RFFLAGS 64  // flags register is r64 (65th register)
 #define RFZERO 65   // zero register is r65 (66th register)
@@ -109,6 +114,41 @@ struct store_queue_t {
    uint64_t ret_cycle;  // store's commit cycle
 };
 
+// State after a step, for differential checking (cbp-check): the stepped
+// instruction's schedule and prediction, the simulator's cycles and counters,
+// and the caches' counters. Two implementations of the same simulation must
+// produce equal digests after every step.
+struct uarch_digest_t {
+   uint64_t seq_no;              // of the stepped instruction (its uop number)
+   uint64_t pc;
+   uint64_t piece;
+   uint64_t fetch_cycle;
+   uint64_t exec_cycle;
+   uint64_t retire_cycle;
+   uint64_t pred_taken;
+   uint64_t next_fetch_cycle;
+   uint64_t cycle;
+   uint64_t num_inst;
+   uint64_t window_size;
+   uint64_t cond_br;
+   uint64_t cond_mispred;
+   uint64_t cycles_on_wrong_path;
+   uint64_t num_load_sqmiss;
+   uint64_t vp_correct;
+   uint64_t vp_incorrect;
+   uint64_t ic_accesses, ic_misses;
+   uint64_t l1_accesses, l1_misses;
+   uint64_t l2_accesses, l2_misses;
+   uint64_t l3_accesses, l3_misses;
+};
+
+// Field names of uarch_digest_t, in declaration order.
+#define UARCH_DIGEST_FIELDS \
+   "seq_no", "pc", "piece", "fetch_cycle", "exec_cycle", "retire_cycle", "pred_taken", "next_fetch_cycle", \
+   "cycle", "num_inst", "window_size", "cond_br", "cond_mispred", "cycles_on_wrong_path", "num_load_sqmiss", \
+   "vp_correct", "vp_incorrect", "ic_accesses", "ic_misses", "l1_accesses", "l1_misses", "l2_accesses", \
+   "l2_misses", "l3_accesses", "l3_misses"
+
 // Class for a microarchitectural simulator.
 
 class uarchsim_t {
@@ -151,6 +191,8 @@ class uarchsim_t {
 
       //Prefetcher
       StridePrefetcher prefetcher;
+      // The pre-rewrite prefetcher in its place (cbp-check's prefetcher-ref), else null
+      ReferenceStridePrefetcher *REF_PF = nullptr;
       // Instruction and cycle counts for IPC.
       uint64_t num_inst;
       uint64_t num_uop;
@@ -160,6 +202,16 @@ class uarchsim_t {
       std::vector<uint64_t> num_insts_per_epoch;
       std::vector<uint64_t> num_cycles_per_epoch;
       uint64_t last_epoch_end_cycle;
+      bool simulation_ended = false;
+
+      // Structured stats stream (-stats), NULL if disabled.
+      stats_writer_t *stats_out = NULL;
+
+      // Host hardware counters (-perf), NULL if disabled.
+      perf_counters_t *perf = NULL;
+
+      // Piece of the current trace instruction being stepped.
+      uint8_t piece = UINT8_MAX;
 
       // CVP measurements
       uint64_t num_eligible;
@@ -183,19 +235,57 @@ class uarchsim_t {
       const window_t& locate_entry_in_window(uint64_t seq_no, uint8_t piece) const;
       void end_current_begin_new_epoch(const bool first_epoch, const bool last_epoch, const uint64_t epoch_end_cycle);
 
+      // Per-step activity log, only formatted when LOG_LEVEL != 0.
+      std::ostringstream activity_trace;
+
+      void eval_decode(bool& activity_observed, const uint64_t current_cycle);
+      void eval_aq(bool& activity_observed, const uint64_t current_cycle);
+      void eval_exec(bool& activity_observed, const uint64_t current_cycle);
+      void eval_retire(bool& activity_observed, const uint64_t current_cycle);
+      void eval_cycle(bool& activity_observed, const uint64_t current_cycle);
+      // Evaluate cycles until every instruction in the window has retired.
+      void drain();
+
    public:
       uarchsim_t();
       ~uarchsim_t();
 
       //void set_funcsim(processor_t *funcsim);
       void step(db_t *inst);
-      void eval_decode(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
-      void eval_aq(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
-      void eval_exec(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
-      void eval_retire(std::ostream& activity_trace, bool& activity_observed, const uint64_t current_fetch_cycle) ;
+      // Functional warming (-smarts): trains the branch predictor (through
+      // the same predict, resolve and commit calls as step()) and the I/D
+      // caches on inst, with no timing. The window is drained first, so
+      // step() can resume right after. Cycle and instruction counts, epochs,
+      // branch measurements and cache counters are left untouched.
+      void warm(db_t *inst);
       void output();
+      // Close the last epoch. output() calls this; callers that only want
+      // the counters (e.g., cbp-sweep) call it directly. Idempotent.
+      void end_simulation();
       uint64_t get_current_fetch_cycle() const;
+      uint64_t get_num_inst() const { return num_inst; }
+      uint64_t get_cycle() const { return cycle; }
+      // Conditional branch stats over the trailing epochs holding more than
+      // target_instr_count instructions; valid after end_simulation().
+      bp_window_stats_t get_conddir_stats(const uint64_t target_instr_count) const;
+      // Counters so far, mid-epoch included; differences of two snapshots give the stats of a region.
+      bp_window_stats_t get_running_stats() const;
+      // Differential checking (cbp-check): the state after the last step.
+      uarch_digest_t digest() const;
       PredictionRequest get_value_prediction_req_for_track(uint64_t cycle, uint64_t seq_no, uint8_t piece, db_t *inst);
+
+      // Parallel interval simulation (-par, see par_sim.h).
+      // Called at the epoch boundary that ends an interval's warmup: drops the
+      // warmup's epochs and zeroes the measurements, keeping all state.
+      void reset_stats();
+      // Makes this (never stepped) simulator the concatenation of the
+      // intervals' measurements, in trace order, ready for output(). Each part
+      // has ended its simulation; the empty epoch a part opened at its
+      // interval's end is dropped, except for the last part.
+      void stitch(const std::vector<const uarchsim_t *> &parts);
+      size_t num_epochs() const { return num_insts_per_epoch.size(); }
+      // Counters over epochs [first, last).
+      bp_window_stats_t epoch_range_stats(const size_t first, const size_t last) const;
 };
 
 #endif
@@ -0,0 +1,30 @@
+// uarchsim_all_hooks.cc
+// uarchsim.cc compiled again as uarchsim_all_hooks_t, with every CBP event
+// consumed; see uarchsim_all_hooks.h.
+#undef CBP_EVENTS_CONSUMED
+#define CBP_EVENTS_CONSUMED CBP_EVENT_ALL
+#define uarchsim_t uarchsim_all_hooks_t
+#include "uarchsim.cc"
+#undef uarchsim_t
+
+#include "uarchsim_all_hooks.h"
+
+class all_hooks_sim_impl_t : public all_hooks_sim_t {
+   public:
+      void step(db_t *inst) override { sim.step(inst); }
+      void end_simulation() override { sim.end_simulation(); }
+      uint64_t get_num_inst() const override { return sim.get_num_inst(); }
+      bp_window_stats_t get_conddir_stats(const uint64_t target_instr_count) const override
+      {
+         return sim.get_conddir_stats(target_instr_count);
+      }
+      uarch_digest_t digest() const override { return sim.digest(); }
+
+   private:
+      uarchsim_all_hooks_t sim;
+};
+
+all_hooks_sim_t *new_all_hooks_sim()
+{
+   return new all_hooks_sim_impl_t();
+}
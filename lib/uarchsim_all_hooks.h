@@ -0,0 +1,26 @@
+// uarchsim_all_hooks.h
+// uarchsim_t as it runs with every CBP event consumed (CBP_EVENT_ALL): the
+// decode, AGEN and execute queues are modeled and the DecodeInfo/ExecuteInfo
+// operands filled, whatever cbp.h's CBP_EVENTS_CONSUMED says. The reference
+// side of cbp-check's all-hooks variant, which checks that skipping them
+// leaves the simulation unchanged.
+#ifndef UARCHSIM_ALL_HOOKS_H
+#define UARCHSIM_ALL_HOOKS_H
+
+#include "uarchsim.h"
+
+// The calls cbp-check makes on a simulator.
+class all_hooks_sim_t {
+   public:
+      virtual ~all_hooks_sim_t() {}
+      virtual void step(db_t *inst) = 0;
+      virtual void end_simulation() = 0;
+      virtual uint64_t get_num_inst() const = 0;
+      virtual bp_window_stats_t get_conddir_stats(const uint64_t target_instr_count) const = 0;
+      virtual uarch_digest_t digest() const = 0;
+};
+
+// A uarchsim_t compiled a second time with CBP_EVENT_ALL (uarchsim_all_hooks.cc).
+all_hooks_sim_t *new_all_hooks_sim();
+
+#endif
@@ -3,20 +3,23 @@
 #include "local_predictor.h"
 #include <stdlib.h>
 #include <stdint.h>
+#include "pc_interner.h"
+#include "sat_counter_array.h"
+#include "history.h"
 
 // Table 1: Local History Table (LHT) - stores local history for each branch
-static uint32_t* lht = NULL;
-static uint32_t lht_mask = 0;
-static int lht_bits = 0;
+static thread_local LocalHistoryTable lht;
+static thread_local uint32_t lht_mask = 0;
+static thread_local int lht_bits = 0;
 
 // Table 2: Pattern History Table (PHT) - stores 2-bit saturating counters
-static uint8_t* pht = NULL;
-static uint32_t pht_mask = 0;
-static int pht_bits = 0;
+static thread_local SatCounterArray<2> pht;
+static thread_local uint32_t pht_mask = 0;
+static thread_local int pht_bits = 0;
 
 // History configuration
-static int history_bits = 0;
-static uint32_t history_mask = 0;
+static thread_local int history_bits = 0;
+static thread_local uint32_t history_mask = 0;
 
 // 2-bit saturating counter states
 static const uint8_t STRONG_NOT_TAKEN = 0;
@@ -24,68 +27,94 @@ static const uint8_t WEAK_NOT_TAKEN = 1;
 static const uint8_t WEAK_TAKEN = 2;
 static const uint8_t STRONG_TAKEN = 3;
 
-void local_predictor_init(int _lht_bits, int _history_bits, int _pht_bits) {
+// Infinite mode: every interned PC has its own local history and its own
+// 2^history_bits PHT, so neither level aliases.
+static thread_local bool infinite = false;
+static thread_local LocalHistoryTable per_pc_lht;
+static thread_local SatCounterArray<2> per_pc_pht;
+
+// LHT and entry, PHT and PHT base index (the local history is added to it) of a branch
+static inline LocalHistoryTable& lht_entry(uint64_t pc, size_t* lht_idx, SatCounterArray<2>** table, size_t* pht_base) {
+    if (infinite) {
+        const uint32_t id = pc_intern(pc);
+        *table = &per_pc_pht;
+        *pht_base = per_pc_counters(per_pc_pht, id, (size_t)history_mask + 1, WEAK_NOT_TAKEN);
+        per_pc_lht.grow((size_t)id + 1);
+        *lht_idx = id;
+        return per_pc_lht;
+    }
+    *table = &pht;
+    *pht_base = 0;
+    // Index into LHT using low bits of PC
+    *lht_idx = pc & lht_mask;
+    return lht;
+}
+
+void local_predictor_init(int _lht_bits, int _history_bits, int _pht_bits, bool _infinite) {
     lht_bits = _lht_bits;
     history_bits = _history_bits;
     pht_bits = _pht_bits;
+    infinite = _infinite;
+    history_mask = (1 << history_bits) - 1;
+    if (infinite) {
+        // The PHT is indexed by the full local history.
+        per_pc_lht.init(0, history_bits);
+        pht_mask = history_mask;
+        return;
+    }
     
     // Local History Table: 2^lht_bits entries, each storing history_bits of history
     uint32_t lht_size = 1 << lht_bits;
-    lht = (uint32_t*)malloc(lht_size * sizeof(uint32_t));
-    for (uint32_t i = 0; i < lht_size; i++) lht[i] = 0;
+    lht.init(lht_size, history_bits);
     lht_mask = lht_size - 1;
     
     // Pattern History Table: 2^pht_bits entries, each storing 2-bit counters
     uint32_t pht_size = 1 << pht_bits;
-    pht = (uint8_t*)malloc(pht_size * sizeof(uint8_t));
-    for (uint32_t i = 0; i < pht_size; i++) pht[i] = WEAK_NOT_TAKEN; // Initialize to weakly not taken
+    pht.init(pht_size, WEAK_NOT_TAKEN); // Initialize to weakly not taken
     pht_mask = pht_size - 1;
     
     history_mask = (1 << history_bits) - 1;
 }
 
-uint8_t local_predictor_predict(uint32_t pc) {
-    // Step 1: Index into LHT using low bits of PC
-    uint32_t lht_idx = pc & lht_mask;
-    uint32_t local_history = lht[lht_idx] & history_mask;
+uint8_t local_predictor_predict(uint64_t pc) {
+    // Step 1: Look up the branch's local history
+    size_t lht_idx;
+    SatCounterArray<2>* table;
+    size_t pht_base;
+    uint32_t local_history = lht_entry(pc, &lht_idx, &table, &pht_base).get(lht_idx);
     
     // Step 2: Index into PHT using local history
     uint32_t pht_idx = local_history & pht_mask;
-    uint8_t counter = pht[pht_idx];
     
     // Predict taken if counter >= 2 (WEAK_TAKEN or STRONG_TAKEN)
-    return (counter >= 2) ? 1 : 0;
+    return table->taken(pht_base + pht_idx) ? 1 : 0;
 }
 
-void local_predictor_train(uint32_t pc, uint8_t outcome) {
-    // Step 1: Index into LHT using low bits of PC
-    uint32_t lht_idx = pc & lht_mask;
-    uint32_t local_history = lht[lht_idx] & history_mask;
+void local_predictor_train(uint64_t pc, uint8_t outcome) {
+    // Step 1: Look up the branch's local history
+    size_t lht_idx;
+    SatCounterArray<2>* table;
+    size_t pht_base;
+    LocalHistoryTable& lht_table = lht_entry(pc, &lht_idx, &table, &pht_base);
+    uint32_t local_history = lht_table.get(lht_idx);
     
     // Step 2: Index into PHT using local history and update counter
+    // (saturating at STRONG_NOT_TAKEN and STRONG_TAKEN)
     uint32_t pht_idx = local_history & pht_mask;
-    uint8_t counter = pht[pht_idx];
-    
-    if (outcome) {
-        // Branch was taken - increment counter (saturate at 3)
-        if (counter < STRONG_TAKEN) {
-            pht[pht_idx] = counter + 1;
-        }
-    } else {
-        // Branch was not taken - decrement counter (saturate at 0)
-        if (counter > STRONG_NOT_TAKEN) {
-            pht[pht_idx] = counter - 1;
-        }
-    }
+    table->update(pht_base + pht_idx, outcome);
     
     // Step 3: Update local history in LHT
     // Shift left, add new outcome, and mask to keep only history_bits
-    lht[lht_idx] = ((local_history << 1) | (outcome ? 1 : 0)) & history_mask;
+    lht_table.update(lht_idx, outcome);
+}
+
+uint64_t local_predictor_storage_bits() {
+    return infinite ? UINT64_MAX : lht.storage_bits() + pht.storage_bits();
 }
 
 void local_predictor_cleanup() {
-    if (lht) free(lht);
-    if (pht) free(pht);
-    lht = NULL;
-    pht = NULL;
+    lht.clear();
+    pht.clear();
+    per_pc_lht.clear();
+    per_pc_pht.clear();
 }
@@ -3,8 +3,13 @@
 #ifndef LOCAL_PREDICTOR_H
 #define LOCAL_PREDICTOR_H
 #include <stdint.h>
-void local_predictor_init(int lht_bits, int history_bits, int pht_bits);
-uint8_t local_predictor_predict(uint32_t pc);
-void local_predictor_train(uint32_t pc, uint8_t outcome);
+// infinite: a private local history and PHT per static branch (interned full PC);
+// lht_bits and pht_bits are ignored
+void local_predictor_init(int lht_bits, int history_bits, int pht_bits, bool infinite = false);
+uint8_t local_predictor_predict(uint64_t pc);
+void local_predictor_train(uint64_t pc, uint8_t outcome);
 void local_predictor_cleanup();
+// Bits of state as sized by init(); UINT64_MAX in infinite mode, whose
+// tables grow with the trace.
+uint64_t local_predictor_storage_bits();
 #endif
@@ -82,4 +82,4 @@ class SampleCondPredictor
 // =================
 
 #endif
-static SampleCondPredictor cond_predictor_impl;
+static thread_local SampleCondPredictor cond_predictor_impl;
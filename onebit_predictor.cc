@@ -2,27 +2,43 @@
 // Simple 1-bit branch predictor template implementation
 #include "onebit_predictor.h"
 #include <stdlib.h>
+#include "pc_interner.h"
+#include "sat_counter_array.h"
 #define TAKEN 1
 #define NOTTAKEN 0
-static uint8_t* table = NULL;
-static uint32_t mask = 0;
-static int bits = 0;
-void onebit_predictor_init(int table_bits) {
+static thread_local SatCounterArray<1> table;
+static thread_local uint32_t mask = 0;
+static thread_local int bits = 0;
+static thread_local bool infinite = false;
+static thread_local SatCounterArray<1> per_pc;   // infinite: one entry per interned PC
+static inline SatCounterArray<1>& table_of(uint64_t pc, size_t* idx) {
+    if (infinite) {
+        *idx = per_pc_counters(per_pc, pc_intern(pc), 1, NOTTAKEN);
+        return per_pc;
+    }
+    *idx = pc & mask;
+    return table;
+}
+void onebit_predictor_init(int table_bits, bool _infinite) {
+    infinite = _infinite;
+    if (infinite) return;
     bits = table_bits;
     uint32_t size = 1 << bits;
-    table = (uint8_t*)malloc(size * sizeof(uint8_t));
-    for (uint32_t i = 0; i < size; i++) table[i] = NOTTAKEN;
+    table.init(size, NOTTAKEN);
     mask = size - 1;
 }
-uint8_t onebit_predictor_predict(uint32_t pc) {
-    uint32_t idx = pc & mask;
-    return table[idx];
+uint8_t onebit_predictor_predict(uint64_t pc) {
+    size_t idx;
+    return table_of(pc, &idx).get(idx);
+}
+void onebit_predictor_train(uint64_t pc, uint8_t outcome) {
+    size_t idx;
+    table_of(pc, &idx).set(idx, outcome ? TAKEN : NOTTAKEN);
 }
-void onebit_predictor_train(uint32_t pc, uint8_t outcome) {
-    uint32_t idx = pc & mask;
-    table[idx] = outcome ? TAKEN : NOTTAKEN;
+uint64_t onebit_predictor_storage_bits() {
+    return infinite ? UINT64_MAX : table.storage_bits();
 }
 void onebit_predictor_cleanup() {
-    if (table) free(table);
-    table = NULL;
+    table.clear();
+    per_pc.clear();
 }
@@ -3,8 +3,12 @@
 #ifndef ONEBIT_PREDICTOR_H
 #define ONEBIT_PREDICTOR_H
 #include <stdint.h>
-void onebit_predictor_init(int table_bits);
-uint8_t onebit_predictor_predict(uint32_t pc);
-void onebit_predictor_train(uint32_t pc, uint8_t outcome);
+// infinite: one entry per static branch (interned full PC), table_bits is ignored
+void onebit_predictor_init(int table_bits, bool infinite = false);
+uint8_t onebit_predictor_predict(uint64_t pc);
+void onebit_predictor_train(uint64_t pc, uint8_t outcome);
 void onebit_predictor_cleanup();
+// Bits of state as sized by init(); UINT64_MAX in infinite mode, whose
+// tables grow with the trace.
+uint64_t onebit_predictor_storage_bits();
 #endif
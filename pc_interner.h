@@ -0,0 +1,109 @@
+// pc_interner.h
+// Dense PC -> id interning for per-static-branch predictor state
+#ifndef PC_INTERNER_H
+#define PC_INTERNER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// Gives every distinct PC a small id (0, 1, 2, ... in order of first sight),
+// so per-branch state can live in flat vectors indexed by id instead of
+// hashed tables or std::unordered_map. Lookup is an open-addressing table
+// (linear probing, power-of-two capacity, kept at most half full).
+//
+// The simulator streams the trace once, so ids are assigned incrementally;
+// reserve() takes the static branch count when it is known in advance (e.g.
+// from an earlier run) to avoid rehashing.
+class PcInterner {
+public:
+    static constexpr uint32_t NO_ID = UINT32_MAX;
+
+    PcInterner() { clear(); }
+
+    void clear() {
+        pcs.clear();
+        slots.assign(1024, NO_ID);
+        mask = slots.size() - 1;
+    }
+
+    void reserve(size_t num_pcs) {
+        pcs.reserve(num_pcs);
+        if (2 * num_pcs > slots.size())
+            rehash(2 * num_pcs);
+    }
+
+    // Id of pc, assigning the next free one on first sight.
+    inline uint32_t intern(uint64_t pc) {
+        size_t i = hash(pc) & mask;
+        while (slots[i] != NO_ID) {
+            if (pcs[slots[i]] == pc)
+                return slots[i];
+            i = (i + 1) & mask;
+        }
+        const uint32_t id = (uint32_t)pcs.size();
+        pcs.push_back(pc);
+        slots[i] = id;
+        if (2 * pcs.size() > slots.size())
+            rehash(2 * slots.size());
+        return id;
+    }
+
+    // Id of pc, or NO_ID if it was never interned.
+    inline uint32_t find(uint64_t pc) const {
+        size_t i = hash(pc) & mask;
+        while (slots[i] != NO_ID) {
+            if (pcs[slots[i]] == pc)
+                return slots[i];
+            i = (i + 1) & mask;
+        }
+        return NO_ID;
+    }
+
+    uint32_t size() const { return (uint32_t)pcs.size(); }
+    uint64_t pc_of(uint32_t id) const { return pcs[id]; }
+
+private:
+    static inline size_t hash(uint64_t pc) {
+        return (size_t)(((pc >> 2) * 0x9E3779B97F4A7C15ull) >> 24);
+    }
+
+    void rehash(size_t min_slots) {
+        size_t n = slots.size();
+        while (n < min_slots)
+            n <<= 1;
+        slots.assign(n, NO_ID);
+        mask = n - 1;
+        for (uint32_t id = 0; id < pcs.size(); id++) {
+            size_t i = hash(pcs[id]) & mask;
+            while (slots[i] != NO_ID)
+                i = (i + 1) & mask;
+            slots[i] = id;
+        }
+    }
+
+    std::vector<uint64_t> pcs;      // id -> pc
+    std::vector<uint32_t> slots;    // hash slot -> id, NO_ID if empty
+    size_t mask;
+};
+
+// Interner shared by all predictors of a simulation (per thread, like the
+// predictor state, so cbp-sweep workers do not share ids). Cleared by
+// beginCondDirPredictor().
+inline thread_local PcInterner g_pc_interner;
+
+inline uint32_t pc_intern(uint64_t pc) {
+    return g_pc_interner.intern(pc);
+}
+
+// Entries of branch `id` in a flat per-branch table with `stride` entries
+// per branch; grows the table (filled with init) to cover new ids.
+template <class T>
+inline T* per_pc_entries(std::vector<T>& table, uint32_t id, size_t stride, const T& init) {
+    const size_t end = ((size_t)id + 1) * stride;
+    if (end > table.size())
+        table.resize(end, init);
+    return &table[(size_t)id * stride];
+}
+
+#endif
@@ -5,24 +5,37 @@
 #include <string.h>
 #include <limits.h>
 #include <stdio.h>
+#include "pc_interner.h"
 
 // Perceptron predictor parameters
-static int num_perceptrons = 0;          // Number of perceptrons in table (2^table_bits)
-static int history_len = 0;              // Length of global history register
-static int weight_bits = 0;              // Number of bits for each weight
-static int threshold = 0;                // Training threshold
-static uint32_t table_mask = 0;          // Mask for indexing into perceptron table
+static thread_local int num_perceptrons = 0;          // Number of perceptrons in table (2^table_bits)
+static thread_local int history_len = 0;              // Length of global history register
+static thread_local int weight_bits = 0;              // Number of bits for each weight
+static thread_local int threshold = 0;                // Training threshold
+static thread_local uint32_t table_mask = 0;          // Mask for indexing into perceptron table
 
 // Data structures
-static int32_t** perceptron_table = NULL; // Table of perceptrons (each is array of weights)
-static int32_t* global_history = NULL;    // Global history register (bipolar: -1/+1)
-static int history_index = 0;            // Current position in circular history buffer
-static int32_t max_weight = 0;           // Maximum weight value (for saturation)
-static int32_t min_weight = 0;           // Minimum weight value (for saturation)
+static thread_local int32_t** perceptron_table = NULL; // Table of perceptrons (each is array of weights)
+static thread_local int32_t* global_history = NULL;    // Global history register (bipolar: -1/+1)
+static thread_local int history_index = 0;            // Current position in circular history buffer
+static thread_local int32_t max_weight = 0;           // Maximum weight value (for saturation)
+static thread_local int32_t min_weight = 0;           // Minimum weight value (for saturation)
 
-void perceptron_predictor_init(int table_bits, int history_length, int weight_bits_param, int threshold_param) {
+// Infinite mode: one perceptron per interned PC, stored back to back
+static thread_local bool infinite = false;
+static thread_local std::vector<int32_t> per_pc_weights;
+
+static inline int32_t* weights_of(uint64_t pc) {
+    if (infinite)
+        return per_pc_entries(per_pc_weights, pc_intern(pc), (size_t)history_len + 1, (int32_t)0);
+    // Hash PC to select perceptron
+    return perceptron_table[pc & table_mask];
+}
+
+void perceptron_predictor_init(int table_bits, int history_length, int weight_bits_param, int threshold_param, bool _infinite) {
     // Set parameters
-    num_perceptrons = 1 << table_bits;
+    infinite = _infinite;
+    num_perceptrons = infinite ? 0 : (1 << table_bits);
     history_len = history_length;
     weight_bits = weight_bits_param;
     threshold = threshold_param;
@@ -50,10 +63,8 @@ void perceptron_predictor_init(int table_bits, int history_length, int weight_bi
     history_index = 0;
 }
 
-uint8_t perceptron_predictor_predict(uint32_t pc) {
-    // Hash PC to select perceptron
-    uint32_t perceptron_idx = pc & table_mask;
-    int32_t* weights = perceptron_table[perceptron_idx];
+uint8_t perceptron_predictor_predict(uint64_t pc) {
+    int32_t* weights = weights_of(pc);
     
     // Compute dot product: y = w0 + sum(xi * wi) for i=1 to history_len
     int32_t y = weights[0]; // Start with bias weight w0
@@ -66,10 +77,8 @@ uint8_t perceptron_predictor_predict(uint32_t pc) {
     return (y >= 0) ? 1 : 0;
 }
 
-void perceptron_predictor_train(uint32_t pc, uint8_t outcome) {
-    // Hash PC to select perceptron
-    uint32_t perceptron_idx = pc & table_mask;
-    int32_t* weights = perceptron_table[perceptron_idx];
+void perceptron_predictor_train(uint64_t pc, uint8_t outcome) {
+    int32_t* weights = weights_of(pc);
     
     // Compute current output
     int32_t y = weights[0]; // Start with bias weight w0
@@ -110,6 +119,13 @@ void perceptron_predictor_update_history(uint8_t outcome) {
     history_index = (history_index + 1) % history_len;
 }
 
+uint64_t perceptron_predictor_storage_bits() {
+    if (infinite)
+        return UINT64_MAX;
+    // weight_bits per weight (the int32_t cells are wider), plus the history
+    return (uint64_t)num_perceptrons * (history_len + 1) * weight_bits + history_len;
+}
+
 void perceptron_predictor_cleanup() {
     if (perceptron_table) {
         for (int i = 0; i < num_perceptrons; i++) {
@@ -125,4 +141,5 @@ void perceptron_predictor_cleanup() {
         free(global_history);
         global_history = NULL;
     }
+    std::vector<int32_t>().swap(per_pc_weights);
 }
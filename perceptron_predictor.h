@@ -4,10 +4,14 @@
 #define PERCEPTRON_PREDICTOR_H
 #include <stdint.h>
 
-void perceptron_predictor_init(int table_bits, int history_length, int weight_bits, int threshold);
-uint8_t perceptron_predictor_predict(uint32_t pc);
-void perceptron_predictor_train(uint32_t pc, uint8_t outcome);
+// infinite: one perceptron per static branch (interned full PC), table_bits is ignored
+void perceptron_predictor_init(int table_bits, int history_length, int weight_bits, int threshold, bool infinite = false);
+uint8_t perceptron_predictor_predict(uint64_t pc);
+void perceptron_predictor_train(uint64_t pc, uint8_t outcome);
 void perceptron_predictor_update_history(uint8_t outcome);
 void perceptron_predictor_cleanup();
+// Bits of state as sized by init(); UINT64_MAX in infinite mode, whose
+// tables grow with the trace.
+uint64_t perceptron_predictor_storage_bits();
 
 #endif
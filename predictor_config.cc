@@ -2,4 +2,5 @@
 // Global configuration instance
 #include "predictor_config.h"
 
-PredictorConfig g_predictor_config;
+thread_local PredictorConfig g_predictor_config;
+thread_local uint64_t g_predictor_config_pinned = 0;
@@ -4,19 +4,23 @@
 #define PREDICTOR_CONFIG_H
 
 #include <cstdlib>
+#include <cstdint>
 #include <string>
 
 // Configuration structure for each predictor type
 struct PredictorConfig {
     // Onebit predictor
     int onebit_table_bits = 17;
+    int onebit_infinite = 0;            // 1: one counter per static branch (no aliasing)
     
     // Twobit predictor  
     int twobit_table_bits = 17;
+    int twobit_infinite = 0;
     
     // Gshare predictor
     int gshare_table_bits = 17;
     int gshare_history_bits = 4;
+    int gshare_infinite = 0;            // 1: per-branch PHT of 2^history_bits counters
     
     // Correlating predictor
     int correlating_pc_bits = 14;
@@ -27,6 +31,7 @@ struct PredictorConfig {
     int local_lht_bits = 14;
     int local_history_bits = 6;
     int local_pht_bits = 12;
+    int local_infinite = 0;             // 1: per-branch history and PHT
     
     // Tournament predictor
     int tournament_selector_bits = 14;
@@ -39,98 +44,100 @@ struct PredictorConfig {
     int perceptron_history_length = 64;
     int perceptron_weight_bits = 8;
     int perceptron_threshold = 35;
+    int perceptron_infinite = 0;        // 1: one perceptron per static branch
 };
 
-// Global configuration instance
-extern PredictorConfig g_predictor_config;
+// Global configuration instance (per thread, so cbp-sweep workers can each
+// run a different grid point)
+extern thread_local PredictorConfig g_predictor_config;
+
+// Environment variable name for each tunable field. cbp-sweep uses the same
+// names for its -set NAME=v1,v2,... grid axes.
+struct PredictorConfigField {
+    const char* name;
+    int PredictorConfig::*member;
+};
+
+inline const PredictorConfigField predictor_config_fields[] = {
+    {"ONEBIT_TABLE_BITS",              &PredictorConfig::onebit_table_bits},
+    {"ONEBIT_INFINITE",                &PredictorConfig::onebit_infinite},
+    {"TWOBIT_TABLE_BITS",              &PredictorConfig::twobit_table_bits},
+    {"TWOBIT_INFINITE",                &PredictorConfig::twobit_infinite},
+    {"GSHARE_TABLE_BITS",              &PredictorConfig::gshare_table_bits},
+    {"GSHARE_HISTORY_BITS",            &PredictorConfig::gshare_history_bits},
+    {"GSHARE_INFINITE",                &PredictorConfig::gshare_infinite},
+    {"CORRELATING_PC_BITS",            &PredictorConfig::correlating_pc_bits},
+    {"CORRELATING_HISTORY_BITS",       &PredictorConfig::correlating_history_bits},
+    {"CORRELATING_COUNTER_BITS",       &PredictorConfig::correlating_counter_bits},
+    {"LOCAL_LHT_BITS",                 &PredictorConfig::local_lht_bits},
+    {"LOCAL_HISTORY_BITS",             &PredictorConfig::local_history_bits},
+    {"LOCAL_PHT_BITS",                 &PredictorConfig::local_pht_bits},
+    {"LOCAL_INFINITE",                 &PredictorConfig::local_infinite},
+    {"TOURNAMENT_SELECTOR_BITS",       &PredictorConfig::tournament_selector_bits},
+    {"TOURNAMENT_BIMODAL_BITS",        &PredictorConfig::tournament_bimodal_bits},
+    {"TOURNAMENT_GSHARE_TABLE_BITS",   &PredictorConfig::tournament_gshare_table_bits},
+    {"TOURNAMENT_GSHARE_HISTORY_BITS", &PredictorConfig::tournament_gshare_history_bits},
+    {"PERCEPTRON_TABLE_BITS",          &PredictorConfig::perceptron_table_bits},
+    {"PERCEPTRON_HISTORY_LENGTH",      &PredictorConfig::perceptron_history_length},
+    {"PERCEPTRON_WEIGHT_BITS",         &PredictorConfig::perceptron_weight_bits},
+    {"PERCEPTRON_THRESHOLD",           &PredictorConfig::perceptron_threshold},
+    {"PERCEPTRON_INFINITE",            &PredictorConfig::perceptron_infinite},
+};
+static_assert(sizeof(predictor_config_fields) / sizeof(predictor_config_fields[0]) <= 64,
+              "g_predictor_config_pinned has one bit per field");
+
+// Look up a field by its environment variable name; returns nullptr if unknown
+inline const PredictorConfigField* find_config_field(const std::string& name) {
+    for (const PredictorConfigField& f : predictor_config_fields) {
+        if (name == f.name)
+            return &f;
+    }
+    return nullptr;
+}
+
+// Fields load_config_from_env() leaves alone on this thread, one bit per
+// predictor_config_fields entry: cbp-sweep pins its -set axes so a run is
+// simulated with the grid value its label shows.
+extern thread_local uint64_t g_predictor_config_pinned;
+
+inline uint64_t config_field_bit(const PredictorConfigField* f) {
+    return 1ull << (f - predictor_config_fields);
+}
 
 // Function to load configuration from environment variables
 inline void load_config_from_env() {
-    // Onebit
-    if (const char* val = std::getenv("ONEBIT_TABLE_BITS")) {
-        g_predictor_config.onebit_table_bits = std::atoi(val);
-    }
-    
-    // Twobit
-    if (const char* val = std::getenv("TWOBIT_TABLE_BITS")) {
-        g_predictor_config.twobit_table_bits = std::atoi(val);
-    }
-    
-    // Gshare
-    if (const char* val = std::getenv("GSHARE_TABLE_BITS")) {
-        g_predictor_config.gshare_table_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("GSHARE_HISTORY_BITS")) {
-        g_predictor_config.gshare_history_bits = std::atoi(val);
-    }
-    
-    // Correlating
-    if (const char* val = std::getenv("CORRELATING_PC_BITS")) {
-        g_predictor_config.correlating_pc_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("CORRELATING_HISTORY_BITS")) {
-        g_predictor_config.correlating_history_bits = std::atoi(val);
-    }
-    
-    // Local
-    if (const char* val = std::getenv("LOCAL_LHT_BITS")) {
-        g_predictor_config.local_lht_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("LOCAL_HISTORY_BITS")) {
-        g_predictor_config.local_history_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("LOCAL_PHT_BITS")) {
-        g_predictor_config.local_pht_bits = std::atoi(val);
-    }
-    
-    // Tournament
-    if (const char* val = std::getenv("TOURNAMENT_SELECTOR_BITS")) {
-        g_predictor_config.tournament_selector_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("TOURNAMENT_BIMODAL_BITS")) {
-        g_predictor_config.tournament_bimodal_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("TOURNAMENT_GSHARE_TABLE_BITS")) {
-        g_predictor_config.tournament_gshare_table_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("TOURNAMENT_GSHARE_HISTORY_BITS")) {
-        g_predictor_config.tournament_gshare_history_bits = std::atoi(val);
-    }
-    
-    // Perceptron
-    if (const char* val = std::getenv("PERCEPTRON_TABLE_BITS")) {
-        g_predictor_config.perceptron_table_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("PERCEPTRON_HISTORY_LENGTH")) {
-        g_predictor_config.perceptron_history_length = std::atoi(val);
-    }
-    if (const char* val = std::getenv("PERCEPTRON_WEIGHT_BITS")) {
-        g_predictor_config.perceptron_weight_bits = std::atoi(val);
-    }
-    if (const char* val = std::getenv("PERCEPTRON_THRESHOLD")) {
-        g_predictor_config.perceptron_threshold = std::atoi(val);
+    for (const PredictorConfigField& f : predictor_config_fields) {
+        if (g_predictor_config_pinned & config_field_bit(&f))
+            continue;
+        if (const char* val = std::getenv(f.name)) {
+            g_predictor_config.*f.member = std::atoi(val);
+        }
     }
 }
 
 // Function to print current configuration
 inline void print_config() {
     printf("=== Predictor Configuration ===\n");
-    printf("Onebit: table_bits=%d\n", g_predictor_config.onebit_table_bits);
-    printf("Twobit: table_bits=%d\n", g_predictor_config.twobit_table_bits);
-    printf("Gshare: table_bits=%d, history_bits=%d\n", 
-           g_predictor_config.gshare_table_bits, g_predictor_config.gshare_history_bits);
+    printf("Onebit: table_bits=%d, infinite=%d\n",
+           g_predictor_config.onebit_table_bits, g_predictor_config.onebit_infinite);
+    printf("Twobit: table_bits=%d, infinite=%d\n",
+           g_predictor_config.twobit_table_bits, g_predictor_config.twobit_infinite);
+    printf("Gshare: table_bits=%d, history_bits=%d, infinite=%d\n", 
+           g_predictor_config.gshare_table_bits, g_predictor_config.gshare_history_bits,
+           g_predictor_config.gshare_infinite);
     printf("Correlating: pc_bits=%d, history_bits=%d, counter_bits=%d\n",
            g_predictor_config.correlating_pc_bits, g_predictor_config.correlating_history_bits, 
            g_predictor_config.correlating_counter_bits);
-    printf("Local: lht_bits=%d, history_bits=%d, pht_bits=%d\n",
+    printf("Local: lht_bits=%d, history_bits=%d, pht_bits=%d, infinite=%d\n",
            g_predictor_config.local_lht_bits, g_predictor_config.local_history_bits,
-           g_predictor_config.local_pht_bits);
+           g_predictor_config.local_pht_bits, g_predictor_config.local_infinite);
     printf("Tournament: selector_bits=%d, bimodal_bits=%d, gshare_table_bits=%d, gshare_history_bits=%d\n",
            g_predictor_config.tournament_selector_bits, g_predictor_config.tournament_bimodal_bits,
            g_predictor_config.tournament_gshare_table_bits, g_predictor_config.tournament_gshare_history_bits);
-    printf("Perceptron: table_bits=%d, history_length=%d, weight_bits=%d, threshold=%d\n",
+    printf("Perceptron: table_bits=%d, history_length=%d, weight_bits=%d, threshold=%d, infinite=%d\n",
            g_predictor_config.perceptron_table_bits, g_predictor_config.perceptron_history_length,
-           g_predictor_config.perceptron_weight_bits, g_predictor_config.perceptron_threshold);
+           g_predictor_config.perceptron_weight_bits, g_predictor_config.perceptron_threshold,
+           g_predictor_config.perceptron_infinite);
     printf("===============================\n");
 }
 
@@ -1,5 +1,14 @@
-#ifndef _TAGE_PREDICTOR_H_
-#define _TAGE_PREDICTOR_H_
+// Reference copy of the 192KB CBP2016 TAGE-SC-L as it was before the
+// TageScL<Config> rewrite (statistical-corrector gather, structure-of-arrays
+// tagged tables, one template for both budgets). cbp-check's tage-ref
+// variant runs it in lockstep with cbp2016_tage_sc_l.h; do not optimize it.
+//
+// Changes from the original: the include guard, the reference_tage_sc_l_192kb
+// namespace, thread_local file-scope state (each cbp-check side runs on its
+// own thread), no file-scope predictor instance
+// (reference/reference_tage_sc_l_192kb.cc owns it), and PRINTSIZE off.
+#ifndef _REFERENCE_TAGE_SC_L_192KB_H_
+#define _REFERENCE_TAGE_SC_L_192KB_H_
 
 #include <stdlib.h>
 #include <string.h>
@@ -12,6 +21,8 @@
 #include <array>
 #include <iostream>
 
+namespace reference_tage_sc_l_192kb {
+
 
 //parameters of the loop predictor
 #define LOGL 8
@@ -23,7 +34,7 @@
 
 #define BORNTICK  1024
 //To get the predictor storage budget on stderr  uncomment the next line
-#define PRINTSIZE
+//#define PRINTSIZE
 
 #define SC          // 8.2 % if TAGE alone
 #define IMLI            // 0.2 %
@@ -43,9 +54,9 @@
 //The three BIAS tables in the SC component
 //We play with the TAGE  confidence here, with the number of the hitting bank
 #define LOGBIAS 11
-int8_t Bias[(1 << LOGBIAS)];
-int8_t BiasSK[(1 << LOGBIAS)];
-int8_t BiasBank[(1 << LOGBIAS)];
+thread_local int8_t Bias[(1 << LOGBIAS)];
+thread_local int8_t BiasSK[(1 << LOGBIAS)];
+thread_local int8_t BiasBank[(1 << LOGBIAS)];
 
 //In all th GEHL components, the two tables with the shortest history lengths have only half of the entries.
 
@@ -53,63 +64,63 @@ int8_t BiasBank[(1 << LOGBIAS)];
 #ifdef IMLI
 #define LOGINB 10        // 512-entry
 #define INB 1
-int Im[INB] = { 8 };
-int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
+thread_local int Im[INB] = { 8 };
+thread_local int8_t IGEHLA[INB][(1 << LOGINB)] = { {0} };
 
-int8_t *IGEHL[INB];
+thread_local int8_t *IGEHL[INB];
 
 #define LOGIMNB 11       // 2 * 1K-entry
 #define IMNB 2
 
-int IMm[IMNB] = { 10, 4 };
-int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
+thread_local int IMm[IMNB] = { 10, 4 };
+thread_local int8_t IMGEHLA[IMNB][(1 << LOGIMNB)] = { {0} };
 
-int8_t *IMGEHL[IMNB];
+thread_local int8_t *IMGEHL[IMNB];
 
 #endif
 
 //global branch GEHL
 #define LOGGNB 12       // 1 4K + 2 * 2K-entry tables
 #define GNB 3
-int Gm[GNB] = { 40, 24, 10 };
-int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
+thread_local int Gm[GNB] = { 40, 24, 10 };
+thread_local int8_t GGEHLA[GNB][(1 << LOGGNB)] = { {0} };
 
-int8_t *GGEHL[GNB];
+thread_local int8_t *GGEHL[GNB];
 
 //variation on global branch history
 #define PNB 3
 #define LOGPNB 11        // 1 2K + 2 * 1K-entry tables
-int Pm[PNB] = { 25, 16, 9 };
-int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
+thread_local int Pm[PNB] = { 25, 16, 9 };
+thread_local int8_t PGEHLA[PNB][(1 << LOGPNB)] = { {0} };
 
-int8_t *PGEHL[PNB];
+thread_local int8_t *PGEHL[PNB];
 
 //first local history
 #define LOGLNB  11      // 1 2K + 2 * 1K-entry tables
 #define LNB 3
-int Lm[LNB] = { 11, 6, 3 };
-int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
-int8_t *LGEHL[LNB];
+thread_local int Lm[LNB] = { 11, 6, 3 };
+thread_local int8_t LGEHLA[LNB][(1 << LOGLNB)] = { {0} };
+thread_local int8_t *LGEHL[LNB];
 #define  LOGLOCAL 9
 #define NLOCAL (1<<LOGLOCAL)
 
 // second local history
 #define LOGSNB 10        // 1 1K + 2 * 512-entry tables
 #define SNB 3
-int Sm[SNB] = { 16, 11, 6 };
-int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
+thread_local int Sm[SNB] = { 16, 11, 6 };
+thread_local int8_t SGEHLA[SNB][(1 << LOGSNB)] = { {0} };
 
-int8_t *SGEHL[SNB];
+thread_local int8_t *SGEHL[SNB];
 #define LOGSECLOCAL 5
 #define NSECLOCAL (1<<LOGSECLOCAL)  //Number of second local histories
 
 //third local history
 #define LOGTNB 11       // 2 * 1K-entry tables
 #define TNB 2
-int Tm[TNB] = { 9, 4 };
-int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
+thread_local int Tm[TNB] = { 9, 4 };
+thread_local int8_t TGEHLA[TNB][(1 << LOGTNB)] = { {0} };
 
-int8_t *TGEHL[TNB];
+thread_local int8_t *TGEHL[TNB];
 #define LOGTLOCAL 5
 #define NTLOCAL (1<<LOGTLOCAL)  //Number of third local histories
 
@@ -127,24 +138,24 @@ int8_t *TGEHL[TNB];
 #endif
 // LOGSIZEUPS and related weights
 #define LOGSIZEUPS  (LOGSIZEUP/2)
-int updatethreshold;
-int Pupdatethreshold[(1 << LOGSIZEUP)]; //size is fixed by LOGSIZEUP
+thread_local int updatethreshold;
+thread_local int Pupdatethreshold[(1 << LOGSIZEUP)]; //size is fixed by LOGSIZEUP
 #define INDUPD (PC ^ (PC >>2)) & ((1 << LOGSIZEUP) - 1)
 #define INDUPDS ((PC ^ (PC >>2)) & ((1 << (LOGSIZEUPS)) - 1))
-int8_t WG[(1 << LOGSIZEUPS)];
-int8_t WL[(1 << LOGSIZEUPS)];
-int8_t WS[(1 << LOGSIZEUPS)];
-int8_t WT[(1 << LOGSIZEUPS)];
-int8_t WP[(1 << LOGSIZEUPS)];
-int8_t WI[(1 << LOGSIZEUPS)];
-int8_t WIM[(1 << LOGSIZEUPS)];
-int8_t WB[(1 << LOGSIZEUPS)];
+thread_local int8_t WG[(1 << LOGSIZEUPS)];
+thread_local int8_t WL[(1 << LOGSIZEUPS)];
+thread_local int8_t WS[(1 << LOGSIZEUPS)];
+thread_local int8_t WT[(1 << LOGSIZEUPS)];
+thread_local int8_t WP[(1 << LOGSIZEUPS)];
+thread_local int8_t WI[(1 << LOGSIZEUPS)];
+thread_local int8_t WIM[(1 << LOGSIZEUPS)];
+thread_local int8_t WB[(1 << LOGSIZEUPS)];
 #define EWIDTH 6
-int LSUM;
+thread_local int LSUM;
 
 // The two counters used to choose between TAGE and SC on Low Conf SC
-int8_t FirstH, SecondH;
-bool MedConf;           // is the TAGE prediction medium confidence
+thread_local int8_t FirstH, SecondH;
+thread_local bool MedConf;           // is the TAGE prediction medium confidence
 
 
 // Counter and buffer widths
@@ -196,7 +207,7 @@ class gentry            // TAGE global table entry
 #define NBANKLOW 10     // number of banks in the shared bank-interleaved for the low history lengths
 #define NBANKHIGH 20        // number of banks in the shared bank-interleaved for the  history lengths
 
-int SizeTable[NHIST + 1];
+thread_local int SizeTable[NHIST + 1];
 
 
 #define BORN 13         // below BORN in the table for low history lengths, >= BORN in the table for high history lengths,
@@ -215,7 +226,7 @@ int SizeTable[NHIST + 1];
 #define TBITS 10         //minimum width of the tags  (low history lengths), +4 for high history lengths
 
 
-bool NOSKIP[NHIST + 1];     // to manage the associativity for different history lengths
+thread_local bool NOSKIP[NHIST + 1];     // to manage the associativity for different history lengths
 
 
 
@@ -231,15 +242,15 @@ bool NOSKIP[NHIST + 1];     // to manage the associativity for different history
 
 //the counter(s) to chose between longest match and alternate prediction on TAGE when weak counters
 #define LOGSIZEUSEALT 4
-bool AltConf;           // Confidence on the alternate prediction
+thread_local bool AltConf;           // Confidence on the alternate prediction
 #define ALTWIDTH 5
 #define SIZEUSEALT  (1<<(LOGSIZEUSEALT))
 #define INDUSEALT (((((HitBank-1)/8)<<1)+AltConf) % (SIZEUSEALT-1))
-int8_t use_alt_on_na[SIZEUSEALT];
+thread_local int8_t use_alt_on_na[SIZEUSEALT];
 //very marginal benefit
-int8_t BIM;
+thread_local int8_t BIM;
 
-int TICK;           // for the reset of the u counter
+thread_local int TICK;           // for the reset of the u counter
 //uint8_t ghist[HISTBUFFERLENGTH];
 //int ptghist;
 //uint64_t phist;      //path history
@@ -270,14 +281,14 @@ class lentry            //loop predictor entry
 };
 
 //For the TAGE predictor
-bentry *btable;         //bimodal TAGE table
-gentry *gtable[NHIST + 1];  // tagged TAGE tables
+thread_local bentry *btable;         //bimodal TAGE table
+thread_local gentry *gtable[NHIST + 1];  // tagged TAGE tables
 //lentry *ltable;
-int m[NHIST + 1];
-int TB[NHIST + 1];
-int logg[NHIST + 1];
+thread_local int m[NHIST + 1];
+thread_local int TB[NHIST + 1];
+thread_local int logg[NHIST + 1];
 
-uint64_t Seed;           // for the pseudo-random number generator
+thread_local uint64_t Seed;           // for the pseudo-random number generator
 
 
 class folded_history
@@ -1763,7 +1774,8 @@ class CBP2016_TAGE_SC_L
 // =================
 
 
+} // namespace reference_tage_sc_l_192kb
+
 #undef UINT64
 
 #endif
-static CBP2016_TAGE_SC_L cbp2016_tage_sc_l;
@@ -0,0 +1,53 @@
+// Reference copy of the onebit predictor as it was before the SatCounterArray
+// port and the infinite-table mode. cbp-check's simple-ref variant runs it in
+// lockstep with onebit_predictor.cc; do not optimize it.
+//
+// Changes from the original: the include guard, the reference_onebit
+// namespace, the declarations from its header, per-thread file-scope state
+// (static thread_local) and #undef of its macros at the end.
+
+#ifndef _REFERENCE_ONEBIT_PREDICTOR_H
+#define _REFERENCE_ONEBIT_PREDICTOR_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace reference_onebit {
+
+void onebit_predictor_init(int table_bits);
+uint8_t onebit_predictor_predict(uint32_t pc);
+void onebit_predictor_train(uint32_t pc, uint8_t outcome);
+void onebit_predictor_cleanup();
+
+// onebit_predictor.cc
+// Simple 1-bit branch predictor template implementation
+#define TAKEN 1
+#define NOTTAKEN 0
+static thread_local uint8_t* table = NULL;
+static thread_local uint32_t mask = 0;
+static thread_local int bits = 0;
+void onebit_predictor_init(int table_bits) {
+    bits = table_bits;
+    uint32_t size = 1 << bits;
+    table = (uint8_t*)malloc(size * sizeof(uint8_t));
+    for (uint32_t i = 0; i < size; i++) table[i] = NOTTAKEN;
+    mask = size - 1;
+}
+uint8_t onebit_predictor_predict(uint32_t pc) {
+    uint32_t idx = pc & mask;
+    return table[idx];
+}
+void onebit_predictor_train(uint32_t pc, uint8_t outcome) {
+    uint32_t idx = pc & mask;
+    table[idx] = outcome ? TAKEN : NOTTAKEN;
+}
+void onebit_predictor_cleanup() {
+    if (table) free(table);
+    table = NULL;
+}
+
+#undef TAKEN
+#undef NOTTAKEN
+} // namespace reference_onebit
+
+#endif
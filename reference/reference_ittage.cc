@@ -0,0 +1,38 @@
+// reference_ittage.cc
+// The pre-rewrite ITTAGE behind ReferenceIttage, and the per-thread switch
+// bp_t reads.
+#include "reference_predictors.h"
+#include "ittage.h"
+
+class ReferenceIttageImpl : public ReferenceIttage {
+public:
+    uint64_t GetPrediction(uint64_t pc) override {
+        return p.GetPrediction(pc);
+    }
+    void UpdatePredictor(uint64_t pc, uint64_t target) override {
+        p.UpdatePredictor(pc, target);
+    }
+    void TrackOtherInst(uint64_t pc, uint64_t next_pc) override {
+        p.TrackOtherInst(pc, next_pc);
+    }
+
+private:
+    reference_ittage::IPREDICTOR p;
+};
+
+ReferenceIttage *new_reference_ittage()
+{
+    return new ReferenceIttageImpl();
+}
+
+static thread_local bool reference_ittage_on = false;
+
+void select_reference_ittage(bool on)
+{
+    reference_ittage_on = on;
+}
+
+bool reference_ittage_selected()
+{
+    return reference_ittage_on;
+}
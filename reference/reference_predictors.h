@@ -0,0 +1,111 @@
+// reference_predictors.h
+// The pre-rewrite TAGE-SC-L (64KB and 192KB), ITTAGE, simple predictors and
+// stride prefetcher, kept as the reference side of cbp-check's tage-ref,
+// ittage-ref, simple-ref and prefetcher-ref variants. Each one is compiled in
+// its own namespace (reference_*.cc), so its macros and names stay away from
+// the current implementations.
+#ifndef REFERENCE_PREDICTORS_H
+#define REFERENCE_PREDICTORS_H
+
+#include <stdint.h>
+#include "../lib/predictor_type.h"
+
+// A reference TAGE-SC-L behind the calls the interface makes on TageScL.
+// Selected with PRED_TAGE_SC_L_REF / PRED_TAGE_SC_L_192KB_REF.
+class ReferenceTageScL {
+public:
+    virtual ~ReferenceTageScL() {}
+    virtual bool predict(uint64_t seq_no, uint8_t piece, uint64_t pc) = 0;
+    virtual cond_provider_t provider(bool pred_taken) const = 0;
+    virtual void history_update(uint64_t seq_no, uint8_t piece, uint64_t pc, int br_type, bool pred_dir, bool resolve_dir, uint64_t next_pc) = 0;
+    virtual void TrackOtherInst(uint64_t pc, int br_type, bool pred_dir, bool resolve_dir, uint64_t next_pc) = 0;
+    virtual void update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) = 0;
+};
+
+template <class TAGE>
+class ReferenceTageScLAdapter : public ReferenceTageScL {
+public:
+    bool predict(uint64_t seq_no, uint8_t piece, uint64_t pc) override {
+        return p.predict(seq_no, piece, pc);
+    }
+    cond_provider_t provider(bool pred_taken) const override {
+        return tage_sc_l_provider(p, pred_taken);
+    }
+    void history_update(uint64_t seq_no, uint8_t piece, uint64_t pc, int br_type, bool pred_dir, bool resolve_dir, uint64_t next_pc) override {
+        p.history_update(seq_no, piece, pc, br_type, pred_dir, resolve_dir, next_pc);
+    }
+    void TrackOtherInst(uint64_t pc, int br_type, bool pred_dir, bool resolve_dir, uint64_t next_pc) override {
+        p.TrackOtherInst(pc, br_type, pred_dir, resolve_dir, next_pc);
+    }
+    void update(uint64_t seq_no, uint8_t piece, uint64_t pc, bool resolve_dir, bool pred_dir, uint64_t next_pc) override {
+        p.update(seq_no, piece, pc, resolve_dir, pred_dir, next_pc);
+    }
+
+private:
+    TAGE p;
+};
+
+// A fresh predictor; its file-scope tables are per thread, so one at a time
+// per thread. The object is value-initialized, so members the constructor
+// leaves alone start at zero as they did in the original file-scope instance.
+ReferenceTageScL *new_reference_tage_sc_l_64kb();
+ReferenceTageScL *new_reference_tage_sc_l_192kb();
+
+// The reference ITTAGE, with its original calls (no prediction state passed
+// from GetPrediction() to UpdatePredictor()).
+class ReferenceIttage {
+public:
+    virtual ~ReferenceIttage() {}
+    virtual uint64_t GetPrediction(uint64_t pc) = 0;
+    virtual void UpdatePredictor(uint64_t pc, uint64_t target) = 0;
+    virtual void TrackOtherInst(uint64_t pc, uint64_t next_pc) = 0;
+};
+
+ReferenceIttage *new_reference_ittage();
+
+// Per thread: bp_t objects created while this is set predict indirect
+// branches with the reference ITTAGE.
+void select_reference_ittage(bool on);
+bool reference_ittage_selected();
+
+// The pre-port onebit, twobit, correlating, local, gshare, tournament and
+// perceptron predictors (finite tables only), behind the calls the simulator
+// makes on the selected one.
+class ReferenceSimplePredictor {
+public:
+    virtual ~ReferenceSimplePredictor() {}
+    virtual bool predict(uint64_t pc) = 0;
+    virtual void train(uint64_t pc, bool taken) = 0;
+};
+
+// Sized from g_predictor_config; null for a predictor with no reference copy.
+ReferenceSimplePredictor *new_reference_simple_predictor(PredictorType pt);
+
+// Per thread: beginCondDirPredictor() calls made while this is set run the
+// reference copy of the selected simple predictor in its place.
+void select_reference_simple(bool on);
+bool reference_simple_selected();
+// The copy the last beginCondDirPredictor() on this thread created, else null.
+ReferenceSimplePredictor *reference_simple_predictor();
+
+// The reference stride prefetcher, behind the calls uarchsim_t makes on
+// StridePrefetcher (a Prefetch is passed as its address and generation cycle).
+class ReferenceStridePrefetcher {
+public:
+    virtual ~ReferenceStridePrefetcher() {}
+    virtual void lookahead(uint64_t la_pc, uint64_t cycle) = 0;
+    virtual void train(uint64_t pc, uint64_t address, uint64_t size, bool miss) = 0;
+    virtual bool issue(uint64_t &address, uint64_t &cycle_generated, uint64_t cycle) = 0;
+    virtual void put_back(uint64_t address, uint64_t cycle_generated) = 0;
+    virtual uint64_t get_oldest_pf_cycle() const = 0;
+    virtual void print_stats() = 0;
+};
+
+ReferenceStridePrefetcher *new_reference_stride_prefetcher();
+
+// Per thread: uarchsim_t objects created while this is set prefetch with the
+// reference stride prefetcher.
+void select_reference_prefetcher(bool on);
+bool reference_prefetcher_selected();
+
+#endif // REFERENCE_PREDICTORS_H
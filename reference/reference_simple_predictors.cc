@@ -0,0 +1,100 @@
+// reference_simple_predictors.cc
+// The pre-port simple predictors behind ReferenceSimplePredictor, and the
+// per-thread switch beginCondDirPredictor() reads.
+#include "reference_predictors.h"
+#include "../predictor_config.h"
+#include "onebit_predictor.h"
+#include "twobit_predictor.h"
+#include "correlating_predictor.h"
+#include "local_predictor.h"
+#include "gshare_predictor.h"
+#include "tournament_predictor.h"
+#include "perceptron_predictor.h"
+
+// One reference predictor's functions; the PC is cut to 32 bits, as the
+// interface did before the ports.
+class ReferenceSimplePredictorImpl : public ReferenceSimplePredictor {
+public:
+    ReferenceSimplePredictorImpl(uint8_t (*predict_fn)(uint32_t), void (*train_fn)(uint32_t, uint8_t), void (*cleanup_fn)())
+        : predict_fn(predict_fn), train_fn(train_fn), cleanup_fn(cleanup_fn) {}
+    ~ReferenceSimplePredictorImpl() override {
+        cleanup_fn();
+    }
+    bool predict(uint64_t pc) override {
+        return predict_fn((uint32_t)pc);
+    }
+    void train(uint64_t pc, bool taken) override {
+        train_fn((uint32_t)pc, taken);
+    }
+
+private:
+    uint8_t (*predict_fn)(uint32_t);
+    void (*train_fn)(uint32_t, uint8_t);
+    void (*cleanup_fn)();
+};
+
+// The interface trained the perceptron and then shifted its history.
+static void perceptron_train_and_update_history(uint32_t pc, uint8_t outcome)
+{
+    reference_perceptron::perceptron_predictor_train(pc, outcome);
+    reference_perceptron::perceptron_predictor_update_history(outcome);
+}
+
+ReferenceSimplePredictor *new_reference_simple_predictor(PredictorType pt)
+{
+    const PredictorConfig &c = g_predictor_config;
+    switch (pt) {
+    case PredictorType::PRED_ONEBIT:
+        reference_onebit::onebit_predictor_init(c.onebit_table_bits);
+        return new ReferenceSimplePredictorImpl(reference_onebit::onebit_predictor_predict,
+                                                reference_onebit::onebit_predictor_train,
+                                                reference_onebit::onebit_predictor_cleanup);
+    case PredictorType::PRED_TWOBIT:
+        reference_twobit::twobit_predictor_init(c.twobit_table_bits);
+        return new ReferenceSimplePredictorImpl(reference_twobit::twobit_predictor_predict,
+                                                reference_twobit::twobit_predictor_train,
+                                                reference_twobit::twobit_predictor_cleanup);
+    case PredictorType::PRED_CORRELATING:
+        reference_correlating::correlating_predictor_init(c.correlating_pc_bits, c.correlating_history_bits,
+                                                          c.correlating_counter_bits);
+        return new ReferenceSimplePredictorImpl(reference_correlating::correlating_predictor_predict,
+                                                reference_correlating::correlating_predictor_train,
+                                                reference_correlating::correlating_predictor_cleanup);
+    case PredictorType::PRED_LOCAL:
+        reference_local::local_predictor_init(c.local_lht_bits, c.local_history_bits, c.local_pht_bits);
+        return new ReferenceSimplePredictorImpl(reference_local::local_predictor_predict,
+                                                reference_local::local_predictor_train,
+                                                reference_local::local_predictor_cleanup);
+    case PredictorType::PRED_GSHARE:
+        reference_gshare::gshare_predictor_init(c.gshare_table_bits, c.gshare_history_bits);
+        return new ReferenceSimplePredictorImpl(reference_gshare::gshare_predictor_predict,
+                                                reference_gshare::gshare_predictor_train,
+                                                reference_gshare::gshare_predictor_cleanup);
+    case PredictorType::PRED_TOURNAMENT:
+        reference_tournament::tournament_predictor_init(c.tournament_selector_bits, c.tournament_bimodal_bits,
+                                                        c.tournament_gshare_table_bits, c.tournament_gshare_history_bits);
+        return new ReferenceSimplePredictorImpl(reference_tournament::tournament_predictor_predict,
+                                                reference_tournament::tournament_predictor_train,
+                                                reference_tournament::tournament_predictor_cleanup);
+    case PredictorType::PRED_PERCEPTRON:
+        reference_perceptron::perceptron_predictor_init(c.perceptron_table_bits, c.perceptron_history_length,
+                                                        c.perceptron_weight_bits, c.perceptron_threshold);
+        return new ReferenceSimplePredictorImpl(reference_perceptron::perceptron_predictor_predict,
+                                                perceptron_train_and_update_history,
+                                                reference_perceptron::perceptron_predictor_cleanup);
+    default:
+        return nullptr;
+    }
+}
+
+static thread_local bool reference_simple_on = false;
+
+void select_reference_simple(bool on)
+{
+    reference_simple_on = on;
+}
+
+bool reference_simple_selected()
+{
+    return reference_simple_on;
+}
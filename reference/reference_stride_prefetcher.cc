@@ -0,0 +1,51 @@
+// reference_stride_prefetcher.cc
+// The pre-rewrite stride prefetcher behind ReferenceStridePrefetcher, and the
+// per-thread switch uarchsim_t reads.
+#include "reference_predictors.h"
+#include "stride_prefetcher.h"
+
+class ReferenceStridePrefetcherImpl : public ReferenceStridePrefetcher {
+public:
+    void lookahead(uint64_t la_pc, uint64_t cycle) override {
+        p.lookahead(la_pc, cycle);
+    }
+    void train(uint64_t pc, uint64_t address, uint64_t size, bool miss) override {
+        p.train(reference_stride_prefetcher::PrefetchTrainingInfo{pc, address, size, miss});
+    }
+    bool issue(uint64_t &address, uint64_t &cycle_generated, uint64_t cycle) override {
+        reference_stride_prefetcher::Prefetch pf;
+        const bool issued = p.issue(pf, cycle);
+        address = pf.address;
+        cycle_generated = pf.cycle_generated;
+        return issued;
+    }
+    void put_back(uint64_t address, uint64_t cycle_generated) override {
+        p.put_back(reference_stride_prefetcher::Prefetch{address, cycle_generated});
+    }
+    uint64_t get_oldest_pf_cycle() const override {
+        return p.get_oldest_pf_cycle();
+    }
+    void print_stats() override {
+        p.print_stats();
+    }
+
+private:
+    reference_stride_prefetcher::StridePrefetcher p;
+};
+
+ReferenceStridePrefetcher *new_reference_stride_prefetcher()
+{
+    return new ReferenceStridePrefetcherImpl();
+}
+
+static thread_local bool reference_prefetcher_on = false;
+
+void select_reference_prefetcher(bool on)
+{
+    reference_prefetcher_on = on;
+}
+
+bool reference_prefetcher_selected()
+{
+    return reference_prefetcher_on;
+}
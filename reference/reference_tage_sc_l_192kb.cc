@@ -0,0 +1,9 @@
+// reference_tage_sc_l_192kb.cc
+// The pre-rewrite 192KB TAGE-SC-L behind ReferenceTageScL.
+#include "reference_predictors.h"
+#include "cbp2016_tage_sc_l_192kb.h"
+
+ReferenceTageScL *new_reference_tage_sc_l_192kb()
+{
+    return new ReferenceTageScLAdapter<reference_tage_sc_l_192kb::CBP2016_TAGE_SC_L>();
+}
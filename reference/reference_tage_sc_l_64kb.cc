@@ -0,0 +1,9 @@
+// reference_tage_sc_l_64kb.cc
+// The pre-rewrite 64KB TAGE-SC-L behind ReferenceTageScL.
+#include "reference_predictors.h"
+#include "cbp2016_tage_sc_l_64kb.h"
+
+ReferenceTageScL *new_reference_tage_sc_l_64kb()
+{
+    return new ReferenceTageScLAdapter<reference_tage_sc_l_64kb::CBP2016_TAGE_SC_L>();
+}
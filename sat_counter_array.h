@@ -0,0 +1,157 @@
+// sat_counter_array.h
+// Bit-packed saturating-counter tables for the simple predictors
+#ifndef SAT_COUNTER_ARRAY_H
+#define SAT_COUNTER_ARRAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+// A table of n-bit saturating counters packed into 64-bit words, in place of
+// one uint8_t per counter: a 2^22-entry table of 2-bit counters takes 1 MiB
+// instead of 4 MiB. Slots are rounded up to 1, 2, 4 or 8 bits so a counter
+// never straddles two words; storage_bits() counts the counters' own width.
+//
+// Bits is the counter width; Bits = 0 takes the width from init() instead
+// (for configurable widths such as CORRELATING_COUNTER_BITS), at the cost of
+// shifts by a variable. Widths above 8 are not supported.
+//
+// update() steps a counter toward taken or not taken without branching on its
+// value. Counters are in [0, 2^bits - 1] and taken() is the upper half.
+template <unsigned Bits>
+class SatCounterArray {
+    static_assert(Bits <= 8, "SatCounterArray holds counters of at most 8 bits");
+
+public:
+    SatCounterArray() { set_width(Bits ? Bits : 2); }
+
+    // n counters of `bits` bits (ignored unless Bits is 0), all set to value.
+    void init(size_t n, unsigned value, unsigned bits = Bits) {
+        set_width(Bits ? Bits : bits);
+        num = n;
+        words.assign(words_for(n), fill_word(value));
+    }
+
+    // Grows the table to at least n counters; the new ones are set to value.
+    void grow(size_t n, unsigned value) {
+        if (n <= num)
+            return;
+        // The rest of the last partly used word, then whole words.
+        const size_t first_whole = words.size() << per_word_log2();
+        for (size_t i = num; i < n && i < first_whole; i++)
+            set(i, value);
+        words.resize(words_for(n), fill_word(value));
+        num = n;
+    }
+
+    void clear() {
+        std::vector<uint64_t>().swap(words);
+        num = 0;
+    }
+
+    inline unsigned get(size_t i) const {
+        return (unsigned)(words[i >> per_word_log2()] >> shift_of(i)) & mask();
+    }
+
+    inline void set(size_t i, unsigned value) {
+        uint64_t& w = words[i >> per_word_log2()];
+        const unsigned s = shift_of(i);
+        w = (w & ~((uint64_t)mask() << s)) | ((uint64_t)(value & mask()) << s);
+    }
+
+    // Counter in the upper half of its range.
+    inline bool taken(size_t i) const {
+        return (get(i) >> (width() - 1)) & 1;
+    }
+
+    // Saturating increment (up) or decrement. A decrement only happens on a
+    // nonzero counter, so the subtraction never borrows from the next slot.
+    inline void update(size_t i, bool up) {
+        uint64_t& w = words[i >> per_word_log2()];
+        const unsigned s = shift_of(i);
+        const unsigned v = (unsigned)(w >> s) & mask();
+        const uint64_t inc = (uint64_t)(up & (v != mask()));
+        const uint64_t dec = (uint64_t)(!up & (v != 0));
+        w += (inc << s) - (dec << s);
+    }
+
+    size_t size() const { return num; }
+    unsigned bits() const { return width(); }
+    // Exact storage of the counters, as a hardware budget counts it.
+    uint64_t storage_bits() const { return (uint64_t)num * width(); }
+    // Memory actually used, slot padding included.
+    size_t footprint_bytes() const { return words.size() * sizeof(uint64_t); }
+
+private:
+    static constexpr unsigned slot_log2_of(unsigned bits) {
+        return bits <= 1 ? 0 : bits <= 2 ? 1 : bits <= 4 ? 2 : 3;
+    }
+
+    void set_width(unsigned bits) {
+        dyn_width = bits;
+        dyn_slot_log2 = slot_log2_of(bits);
+    }
+
+    // Constants when Bits is given, so the compiler folds them.
+    inline unsigned width() const { return Bits ? Bits : dyn_width; }
+    inline unsigned slot_log2() const { return Bits ? slot_log2_of(Bits) : dyn_slot_log2; }
+    inline unsigned per_word_log2() const { return 6 - slot_log2(); }
+    inline unsigned mask() const { return (1u << width()) - 1; }
+    inline unsigned shift_of(size_t i) const {
+        return (unsigned)(i & ((1u << per_word_log2()) - 1)) << slot_log2();
+    }
+
+    size_t words_for(size_t n) const {
+        return (n + (1u << per_word_log2()) - 1) >> per_word_log2();
+    }
+
+    // A word with every slot set to value (batch initialization).
+    uint64_t fill_word(unsigned value) const {
+        uint64_t w = 0;
+        for (unsigned s = 0; s < 64; s += 1u << slot_log2())
+            w |= (uint64_t)(value & mask()) << s;
+        return w;
+    }
+
+    std::vector<uint64_t> words;
+    size_t num = 0;
+    unsigned dyn_width = 0;
+    unsigned dyn_slot_log2 = 0;
+};
+
+// Signed counters in [-2^(Bits-1), 2^(Bits-1) - 1], as TAGE-style predictors
+// use them; taken() is value >= 0. They are stored offset by 2^(Bits-1), so
+// saturation and packing are those of SatCounterArray.
+template <unsigned Bits>
+class SignedSatCounterArray {
+    static_assert(Bits >= 1 && Bits <= 8, "SignedSatCounterArray holds counters of 1 to 8 bits");
+    static constexpr int BIAS = 1 << (Bits - 1);
+
+public:
+    void init(size_t n, int value) { counters.init(n, (unsigned)(value + BIAS)); }
+    void grow(size_t n, int value) { counters.grow(n, (unsigned)(value + BIAS)); }
+    void clear() { counters.clear(); }
+
+    inline int get(size_t i) const { return (int)counters.get(i) - BIAS; }
+    inline void set(size_t i, int value) { counters.set(i, (unsigned)(value + BIAS)); }
+    inline bool taken(size_t i) const { return counters.taken(i); }
+    inline void update(size_t i, bool up) { counters.update(i, up); }
+
+    size_t size() const { return counters.size(); }
+    uint64_t storage_bits() const { return counters.storage_bits(); }
+    size_t footprint_bytes() const { return counters.footprint_bytes(); }
+
+private:
+    SatCounterArray<Bits> counters;
+};
+
+// First counter of branch `id` in a per-branch table with `stride` counters
+// per branch (the infinite modes); grows the table, filled with init, to
+// cover new ids. The packed counterpart of per_pc_entries() in pc_interner.h.
+template <unsigned Bits>
+inline size_t per_pc_counters(SatCounterArray<Bits>& table, uint32_t id, size_t stride, unsigned init) {
+    table.grow(((size_t)id + 1) * stride, init);
+    return (size_t)id * stride;
+}
+
+#endif
@@ -0,0 +1,472 @@
+// gen_trace.cc
+// Synthetic trace generator: writes a *_trace.gz in exactly the format
+// TraceReader::readInstr() parses, so throughput and scaling runs do not
+// depend on the training set being reachable.
+//
+// A static program is generated first (basic blocks of typed instructions
+// ending in a branch, each memory instruction with its own access pattern,
+// each conditional branch with its own behaviour), then executed for -n
+// instructions. PCs therefore keep a fixed type, registers and target
+// across the run, like a real binary. Memory use is independent of -n, so
+// traces of billions of instructions can be streamed out.
+//
+// Record layout (see readInstr()):
+//    PC 8B, type 1B,
+//    load/store: EA 8B, size 1B, base update 1B, store: reg offset 1B
+//    branch:     taken 1B, if taken: target 8B
+//    #in 1B, in regs 1B each, #out 1B, out regs 1B each,
+//    out values: 8B per int reg, 16B (lo, hi) per SIMD reg
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <algorithm>
+#include <vector>
+#include <zlib.h>
+#include "../lib/sim_common_structs.h"
+
+// Register encoding used by the traces.
+static const uint8_t REG_LINK = 30;
+static const uint8_t REG_VEC_BASE = 32;
+static const uint8_t REG_FLAGS = 64;
+
+struct gen_rng_t {
+   uint64_t s;
+   explicit gen_rng_t(uint64_t seed) : s(seed) {}
+   uint64_t next() {
+      uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+   }
+   uint64_t below(uint64_t n) { return n ? next() % n : 0; }
+   bool chance(double percent) { return (double)(next() % 1000000) < percent * 10000.0; }
+};
+
+struct gen_params_t {
+   uint64_t num_instr = 10000000;
+   uint64_t seed = 1;
+   // Instruction mix, percent of all instructions; ALU gets the remainder.
+   double load_pct = 25.0;
+   double store_pct = 10.0;
+   double branch_pct = 15.0;
+   double fp_pct = 5.0;
+   double slow_pct = 2.0;
+   // Percent of branches that are not conditional (calls, returns, jumps, indirect).
+   double uncond_pct = 25.0;
+   // Percent of static conditional branches with a learnable behaviour
+   // (biased, loop or short periodic pattern); the rest are 50/50 random.
+   double predictable_pct = 90.0;
+   // Percent of FP ops and loads that write a 128-bit SIMD register.
+   double simd_pct = 10.0;
+   uint64_t data_footprint = 16ULL << 20;   // bytes touched by loads/stores
+   uint64_t code_footprint = 256ULL << 10;  // bytes of static code
+   int gz_level = 1;
+};
+
+enum cond_kind_t { COND_BIASED, COND_LOOP, COND_PATTERN, COND_RANDOM };
+
+struct static_inst_t {
+   InstClass type;
+   uint8_t num_in;
+   uint8_t in[3];
+   uint8_t out;          // 0xff: no output register
+   bool simd;            // output (or stored value) is a 128-bit SIMD register
+   uint8_t size;         // memory access size in bytes
+   // memory pattern: strided stream when stride != 0, else random in footprint
+   uint64_t mem_base;
+   uint64_t mem_stride;
+   uint64_t mem_span;
+   uint64_t mem_pos;
+   // branches
+   uint32_t target_block;
+   uint32_t alt_targets[4];
+   cond_kind_t cond_kind;
+   uint32_t cond_param;  // bias percent / trip count / pattern bits
+   uint32_t cond_len;    // pattern length
+   uint32_t cond_state;
+};
+
+struct block_t {
+   uint64_t pc;
+   uint32_t first;       // index of first instruction in insts
+   uint32_t len;         // including the terminating branch
+};
+
+struct program_t {
+   std::vector<static_inst_t> insts;
+   std::vector<block_t> blocks;
+};
+
+static const uint64_t GEN_CODE_BASE = 0x400000;
+static const uint64_t GEN_DATA_BASE = 0x10000000;
+
+static uint8_t pick_int_reg(gen_rng_t &rng)
+{
+   return (uint8_t)rng.below(29);   // x0-x28, keep x29/x30 for frame/link
+}
+
+static InstClass pick_body_type(gen_rng_t &rng, const gen_params_t &p)
+{
+   const double body = 100.0 - p.branch_pct;
+   double r = (double)rng.below(1000000) / 10000.0 * (body / 100.0);
+   if ((r -= p.load_pct) < 0) return InstClass::loadInstClass;
+   if ((r -= p.store_pct) < 0) return InstClass::storeInstClass;
+   if ((r -= p.fp_pct) < 0) return InstClass::fpInstClass;
+   if ((r -= p.slow_pct) < 0) return InstClass::slowAluInstClass;
+   return InstClass::aluInstClass;
+}
+
+static void init_mem(static_inst_t &si, gen_rng_t &rng, const gen_params_t &p)
+{
+   si.size = si.simd ? 16 : 8;
+   const uint64_t footprint = p.data_footprint < 64 ? 64 : p.data_footprint;
+   // Three quarters strided streams (what a stride prefetcher can learn),
+   // one quarter random accesses.
+   if (rng.chance(75.0)) {
+      static const uint64_t strides[] = {8, 16, 64, 128, 4096};
+      si.mem_stride = si.simd ? 16 * (1 + rng.below(4)) : strides[rng.below(5)];
+      si.mem_span = std::min<uint64_t>(footprint, 4096 * (1 + rng.below(64)));
+      si.mem_base = GEN_DATA_BASE + (rng.below(footprint - si.mem_span + 1) & ~63ULL);
+   } else {
+      si.mem_stride = 0;
+      si.mem_span = footprint;
+      si.mem_base = GEN_DATA_BASE;
+   }
+   si.mem_pos = 0;
+}
+
+static void init_cond(static_inst_t &si, gen_rng_t &rng, const gen_params_t &p)
+{
+   if (!rng.chance(p.predictable_pct)) {
+      si.cond_kind = COND_RANDOM;
+      return;
+   }
+   switch (rng.below(3)) {
+   case 0:
+      si.cond_kind = COND_BIASED;
+      si.cond_param = rng.chance(50.0) ? 98 : 2;
+      break;
+   case 1:
+      si.cond_kind = COND_LOOP;
+      si.cond_param = 2 + (uint32_t)rng.below(30);
+      break;
+   default:
+      si.cond_kind = COND_PATTERN;
+      si.cond_len = 2 + (uint32_t)rng.below(15);
+      si.cond_param = (uint32_t)rng.next();
+      break;
+   }
+   si.cond_state = 0;
+}
+
+static program_t build_program(const gen_params_t &p, gen_rng_t &rng)
+{
+   program_t prog;
+   const double branch_pct = p.branch_pct < 0.1 ? 0.1 : p.branch_pct;
+   const uint32_t avg_len = std::max<uint32_t>(1, (uint32_t)(100.0 / branch_pct + 0.5));
+   const uint64_t code_insts = std::max<uint64_t>(64, p.code_footprint / 4);
+   const uint32_t num_blocks = (uint32_t)std::max<uint64_t>(4, code_insts / avg_len);
+
+   uint64_t pc = GEN_CODE_BASE;
+   for (uint32_t b = 0; b < num_blocks; b++) {
+      // Block lengths vary around the average so the branch fraction holds.
+      const uint32_t len = 1 + (uint32_t)rng.below(2 * avg_len - 1);
+      block_t blk = {pc, (uint32_t)prog.insts.size(), len};
+      for (uint32_t i = 0; i + 1 < len; i++) {
+         static_inst_t si = {};
+         si.type = pick_body_type(rng, p);
+         si.out = 0xff;
+         switch (si.type) {
+         case InstClass::loadInstClass:
+            si.simd = rng.chance(p.simd_pct);
+            si.num_in = 1;
+            si.in[0] = pick_int_reg(rng);
+            si.out = si.simd ? (uint8_t)(REG_VEC_BASE + rng.below(32)) : pick_int_reg(rng);
+            init_mem(si, rng, p);
+            break;
+         case InstClass::storeInstClass:
+            si.simd = rng.chance(p.simd_pct);
+            si.num_in = 2;
+            si.in[0] = pick_int_reg(rng);
+            si.in[1] = si.simd ? (uint8_t)(REG_VEC_BASE + rng.below(32)) : pick_int_reg(rng);
+            init_mem(si, rng, p);
+            break;
+         case InstClass::fpInstClass:
+            si.simd = rng.chance(p.simd_pct);
+            si.num_in = 2;
+            si.in[0] = (uint8_t)(REG_VEC_BASE + rng.below(32));
+            si.in[1] = (uint8_t)(REG_VEC_BASE + rng.below(32));
+            si.out = (uint8_t)(REG_VEC_BASE + rng.below(32));
+            break;
+         default:
+            si.num_in = 1 + (uint8_t)rng.below(2);
+            si.in[0] = pick_int_reg(rng);
+            si.in[1] = pick_int_reg(rng);
+            // Some ALU ops set the flags the next conditional branch reads.
+            si.out = rng.chance(20.0) ? REG_FLAGS : pick_int_reg(rng);
+            break;
+         }
+         prog.insts.push_back(si);
+      }
+
+      static_inst_t br = {};
+      br.out = 0xff;
+      if (rng.chance(p.uncond_pct)) {
+         const uint64_t r = rng.below(100);
+         if (r < 35) {
+            br.type = InstClass::callDirectInstClass;
+            br.out = REG_LINK;
+         } else if (r < 70) {
+            br.type = InstClass::ReturnInstClass;
+            br.num_in = 1;
+            br.in[0] = REG_LINK;
+         } else if (r < 85) {
+            br.type = InstClass::uncondDirectBranchInstClass;
+         } else if (r < 95) {
+            br.type = InstClass::uncondIndirectBranchInstClass;
+            br.num_in = 1;
+            br.in[0] = pick_int_reg(rng);
+         } else {
+            br.type = InstClass::callIndirectInstClass;
+            br.num_in = 1;
+            br.in[0] = pick_int_reg(rng);
+            br.out = REG_LINK;
+         }
+      } else {
+         br.type = InstClass::condBranchInstClass;
+         br.num_in = 1;
+         br.in[0] = REG_FLAGS;
+         init_cond(br, rng, p);
+      }
+      br.target_block = (uint32_t)rng.below(num_blocks);
+      for (uint32_t &t : br.alt_targets)
+         t = (uint32_t)rng.below(num_blocks);
+      // Loop branches jump back to their own block.
+      if (br.type == InstClass::condBranchInstClass && br.cond_kind == COND_LOOP)
+         br.target_block = b;
+      // A taken conditional branch must not land on its own fall-through
+      // (the simulator treats next_pc == pc + 4 as not taken).
+      if (br.type == InstClass::condBranchInstClass && br.target_block == b + 1)
+         br.target_block = (b + 2) % num_blocks;
+      prog.insts.push_back(br);
+
+      prog.blocks.push_back(blk);
+      pc += 4ULL * len;
+   }
+
+   // The last block has nothing to fall through to: end it with a jump.
+   static_inst_t &last = prog.insts.back();
+   last = {};
+   last.type = InstClass::uncondDirectBranchInstClass;
+   last.out = 0xff;
+   last.target_block = 0;
+   return prog;
+}
+
+static bool cond_outcome(static_inst_t &si, gen_rng_t &rng)
+{
+   switch (si.cond_kind) {
+   case COND_BIASED:
+      return rng.chance(si.cond_param);
+   case COND_LOOP:
+      si.cond_state = (si.cond_state + 1) % si.cond_param;
+      return si.cond_state != 0;
+   case COND_PATTERN:
+      si.cond_state = (si.cond_state + 1) % si.cond_len;
+      return (si.cond_param >> si.cond_state) & 1;
+   default:
+      return rng.chance(50.0);
+   }
+}
+
+struct trace_writer_t {
+   gzFile f;
+   std::vector<uint8_t> buf;
+
+   template <typename T> void put(T v) {
+      const uint8_t *b = (const uint8_t *)&v;
+      buf.insert(buf.end(), b, b + sizeof(T));
+   }
+   void flush_if_full() {
+      if (buf.size() >= (1 << 20)) {
+         gzwrite(f, buf.data(), (unsigned)buf.size());
+         buf.clear();
+      }
+   }
+   void close() {
+      if (!buf.empty())
+         gzwrite(f, buf.data(), (unsigned)buf.size());
+      gzclose(f);
+   }
+};
+
+static void usage(const char *prog)
+{
+   printf("usage:\t%s [options] <out_trace.gz>\n"
+          "\t[-n <instructions> (default 10000000; billions are fine, memory use is constant)]\n"
+          "\t[-seed <n> (default 1)]\n"
+          "\t[-load <pct>] [-store <pct>] [-branch <pct>] [-fp <pct>] [-slow <pct>]  instruction mix, rest is ALU (default 25/10/15/5/2)\n"
+          "\t[-uncond <pct> of branches that are calls/returns/jumps/indirect (default 25)]\n"
+          "\t[-predictable <pct> of static conditional branches that are learnable (default 90)]\n"
+          "\t[-simd <pct> of FP ops, loads and stores on 128-bit SIMD registers (default 10)]\n"
+          "\t[-footprint <bytes> data footprint, K/M/G suffix allowed (default 16M)]\n"
+          "\t[-code <bytes> static code footprint, K/M/G suffix allowed (default 256K)]\n"
+          "\t[-level <0-9> gzip level (default 1)]\n", prog);
+   exit(1);
+}
+
+static uint64_t parse_size(const char *s)
+{
+   char *end;
+   uint64_t v = strtoull(s, &end, 0);
+   switch (*end) {
+   case 'k': case 'K': v <<= 10; break;
+   case 'm': case 'M': v <<= 20; break;
+   case 'g': case 'G': v <<= 30; break;
+   default: break;
+   }
+   return v;
+}
+
+int main(int argc, char **argv)
+{
+   gen_params_t p;
+   int i = 1;
+   for (; i + 1 < argc && argv[i][0] == '-'; i += 2) {
+      const char *opt = argv[i], *val = argv[i + 1];
+      if (!strcmp(opt, "-n")) p.num_instr = parse_size(val);
+      else if (!strcmp(opt, "-seed")) p.seed = strtoull(val, NULL, 0);
+      else if (!strcmp(opt, "-load")) p.load_pct = atof(val);
+      else if (!strcmp(opt, "-store")) p.store_pct = atof(val);
+      else if (!strcmp(opt, "-branch")) p.branch_pct = atof(val);
+      else if (!strcmp(opt, "-fp")) p.fp_pct = atof(val);
+      else if (!strcmp(opt, "-slow")) p.slow_pct = atof(val);
+      else if (!strcmp(opt, "-uncond")) p.uncond_pct = atof(val);
+      else if (!strcmp(opt, "-predictable")) p.predictable_pct = atof(val);
+      else if (!strcmp(opt, "-simd")) p.simd_pct = atof(val);
+      else if (!strcmp(opt, "-footprint")) p.data_footprint = parse_size(val);
+      else if (!strcmp(opt, "-code")) p.code_footprint = parse_size(val);
+      else if (!strcmp(opt, "-level")) p.gz_level = atoi(val);
+      else usage(argv[0]);
+   }
+   if (i + 1 != argc)
+      usage(argv[0]);
+   if (p.load_pct + p.store_pct + p.branch_pct + p.fp_pct + p.slow_pct > 100.0) {
+      printf("gen_trace: instruction mix adds up to more than 100%%\n");
+      exit(1);
+   }
+
+   gen_rng_t rng(p.seed);
+   program_t prog = build_program(p, rng);
+
+   char mode[8];
+   snprintf(mode, sizeof(mode), "wb%d", std::min(9, std::max(0, p.gz_level)));
+   trace_writer_t w;
+   w.f = gzopen(argv[i], mode);
+   if (!w.f) {
+      printf("gen_trace: cannot open %s\n", argv[i]);
+      exit(1);
+   }
+   w.buf.reserve((1 << 20) + 64);
+
+   std::vector<uint32_t> call_stack;
+   uint32_t blk = 0;
+   uint64_t emitted = 0;
+   while (emitted < p.num_instr) {
+      const block_t &b = prog.blocks[blk];
+      uint32_t next_blk = (blk + 1) % prog.blocks.size();
+      for (uint32_t k = 0; k < b.len && emitted < p.num_instr; k++, emitted++) {
+         static_inst_t &si = prog.insts[b.first + k];
+         const uint64_t pc = b.pc + 4ULL * k;
+         w.put<uint64_t>(pc);
+         w.put<uint8_t>((uint8_t)si.type);
+
+         if (si.type == InstClass::loadInstClass || si.type == InstClass::storeInstClass) {
+            uint64_t ea;
+            if (si.mem_stride) {
+               ea = si.mem_base + si.mem_pos;
+               si.mem_pos = (si.mem_pos + si.mem_stride) % si.mem_span;
+            } else {
+               ea = si.mem_base + (rng.below(si.mem_span) & ~(uint64_t)(si.size - 1));
+            }
+            w.put<uint64_t>(ea);
+            w.put<uint8_t>(si.size);
+            w.put<uint8_t>(0);                 // no base update
+            if (si.type == InstClass::storeInstClass)
+               w.put<uint8_t>(0);              // no register offset
+         }
+
+         if (is_br(si.type)) {
+            bool taken = true;
+            uint64_t target;
+            switch (si.type) {
+            case InstClass::condBranchInstClass:
+               taken = cond_outcome(si, rng);
+               target = prog.blocks[si.target_block].pc;
+               if (taken)
+                  next_blk = si.target_block;
+               break;
+            case InstClass::callDirectInstClass:
+            case InstClass::callIndirectInstClass: {
+               const uint32_t callee = (si.type == InstClass::callDirectInstClass) ? si.target_block : si.alt_targets[rng.below(4)];
+               // Bound the stack so deep random recursion cannot grow it forever.
+               if (call_stack.size() >= 256)
+                  call_stack.erase(call_stack.begin());
+               call_stack.push_back(next_blk);
+               next_blk = callee;
+               target = prog.blocks[callee].pc;
+               break;
+            }
+            case InstClass::ReturnInstClass:
+               if (!call_stack.empty()) {
+                  next_blk = call_stack.back();
+                  call_stack.pop_back();
+               } else {
+                  next_blk = si.target_block;
+               }
+               target = prog.blocks[next_blk].pc;
+               break;
+            case InstClass::uncondIndirectBranchInstClass:
+               next_blk = si.alt_targets[rng.below(4)];
+               target = prog.blocks[next_blk].pc;
+               break;
+            default:
+               next_blk = si.target_block;
+               target = prog.blocks[next_blk].pc;
+               break;
+            }
+            w.put<uint8_t>(taken);
+            if (taken)
+               w.put<uint64_t>(target);
+         }
+
+         w.put<uint8_t>(si.num_in);
+         for (uint8_t r = 0; r < si.num_in; r++)
+            w.put<uint8_t>(si.in[r]);
+
+         if (si.out == 0xff) {
+            w.put<uint8_t>(0);
+         } else {
+            w.put<uint8_t>(1);
+            w.put<uint8_t>(si.out);
+            if (si.type == InstClass::callDirectInstClass || si.type == InstClass::callIndirectInstClass) {
+               w.put<uint64_t>(pc + 4);
+            } else if (si.out >= REG_VEC_BASE && si.out < REG_FLAGS) {
+               w.put<uint64_t>(rng.next());
+               w.put<uint64_t>(si.simd ? (rng.next() | 1) : 0);  // non-zero hi half: 128-bit result
+            } else {
+               w.put<uint64_t>(rng.next() & 0xffff);
+            }
+         }
+         w.flush_if_full();
+      }
+      blk = next_blk;
+   }
+   w.close();
+
+   printf("gen_trace: wrote %llu instructions (%zu static, %zu blocks) to %s\n",
+          (unsigned long long)emitted, prog.insts.size(), prog.blocks.size(), argv[i]);
+   return 0;
+}
@@ -0,0 +1,47 @@
+#!/bin/bash
+# SimPoint accuracy and speed against full detailed runs.
+#
+# usage: scripts/simpoint_eval.sh [-i interval] [-w warmup] [-k maxk] [trace.gz ...]
+#
+# For each trace (default: every .gz under sample_traces/), picks simulation
+# points with -simpoint-gen, simulates them with -simpoint, runs the full
+# simulation, and prints both IPC/MPKI pairs, the relative errors and the
+# wall-time speedup of the sampled run (point selection included). Extra cbp
+# options can be passed in CBP_ARGS (e.g. CBP_ARGS="-pred gshare").
+
+CBP=${CBP:-./cbp}
+INTERVAL=10000000
+WARMUP=
+MAXK=10
+while getopts "i:w:k:" opt; do
+   case $opt in
+      i) INTERVAL=$OPTARG ;;
+      w) WARMUP="-simpoint-warmup $OPTARG" ;;
+      k) MAXK=$OPTARG ;;
+      *) echo "usage: $0 [-i interval] [-w warmup] [-k maxk] [trace.gz ...]"; exit 1 ;;
+   esac
+done
+shift $((OPTIND - 1))
+TRACES=("$@")
+[ ${#TRACES[@]} -eq 0 ] && TRACES=($(find sample_traces -name '*.gz' | sort))
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+now() { date +%s.%N; }
+
+printf "%-28s %3s %8s %8s %8s %9s %9s %8s %8s\n" "Trace" "k" "IPC" "estIPC" "err" "MPKI" "estMPKI" "err" "speedup"
+for t in "${TRACES[@]}"; do
+   s=$(now)
+   $CBP $CBP_ARGS -simpoint-gen "$TMP/sp" -simpoint-interval "$INTERVAL" -simpoint-maxk "$MAXK" "$t" > "$TMP/gen.out" 2>&1 || { echo "$t: -simpoint-gen failed"; cat "$TMP/gen.out"; continue; }
+   $CBP $CBP_ARGS -simpoint "$TMP/sp" $WARMUP "$t" > "$TMP/sp.out" 2>&1 || { echo "$t: -simpoint failed"; continue; }
+   m=$(now)
+   $CBP $CBP_ARGS "$t" > "$TMP/full.out" 2>&1 || { echo "$t: full run failed"; continue; }
+   e=$(now)
+   k=$(awk '$1 == "k" { print $2 }' "$TMP/sp")
+   read full_ipc full_mpki < <(awk '/DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS \(Full Simulation/ { getline; getline; print $3, $9 }' "$TMP/full.out")
+   read est_ipc est_mpki < <(awk '/^Weighted:/ { print $3, $7 }' "$TMP/sp.out")
+   awk -v t="$(basename "$t")" -v k="$k" -v fi="$full_ipc" -v ei="$est_ipc" -v fm="$full_mpki" -v em="$est_mpki" \
+       -v ts="$(awk -v a="$s" -v b="$m" 'BEGIN { print b - a }')" -v tf="$(awk -v a="$m" -v b="$e" 'BEGIN { print b - a }')" \
+      'BEGIN { printf "%-28s %3d %8.4f %8.4f %7.2f%% %9.4f %9.4f %7.2f%% %7.2fx\n", t, k, fi, ei, 100 * (ei - fi) / fi, fm, em, (fm > 0) ? 100 * (em - fm) / fm : 0, tf / ts }'
+done
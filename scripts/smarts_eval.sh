@@ -0,0 +1,47 @@
+#!/bin/bash
+# SMARTS sampling accuracy and speed against full detailed runs.
+#
+# usage: scripts/smarts_eval.sh [-p period] [-u window] [-d detailed warmup] [-f functional warming] [trace.gz ...]
+#
+# For each trace (default: every .gz under sample_traces/), runs -smarts and
+# the full simulation, and prints both IPC/MPKI pairs, the estimates' 95%
+# confidence half-widths, the relative errors and the wall-time speedup of the
+# sampled run. Extra cbp options can be passed in CBP_ARGS (e.g.
+# CBP_ARGS="-pred gshare").
+
+CBP=${CBP:-./cbp}
+PERIOD=1000000
+OPTS=
+while getopts "p:u:d:f:" opt; do
+   case $opt in
+      p) PERIOD=$OPTARG ;;
+      u) OPTS="$OPTS -smarts-window $OPTARG" ;;
+      d) OPTS="$OPTS -smarts-detail-warmup $OPTARG" ;;
+      f) OPTS="$OPTS -smarts-warmup $OPTARG" ;;
+      *) echo "usage: $0 [-p period] [-u window] [-d detailed warmup] [-f functional warming] [trace.gz ...]"; exit 1 ;;
+   esac
+done
+shift $((OPTIND - 1))
+TRACES=("$@")
+[ ${#TRACES[@]} -eq 0 ] && TRACES=($(find sample_traces -name '*.gz' | sort))
+
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+now() { date +%s.%N; }
+
+printf "%-28s %5s %8s %8s %7s %8s %9s %9s %7s %8s %8s\n" "Trace" "n" "IPC" "estIPC" "+-CI" "err" "MPKI" "estMPKI" "+-CI" "err" "speedup"
+for t in "${TRACES[@]}"; do
+   s=$(now)
+   $CBP $CBP_ARGS -smarts "$PERIOD" $OPTS "$t" > "$TMP/sm.out" 2>&1 || { echo "$t: -smarts failed"; cat "$TMP/sm.out"; continue; }
+   m=$(now)
+   $CBP $CBP_ARGS "$t" > "$TMP/full.out" 2>&1 || { echo "$t: full run failed"; continue; }
+   e=$(now)
+   read full_ipc full_mpki < <(awk '/DIRECT CONDITIONAL BRANCH PREDICTION MEASUREMENTS \(Full Simulation/ { getline; getline; print $3, $9 }' "$TMP/full.out")
+   n=$(awk '/SMARTS ESTIMATE/ { sub(/.*\(/, ""); print $1 }' "$TMP/sm.out")
+   read est_ipc ci_ipc < <(awk '$1 == "IPC" && NF > 4 { print $2, $(NF - 2) }' "$TMP/sm.out")
+   read est_mpki ci_mpki < <(awk '$1 == "MPKI" && NF > 4 { print $2, $(NF - 2) }' "$TMP/sm.out")
+   awk -v t="$(basename "$t")" -v n="$n" -v fi="$full_ipc" -v ei="$est_ipc" -v ci="$ci_ipc" -v fm="$full_mpki" -v em="$est_mpki" -v cm="$ci_mpki" \
+       -v ts="$(awk -v a="$s" -v b="$m" 'BEGIN { print b - a }')" -v tf="$(awk -v a="$m" -v b="$e" 'BEGIN { print b - a }')" \
+      'BEGIN { printf "%-28s %5d %8.4f %8.4f %7s %7.2f%% %9.4f %9.4f %7s %7.2f%% %7.2fx\n", t, n, fi, ei, ci, 100 * (ei - fi) / fi, fm, em, cm, (fm > 0) ? 100 * (em - fm) / fm : 0, tf / ts }'
+done
@@ -17,8 +17,8 @@ parser = argparse.ArgumentParser()
 parser.add_argument('--trace_dir', help='path to trace directory', required= True)
 parser.add_argument('--results_dir', help='path to results directory', required= True)
 
-parser.add_argument('--predictors', help='comma-separated list of predictors to test (tage-sc-l,tage,onebit,twobit,correlating,local,gshare,perceptron)', default='tage-sc-l,tage,tournament,local,onebit,twobit')
-parser.add_argument('--sweep_predictors', action='store_true', help='sweep all available predictors (tage-sc-l,tage,onebit,twobit,correlating,local,gshare,tournament,perceptron)')
+parser.add_argument('--predictors', help='comma-separated list of predictors to test (tage-sc-l,tage-sc-l-192kb,tage,onebit,twobit,correlating,local,gshare,perceptron)', default='tage-sc-l,tage,tournament,local,onebit,twobit')
+parser.add_argument('--sweep_predictors', action='store_true', help='sweep all available predictors (tage-sc-l,tage-sc-l-192kb,tage,onebit,twobit,correlating,local,gshare,tournament,perceptron)')
 
 args = parser.parse_args()
 trace_dir = Path(args.trace_dir)
@@ -27,12 +27,12 @@ results_dir = Path(args.results_dir)
 # Parse predictor options
 
 if args.sweep_predictors:
-    predictors = ['tage-sc-l', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', 'perceptron']
+    predictors = ['tage-sc-l', 'tage-sc-l-192kb', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', 'perceptron']
 else:
     predictors = [p.strip() for p in args.predictors.split(',')]
 
 # Validate predictor names
-valid_predictors = ['tage-sc-l', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', 'perceptron']
+valid_predictors = ['tage-sc-l', 'tage-sc-l-192kb', 'tage', 'onebit', 'twobit', 'correlating', 'local', 'gshare', 'tournament', 'perceptron']
 for pred in predictors:
     if pred not in valid_predictors:
         print(f"Error: '{pred}' is not a valid predictor. Valid options: {valid_predictors}")
@@ -0,0 +1,58 @@
+#!/bin/bash
+# Benchmark matrix for uarchsim_t::step().
+#
+# usage: scripts/uarch_matrix.sh [-r reps] [-b baseline_cbp] [trace.gz]
+#
+# Runs each simulator configuration, keeping the best of <reps> wall times.
+# With -b, a second binary (e.g. one built from an older commit) is timed too,
+# and the speedup against it is printed.
+
+CBP=${CBP:-./cbp}
+REPS=3
+BASELINE=
+while getopts "r:b:" opt; do
+   case $opt in
+      r) REPS=$OPTARG ;;
+      b) BASELINE=$OPTARG ;;
+      *) echo "usage: $0 [-r reps] [-b baseline_cbp] [trace.gz]"; exit 1 ;;
+   esac
+done
+shift $((OPTIND - 1))
+TRACE=${1:-sample_traces/int/sample_int_trace.gz}
+
+CONFIGS=(
+   "default|"
+   "perfect D$ (-d)|-d"
+   "no I$/fetch stops|-F 16,16,0,0,0"
+   "-d, no fetch stops|-d -F 16,16,0,0,0"
+   "gshare|-pred gshare"
+)
+
+# best_time <binary> <args...>: best wall time in seconds over REPS runs
+best_time() {
+   local bin=$1; shift
+   local best=
+   for ((r = 0; r < REPS; r++)); do
+      local s=$(date +%s.%N)
+      "$bin" "$@" "$TRACE" > /dev/null 2>&1 || { echo "FAILED: $bin $*" >&2; exit 1; }
+      best=$(awk -v s="$s" -v e="$(date +%s.%N)" -v b="$best" 'BEGIN { t = e - s; print (b == "" || t < b) ? t : b }')
+   done
+   echo "$best"
+}
+
+if [ -n "$BASELINE" ]; then
+   printf "%-20s %10s %10s %9s\n" "Config" "Baseline" "Time" "Speedup"
+else
+   printf "%-20s %10s\n" "Config" "Time"
+fi
+for c in "${CONFIGS[@]}"; do
+   name=${c%%|*}
+   args=${c#*|}
+   t=$(best_time "$CBP" $args)
+   if [ -n "$BASELINE" ]; then
+      base=$(best_time "$BASELINE" $args)
+      awk -v n="$name" -v b="$base" -v t="$t" 'BEGIN { printf "%-20s %10.2f %10.2f %8.2fx\n", n, b, t, b / t }'
+   else
+      awk -v n="$name" -v t="$t" 'BEGIN { printf "%-20s %10.2f\n", n, t }'
+   fi
+done
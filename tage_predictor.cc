@@ -32,13 +32,13 @@ typedef struct {
 } gentry_t;
 
 // Predictor state
-static bentry_t* btable = NULL;         // Bimodal table
-static gentry_t** gtable = NULL;        // Tagged tables
-static uint64_t ghist = 0;              // Global history
-static int m[NHIST + 1];                // History lengths for each table
-static int TB[NHIST + 1];               // Tag bits for each table
-static uint32_t SizeTable[NHIST + 1];   // Size of each table
-static bool NOSKIP[NHIST + 1];          // Whether to skip table
+static thread_local bentry_t* btable = NULL;         // Bimodal table
+static thread_local gentry_t** gtable = NULL;        // Tagged tables
+static thread_local uint64_t ghist = 0;              // Global history
+static thread_local int m[NHIST + 1];                // History lengths for each table
+static thread_local int TB[NHIST + 1];               // Tag bits for each table
+static thread_local uint32_t SizeTable[NHIST + 1];   // Size of each table
+static thread_local bool NOSKIP[NHIST + 1];          // Whether to skip table
 
 // Folded history for efficient hash computation
 typedef struct {
@@ -48,8 +48,8 @@ typedef struct {
     int OUTPOINT;
 } folded_history_t;
 
-static folded_history_t ch_i[NHIST + 1];  // For indices
-static folded_history_t ch_t[NHIST + 1];  // For tags
+static thread_local folded_history_t ch_i[NHIST + 1];  // For indices
+static thread_local folded_history_t ch_t[NHIST + 1];  // For tags
 
 // Initialize folded history
 static void init_folded_history(folded_history_t* fh, int original_length, int compressed_length) {
@@ -0,0 +1,344 @@
+// history_check.cc
+// Brute-force check of history.h: every register is compared, after every
+// push, with a recompute from the raw outcomes (or branch addresses) kept
+// in a plain vector. Run by `make check`.
+//
+// - GlobalHistory: bit(age) over the whole length and recent(n) for n = 1..64,
+//   long enough to wrap the circular buffer several times.
+// - FoldedHistories / FoldedGlobalHistory: each (length, width) register
+//   against the XOR of bit(a) << (a % width) over a < length.
+// - Checkpoints: position() / checkpoint() / value() taken at random points,
+//   then up to `slack` outcomes pushed, restored, and compared again; the
+//   reference rewinds with them.
+// - PathHistory and LocalHistoryTable against shift registers of the same
+//   width.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../history.h"
+
+static unsigned checks = 0, failed = 0;
+
+static void report(const bool ok, const std::string &what)
+{
+   checks++;
+   if (!ok)
+   {
+      failed++;
+      printf("FAIL     %s\n", what.c_str());
+   }
+}
+
+// splitmix64, as in the benchmarks.
+struct check_rng_t {
+   uint64_t s;
+   explicit check_rng_t(uint64_t seed) : s(seed) {}
+   uint64_t next() {
+      uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+   }
+};
+
+// Outcomes in push order; outcomes before the first push are 0.
+struct ref_history_t {
+   std::vector<bool> bits;
+   bool bit(size_t age) const { return age < bits.size() ? bits[bits.size() - 1 - age] : false; }
+   uint64_t recent(unsigned n) const
+   {
+      uint64_t v = 0;
+      for (unsigned a = 0; a < n && a < 64; a++)
+         v |= (uint64_t)bit(a) << a;
+      return v;
+   }
+   uint32_t fold(unsigned length, unsigned width) const
+   {
+      uint32_t v = 0;
+      for (unsigned a = 0; a < length; a++)
+         v ^= (uint32_t)bit(a) << (a % width);
+      return v;
+   }
+};
+
+// A mix of short and long windows, widths below, at and above the length,
+// and lengths that are and are not multiples of the width.
+static const std::pair<unsigned, unsigned> fold_shapes[] = {
+   {1, 1}, {5, 3}, {8, 8}, {9, 10}, {17, 7}, {64, 11}, {65, 13}, {130, 12}, {359, 9}, {640, 15}, {1000, 31}, {2000, 16},
+};
+static const unsigned MAX_FOLD_LENGTH = 2000;
+
+// Why the history and its reference differ, or "" if they agree.
+template <class History>
+static std::string compare_global(const History &h, const ref_history_t &ref, const size_t length)
+{
+   for (size_t a = 0; a <= length; a++)
+      if (h.bit(a) != ref.bit(a))
+         return "bit(" + std::to_string(a) + ")";
+   for (unsigned n = 1; n <= 64; n++)
+      if (h.recent(n) != ref.recent(n))
+         return "recent(" + std::to_string(n) + ")";
+   return "";
+}
+
+static void check_global_history()
+{
+   const size_t lengths[] = {1, 31, 64, 100, 1000, 5000};
+   for (const size_t length : lengths)
+   {
+      const std::string tag = "GlobalHistory length=" + std::to_string(length);
+      const size_t slack = 256;
+      GlobalHistory h(length, slack);
+      ref_history_t ref;
+      check_rng_t rng(length);
+      std::string bad = compare_global(h, ref, length);
+      // Several times the buffer, so the window wraps.
+      const size_t pushes = 4 * (length + slack + 128) + 500;
+      for (size_t k = 0; k < pushes && bad.empty(); k++)
+      {
+         const bool taken = rng.next() & 1;
+         h.push(taken);
+         ref.bits.push_back(taken);
+         // The full comparison is O(length); do it on a sample of pushes.
+         if (k < 200 || k % 37 == 0)
+            bad = compare_global(h, ref, length);
+      }
+      report(bad.empty(), tag + ": push " + bad);
+
+      // Rewind by up to slack outcomes and push a different future.
+      bad = "";
+      for (unsigned round = 0; round < 20 && bad.empty(); round++)
+      {
+         const uint64_t pos = h.position();
+         const ref_history_t saved = ref;
+         const size_t ahead = rng.next() % slack;
+         for (size_t k = 0; k < ahead; k++)
+            h.push(rng.next() & 1);
+         h.restore(pos);
+         ref = saved;
+         bad = compare_global(h, ref, length);
+         for (size_t k = 0; k < 50 && bad.empty(); k++)
+         {
+            const bool taken = rng.next() & 1;
+            h.push(taken);
+            ref.bits.push_back(taken);
+            bad = compare_global(h, ref, length);
+         }
+      }
+      report(bad.empty(), tag + ": restore " + bad);
+   }
+}
+
+template <class Folds>
+static std::string compare_folds(const Folds &f, const std::vector<size_t> &ids, const ref_history_t &ref)
+{
+   for (size_t s = 0; s < ids.size(); s++)
+   {
+      const unsigned length = fold_shapes[s].first, width = fold_shapes[s].second;
+      if (f(ids[s]) != ref.fold(length, width))
+         return "fold(" + std::to_string(length) + ", " + std::to_string(width) + ")";
+   }
+   return "";
+}
+
+static void check_folded_histories()
+{
+   // FoldedHistories driven by a separate GlobalHistory.
+   {
+      GlobalHistory h(MAX_FOLD_LENGTH);
+      FoldedHistories folds;
+      std::vector<size_t> ids;
+      for (const auto &shape : fold_shapes)
+         ids.push_back(folds.add(shape.first, shape.second));
+      ref_history_t ref;
+      check_rng_t rng(1);
+      auto get = [&folds](size_t id) { return folds[id]; };
+      std::string bad = compare_folds(get, ids, ref);
+      for (size_t k = 0; k < 3 * MAX_FOLD_LENGTH && bad.empty(); k++)
+      {
+         const bool taken = (rng.next() % 3) != 0;
+         h.push(taken);
+         folds.update(h);
+         ref.bits.push_back(taken);
+         bad = compare_folds(get, ids, ref);
+      }
+      report(bad.empty(), "FoldedHistories: update " + bad);
+
+      // values() / restore() with the history position.
+      bad = "";
+      for (unsigned round = 0; round < 20 && bad.empty(); round++)
+      {
+         const uint64_t pos = h.position();
+         const std::vector<uint32_t> values = folds.values();
+         const ref_history_t saved = ref;
+         const size_t ahead = rng.next() % 1024;
+         for (size_t k = 0; k < ahead; k++)
+         {
+            h.push(rng.next() & 1);
+            folds.update(h);
+         }
+         h.restore(pos);
+         folds.restore(values);
+         ref = saved;
+         bad = compare_folds(get, ids, ref);
+         for (size_t k = 0; k < 50 && bad.empty(); k++)
+         {
+            const bool taken = rng.next() & 1;
+            h.push(taken);
+            folds.update(h);
+            ref.bits.push_back(taken);
+            bad = compare_folds(get, ids, ref);
+         }
+      }
+      report(bad.empty(), "FoldedHistories: restore " + bad);
+
+      folds.reset();
+      bool zero = true;
+      for (const size_t id : ids)
+         zero = zero && folds[id] == 0;
+      report(zero && folds.size() == ids.size(), "FoldedHistories: reset");
+   }
+
+   // FoldedGlobalHistory: the same registers, pushed with their history.
+   {
+      FoldedGlobalHistory h(MAX_FOLD_LENGTH);
+      std::vector<size_t> ids;
+      for (const auto &shape : fold_shapes)
+         ids.push_back(h.add_fold(shape.first, shape.second));
+      ref_history_t ref;
+      check_rng_t rng(2);
+      auto get = [&h](size_t id) { return h.fold(id); };
+      std::string bad;
+      for (size_t k = 0; k < 3 * MAX_FOLD_LENGTH && bad.empty(); k++)
+      {
+         const bool taken = rng.next() & 1;
+         h.push(taken);
+         ref.bits.push_back(taken);
+         bad = compare_folds(get, ids, ref);
+         if (bad.empty() && (k < 200 || k % 53 == 0))
+            bad = compare_global(h, ref, MAX_FOLD_LENGTH);
+      }
+      report(bad.empty(), "FoldedGlobalHistory: push " + bad);
+
+      bad = "";
+      for (unsigned round = 0; round < 20 && bad.empty(); round++)
+      {
+         const FoldedGlobalHistory::Checkpoint c = h.checkpoint();
+         const ref_history_t saved = ref;
+         const size_t ahead = rng.next() % 1024;
+         for (size_t k = 0; k < ahead; k++)
+            h.push(rng.next() & 1);
+         h.restore(c);
+         ref = saved;
+         bad = compare_folds(get, ids, ref);
+         if (bad.empty())
+            bad = compare_global(h, ref, MAX_FOLD_LENGTH);
+         for (size_t k = 0; k < 50 && bad.empty(); k++)
+         {
+            const bool taken = rng.next() & 1;
+            h.push(taken);
+            ref.bits.push_back(taken);
+            bad = compare_folds(get, ids, ref);
+         }
+      }
+      report(bad.empty(), "FoldedGlobalHistory: checkpoint/restore " + bad);
+   }
+}
+
+static void check_path_history()
+{
+   struct shape_t { unsigned length, bits, shift; };
+   const shape_t shapes[] = {{16, 1, 2}, {27, 3, 2}, {32, 2, 0}, {63, 4, 1}, {64, 4, 2}, {64, 5, 2}};
+   for (const shape_t &sh : shapes)
+   {
+      const std::string tag = "PathHistory length=" + std::to_string(sh.length) + " bits=" + std::to_string(sh.bits) +
+                              " shift=" + std::to_string(sh.shift);
+      PathHistory p(sh.length, sh.bits, sh.shift);
+      std::vector<uint64_t> pcs;
+      check_rng_t rng(sh.length * 100 + sh.bits);
+      // The newest branch's bits in the low bits, older ones above.
+      auto expect = [&pcs, &sh]() {
+         uint64_t v = 0;
+         unsigned at = 0;
+         for (size_t k = pcs.size(); k-- > 0 && at < sh.length; at += sh.bits)
+            v |= ((pcs[k] >> sh.shift) & ((1ull << sh.bits) - 1)) << at;
+         return (sh.length >= 64) ? v : v & ((1ull << sh.length) - 1);
+      };
+      bool ok = p.value() == 0;
+      for (size_t k = 0; k < 500 && ok; k++)
+      {
+         pcs.push_back(0x400000 + (rng.next() & 0xffffc));
+         p.push(pcs.back());
+         ok = p.value() == expect();
+      }
+      report(ok, tag + ": push");
+
+      const uint64_t saved = p.value();
+      const size_t n = pcs.size();
+      for (size_t k = 0; k < 40; k++)
+         p.push(rng.next());
+      p.restore(saved);
+      pcs.resize(n);
+      ok = p.value() == expect();
+      for (size_t k = 0; k < 100 && ok; k++)
+      {
+         pcs.push_back(rng.next());
+         p.push(pcs.back());
+         ok = p.value() == expect();
+      }
+      report(ok, tag + ": restore");
+   }
+}
+
+static void check_local_history_table()
+{
+   const unsigned widths[] = {1, 10, 31, 32};
+   for (const unsigned bits : widths)
+   {
+      const std::string tag = "LocalHistoryTable bits=" + std::to_string(bits);
+      const uint64_t mask = (bits >= 32) ? 0xffffffffull : (1ull << bits) - 1;
+      LocalHistoryTable t;
+      t.init(64, bits);
+      std::vector<uint64_t> ref(64, 0);
+      check_rng_t rng(bits);
+      bool ok = true;
+      for (size_t k = 0; k < 20000 && ok; k++)
+      {
+         const size_t i = rng.next() % ref.size();
+         if (rng.next() % 16 == 0)
+         {
+            const uint32_t v = (uint32_t)rng.next();
+            t.set(i, v);
+            ref[i] = v & mask;
+         }
+         else
+         {
+            const bool taken = rng.next() & 1;
+            t.update(i, taken);
+            ref[i] = ((ref[i] << 1) | taken) & mask;
+         }
+         ok = t.get(i) == ref[i];
+      }
+      report(ok, tag + ": update/set");
+
+      t.grow(100);
+      ref.resize(100, 0);
+      for (size_t i = 0; i < ref.size() && ok; i++)
+         ok = t.get(i) == ref[i];
+      report(ok && t.size() == 100 && t.storage_bits() == 100ull * bits, tag + ": grow");
+   }
+}
+
+int main()
+{
+   check_global_history();
+   check_folded_histories();
+   check_path_history();
+   check_local_history_table();
+   printf("history_check: %u of %u checks passed\n", checks - failed, checks);
+   return failed ? 1 : 0;
+}
@@ -0,0 +1,155 @@
+// sat_counter_check.cc
+// Brute-force check of sat_counter_array.h: every SatCounterArray<Bits> and
+// SignedSatCounterArray<Bits> width from 1 to 8 (and SatCounterArray<0> at
+// each width) against a plain vector of ints, through init, grow, set and
+// random saturating updates. Run by `make check`.
+//
+// Table sizes are not multiples of the counters per word, so the last,
+// partly used word and grow() across it are covered.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../sat_counter_array.h"
+
+static unsigned checks = 0, failed = 0;
+
+static void report(const bool ok, const std::string &what)
+{
+   checks++;
+   if (!ok)
+   {
+      failed++;
+      printf("FAIL     %s\n", what.c_str());
+   }
+}
+
+// splitmix64, as in the benchmarks.
+struct check_rng_t {
+   uint64_t s;
+   explicit check_rng_t(uint64_t seed) : s(seed) {}
+   uint64_t next() {
+      uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+   }
+};
+
+// First index where the table differs from the reference, or -1. taken() is
+// checked against the upper half of [lo, hi].
+template <class Table>
+static long first_mismatch(const Table &t, const std::vector<int> &ref, const int lo, const int hi)
+{
+   if (t.size() != ref.size())
+      return 0;
+   const int half = lo + (hi - lo + 1) / 2;
+   for (size_t i = 0; i < ref.size(); i++)
+      if (t.get(i) != ref[i] || t.taken(i) != (ref[i] >= half))
+         return (long)i;
+   return -1;
+}
+
+// One table type through init, set, update and grow. Counters are in
+// [lo, hi]; init_args() builds init()'s arguments (the width for
+// SatCounterArray<0>).
+template <class Table, class Init>
+static void check_table(const std::string &name, const unsigned bits, const int lo, const int hi, Init init_args)
+{
+   const size_t sizes[] = {1, 63, 1000, 4099};
+   check_rng_t rng(bits * 7919 + (unsigned)name.size());
+   for (const size_t n : sizes)
+   {
+      const std::string tag = name + " n=" + std::to_string(n);
+      Table t;
+      std::vector<int> ref;
+
+      // init() to each value in range.
+      bool ok = true;
+      for (int v = lo; v <= hi && ok; v++)
+      {
+         init_args(t, n, v);
+         ref.assign(n, v);
+         ok = first_mismatch(t, ref, lo, hi) < 0;
+      }
+      report(ok, tag + ": init");
+      report(t.storage_bits() == (uint64_t)n * bits, tag + ": storage_bits");
+      report(t.footprint_bytes() * 8 >= t.storage_bits() && t.footprint_bytes() % sizeof(uint64_t) == 0, tag + ": footprint_bytes");
+
+      // set()/get() round trip of every value at every slot position.
+      ok = true;
+      for (size_t i = 0; i < n && ok; i++)
+      {
+         const int v = lo + (int)((i + n) % (size_t)(hi - lo + 1));
+         t.set(i, v);
+         ref[i] = v;
+         ok = (t.get(i) == v);
+      }
+      report(ok && first_mismatch(t, ref, lo, hi) < 0, tag + ": set/get");
+
+      // Random saturating updates; the neighbours of each slot must not move.
+      ok = true;
+      for (size_t k = 0; k < 20 * n + 1000 && ok; k++)
+      {
+         const size_t i = rng.next() % n;
+         const bool up = rng.next() & 1;
+         t.update(i, up);
+         ref[i] = up ? std::min(ref[i] + 1, hi) : std::max(ref[i] - 1, lo);
+         ok = (t.get(i) == ref[i]) && (i == 0 || t.get(i - 1) == ref[i - 1]) && (i + 1 == n || t.get(i + 1) == ref[i + 1]);
+      }
+      report(ok && first_mismatch(t, ref, lo, hi) < 0, tag + ": update");
+
+      // Saturation at both ends.
+      ok = true;
+      for (int k = 0; k < hi - lo + 2; k++)
+         t.update(0, true);
+      ok = ok && t.get(0) == hi && t.taken(0);
+      for (int k = 0; k < hi - lo + 2; k++)
+         t.update(0, false);
+      ok = ok && t.get(0) == lo && (hi == lo || !t.taken(0));
+      ref[0] = lo;
+      report(ok && first_mismatch(t, ref, lo, hi) < 0, tag + ": saturation");
+
+      // grow() keeps the old counters and fills the new ones, across the
+      // partly used last word; growing to a smaller size does nothing.
+      const int fill = hi - (int)(n % (size_t)(hi - lo + 1));
+      t.grow(n + 37, fill);
+      ref.resize(n + 37, fill);
+      report(first_mismatch(t, ref, lo, hi) < 0, tag + ": grow");
+      t.grow(n, lo);
+      report(first_mismatch(t, ref, lo, hi) < 0, tag + ": grow to a smaller size");
+
+      t.clear();
+      report(t.size() == 0 && t.footprint_bytes() == 0, tag + ": clear");
+   }
+}
+
+template <unsigned Bits>
+static void check_width()
+{
+   const int max = (1 << Bits) - 1;
+   const int bias = 1 << (Bits - 1);
+   check_table<SatCounterArray<Bits>>("SatCounterArray<" + std::to_string(Bits) + ">", Bits, 0, max,
+                                      [](SatCounterArray<Bits> &t, size_t n, int v) { t.init(n, (unsigned)v); });
+   check_table<SatCounterArray<0>>("SatCounterArray<0> bits=" + std::to_string(Bits), Bits, 0, max,
+                                   [](SatCounterArray<0> &t, size_t n, int v) { t.init(n, (unsigned)v, Bits); });
+   check_table<SignedSatCounterArray<Bits>>("SignedSatCounterArray<" + std::to_string(Bits) + ">", Bits, -bias, bias - 1,
+                                            [](SignedSatCounterArray<Bits> &t, size_t n, int v) { t.init(n, v); });
+}
+
+template <unsigned... B>
+static void check_widths(std::integer_sequence<unsigned, B...>)
+{
+   (check_width<B + 1>(), ...);
+}
+
+int main()
+{
+   check_widths(std::make_integer_sequence<unsigned, 8>());
+   printf("sat_counter_check: %u of %u checks passed\n", checks - failed, checks);
+   return failed ? 1 : 0;
+}
@@ -4,6 +4,7 @@
 #include "twobit_predictor.h"
 #include "gshare_predictor.h"
 #include <stdlib.h>
+#include "sat_counter_array.h"
 
 // Tournament selector states (2-bit saturating counter)
 #define STRONG_BIMODAL    0  // Strongly prefer bimodal (P1)
@@ -12,15 +13,15 @@
 #define STRONG_GSHARE     3  // Strongly prefer gshare (P2)
 
 // Tournament predictor state
-static uint8_t* selector_table = NULL;
-static uint32_t selector_mask = 0;
-static int selector_bits = 0;
-static bool initialized = false;
+static thread_local SatCounterArray<2> selector_table;
+static thread_local uint32_t selector_mask = 0;
+static thread_local int selector_bits = 0;
+static thread_local bool initialized = false;
 
 // Store predictions for training
-static uint8_t last_bimodal_pred = 0;
-static uint8_t last_gshare_pred = 0;
-static uint32_t last_pc = 0;
+static thread_local uint8_t last_bimodal_pred = 0;
+static thread_local uint8_t last_gshare_pred = 0;
+static thread_local uint32_t last_pc = 0;
 
 void tournament_predictor_init(int _selector_bits, int bimodal_bits, int gshare_table_bits, int gshare_history_bits) {
     // Clean up any existing state
@@ -29,12 +30,9 @@ void tournament_predictor_init(int _selector_bits, int bimodal_bits, int gshare_
     // Initialize selector table
     selector_bits = _selector_bits;
     uint32_t selector_size = 1 << selector_bits;
-    selector_table = (uint8_t*)malloc(selector_size * sizeof(uint8_t));
     
     // Initialize selectors to weakly prefer bimodal (historical default)
-    for (uint32_t i = 0; i < selector_size; i++) {
-        selector_table[i] = WEAK_BIMODAL;
-    }
+    selector_table.init(selector_size, WEAK_BIMODAL);
     selector_mask = selector_size - 1;
     
     // Initialize the two component predictors
@@ -58,12 +56,11 @@ uint8_t tournament_predictor_predict(uint32_t pc) {
     
     // Use selector to choose which prediction to return
     uint32_t selector_idx = pc & selector_mask;
-    uint8_t selector = selector_table[selector_idx];
     
     // Select based on selector value:
     // 0,1: Use bimodal (P1)
     // 2,3: Use gshare (P2)
-    if (selector <= WEAK_BIMODAL) {
+    if (!selector_table.taken(selector_idx)) {
         return bimodal_pred;  // Use bimodal prediction
     } else {
         return gshare_pred;   // Use gshare prediction
@@ -88,32 +85,27 @@ void tournament_predictor_train(uint32_t pc, uint8_t outcome) {
     
     // Update the selector based on which predictor was more accurate
     uint32_t selector_idx = pc & selector_mask;
-    uint8_t selector = selector_table[selector_idx];
     
     // Use the stored predictions to evaluate accuracy
     bool bimodal_correct = (last_bimodal_pred == outcome);
     bool gshare_correct = (last_gshare_pred == outcome);
     
-    // Update selector based on relative accuracy
-    if (bimodal_correct && !gshare_correct) {
-        // Bimodal was right, gshare was wrong -> favor bimodal
-        if (selector > STRONG_BIMODAL) {
-            selector_table[selector_idx] = selector - 1;
-        }
-    } else if (gshare_correct && !bimodal_correct) {
-        // Gshare was right, bimodal was wrong -> favor gshare  
-        if (selector < STRONG_GSHARE) {
-            selector_table[selector_idx] = selector + 1;
-        }
+    // Update selector based on relative accuracy, saturating at
+    // STRONG_BIMODAL and STRONG_GSHARE:
+    // bimodal right, gshare wrong -> favor bimodal;
+    // gshare right, bimodal wrong -> favor gshare
+    if (bimodal_correct != gshare_correct) {
+        selector_table.update(selector_idx, gshare_correct);
     }
     // If both correct or both wrong, don't update selector
 }
 
+uint64_t tournament_predictor_storage_bits() {
+    return selector_table.storage_bits() + twobit_predictor_storage_bits() + gshare_predictor_storage_bits();
+}
+
 void tournament_predictor_cleanup() {
-    if (selector_table) {
-        free(selector_table);
-        selector_table = NULL;
-    }
+    selector_table.clear();
     
     // Clean up component predictors
     twobit_predictor_cleanup();
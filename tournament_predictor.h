@@ -10,5 +10,7 @@ void tournament_predictor_init(int selector_bits, int bimodal_bits, int gshare_t
 uint8_t tournament_predictor_predict(uint32_t pc);
 void tournament_predictor_train(uint32_t pc, uint8_t outcome);
 void tournament_predictor_cleanup();
+// Bits of state as sized by init().
+uint64_t tournament_predictor_storage_bits();
 
 #endif // TOURNAMENT_PREDICTOR_H
@@ -3,6 +3,8 @@
 #include "twobit_predictor.h"
 #include <stdlib.h>
  #include <cmath>
+#include "pc_interner.h"
+#include "sat_counter_array.h"
 
 
 // 2-bit saturating counter states:
@@ -16,49 +18,51 @@
 #define WEAK_TAKEN        2
 #define STRONG_TAKEN      3
 
-static uint8_t* table = NULL;
-static uint32_t mask = 0;
-static int bits = 0;
-static int n_bits = 2; // default to 2 bits if not set
-static uint8_t max_val = (1 << n_bits) - 1;
-static uint8_t threshold = (1 << (n_bits - 1));
+static thread_local SatCounterArray<2> table;
+static thread_local uint32_t mask = 0;
+static thread_local int bits = 0;
 
-void twobit_predictor_init(int table_bits) {
+// Infinite mode: one counter per interned PC, no aliasing.
+static thread_local bool infinite = false;
+static thread_local SatCounterArray<2> per_pc;
+
+static inline SatCounterArray<2>& table_of(uint64_t pc, size_t* idx) {
+    if (infinite) {
+        *idx = per_pc_counters(per_pc, pc_intern(pc), 1, WEAK_NOT_TAKEN);
+        return per_pc;
+    }
+    *idx = pc & mask;
+    return table;
+}
+
+void twobit_predictor_init(int table_bits, bool _infinite) {
     bits = table_bits;
-    n_bits = 2; // default, can be set externally if needed
-    uint32_t size = 1 << bits;
-    table = (uint8_t*)malloc(size * sizeof(uint8_t));
-    // Initialize to weakly not taken (neutral, can adapt either direction quickly)
-    for (uint32_t i = 0; i < size; i++) table[i] = WEAK_NOT_TAKEN;
-    mask = size - 1;
-    max_val = (1 << n_bits) - 1;
-    threshold = (1 << (n_bits - 1));
+    infinite = _infinite;
+    if (!infinite) {
+        uint32_t size = 1 << bits;
+        // Initialize to weakly not taken (neutral, can adapt either direction quickly)
+        table.init(size, WEAK_NOT_TAKEN);
+        mask = size - 1;
+    }
 }
 
-uint8_t twobit_predictor_predict(uint32_t pc) {
-    uint32_t idx = pc & mask;
-    uint8_t counter = table[idx];
-    // Predict taken if counter >= threshold (upper half of range)
-    return (counter >= threshold) ? 1 : 0;
+uint8_t twobit_predictor_predict(uint64_t pc) {
+    size_t idx;
+    // Predict taken if the counter is in the upper half of its range
+    return table_of(pc, &idx).taken(idx) ? 1 : 0;
 }
 
-void twobit_predictor_train(uint32_t pc, uint8_t outcome) {
-    uint32_t idx = pc & mask;
-    uint8_t counter = table[idx];
-    if (outcome) {
-        // Branch was taken - increment counter (saturate at max_val)
-        if (counter < max_val) {
-            table[idx] = counter + 1;
-        }
-    } else {
-        // Branch was not taken - decrement counter (saturate at 0)
-        if (counter > 0) {
-            table[idx] = counter - 1;
-        }
-    }
+void twobit_predictor_train(uint64_t pc, uint8_t outcome) {
+    size_t idx;
+    // Increment if taken, decrement if not, saturating at both ends
+    table_of(pc, &idx).update(idx, outcome);
+}
+
+uint64_t twobit_predictor_storage_bits() {
+    return infinite ? UINT64_MAX : table.storage_bits();
 }
 
 void twobit_predictor_cleanup() {
-    if (table) free(table);
-    table = NULL;
+    table.clear();
+    per_pc.clear();
 }
@@ -3,8 +3,12 @@
 #ifndef TWOBIT_PREDICTOR_H
 #define TWOBIT_PREDICTOR_H
 #include <stdint.h>
-void twobit_predictor_init(int table_bits);
-uint8_t twobit_predictor_predict(uint32_t pc);
-void twobit_predictor_train(uint32_t pc, uint8_t outcome);
+// infinite: one counter per static branch (interned full PC), table_bits is ignored
+void twobit_predictor_init(int table_bits, bool infinite = false);
+uint8_t twobit_predictor_predict(uint64_t pc);
+void twobit_predictor_train(uint64_t pc, uint8_t outcome);
 void twobit_predictor_cleanup();
+// Bits of state as sized by init(); UINT64_MAX in infinite mode, whose
+// tables grow with the trace.
+uint64_t twobit_predictor_storage_bits();
 #endif